@@ -0,0 +1,139 @@
+#ifndef ARENA_CLASS_HPP
+# define ARENA_CLASS_HPP
+
+# include <cstddef>
+# include <limits>
+# include <new>
+# include <string>
+# include <vector>
+
+# ifndef ARENA_CHUNK_SIZE
+#  define ARENA_CHUNK_SIZE 65536
+# endif
+
+/*
+	Bump-pointer allocator for the temporaries of an event loop iteration.
+
+	Memory is taken from big chunks, by moving a pointer forward, and is only
+	given back all at once by reset(), at the end of the iteration, the chunks
+	being kept for the next ones: once the arena grew large enough for the
+	busiest iteration, it never calls malloc again.
+	Freeing the last allocation moves the pointer back, so a temporary freed
+	right after being used leaves its space to the next one.
+	Requests bigger than a chunk get a block of their own, freed by reset().
+
+	The arena of the iterations, tick(), is only for the main loop thread:
+	nothing allocated in it may outlive the iteration, nor be handed to a worker.
+*/
+class Arena
+{
+private:
+	// Attributes
+	std::vector<char *>	_chunks;
+	std::vector<char *>	_blocks;
+
+	size_t				_chunk;
+	size_t				_used;
+	size_t				_peak;
+	unsigned long		_heapAllocs;
+
+	char				*_last;
+
+	// Constructors
+	Arena(Arena const &src);
+
+	// Operators
+	Arena	&operator=(Arena const &rhs);
+
+public:
+	// Constructors
+	Arena(void);
+
+	// Destructors
+	virtual ~Arena(void);
+
+	// Member functions
+	void	*allocate(size_t const size);
+	void	deallocate(void *const ptr);
+	void	reset(void);
+
+	size_t	used(void) const;
+
+	static Arena	&tick(void);
+
+	// Accessors
+	size_t const		&getPeak(void) const;
+	unsigned long const	&getHeapAllocs(void) const;
+};
+
+/**
+ * Standard allocator taking its memory from the arena of the iterations.
+ */
+template <typename T>
+class ArenaAllocator
+{
+public:
+	typedef T				value_type;
+	typedef T				*pointer;
+	typedef T const			*const_pointer;
+	typedef T				&reference;
+	typedef T const			&const_reference;
+	typedef size_t			size_type;
+	typedef ptrdiff_t		difference_type;
+
+	template <typename U>
+	struct	rebind
+	{
+		typedef ArenaAllocator<U>	other;
+	};
+
+	// Constructors
+	ArenaAllocator(void) {}
+	ArenaAllocator(ArenaAllocator const &) {}
+	template <typename U>
+	ArenaAllocator(ArenaAllocator<U> const &) {}
+
+	// Destructors
+	~ArenaAllocator(void) {}
+
+	// Member functions
+	pointer			address(reference x) const { return &x; }
+	const_pointer	address(const_reference x) const { return &x; }
+
+	pointer			allocate(size_type const n, void const *const = NULL)
+	{
+		return static_cast<pointer>(Arena::tick().allocate(n * sizeof(T)));
+	}
+
+	void			deallocate(pointer const p, size_type const)
+	{
+		Arena::tick().deallocate(p);
+	}
+
+	size_type		max_size(void) const { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+	void			construct(pointer const p, const_reference val) { new (static_cast<void *>(p)) T(val); }
+	void			destroy(pointer const p) { p->~T(); }
+};
+
+template <typename T, typename U>
+bool	operator==(ArenaAllocator<T> const &, ArenaAllocator<U> const &) { return true; }
+
+template <typename T, typename U>
+bool	operator!=(ArenaAllocator<T> const &, ArenaAllocator<U> const &) { return false; }
+
+/**
+ * String for the temporaries of parsing and reply building.
+ */
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char> >	ArenaString;
+
+ArenaString	operator+(ArenaString const &lhs, std::string const &rhs);
+ArenaString	operator+(std::string const &lhs, ArenaString const &rhs);
+ArenaString	&operator+=(ArenaString &lhs, std::string const &rhs);
+
+bool		operator==(ArenaString const &lhs, std::string const &rhs);
+bool		operator==(std::string const &lhs, ArenaString const &rhs);
+bool		operator!=(ArenaString const &lhs, std::string const &rhs);
+bool		operator!=(std::string const &lhs, ArenaString const &rhs);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef CAPTURE_CLASS_HPP
+# define CAPTURE_CLASS_HPP
+
+# include <stdint.h>
+# include <map>
+# include <string>
+
+# ifndef CAPTURE_BUFFER_SIZE
+#  define CAPTURE_BUFFER_SIZE 65536
+# endif
+
+# define CAPTURE_MAGIC		"IRCCAP1\n"
+# define CAPTURE_MAGIC_SIZE	8
+
+/*
+	Recorder of the inbound traffic of every connection, for replay.
+
+	File format, integers being little-endian, and varints being unsigned
+	LEB128 (7 bits per byte, the high bit telling another byte follows):
+		header:	"IRCCAP1\n", then the wall clock time of the file start
+				in microseconds on 8 bytes
+		record:	type (1 byte), connection id (varint),
+				microseconds since the previous record of the file (varint),
+				and for DATA records only: size (varint), then the bytes
+	Connection ids are never reused within a capture, unlike sockets.
+	The file is rotated to <path>.<n> once it grows over its maximum size.
+
+	Records are buffered, and written in big chunks.
+*/
+class Capture
+{
+public:
+	enum	e_record
+	{
+		OPEN,
+		DATA,
+		CLOSE
+	};
+
+private:
+	// Attributes
+	std::string						_path;
+	std::string						_buffer;
+	std::map<int, unsigned long>	_lookupIds;
+
+	int								_fd;
+	unsigned long					_nextId;
+	unsigned int					_rotations;
+	size_t							_maxSize;
+	size_t							_size;
+	uint64_t						_last;
+	uint64_t						_lastFlush;
+
+	// Constructors
+	Capture(Capture const &src);
+
+	// Operators
+	Capture	&operator=(Capture const &rhs);
+
+	// Member functions
+	void	putVarint(uint64_t value);
+	void	record(int const type, int const socket);
+
+	bool	flush(void);
+	bool	openFile(void);
+
+public:
+	// Constructors
+	Capture(void);
+
+	// Destructors
+	virtual ~Capture(void);
+
+	// Member functions
+	void	close(int const socket);
+	void	data(int const socket, char const *const bytes, size_t const size);
+	void	open(int const socket);
+	void	stop(void);
+	void	tick(void);
+
+	bool	init(std::string const &path, size_t const maxSize);
+	bool	isEnabled(void) const;
+
+	static uint64_t	microseconds(void);
+};
+
+#endif
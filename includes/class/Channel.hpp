@@ -3,7 +3,12 @@
 
 #include <iostream>
 #include <algorithm>
+#include <ctime> // time_t
 #include <vector>
+#include "class/History.hpp"
+#include "class/Identifier.hpp"
+#include "class/StateReader.hpp"
+#include "class/StateWriter.hpp"
 #include "class/User.hpp"
 
 
@@ -11,24 +16,72 @@ class User;
 
 class Channel
 {
-private:
+public:
 	enum	e_mode
 	{
-		INVITE_ONLY,
-		INSIDE_ONLY,
-		PRIVATE,
-		SECRET
+		INVITE_ONLY = 1U << 0,
+		INSIDE_ONLY = 1U << 1,
+		SECRET = 1U << 2,
+		MODERATED = 1U << 3,
+		TOPIC_LOCK = 1U << 4,
+		KEY = 1U << 5,
+		LIMIT = 1U << 6
+	};
+
+	enum	e_memberMode
+	{
+		CHANOP = 1U << 0,
+		VOICE = 1U << 1
+	};
+
+	enum	e_modeType
+	{
+		FLAG,		// no parameter
+		PARAM,		// parameter to set and to unset
+		PARAM_SET,	// parameter to set only
+		LIST,		// parameter adding/removing an entry of a list
+		MEMBER		// nickname of the member to (un)set the mode for
 	};
 
+	typedef struct	s_modeDef
+	{
+		char			letter;
+		unsigned int	bit;
+		int				type;
+	}	t_modeDef;
+
+private:
 	// Attributes
-	std::string									_name;
+	Identifier									_name;
 	std::string									_topic;
-	std::string									_modes;
+	std::string									_key;
+
+	unsigned int								_modes;
+	unsigned int								_limit;
+
+	time_t										_timestamp;
+
+	unsigned long								_revision;
+
+	std::vector<std::string>					_banList;
 
-	std::map<std::string const, User *const>	_lookupUsers;
+	History::Ring								_history;
+
+	std::map<Identifier const, User *const>	_lookupUsers;
+	std::map<User const *const, unsigned int>	_lookupMemberModes;
+
+	static unsigned long						_revisions;
+	static unsigned long						_takenRevision;
+	static bool									_isTracked;
+	static std::vector<Identifier>				_changes;
 
 	static std::string const					_availableModes;
 
+	static t_modeDef const						_arrayModes[];
+
+	// Member functions
+	void	touch(void);
+
 public:
 	// Constructors
 	Channel(std::string const &name = "defaultChannelName");
@@ -37,30 +90,68 @@ public:
 	virtual ~Channel(void);
 
 	// Member functions
+	void														addModes(unsigned int const modes);
+	void														addMemberModes(User const &user, unsigned int const modes);
 	void														addUser(User &user);
-	void														delUser(std::string const &nickname);
-
+	void														delModes(unsigned int const modes);
+	void														delMemberModes(User const &user, unsigned int const modes);
+	void														delUser(Identifier const &nickname);
+	void														load(StateReader &state);
+	void														renameUser(Identifier const &nickname, User &user);
+	void														save(StateWriter &state) const;
+
+	bool														addBan(std::string const &mask);
+	bool														delBan(std::string const &mask);
 	bool														empty(void) const;
+	bool														hasMode(unsigned int const mode) const;
+	bool														isBanned(User const &user) const;
+
+	size_t														size(void) const;
+
+	unsigned int												getMemberModes(User const &user) const;
 
-	std::map<std::string const, User *const>::iterator			begin(void);
-	std::map<std::string const, User *const>::iterator			end(void);
-	std::map<std::string const, User *const>::iterator			find(std::string const &nickname);
+	std::string													getModeString(bool const withParams) const;
 
-	std::map<std::string const, User *const>::const_iterator	begin(void) const;
-	std::map<std::string const, User *const>::const_iterator	end(void) const;
-	std::map<std::string const, User *const>::const_iterator	find(std::string const &nickname) const;
+	static t_modeDef const										*getModeDef(char const letter);
+
+	static void													takeChanges(std::vector<Identifier> &changes);
+	static void													track(bool const isTracked);
+
+	std::map<Identifier const, User *const>::iterator			begin(void);
+	std::map<Identifier const, User *const>::iterator			end(void);
+	std::map<Identifier const, User *const>::iterator			find(Identifier const &nickname);
+	std::map<Identifier const, User *const>::iterator			find(std::string const &nickname);
+
+	std::map<Identifier const, User *const>::const_iterator	begin(void) const;
+	std::map<Identifier const, User *const>::const_iterator	end(void) const;
+	std::map<Identifier const, User *const>::const_iterator	find(Identifier const &nickname) const;
+	std::map<Identifier const, User *const>::const_iterator	find(std::string const &nickname) const;
 
 	// Accessors
 	std::string const	&getName(void) const;
+	Identifier const	&getNameId(void) const;
 	std::string const	&getTopic(void) const;
-	std::string const	&getModes(void) const;
+	std::string const	&getKey(void) const;
+
+	unsigned int const	&getModes(void) const;
+	unsigned int const	&getLimit(void) const;
+
+	time_t const		&getTimestamp(void) const;
+
+	std::vector<std::string> const	&getBanList(void) const;
+
+	History::Ring const	&getHistory(void) const;
+	History::Ring		&getHistory(void);
 
 	static std::string const	&getAvailableModes(void);
 
 	// Mutators
 	void	setName(std::string const &name);
 	void	setTopic(std::string const &topic);
-	void	setModes(std::string const &modes);
+	void	setKey(std::string const &key);
+	void	setLimit(unsigned int const limit);
+	void	setModes(unsigned int const modes);
+	void	setTimestamp(time_t const timestamp);
 };
 
 #endif
@@ -0,0 +1,33 @@
+#ifndef CHECKPASSWORDJOB_CLASS_HPP
+# define CHECKPASSWORDJOB_CLASS_HPP
+
+# include <string>
+# include "class/Job.hpp"
+
+class CheckPasswordJob : public Job
+{
+private:
+	// Attributes
+	std::string	_password;
+	std::string	_hash;
+	std::string	_name;
+
+	bool		_isValid;
+
+public:
+	// Constructors
+	CheckPasswordJob(User *const user, t_done const done, std::string const &password, std::string const &hash, std::string const &name = "");
+
+	// Destructors
+	virtual ~CheckPasswordJob(void);
+
+	// Member functions
+	virtual void	execute(void);
+
+	// Accessors
+	std::string const	&getName(void) const;
+
+	bool const			&getIsValid(void) const;
+};
+
+#endif
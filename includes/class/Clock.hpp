@@ -0,0 +1,35 @@
+#ifndef CLOCK_CLASS_HPP
+# define CLOCK_CLASS_HPP
+
+# include <ctime> // time_t
+# include <stdint.h>
+
+/**
+ * The source of the time the server runs on, in seconds, or in
+ * milliseconds for the time of the messages.
+ * Every timer (ping, timeouts, deadlines, caches, logs) reads it,
+ * so that it can be replaced by a virtual clock, see SimClock.
+ * This one is the wall clock.
+ */
+class Clock
+{
+private:
+	// Constructors
+	Clock(Clock const &src);
+
+	// Operators
+	Clock	&operator=(Clock const &rhs);
+
+public:
+	// Constructors
+	Clock(void);
+
+	// Destructors
+	virtual ~Clock(void);
+
+	// Member functions
+	virtual time_t		now(void) const;
+	virtual uint64_t	milliseconds(void) const;
+};
+
+#endif
@@ -21,6 +21,19 @@ private:
 		ping,
 		timeout,
 		backlog,
+		workers,
+		register_timeout,
+		auth_attempts,
+		auth_window,
+		dns_timeout,
+		dns_ttl,
+		dns_negative_ttl,
+		metrics_listen,
+		slow_tick,
+		slow_tick_log_interval,
+		capture_file,
+		capture_max_size,
+		spam_filter,
 		oper_ + name
 	 */
 
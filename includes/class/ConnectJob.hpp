@@ -0,0 +1,40 @@
+#ifndef CONNECTJOB_CLASS_HPP
+# define CONNECTJOB_CLASS_HPP
+
+# include <stdint.h>
+# include <string>
+# include "class/Job.hpp"
+# include "class/Transport.hpp"
+
+class ConnectJob : public Job
+{
+private:
+	// Attributes
+	Transport	&_transport;
+
+	std::string	_host;
+	uint16_t	_port;
+
+	int			_fd;
+	std::string	_error;
+
+public:
+	// Constructors
+	ConnectJob(t_done const done, Transport &transport, std::string const &host, uint16_t const port);
+
+	// Destructors
+	virtual ~ConnectJob(void);
+
+	// Member functions
+	virtual void	execute(void);
+
+	// Accessors
+	std::string const	&getHost(void) const;
+	std::string const	&getError(void) const;
+
+	uint16_t const		&getPort(void) const;
+
+	int const			&getFd(void) const;
+};
+
+#endif
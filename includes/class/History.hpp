@@ -0,0 +1,144 @@
+#ifndef HISTORY_CLASS_HPP
+# define HISTORY_CLASS_HPP
+
+# include <stdint.h>
+# include <cstddef>
+# include <vector>
+
+/**
+ * The longest message kept, the trailing CRLF excluded.
+ */
+# ifndef HISTORY_LINE_LENGTH
+#  define HISTORY_LINE_LENGTH 510
+# endif
+
+/*
+	Message history of the channels, for CHATHISTORY.
+
+	A single block of `history_memory` bytes is allocated at startup, and
+	carved into rings of `history_size` bytes: a channel gets one of them on
+	its first message, and gives it back when it is destroyed. The messages
+	are stored one after the other in the ring, each behind a header holding
+	its msgid and time, the oldest ones being overwritten by the new ones.
+	Once every ring is taken, the channel that got a message the longest ago
+	loses its history to the new one.
+	So a channel never takes more than `history_size` bytes, nor all the
+	channels more than `history_memory` bytes, and storing a message or
+	reading the history never calls malloc.
+
+	The msgids grow with every message, starting from the time the server
+	started: the history of a ring is sorted both by msgid and by time.
+*/
+class History
+{
+public:
+	enum	e_select
+	{
+		LATEST,
+		BEFORE,
+		AFTER
+	};
+
+	/**
+	 * A message of the history, followed by its `size` bytes.
+	 */
+	struct	t_entry
+	{
+		uint64_t	msgid;
+		uint64_t	time;
+		uint32_t	size;
+		uint32_t	length;
+	};
+
+	/**
+	 * The history of a channel: the ring it got from the pool, if any.
+	 * A copy starts without history, and an assignment keeps its own.
+	 */
+	class Ring
+	{
+		friend class History;
+
+	private:
+		// Attributes
+		History	*_pool;
+		size_t	_index;
+
+	public:
+		// Constructors
+		Ring(void);
+		Ring(Ring const &src);
+
+		// Destructors
+		~Ring(void);
+
+		// Operators
+		Ring	&operator=(Ring const &rhs);
+	};
+
+private:
+	struct	t_ring
+	{
+		Ring	*owner;
+		size_t	head;
+		size_t	tail;
+		size_t	end;
+		size_t	count;
+		size_t	older;
+		size_t	newer;
+	};
+
+	// Attributes
+	char				*_memory;
+	size_t				_ringSize;
+
+	std::vector<t_ring>	_rings;
+	std::vector<size_t>	_free;
+	size_t				_newest;
+	size_t				_oldest;
+
+	uint64_t			_nextMsgid;
+	unsigned long		_evictions;
+
+	// Constructors
+	History(History const &src);
+
+	// Operators
+	History	&operator=(History const &rhs);
+
+	// Member functions
+	void			acquire(Ring &ring);
+	void			release(size_t const index);
+	void			unlink(size_t const index);
+	void			pushNewest(size_t const index);
+
+	size_t			bound(t_ring const &state, bool const byTime, uint64_t const key, bool const isStrict) const;
+	t_entry const	*at(t_ring const &state, size_t const pos) const;
+	t_entry const	*skip(t_ring const &state, size_t pos, size_t nb) const;
+
+public:
+	// Constructors
+	History(void);
+
+	// Destructors
+	virtual ~History(void);
+
+	// Member functions
+	void			append(Ring &ring, uint64_t const msgid, uint64_t const time, char const *const line, size_t const size);
+	bool			init(size_t const memory, size_t const ringSize, uint64_t const firstMsgid);
+	void			stop(void);
+
+	size_t			select(Ring const &ring, e_select const way, bool const byTime, uint64_t const key, size_t const limit, t_entry const *&first) const;
+	t_entry const	*next(Ring const &ring, t_entry const *const entry) const;
+
+	uint64_t		newMsgid(void);
+
+	size_t			used(void) const;
+
+	static char const	*getLine(t_entry const *const entry);
+
+	// Accessors
+	size_t const		&getRingSize(void) const;
+	unsigned long const	&getEvictions(void) const;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef IDENTIFIER_CLASS_HPP
+# define IDENTIFIER_CLASS_HPP
+
+# include <string>
+# include <vector>
+# include "class/Arena.hpp"
+
+/**
+ * Handle to a nickname or a channel name, interned in a table shared by the
+ * whole server, so the indexes keyed by a name hold a pointer instead of
+ * a copy of it.
+ * Names are compared case insensitively, following the rfc1459 casemapping:
+ * the hash of their casefolded form is computed once when interned, and two
+ * names equal once casefolded share the same entry, so comparing two handles
+ * is comparing two pointers, and ordering them is mostly comparing two hashes.
+ * An entry is forgotten when the last handle to it is destroyed.
+ */
+class Identifier
+{
+private:
+	struct	t_entry
+	{
+		t_entry			*next;
+		unsigned long	hash;
+		unsigned long	refs;
+		std::string		name;
+	};
+
+	// Attributes
+	t_entry			*_entry;
+	unsigned long	_hash;
+
+	static std::vector<t_entry *>	_buckets;
+	static size_t					_size;
+
+	// Constructors
+	Identifier(t_entry *const entry);
+
+	// Member functions
+	void	release(void);
+
+	static int				compare(std::string const &lhs, char const *const rhs, size_t const size);
+	static unsigned long	hash(char const *const name, size_t const size);
+	static t_entry			**lookup(char const *const name, size_t const size, unsigned long const hash);
+
+public:
+	// Constructors
+	Identifier(void);
+	explicit Identifier(std::string const &name);
+	Identifier(Identifier const &src);
+
+	// Destructors
+	~Identifier(void);
+
+	// Operators
+	Identifier	&operator=(Identifier const &rhs);
+
+	bool		operator==(Identifier const &rhs) const;
+	bool		operator!=(Identifier const &rhs) const;
+	bool		operator<(Identifier const &rhs) const;
+
+	// Member functions
+	bool	empty(void) const;
+
+	static Identifier	find(std::string const &name);
+	static Identifier	find(ArenaString const &name);
+
+	static std::string	fold(std::string const &name);
+
+	static size_t		size(void);
+
+	// Accessors
+	std::string const	&getName(void) const;
+
+	unsigned long		getHash(void) const;
+
+	// Mutators
+	void	setName(std::string const &name);
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef JOB_CLASS_HPP
+# define JOB_CLASS_HPP
+
+# include <cstddef> // NULL
+
+class Server;
+class User;
+
+/**
+ * A unit of blocking work run by a ThreadPool worker.
+ * `execute()` runs on a worker thread and must only touch the job's own
+ * attributes; the completion callback then runs back on the event loop.
+ * A job may belong to an user, which is then suspended until it completes.
+ */
+class Job
+{
+public:
+	typedef bool	(Server::*t_done)(Job &job);
+
+private:
+	// Attributes
+	User	*_user;
+	t_done	_done;
+
+	// Constructors
+	Job(Job const &src);
+
+	// Operators
+	Job	&operator=(Job const &rhs);
+
+public:
+	// Constructors
+	Job(User *const user = NULL, t_done const done = NULL);
+
+	// Destructors
+	virtual ~Job(void);
+
+	// Member functions
+	virtual void	execute(void) = 0;
+
+	// Accessors
+	User	*getUser(void) const;
+	t_done	getDone(void) const;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef LATENCYHISTOGRAM_CLASS_HPP
+# define LATENCYHISTOGRAM_CLASS_HPP
+
+# include <stdint.h>
+# include <vector>
+
+# ifndef LATENCY_SUB_BUCKET_BITS
+#  define LATENCY_SUB_BUCKET_BITS 4
+# endif
+
+/**
+ * HDR-style histogram of durations in nanoseconds.
+ * Values are split in powers of 2, each of them being split in
+ * 2^LATENCY_SUB_BUCKET_BITS linear sub-buckets, so any recorded value is
+ * known within 1/2^LATENCY_SUB_BUCKET_BITS of its magnitude,
+ * whatever this magnitude is, for a fixed memory footprint.
+ */
+class LatencyHistogram
+{
+private:
+	// Attributes
+	std::vector<unsigned long>	_buckets;
+	unsigned long				_count;
+	uint64_t					_max;
+
+	// Member functions
+	static size_t	bucketOf(uint64_t const value);
+	static uint64_t	highestOf(size_t const bucket);
+
+public:
+	// Constructors
+	LatencyHistogram(void);
+
+	// Destructors
+	virtual ~LatencyHistogram(void);
+
+	// Member functions
+	void		record(uint64_t const value);
+
+	uint64_t	percentile(double const p) const;
+
+	// Accessors
+	unsigned long const	&getCount(void) const;
+	uint64_t const		&getMax(void) const;
+};
+
+#endif
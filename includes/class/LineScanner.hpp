@@ -0,0 +1,68 @@
+#ifndef LINESCANNER_CLASS_HPP
+# define LINESCANNER_CLASS_HPP
+
+# include <cstddef>
+# include <vector>
+# include "class/Arena.hpp"
+
+/**
+ * Finds every line of a buffer received from a client in a single pass,
+ * checking at the same time whether each of them is valid UTF-8.
+ * The buffer is read 32 (AVX2) or 16 (SSE2) bytes at a time, the blocks
+ * of ASCII only needing their '\n' to be located, while the others,
+ * and the end of the buffer, go through the scalar UTF-8 decoder.
+ * The version used is the best one the CPU supports, known at startup.
+ */
+class LineScanner
+{
+public:
+	struct	t_line
+	{
+		size_t	end;
+		bool	isUtf8;
+	};
+
+	typedef std::vector<t_line, ArenaAllocator<t_line> >	t_lines;
+	typedef void	(*t_scan)(char const *const data, size_t const size, t_lines &lines);
+
+private:
+	/**
+	 * Where the UTF-8 decoder is in the current character: the number
+	 * of bytes still expected, and the range the next one has to be in.
+	 */
+	struct	t_state
+	{
+		unsigned int	pending;
+		unsigned char	lo;
+		unsigned char	hi;
+		bool			isUtf8;
+	};
+
+	// Attributes
+	static t_scan const			_scan;
+	static char const *const	_name;
+
+	// Constructors
+	LineScanner(void);
+
+	// Member functions
+	static void			scanBytes(char const *const data, size_t const from, size_t const to, t_state &state, t_lines &lines);
+
+	static t_scan		select(void);
+	static char const	*selectName(void);
+
+public:
+	// Member functions
+	static void	scan(char const *const data, size_t const size, t_lines &lines);
+	static void	scanScalar(char const *const data, size_t const size, t_lines &lines);
+	static void	scanSse2(char const *const data, size_t const size, t_lines &lines);
+	static void	scanAvx2(char const *const data, size_t const size, t_lines &lines);
+
+	static bool	hasSse2(void);
+	static bool	hasAvx2(void);
+
+	// Accessors
+	static char const	*getName(void);
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef METRICS_CLASS_HPP
+# define METRICS_CLASS_HPP
+
+# include <list>
+# include <stdint.h>
+# include <map>
+# include <string>
+# include <vector>
+
+/*
+	Registry of counters, gauges and histograms, rendered in the Prometheus
+	text exposition format.
+	The values are only updated by the event loop thread, so the hot paths
+	increment plain integers through the handles given at registration,
+	without any lock nor lookup.
+*/
+class Metrics
+{
+public:
+	class Histogram
+	{
+	private:
+		// Attributes
+		double const				*_bounds;
+		std::vector<unsigned long>	_buckets;
+		double						_sum;
+		unsigned long				_count;
+
+	public:
+		// Constructors
+		Histogram(double const *const bounds);
+
+		// Member functions
+		void	observe(double const value);
+		void	render(std::string &out, std::string const &name, std::string const &labels) const;
+	};
+
+private:
+	enum	e_type
+	{
+		COUNTER,
+		GAUGE,
+		HISTOGRAM
+	};
+
+	struct	t_series
+	{
+		std::string		labels;
+		unsigned long	*counter;
+		long			*gauge;
+		Histogram		*histogram;
+	};
+
+	struct	t_family
+	{
+		std::string				name;
+		std::string				help;
+		int						type;
+		std::vector<t_series>	series;
+	};
+
+	// Attributes
+	std::vector<t_family>			_families;
+	std::map<std::string, size_t>	_lookupFamilies;
+
+	std::list<unsigned long>		_counters;
+	std::list<long>					_gauges;
+	std::list<Histogram>			_histograms;
+
+	static char const *const	_arrayTypeNames[];
+
+	// Constructors
+	Metrics(Metrics const &src);
+
+	// Operators
+	Metrics	&operator=(Metrics const &rhs);
+
+	// Member functions
+	t_family	&family(std::string const &name, std::string const &help, int const type);
+
+public:
+	static double const	secondsBounds[];
+	static double const	bytesBounds[];
+
+	// Constructors
+	Metrics(void);
+
+	// Destructors
+	virtual ~Metrics(void);
+
+	// Member functions
+	unsigned long	*addCounter(std::string const &name, std::string const &help, std::string const &labels = "");
+	long			*addGauge(std::string const &name, std::string const &help, std::string const &labels = "");
+	Histogram		*addHistogram(std::string const &name, std::string const &help, double const *const bounds, std::string const &labels = "");
+
+	std::string		render(void) const;
+
+	static double	now(void);
+	static uint64_t	nanoseconds(void);
+};
+
+#endif
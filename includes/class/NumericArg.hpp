@@ -0,0 +1,43 @@
+#ifndef NUMERICARG_CLASS_HPP
+# define NUMERICARG_CLASS_HPP
+
+# include <string>
+# include "class/Arena.hpp"
+
+/**
+ * A parameter of a numeric reply, pointing to its text without copying it,
+ * so the reply is written in a single pass from its parameters.
+ * Only the characters and numbers, that have no text of their own,
+ * are written in the parameter itself.
+ * A parameter must not outlive the text it points to: it is only meant
+ * to be passed to Server::replyNumeric().
+ */
+class NumericArg
+{
+private:
+	// Attributes
+	char const	*_data;
+	size_t		_size;
+	char		_buff[24];
+
+	// Operators
+	NumericArg	&operator=(NumericArg const &rhs);
+
+public:
+	// Constructors
+	NumericArg(std::string const &str);
+	NumericArg(ArenaString const &str);
+	NumericArg(char const *const str);
+	NumericArg(char const c);
+	NumericArg(unsigned long const nb);
+	NumericArg(NumericArg const &src);
+
+	// Destructors
+	~NumericArg(void);
+
+	// Accessors
+	char const	*getData(void) const;
+	size_t		getSize(void) const;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef READFILEJOB_CLASS_HPP
+# define READFILEJOB_CLASS_HPP
+
+# include <string>
+# include <vector>
+# include "class/Job.hpp"
+
+class ReadFileJob : public Job
+{
+private:
+	// Attributes
+	std::string					_path;
+	std::vector<std::string>	_lines;
+
+	bool						_isOpen;
+
+public:
+	// Constructors
+	ReadFileJob(User *const user, t_done const done, std::string const &path);
+
+	// Destructors
+	virtual ~ReadFileJob(void);
+
+	// Member functions
+	virtual void	execute(void);
+
+	// Accessors
+	std::vector<std::string> const	&getLines(void) const;
+
+	bool const						&getIsOpen(void) const;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef RESOLVEJOB_CLASS_HPP
+# define RESOLVEJOB_CLASS_HPP
+
+# include <netinet/in.h> // in_addr
+# include <string>
+# include "class/Job.hpp"
+
+class ResolveJob : public Job
+{
+private:
+	// Attributes
+	in_addr		_addr;
+
+	std::string	_hostname;
+
+	// Member functions
+	bool	confirm(void) const;
+
+public:
+	// Constructors
+	ResolveJob(t_done const done, in_addr const &addr);
+
+	// Destructors
+	virtual ~ResolveJob(void);
+
+	// Member functions
+	virtual void	execute(void);
+
+	// Accessors
+	in_addr const		&getAddr(void) const;
+
+	std::string const	&getHostname(void) const;
+};
+
+#endif
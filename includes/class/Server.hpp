@@ -8,30 +8,96 @@
 # include <map>
 # include <netinet/in.h>// sockaddr_in
 # include <poll.h>
+# include <set>
 # include <string>
 # include <sys/types.h> // socket, bind, listen, recv, send
 # include <sys/socket.h> //   "      "      "      "     "
 # include <unistd.h> // fcntl
 # include "color.h"
 # include "class/User.hpp"
+# include "class/Arena.hpp"
+# include "class/Capture.hpp"
 # include "class/Channel.hpp"
+# include "class/Clock.hpp"
 # include "class/Config.hpp"
+# include "class/ConnectJob.hpp"
+# include "class/History.hpp"
+# include "class/Job.hpp"
+# include "class/LatencyHistogram.hpp"
+# include "class/LineScanner.hpp"
+# include "class/Metrics.hpp"
+# include "class/NumericArg.hpp"
+# include "class/ReadFileJob.hpp"
+# include "class/SnapshotJob.hpp"
+# include "class/SpamFilter.hpp"
+# include "class/StateReader.hpp"
+# include "class/StateWriter.hpp"
+# include "class/TaggedLine.hpp"
+# include "class/TcpTransport.hpp"
+# include "class/ThreadPool.hpp"
+# include "class/Watchdog.hpp"
 
 # ifndef BUFFER_SIZE
 #  define BUFFER_SIZE 4096
 # endif
 
+/**
+ * The most messages a single CHATHISTORY command replies.
+ */
+# ifndef CHATHISTORY_LIMIT
+#  define CHATHISTORY_LIMIT 100
+# endif
+
+# ifndef CONFIG_FILE
+#  define CONFIG_FILE "config/default.conf"
+# endif
+
+# ifndef DNS_CACHE_SIZE
+#  define DNS_CACHE_SIZE 65536
+# endif
+
+/**
+ * The longest line sent to a client, the trailing CRLF excluded.
+ */
+# ifndef MAX_LINE_LENGTH
+#  define MAX_LINE_LENGTH 510
+# endif
+
+/**
+ * How long (in milliseconds) a server handing itself over waits for
+ * the new process to resume, before going on serving.
+ */
+# ifndef UPGRADE_TIMEOUT
+#  define UPGRADE_TIMEOUT 10000
+# endif
+
+/**
+ * The most file descriptors passed in a single message, see SCM_MAX_FD.
+ */
+# ifndef UPGRADE_FDS_PER_MSG
+#  define UPGRADE_FDS_PER_MSG 253
+# endif
+
+# define UPGRADE_MAGIC	"IRCUPG1"
+
 extern bool	g_interrupted;
+extern bool	g_upgrade;
 
 class Server
 {
+	friend class Microbench;
+	friend class Simulation;
+
 private:
-	typedef bool	(Server::*t_fct)(User &user, std::string const &params);
+	typedef bool	(Server::*t_fct)(User &user, ArenaString const &params);
+	typedef bool	(Server::*t_linkFct)(User &link, ArenaString const &source, ArenaString const &params);
+	typedef std::vector<ArenaString, ArenaAllocator<ArenaString> >	t_params;
 
 	enum	e_state
 	{
 		STOPPED,
-		RUNNING
+		RUNNING,
+		HANDED_OVER
 	};
 
 	enum	e_logMsg
@@ -48,87 +114,378 @@ private:
 		RPL_YOURHOST = 002,
 		RPL_CREATED = 003,
 		RPL_MYINFO = 004,
+		RPL_ISUPPORT = 005,
 
+		RPL_STATSLINKINFO = 211,
+		RPL_STATSCOMMANDS = 212,
+		RPL_ENDOFSTATS = 219,
 		RPL_UMODEIS = 221,
 		RPL_AWAY = 301,
 		RPL_WHOISREGNICK = 307,
-		RPL_WHOSIUSER = 311,
+		RPL_WHOISUSER = 311,
 		RPL_WHOISOPERATOR = 313,
 		RPL_ENDOFWHOIS = 318,
 		RPL_CHANNELMODEIS = 324,
+		RPL_NOTOPIC = 331,
 		RPL_TOPIC = 332,
+		RPL_NAMREPLY = 353,
+		RPL_ENDOFNAMES = 366,
+		RPL_BANLIST = 367,
+		RPL_ENDOFBANLIST = 368,
+		RPL_MOTD = 372,
+		RPL_MOTDSTART = 375,
+		RPL_ENDOFMOTD = 376,
 		RPL_WHOISMODES = 379,
 		RPL_YOUREOPER = 381,
+		RPL_REHASHING = 382,
 
 		ERR_NOSUCHNICK = 401,
+		ERR_NOSUCHSERVER = 402,
 		ERR_NOSUCHCHANNEL = 403,
 		ERR_CANTSENDTOCHAN = 404,
+		ERR_TOOMANYTARGETS = 407,
+		ERR_INVALIDCAPCMD = 410,
 		ERR_NORECIPENT = 411,
 		ERR_NOTEXTTOSEND = 412,
+		ERR_NOMOTD = 422,
 		ERR_NONICKNAMEGIVEN = 431,
 		ERR_ERRONEUSNICKNAME = 432,
 		ERR_NICKNAMEINUSE = 433,
+		ERR_NOTREGISTERED = 451,
+		ERR_USERNOTINCHANNEL = 441,
+		ERR_NOTONCHANNEL = 442,
 		ERR_NEEDMOREPARAMS = 461,
 		ERR_ALREADYREGISTRED = 462,
 		ERR_PASSWDMISMATCH = 464,
+		ERR_CHANNELISFULL = 471,
 		ERR_UNKNOWNMODE = 472,
+		ERR_INVITEONLYCHAN = 473,
+		ERR_BANNEDFROMCHAN = 474,
+		ERR_BADCHANNELKEY = 475,
+		ERR_BADCHANMASK = 476,
 		ERR_NOPRIVILEGES = 481,
+		ERR_CHANOPRIVSNEEDED = 482,
+		ERR_CANTKILLSERVER = 483,
 		ERR_UMODEUNKNOWNFLAG = 501,
-		ERR_USERSDONTMATCH = 502
+		ERR_USERSDONTMATCH = 502,
+
+		RPL_MONONLINE = 730,
+		RPL_MONOFFLINE = 731,
+		RPL_MONLIST = 732,
+		RPL_ENDOFMONLIST = 733,
+		ERR_MONLISTFULL = 734
+	};
+
+	/**
+	 * A connection to a linked server, from its PASS to its closing.
+	 * Its name is only known once its SERVER is accepted, and a server
+	 * this one connected to has the `host:port` it was reached at.
+	 */
+	struct	t_link
+	{
+		std::string	name;
+		std::string	target;
+		bool		isAuthenticated;
+	};
+
+	/**
+	 * A server of the network, reached through one of the links:
+	 * either the server of the link itself, or one behind it.
+	 */
+	struct	t_server
+	{
+		User			*link;
+		std::string		uplink;
+		std::string		description;
+		unsigned int	hops;
+	};
+
+	/**
+	 * A server to connect to, from the `links` configuration.
+	 */
+	struct	t_connect
+	{
+		std::string	host;
+		uint16_t	port;
+		time_t		nextAttempt;
+		bool		isPending;
+	};
+
+	/**
+	 * The limits advertised to the users in RPL_ISUPPORT, read from the
+	 * configuration: the longest nickname and channel name, the most modes
+	 * with a parameter a MODE sets, the most targets of a command
+	 * (TARGMAX), and the most nicknames an user monitors.
+	 * A limit of 0 is no limit.
+	 */
+	struct	t_limits
+	{
+		size_t	nicknameLength;
+		size_t	channelLength;
+		size_t	modes;
+		size_t	joinTargets;
+		size_t	kickTargets;
+		size_t	partTargets;
+		size_t	privmsgTargets;
+		size_t	monitors;
+	};
+
+	/**
+	 * The text of a numeric reply, known at compile time, with its number
+	 * of parameters: see the table at the end of this file.
+	 * A numeric missing from the table cannot be replied.
+	 */
+	template <e_rplNo N>
+	struct	t_numeric;
+
+	struct	t_cmdMetrics
+	{
+		unsigned long		*linesIn;
+		unsigned long		*linesOut;
+		unsigned long		*calls;
+		unsigned long		*errors;
+		LatencyHistogram	latency;
+	};
+
+	struct	t_metrics
+	{
+		unsigned long		*connections;
+		unsigned long		*registrations;
+		unsigned long		*bytesIn;
+		unsigned long		*bytesOut;
+		unsigned long		*nonUtf8Lines;
+		long				*users;
+		long				*channels;
+		unsigned long		*arenaHeapAllocs;
+		long				*arenaPeak;
+		unsigned long		*spamMatches[SpamFilter::KILL + 1];
+		long				*spamPatterns;
+		long				*servers;
+		long				*remoteUsers;
+		long				*historyBytes;
+		unsigned long		*historyEvictions;
+		Metrics::Histogram	*sendq;
+		Metrics::Histogram	*pollWait;
+		Metrics::Histogram	*loopIteration;
 	};
 
 	// Attributes
 	int											_state;
 	int											_socket;
+	int											_metricsSocket;
+
+	Clock										_systemClock;
+	Clock										*_clock;
+
+	TcpTransport								_tcpTransport;
+	Transport									*_transport;
 
 	Config										_config;
 
+	ThreadPool									_pool;
+
+	Metrics										_metrics;
+	t_metrics									_stats;
+	t_cmdMetrics								*_currentCmdMetrics;
+	bool										_isCmdError;
+
+	Watchdog									_watchdog;
+	time_t										_slowTickLogTime;
+	unsigned long								_slowTicksNotLogged;
+
+	Capture										_capture;
+
+	SpamFilter									_spamFilter;
+
+	History										_history;
+
+	std::string									_configFile;
+	std::string									_executable;
 	std::string									_creationTime;
+	std::string									_numericPrefix;
+
+	t_limits									_limits;
+	std::vector<std::string>					_isupport;
+
+	unsigned long								_jobsInFlight;
+	time_t										_upgradeDeadline;
+
+	time_t										_nextSnapshot;
+	bool										_isSnapshotPending;
+	bool										_isSnapshotStale;
 
 	std::vector<pollfd>							_pollfds;
+	std::map<int const, size_t>					_lookupPollfds;
 
 	std::list<User>								_users;
+	std::list<User>								_remoteUsers;
 
 	std::map<std::string const, t_fct const>	_lookupCmds;
-	std::map<std::string const, User *const>	_lookupUsers;
-	std::map<std::string const, Channel>		_lookupChannels;
+	std::map<std::string const, t_linkFct const>	_lookupLinkCmds;
+	std::map<Identifier const, User *const>	_lookupUsers;
+	std::map<Identifier const, std::set<User *> >	_lookupWatchers;
+	std::map<int const, User *const>			_lookupSockets;
+	std::map<Identifier const, Channel>		_lookupChannels;
+	SnapshotJob::t_records						_snapshotRecords;
 	std::map<uint const, std::string const>		_lookupLogMsgTypes;
-	
+
+	std::map<in_addr_t const, std::pair<std::string, time_t> >	_lookupHostnames;
+	std::multimap<in_addr_t const, User *const>					_lookupResolving;
+
+	std::multimap<time_t const, int const>		_registrationTimers;
+	std::set<std::string>						_lookupRegistrationCmds;
+
+	std::map<std::string const, t_cmdMetrics>	_lookupCmdMetrics;
+	std::map<int const, std::pair<std::string, std::string> >	_metricsClients;
+
+	std::map<User *const, t_link>				_lookupLinks;
+	std::map<std::string const, t_server>		_lookupServers;
+	std::map<std::string const, t_connect>		_lookupConnects;
+	std::map<User const *const, std::list<User>::iterator>	_lookupRemoteUsers;
+
 	std::list<std::string>						_banList;
 
 	static std::pair<std::string const, t_fct const> const	_arrayCmds[];
+	static std::pair<std::string const, t_linkFct const> const	_arrayLinkCmds[];
 	static std::pair<uint const, char const *const> const	_arrayLogMsgTypes[];
+	static char const *const								_arrayRegistrationCmds[];
+	static std::pair<char const *const, size_t t_limits::*const> const	_arrayTargmax[];
 
 	// Member functions
 	void	logMsg(uint const type, std::string const &msg);
+	void	logMsg(uint const type, ArenaString const &msg);
+	void	logMsg(uint const type, char const *const msg);
+	void	logMsg(uint const type, char const *const msg, size_t const size);
 	void	joinSend(User &user, Channel &channel, std::string const &name_join);
 	void	partSend(User &user, std::string &channel_name, std::string &message_left);
+	void	addPollfd(int const fd, short const events);
 	void	addToBanList(User const &user);
+	void	delPollfd(int const fd);
+	void	disconnect(User &user);
+	void	forgetLink(User &link);
+	void	forgetResolving(User &user);
+	void	forgetWatcher(User &user);
+	void	logSlowTick(void);
+	void	keepHistory(Channel &channel, TaggedLine const &line);
+	void	forgetDormant(Identifier const &name);
+	void	loadSnapshot(void);
+	void	writeSnapshot(void);
 
-	bool	DIE(User &user, std::string const &params);
-	bool	JOIN(User &user, std::string const &params);
-	bool	KICK(User &user, std::string const &params);
-	bool	KILL(User &user, std::string const &params);
-	bool	MODE(User &user, std::string const &params);
-	bool	MOTD(User &user, std::string const &params);
-	bool	NICK(User &user, std::string const &params);
-	bool	OPER(User &user, std::string const &params);
-	bool	PART(User &user, std::string const &params);
-	bool	PASS(User &user, std::string const &params);
-	bool	PING(User &user, std::string const &params);
-	bool	PRIVMSG(User &user, std::string const &params);
-	bool	QUIT(User &user, std::string const &params);
-	bool	USER(User &user, std::string const &params);
-	bool	WHOIS(User &user, std::string const &params);
+	bool	CAP(User &user, ArenaString const &params);
+	bool	CHATHISTORY(User &user, ArenaString const &params);
+	bool	DIE(User &user, ArenaString const &params);
+	bool	JOIN(User &user, ArenaString const &params);
+	bool	KICK(User &user, ArenaString const &params);
+	bool	KILL(User &user, ArenaString const &params);
+	bool	MODE(User &user, ArenaString const &params);
+	bool	MONITOR(User &user, ArenaString const &params);
+	bool	MOTD(User &user, ArenaString const &params);
+	bool	NICK(User &user, ArenaString const &params);
+	bool	OPER(User &user, ArenaString const &params);
+	bool	PART(User &user, ArenaString const &params);
+	bool	PASS(User &user, ArenaString const &params);
+	bool	PING(User &user, ArenaString const &params);
+	bool	PRIVMSG(User &user, ArenaString const &params);
+	bool	QUIT(User &user, ArenaString const &params);
+	bool	REHASH(User &user, ArenaString const &params);
+	bool	SERVER(User &user, ArenaString const &params);
+	bool	STATS(User &user, ArenaString const &params);
+	bool	TOPIC(User &user, ArenaString const &params);
+	bool	USER(User &user, ArenaString const &params);
+	bool	WHOIS(User &user, ArenaString const &params);
+	bool	linkERROR(User &link, ArenaString const &source, ArenaString const &params);
+	bool	linkKICK(User &link, ArenaString const &source, ArenaString const &params);
+	bool	linkKILL(User &link, ArenaString const &source, ArenaString const &params);
+	bool	linkNICK(User &link, ArenaString const &source, ArenaString const &params);
+	bool	linkPART(User &link, ArenaString const &source, ArenaString const &params);
+	bool	linkPING(User &link, ArenaString const &source, ArenaString const &params);
+	bool	linkPONG(User &link, ArenaString const &source, ArenaString const &params);
+	bool	linkPRIVMSG(User &link, ArenaString const &source, ArenaString const &params);
+	bool	linkQUIT(User &link, ArenaString const &source, ArenaString const &params);
+	bool	linkSERVER(User &link, ArenaString const &source, ArenaString const &params);
+	bool	linkSJOIN(User &link, ArenaString const &source, ArenaString const &params);
+	bool	linkSQUIT(User &link, ArenaString const &source, ArenaString const &params);
+	bool	CONNECTdone(Job &job);
+	bool	DNSdone(Job &job);
+	bool	MOTDdone(Job &job);
+	bool	OPERdone(Job &job);
+	bool	PASSdone(Job &job);
+	bool	REHASHdone(Job &job);
+	bool	SNAPSHOTdone(Job &job);
+	bool	allowAuthAttempt(User &user);
+	bool	async(Job *const job);
+	bool	burst(User &link);
 	bool	checkStillAlive(User &user);
+	bool	checkLinks(void);
 	bool	checkPONG(User &user, std::string const &params);
+	bool	channelMode(User &user, std::string const &targetName, std::string const &modeString, std::vector<std::string> const &modeArgs);
+	bool	collectJobs(void);
+	bool	dropLink(User &link, std::string const &reason);
+	bool	expireRegistrations(void);
+	bool	fail(User &user, std::string const &text);
+	bool	flushUser(User &user);
+	bool	forgetNickname(User &user);
+	bool	initMetrics(void);
+	bool	initSupport(void);
 	bool	judge(User &user, std::string &msg);
+	bool	launch(void);
+	bool	kill(User &userToKill, std::string const &source, std::string const &killer, std::string reason, User const *const from = NULL);
+	bool	linkHandshake(User &link);
+	bool	linkJudge(User &link, ArenaString const &line);
+	bool	linkSend(User &link, ArenaString const &line);
+	bool	listenMetrics(void);
+	bool	loadSpamFilter(ReadFileJob const &file, std::string &error);
+	bool	localSend(Channel const &channel, User const *const except, ArenaString const &line);
+	bool	localSend(Channel const &channel, User const *const except, TaggedLine &line);
+	bool	notice(User &user, std::string const &text);
+	bool	notifyWatchers(Identifier const &nickname, bool const isOnline, std::string const &target);
+	bool	propagate(User const *const from, ArenaString const &line);
+	bool	propagateChannel(Channel const &channel, User const *const from, ArenaString const &line);
+	bool	quitChannels(User &user, std::string const &reason);
+	bool	pushNumeric(User &user, e_rplNo const rplNo, char const *const format, NumericArg const *const *const args, size_t const nbArgs);
 	bool	recvAll(void);
+	bool	registerUser(User &user);
+	bool	removeRemoteUser(User &user);
+	bool	rename(User &user, std::string const &nickname);
 	bool	replyPush(User &user, std::string const &line);
+	bool	replyPush(User &user, ArenaString const &line);
+	bool	replyPush(User &user, char const *const line);
+	bool	replyPush(User &user, char const *const line, size_t const size);
 	bool	replySend(User &user);
+	bool	resolve(User &user);
+	bool	restoreState(StateReader &state, std::vector<int> const &fds);
+	bool	serveMetrics(void);
+	bool	snapshot(void);
+	bool	spamCaught(User &user, SpamFilter::t_match const &match);
+	bool	squit(std::string const &name, std::string const &reason);
+	bool	tick(void);
+	bool	updateSnapshot(void);
+	bool	upgrade(void);
+	bool	userMode(User &user, std::string const &targetName, std::string const &modeString);
+	bool	wakeChannel(Channel &channel);
 	bool	welcomeDwarves(void);
 
+	User		*findRemote(User const &link, ArenaString const &nickname);
+	ArenaString	introduce(User const &user);
+
+	void	saveState(StateWriter &state, std::vector<int> &fds);
+
 	static std::string	toString(int const nb);
+	static void			splitParams(ArenaString const &params, t_params &args);
+	static void			appendLine(char *const line, size_t &size, char const *const data, size_t const len);
+	static bool			recvHandover(int const channel, std::string &state, std::vector<int> &fds);
+	static bool			sendHandover(int const channel, std::string const &state, std::vector<int> const &fds);
+
+	template <e_rplNo N>
+	bool	replyNumeric(User &user);
+	template <e_rplNo N>
+	bool	replyNumeric(User &user, NumericArg const &arg0);
+	template <e_rplNo N>
+	bool	replyNumeric(User &user, NumericArg const &arg0, NumericArg const &arg1);
+	template <e_rplNo N>
+	bool	replyNumeric(User &user, NumericArg const &arg0, NumericArg const &arg1, NumericArg const &arg2);
+	template <e_rplNo N>
+	bool	replyNumeric(User &user, NumericArg const &arg0, NumericArg const &arg1, NumericArg const &arg2, NumericArg const &arg3);
 
 public:
 	// Constructors
@@ -138,9 +495,12 @@ public:
 	virtual ~Server(void);
 
 	// Member functions
+	void	setClock(Clock &clock);
+	void	setTransport(Transport &transport);
 	void	stop(void);
 
-	bool	init(std::string const &password);
+	bool	init(std::string const &password, std::string const &configFile = CONFIG_FILE);
+	bool	resume(int const channel);
 	bool	run(void);
 	bool	start(uint16_t const port);
 
@@ -157,4 +517,138 @@ public:
 	 */
 };
 
+// ************************************************************************** //
+//                              Numeric Replies                               //
+// ************************************************************************** //
+
+/**
+ * Fail to compile a reply given another number of parameters than its text takes.
+ */
+# define NUMERIC_ARGS(N, nbArgs)	static_cast<void>(sizeof(char[Server::t_numeric<N>::args == (nbArgs) ? 1 : -1]))
+
+/**
+ * @brief	Append a numeric reply to the message to send to an user client,
+ * 			each '%' of its text being replaced by a parameter, in order.
+ * 
+ * @param	user The user to send the reply to.
+ * 
+ * @return	true if success, false otherwise.
+ */
+template <Server::e_rplNo N>
+bool	Server::replyNumeric(User &user)
+{
+	NUMERIC_ARGS(N, 0);
+	return this->pushNumeric(user, N, Server::t_numeric<N>::format(), NULL, 0UL);
+}
+
+template <Server::e_rplNo N>
+bool	Server::replyNumeric(User &user, NumericArg const &arg0)
+{
+	NumericArg const *const	args[] = {&arg0};
+
+	NUMERIC_ARGS(N, 1);
+	return this->pushNumeric(user, N, Server::t_numeric<N>::format(), args, 1UL);
+}
+
+template <Server::e_rplNo N>
+bool	Server::replyNumeric(User &user, NumericArg const &arg0, NumericArg const &arg1)
+{
+	NumericArg const *const	args[] = {&arg0, &arg1};
+
+	NUMERIC_ARGS(N, 2);
+	return this->pushNumeric(user, N, Server::t_numeric<N>::format(), args, 2UL);
+}
+
+template <Server::e_rplNo N>
+bool	Server::replyNumeric(User &user, NumericArg const &arg0, NumericArg const &arg1, NumericArg const &arg2)
+{
+	NumericArg const *const	args[] = {&arg0, &arg1, &arg2};
+
+	NUMERIC_ARGS(N, 3);
+	return this->pushNumeric(user, N, Server::t_numeric<N>::format(), args, 3UL);
+}
+
+template <Server::e_rplNo N>
+bool	Server::replyNumeric(User &user, NumericArg const &arg0, NumericArg const &arg1, NumericArg const &arg2, NumericArg const &arg3)
+{
+	NumericArg const *const	args[] = {&arg0, &arg1, &arg2, &arg3};
+
+	NUMERIC_ARGS(N, 4);
+	return this->pushNumeric(user, N, Server::t_numeric<N>::format(), args, 4UL);
+}
+
+# define NUMERIC(N, nbArgs, text)							\
+	template <>												\
+	struct	Server::t_numeric<Server::N>					\
+	{														\
+		enum { args = nbArgs };								\
+		static char const	*format(void) { return text; }	\
+	};
+
+NUMERIC(RPL_WELCOME, 1, ":Welcome to the Mine, %.")
+NUMERIC(RPL_YOURHOST, 2, ":Your host is %, running version %.")
+NUMERIC(RPL_CREATED, 1, ":This server was created %.")
+NUMERIC(RPL_MYINFO, 4, "% % % %")
+NUMERIC(RPL_ISUPPORT, 1, "% :are supported by this server")
+NUMERIC(RPL_STATSLINKINFO, 4, "% p50=% p99=% max=%")
+NUMERIC(RPL_STATSCOMMANDS, 3, "% % %")
+NUMERIC(RPL_ENDOFSTATS, 1, "% :End of STATS report")
+NUMERIC(RPL_UMODEIS, 1, "%")
+NUMERIC(RPL_AWAY, 2, "% :%")
+NUMERIC(RPL_WHOISREGNICK, 1, "% :has identified for this nick")
+NUMERIC(RPL_WHOISUSER, 4, "% % % * :%")
+NUMERIC(RPL_WHOISOPERATOR, 1, "% :is an IRC operator")
+NUMERIC(RPL_ENDOFWHOIS, 1, "% :End of /WHOIS list.")
+NUMERIC(RPL_CHANNELMODEIS, 2, "% %")
+NUMERIC(RPL_NOTOPIC, 1, "% :No topic is set")
+NUMERIC(RPL_TOPIC, 2, "% :%")
+NUMERIC(RPL_NAMREPLY, 3, "% % :%")
+NUMERIC(RPL_ENDOFNAMES, 1, "% :End of /NAMES list")
+NUMERIC(RPL_BANLIST, 2, "% %")
+NUMERIC(RPL_ENDOFBANLIST, 1, "% :End of channel ban list")
+NUMERIC(RPL_MOTD, 1, ":%")
+NUMERIC(RPL_MOTDSTART, 0, ":- Hello Digger! -")
+NUMERIC(RPL_ENDOFMOTD, 0, ":End of /MOTD command")
+NUMERIC(RPL_WHOISMODES, 2, "% :is using modes %")
+NUMERIC(RPL_YOUREOPER, 0, ":You are now an IRC operator.")
+NUMERIC(RPL_REHASHING, 1, "% :Rehashing")
+
+NUMERIC(ERR_NOSUCHNICK, 1, "% :No such nick/channel")
+NUMERIC(ERR_NOSUCHSERVER, 1, "% :No such server")
+NUMERIC(ERR_NOSUCHCHANNEL, 1, "% :No such channel")
+NUMERIC(ERR_CANTSENDTOCHAN, 1, "% :Cannot send to channel")
+NUMERIC(ERR_TOOMANYTARGETS, 1, "% :Too many targets")
+NUMERIC(ERR_INVALIDCAPCMD, 1, "% :Invalid CAP command")
+NUMERIC(ERR_NORECIPENT, 1, ":No recipent given %")
+NUMERIC(ERR_NOTEXTTOSEND, 0, ":No text to send")
+NUMERIC(ERR_NOMOTD, 0, ":MOTD File is missing")
+NUMERIC(ERR_NONICKNAMEGIVEN, 0, ":No nickname given")
+NUMERIC(ERR_ERRONEUSNICKNAME, 1, "% :Erroneous nickname")
+NUMERIC(ERR_NICKNAMEINUSE, 1, "% :Nickname is already in use")
+NUMERIC(ERR_NOTREGISTERED, 0, ":You have not registered")
+NUMERIC(ERR_USERNOTINCHANNEL, 2, "% % :They aren't on that channel")
+NUMERIC(ERR_NOTONCHANNEL, 1, "% :You're not on that channel")
+NUMERIC(ERR_NEEDMOREPARAMS, 1, "% :Not enough parameters")
+NUMERIC(ERR_ALREADYREGISTRED, 0, ":You may not reregister")
+NUMERIC(ERR_PASSWDMISMATCH, 0, ":Password incorrect")
+NUMERIC(ERR_CHANNELISFULL, 1, "% :Cannot join channel (+l)")
+NUMERIC(ERR_UNKNOWNMODE, 1, "% :is unknown mode char to me")
+NUMERIC(ERR_INVITEONLYCHAN, 1, "% :Cannot join channel (+i)")
+NUMERIC(ERR_BANNEDFROMCHAN, 1, "% :Cannot join channel (+b)")
+NUMERIC(ERR_BADCHANNELKEY, 1, "% :Cannot join channel (+k)")
+NUMERIC(ERR_BADCHANMASK, 1, "% :Bad Channel Mask")
+NUMERIC(ERR_NOPRIVILEGES, 0, ":Permission Denied - You're not an IRC operator")
+NUMERIC(ERR_CHANOPRIVSNEEDED, 1, "% :You're not channel operator")
+NUMERIC(ERR_CANTKILLSERVER, 0, ":You can't kill a server!")
+NUMERIC(ERR_UMODEUNKNOWNFLAG, 0, ":Unknown MODE flag")
+NUMERIC(ERR_USERSDONTMATCH, 0, ":Cant change mode for other users")
+
+NUMERIC(RPL_MONONLINE, 1, ":%")
+NUMERIC(RPL_MONOFFLINE, 1, ":%")
+NUMERIC(RPL_MONLIST, 1, ":%")
+NUMERIC(RPL_ENDOFMONLIST, 0, ":End of MONITOR list")
+NUMERIC(ERR_MONLISTFULL, 2, "% % :Monitor list is full")
+
+# undef NUMERIC
+
 #endif
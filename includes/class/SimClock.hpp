@@ -0,0 +1,30 @@
+#ifndef SIMCLOCK_CLASS_HPP
+# define SIMCLOCK_CLASS_HPP
+
+# include "class/Clock.hpp"
+
+/**
+ * A virtual clock, only moving forward when told to.
+ * Hours of pings and timeouts then elapse in as many loop iterations.
+ */
+class SimClock : public Clock
+{
+private:
+	// Attributes
+	time_t	_now;
+
+public:
+	// Constructors
+	SimClock(time_t const start = 0);
+
+	// Destructors
+	virtual ~SimClock(void);
+
+	// Member functions
+	void	advance(time_t const seconds);
+
+	virtual time_t		now(void) const;
+	virtual uint64_t	milliseconds(void) const;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef SIMTRANSPORT_CLASS_HPP
+# define SIMTRANSPORT_CLASS_HPP
+
+# include <deque>
+# include <map>
+# include <vector>
+# include "class/Transport.hpp"
+
+# ifndef SIM_FD_BASE
+#  define SIM_FD_BASE (1 << 24)
+# endif
+
+/**
+ * An in-memory network, the clients being driven by the caller
+ * through connect(), write(), read() and shutdown().
+ * Every connection is a pair of unbounded byte queues, socketpair-like,
+ * known to both sides by the same descriptor.
+ * The descriptors start at SIM_FD_BASE, far above the real ones,
+ * which poll() still forwards to the system, without ever blocking:
+ * the simulation decides when the time goes by, not the network.
+ */
+class SimTransport : public Transport
+{
+private:
+	struct	t_conn
+	{
+		sockaddr_in	addr;
+		std::string	toServer;
+		std::string	toClient;
+		bool		isClientClosed;
+		bool		isServerClosed;
+	};
+
+	// Attributes
+	std::map<int, t_conn>	_conns;
+	std::deque<int>			_backlog;
+	std::vector<pollfd>		_realFds;
+	std::vector<nfds_t>		_realIdx;
+
+	int						_listener;
+	int						_nextFd;
+
+public:
+	// Constructors
+	SimTransport(void);
+
+	// Destructors
+	virtual ~SimTransport(void);
+
+	// Member functions
+	void	shutdown(int const fd);
+	void	write(int const fd, std::string const &data);
+
+	bool	read(int const fd, std::string &data);
+
+	int		connect(sockaddr_in const &addr);
+
+	size_t	size(void) const;
+
+	virtual void	close(int const fd);
+
+	virtual int		accept(int const listener, sockaddr_in &addr);
+	virtual int		connect(std::string const &host, uint16_t const port, std::string &error);
+	virtual int		listen(std::string const &host, uint16_t const port, std::string &error);
+	virtual int		poll(pollfd *const fds, nfds_t const nfds, int const timeout);
+
+	virtual ssize_t	recv(int const fd, char *const buff, size_t const size);
+	virtual ssize_t	send(int const fd, char const *const buff, size_t const size);
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef SNAPSHOTJOB_CLASS_HPP
+# define SNAPSHOTJOB_CLASS_HPP
+
+# include <map>
+# include <string>
+# include "class/Identifier.hpp"
+# include "class/WriteFileJob.hpp"
+
+# define SNAPSHOT_MAGIC	"IRCSNAP1"
+
+/**
+ * Writer of the snapshot file: the SNAPSHOT_MAGIC, the number of channels,
+ * then the settings of each of them as written by Channel::save(), each
+ * preceded by its size, in the order of the lookup.
+ * The records are only read by the worker thread, and must not change
+ * until the job completes.
+ */
+class SnapshotJob : public WriteFileJob
+{
+public:
+	/**
+	 * The settings of a channel as written in the snapshot. A dormant channel
+	 * is one read from the snapshot that nobody joined yet, only decoded
+	 * once someone does.
+	 */
+	struct	t_record
+	{
+		std::string	data;
+		bool		isDormant;
+	};
+
+	typedef std::map<Identifier const, t_record>	t_records;
+
+private:
+	// Attributes
+	t_records const	&_records;
+
+public:
+	// Constructors
+	SnapshotJob(t_done const done, std::string const &path, t_records const &records);
+
+	// Destructors
+	virtual ~SnapshotJob(void);
+
+	// Member functions
+	virtual void	execute(void);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef SPAMFILTER_CLASS_HPP
+# define SPAMFILTER_CLASS_HPP
+
+# include <stdint.h>
+# include <string>
+# include <vector>
+
+/**
+ * Above this many bytes a pattern may start with, out of 256,
+ * the text is not skipped 16 bytes at a time.
+ */
+# ifndef SPAMFILTER_MAX_CANDIDATES
+#  define SPAMFILTER_MAX_CANDIDATES 48
+# endif
+
+/**
+ * Content filter of the messages, matching all its patterns at once.
+ * The patterns, case insensitive, are compiled into a single Aho-Corasick
+ * automaton whose transitions are a flat table, indexed by the state and
+ * by the class of the byte: the bytes no pattern holds share one class,
+ * keeping the table small. While the automaton is at its root, the text is
+ * skipped 16 bytes at a time (SSSE3) to the next byte a pattern starts with,
+ * when few bytes start a pattern.
+ * Each pattern comes with the action to take when a message holds it,
+ * the most severe action of the matching patterns being the one taken.
+ */
+class SpamFilter
+{
+public:
+	enum	e_action
+	{
+		NONE,
+		WARN,
+		DROP,
+		KILL
+	};
+
+	struct	t_match
+	{
+		e_action	action;
+		size_t		pattern;
+	};
+
+private:
+	// Attributes
+	std::vector<std::string>	_patterns;
+	std::vector<e_action>		_actions;
+
+	std::vector<uint32_t>		_delta;
+	std::vector<unsigned char>	_outActions;
+	std::vector<uint32_t>		_outPatterns;
+	uint16_t					_classes[256];
+	size_t						_nbClasses;
+
+	bool						_starts[256];
+	unsigned char				_lowNibbles[16];
+	unsigned char				_highNibbles[16];
+	bool						_isSelective;
+
+	static bool const			_hasSsse3;
+
+	// Member functions
+	size_t			skipScalar(char const *const data, size_t idx, size_t const size) const;
+	size_t			skipSsse3(char const *const data, size_t idx, size_t const size) const;
+	t_match			run(char const *const data, size_t const size, bool const simd) const;
+
+	static bool		detectSsse3(void);
+
+public:
+	// Constructors
+	SpamFilter(void);
+
+	// Destructors
+	virtual ~SpamFilter(void);
+
+	// Member functions
+	bool	compile(std::vector<std::string> const &lines, std::string &error);
+	void	swap(SpamFilter &other);
+
+	t_match	match(char const *const data, size_t const size) const;
+	t_match	matchScalar(char const *const data, size_t const size) const;
+
+	// Accessors
+	std::string const	&getPattern(size_t const idx) const;
+	size_t				getSize(void) const;
+
+	static char const	*getActionName(e_action const action);
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef STATEREADER_CLASS_HPP
+# define STATEREADER_CLASS_HPP
+
+# include <stdint.h>
+# include <string>
+
+/**
+ * Parser of a buffer written by a StateWriter, never reading past its end.
+ * Reading past the end, or a malformed varint, makes the reader invalid:
+ * every following read gives 0 or an empty string, so the validity only
+ * has to be checked once everything is read.
+ * The buffer is not copied, and has to outlive the reader.
+ */
+class StateReader
+{
+private:
+	// Attributes
+	char const	*_data;
+	size_t		_size;
+	size_t		_pos;
+	bool		_isValid;
+
+	// Constructors
+	StateReader(StateReader const &src);
+
+	// Operators
+	StateReader	&operator=(StateReader const &rhs);
+
+public:
+	// Constructors
+	StateReader(char const *const data, size_t const size);
+
+	// Destructors
+	virtual ~StateReader(void);
+
+	// Member functions
+	uint64_t	getVarint(void);
+	std::string	getString(void);
+
+	bool		atEnd(void) const;
+	bool		isValid(void) const;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef STATEWRITER_CLASS_HPP
+# define STATEWRITER_CLASS_HPP
+
+# include <stdint.h>
+# include <string>
+
+/**
+ * Serializer of the state of the server into a flat buffer of bytes,
+ * read back by a StateReader.
+ * Integers are unsigned LEB128 varints (7 bits per byte, the high bit
+ * telling another byte follows), and strings their size as a varint
+ * followed by their bytes.
+ */
+class StateWriter
+{
+private:
+	// Attributes
+	std::string	_data;
+
+public:
+	// Constructors
+	StateWriter(void);
+
+	// Destructors
+	virtual ~StateWriter(void);
+
+	// Member functions
+	void	putVarint(uint64_t value);
+	void	putString(std::string const &str);
+	void	putString(char const *const data, size_t const size);
+	void	reserve(size_t const size);
+
+	// Accessors
+	std::string const	&getData(void) const;
+};
+
+#endif
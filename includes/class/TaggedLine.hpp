@@ -0,0 +1,56 @@
+#ifndef TAGGEDLINE_CLASS_HPP
+# define TAGGEDLINE_CLASS_HPP
+
+# include <stdint.h>
+# include "class/Arena.hpp"
+# include "class/User.hpp"
+
+/**
+ * The longest tags of a message:
+ * `@time=YYYY-MM-DDThh:mm:ss.sssZ;msgid=<16 hex digits> `.
+ */
+# define TAGS_LENGTH	(6 + 24 + 7 + 16 + 1)
+
+/**
+ * A message sent to several users, with the tags each of them asked for
+ * with CAP: its time (server-time) and its msgid (message-tags).
+ * The tagged line is only written the first time an user asks for
+ * a given set of tags, and shared by the users asking for the same one:
+ * a message to the users that did not negotiate any capability is
+ * sent as is.
+ * A TaggedLine must not outlive the line it points to.
+ */
+class TaggedLine
+{
+private:
+	// Attributes
+	ArenaString const	&_line;
+	uint64_t			_msgid;
+	uint64_t			_time;
+	ArenaString			_lines[(User::MESSAGE_TAGS | User::SERVER_TIME) + 1];
+
+	// Constructors
+	TaggedLine(TaggedLine const &src);
+
+	// Operators
+	TaggedLine	&operator=(TaggedLine const &rhs);
+
+public:
+	// Constructors
+	TaggedLine(ArenaString const &line, uint64_t const msgid, uint64_t const time);
+
+	// Destructors
+	~TaggedLine(void);
+
+	// Member functions
+	ArenaString const	&get(unsigned int const caps);
+
+	static size_t	putTags(char *const tags, unsigned int const caps, uint64_t const msgid, uint64_t const time);
+
+	// Accessors
+	ArenaString const	&getLine(void) const;
+	uint64_t const		&getMsgid(void) const;
+	uint64_t const		&getTime(void) const;
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef TCPTRANSPORT_CLASS_HPP
+# define TCPTRANSPORT_CLASS_HPP
+
+# include "class/Transport.hpp"
+
+/**
+ * The clients connecting over TCP, through the real sockets.
+ */
+class TcpTransport : public Transport
+{
+public:
+	// Constructors
+	TcpTransport(void);
+
+	// Destructors
+	virtual ~TcpTransport(void);
+
+	// Member functions
+	virtual void	close(int const fd);
+
+	virtual int		accept(int const listener, sockaddr_in &addr);
+	virtual int		connect(std::string const &host, uint16_t const port, std::string &error);
+	virtual int		listen(std::string const &host, uint16_t const port, std::string &error);
+	virtual int		poll(pollfd *const fds, nfds_t const nfds, int const timeout);
+
+	virtual ssize_t	recv(int const fd, char *const buff, size_t const size);
+	virtual ssize_t	send(int const fd, char const *const buff, size_t const size);
+};
+
+#endif
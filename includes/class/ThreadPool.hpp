@@ -0,0 +1,52 @@
+#ifndef THREADPOOL_CLASS_HPP
+# define THREADPOOL_CLASS_HPP
+
+# include <deque>
+# include <pthread.h>
+# include <vector>
+# include "class/Job.hpp"
+
+class ThreadPool
+{
+private:
+	// Attributes
+	std::vector<pthread_t>	_threads;
+
+	std::deque<Job *>		_pending;
+	std::deque<Job *>		_completed;
+
+	pthread_mutex_t			_mutex;
+	pthread_cond_t			_cond;
+
+	int						_eventfd;
+
+	bool					_stopping;
+
+	// Constructors
+	ThreadPool(ThreadPool const &src);
+
+	// Operators
+	ThreadPool	&operator=(ThreadPool const &rhs);
+
+	// Member functions
+	static void	*routine(void *arg);
+
+public:
+	// Constructors
+	ThreadPool(void);
+
+	// Destructors
+	virtual ~ThreadPool(void);
+
+	// Member functions
+	void	stop(void);
+
+	bool	init(unsigned int const nbWorkers);
+	bool	pop(std::deque<Job *> &completed);
+	bool	push(Job *const job);
+
+	// Accessors
+	int const	&getEventFd(void) const;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef TRANSPORT_CLASS_HPP
+# define TRANSPORT_CLASS_HPP
+
+# include <netinet/in.h> // sockaddr_in
+# include <poll.h>
+# include <stdint.h>
+# include <string>
+# include <sys/types.h> // ssize_t
+
+/**
+ * The network the clients, and the linked servers, connect through.
+ * The calls mirror their socket counterparts, errno included,
+ * so that the server runs the same on TCP (TcpTransport)
+ * and on an in-memory network (SimTransport).
+ */
+class Transport
+{
+private:
+	// Constructors
+	Transport(Transport const &src);
+
+	// Operators
+	Transport	&operator=(Transport const &rhs);
+
+public:
+	// Constructors
+	Transport(void);
+
+	// Destructors
+	virtual ~Transport(void);
+
+	// Member functions
+	virtual void	close(int const fd) = 0;
+
+	virtual int		accept(int const listener, sockaddr_in &addr) = 0;
+	virtual int		connect(std::string const &host, uint16_t const port, std::string &error) = 0;
+	virtual int		listen(std::string const &host, uint16_t const port, std::string &error) = 0;
+	virtual int		poll(pollfd *const fds, nfds_t const nfds, int const timeout) = 0;
+
+	virtual ssize_t	recv(int const fd, char *const buff, size_t const size) = 0;
+	virtual ssize_t	send(int const fd, char const *const buff, size_t const size) = 0;
+};
+
+#endif
@@ -4,10 +4,14 @@
 #include <iostream>
 #include <map>
 #include <netinet/in.h>// sockaddr_in
+#include <set>
 #include <string>
 #include <sys/types.h> // socket, bind, listen, recv, send
 #include <sys/socket.h> //   "      "      "      "     "
 #include "class/Channel.hpp"
+#include "class/Identifier.hpp"
+#include "class/StateReader.hpp"
+#include "class/StateWriter.hpp"
 
 class Channel;
 
@@ -21,32 +25,100 @@ class Channel;
 
 class User
 {
+public:
+	enum	e_state
+	{
+		CONNECTED,
+		AUTHENTICATED,
+		REGISTERED,
+		LINK
+	};
+
+	enum	e_mode
+	{
+		AWAY = 1U << 0,
+		INVISIBLE = 1U << 1,
+		OPERATOR = 1U << 2
+	};
+
+	/**
+	 * The IRCv3 capabilities an user may request with CAP.
+	 * The tags of a message only depend on the first two.
+	 */
+	enum	e_cap
+	{
+		MESSAGE_TAGS = 1U << 0,
+		SERVER_TIME = 1U << 1,
+		BATCH = 1U << 2,
+		ECHO_MESSAGE = 1U << 3,
+		MULTI_PREFIX = 1U << 4
+	};
+
 private:
-	// Attributes
-	sockaddr_in									_addr;
+	/**
+	 * The cold part of an user: what only the registration,
+	 * the authentication, the server links and a few queries (WHOIS, AWAY) read.
+	 * An user connected to another server of the network has a link:
+	 * the connection to the server it is reached through.
+	 * The nicknames an user monitors are its part of the watchers index
+	 * of the server, only read when it runs MONITOR.
+	 */
+	struct	t_identity
+	{
+		sockaddr_in			addr;
+		std::string			username;
+		std::string			realname;
+		std::string			awayMsg;
+		time_t				authWindowStart;
+		time_t				resolveDeadline;
+		time_t				registerDeadline;
+		time_t				timestamp;
+		unsigned int		authAttempts;
+		User				*link;
+		std::string const	*server;
+		std::set<Identifier>	monitors;
+	};
 
+	// Attributes
 	int											_socket;
+	int											_state;
 
-	std::string									_nickname; // Max length is 9 chars
-	std::string									_username;
-	std::string									_hostname;
-	std::string									_servname;
-	std::string									_realname;
-	std::string									_password;
-	std::string									_awayMsg;
-	std::string									_modes;
-	std::string									_mask;
-	std::string									_msg;
+	unsigned int								_modes;
+	unsigned int								_caps;
+	unsigned int								_pendingJobs;
 
-	bool										_isRegistered;
+	bool										_isNegotiating;
+	bool										_isResolving;
 	bool										_waitingForPong;
 
 	time_t										_lastActivity;
 
-	std::map<std::string const, Channel *const>	_lookupChannels;
+	Identifier									_nickname; // Max length is 9 chars
+	std::string									_mask;
+	std::string									_msg;
+	std::string									_input;
+	std::string									_sendq;
+
+	std::string const							*_hostname;
+	t_identity									*_identity;
+
+	std::map<Identifier const, Channel *const>	_lookupChannels;
 
 	static std::string const	_availableModes;
 	static std::string const	_availableNicknameChars;
+	static std::string const	_noHostname;
+	static std::string const	_noNickname;
+
+	static std::pair<char const, unsigned int const> const	_arrayModes[];
+	static std::pair<char const *const, unsigned int const> const	_arrayCaps[];
+
+	static std::map<std::string const, unsigned long>	_lookupHostnames;
+
+	// Operators
+	User	&operator=(User const &rhs);
+
+	// Member functions
+	void	releaseHostname(void);
 
 public:
 	// Constructors
@@ -58,33 +130,69 @@ public:
 
 	// Member functions
 	void	addChannel(Channel &channel);
-	void	delChannel(std::string const &channelName);
-	void	updateLastActivity(void);
-
+	void	addModes(unsigned int const modes);
+	void	appendMsg(char const *const data, size_t const size);
+	void	appendSendq(char const *const data, size_t const size);
+	void	clearMonitors(void);
+	void	delModes(unsigned int const modes);
+	void	delChannel(Identifier const &channelName);
+	void	eraseSendq(size_t const size);
+	void	load(StateReader &state);
+	void	newAuthAttempt(time_t const window, time_t const now);
+	void	resume(void);
+	void	save(StateWriter &state) const;
+	void	suspend(void);
+	void	updateLastActivity(time_t const now);
+
+	bool	addMonitor(Identifier const &nickname);
+	bool	delMonitor(Identifier const &nickname);
+	bool	hasCap(unsigned int const cap) const;
+	bool	hasMode(unsigned int const mode) const;
+	bool	isRemote(void) const;
 	bool	init(int const &socket, sockaddr_in const &addr); // set _socket & _addr + fcntl() <-- setup non-blocking fd
 
+	std::string	getModeString(void) const;
+
+	static unsigned int	getCapBit(std::string const &name);
+	static unsigned int	getModeBit(char const letter);
+	static std::string	getCapString(unsigned int const caps);
+
 	// Accessors
 	sockaddr_in const									&getAddr(void) const;
 
 	int const											&getSocket(void) const;
+	int const											&getState(void) const;
 
 	std::string const									&getNickname(void) const;
+	Identifier const									&getNicknameId(void) const;
 	std::string const									&getUsername(void) const;
 	std::string const									&getHostname(void) const;
-	std::string const									&getServname(void) const;
 	std::string const									&getRealname(void) const;
-	std::string const									&getPassword(void) const;
 	std::string const									&getAwayMsg(void) const;
-	std::string const									&getModes(void) const;
 	std::string const									&getMask(void) const;
 	std::string const									&getMsg(void) const;
+	std::string const									&getInput(void) const;
+	std::string const									&getSendq(void) const;
 
-	bool const											&getIsRegistered(void) const;
+	unsigned int const									&getModes(void) const;
+	unsigned int const									&getCaps(void) const;
+	unsigned int const									&getPendingJobs(void) const;
+	unsigned int const									&getAuthAttempts(void) const;
+
+	bool const											&getIsNegotiating(void) const;
+	bool const											&getIsResolving(void) const;
 	bool const											&getWaitingForPong(void) const;
 
 	time_t const										&getLastActivity(void) const;
+	time_t const										&getResolveDeadline(void) const;
+	time_t const										&getRegisterDeadline(void) const;
+	time_t const										&getTimestamp(void) const;
+
+	User												*getLink(void) const;
+	std::string const									*getServer(void) const;
 
-	std::map<std::string const, Channel *const> const	&getLookupChannels(void) const;
+	std::map<Identifier const, Channel *const> const	&getLookupChannels(void) const;
+	std::set<Identifier> const							&getMonitors(void) const;
 
 	static std::string const	&getAvailableModes(void);
 	static std::string const	&getAvailableNicknameChars(void);
@@ -95,15 +203,22 @@ public:
 	void	setNickname(std::string const &nickname);
 	void	setUsername(std::string const &username);
 	void	setHostname(std::string const &hostname);
-	void	setServname(std::string const &servname);
 	void	setRealname(std::string const &realname);
-	void	setPassword(std::string const &password);
 	void	setAwayMsg(std::string const &awayMsg);
-	void	setModes(std::string const &modes);
+	void	setModes(unsigned int const modes);
+	void	setCaps(unsigned int const caps);
 	void	setMask(std::string const &mask);
 	void	setMask(void);
 	void	setMsg(std::string const &msg);
-	void	setIsRegistered(bool const isRegistered);
+	void	setInput(std::string const &input);
+	void	setIsNegotiating(bool const isNegotiating);
+	void	setIsResolving(bool const isResolving);
+	void	setResolveDeadline(time_t const resolveDeadline);
+	void	setRegisterDeadline(time_t const registerDeadline);
+	void	setState(int const state);
+	void	setTimestamp(time_t const timestamp);
+	void	setLink(User *const link);
+	void	setServer(std::string const *const server);
 	void	setWaitingForPong(bool const waitingForPong);
 };
 
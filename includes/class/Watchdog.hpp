@@ -0,0 +1,87 @@
+#ifndef WATCHDOG_CLASS_HPP
+# define WATCHDOG_CLASS_HPP
+
+# include <stdint.h>
+# include <string>
+# include "class/Metrics.hpp"
+
+# ifndef WATCHDOG_NAME_SIZE
+#  define WATCHDOG_NAME_SIZE 32
+# endif
+
+/**
+ * Slow-tick detector of the event loop.
+ * The loop marks each change of phase, along with the client it works for,
+ * and the time elapsed since the previous mark is charged to the previous
+ * phase. The slice of time and the command that lasted the longest are kept,
+ * to tell what caused a tick to be slow.
+ * Nothing is allocated on the way, names are copied into fixed buffers.
+ */
+class Watchdog
+{
+public:
+	enum	e_phase
+	{
+		ACCEPT,
+		READ,
+		DISPATCH,
+		FLUSH,
+		TIMERS,
+		WAIT,
+		NB_PHASES
+	};
+
+private:
+	struct	t_culprit
+	{
+		uint64_t	duration;
+		int			phase;
+		int			fd;
+		char		name[WATCHDOG_NAME_SIZE];
+	};
+
+	// Attributes
+	uint64_t		_threshold;
+	uint64_t		_tickStart;
+	uint64_t		_last;
+	uint64_t		_durations[NB_PHASES];
+
+	int				_phase;
+	int				_fd;
+	char			_name[WATCHDOG_NAME_SIZE];
+
+	t_culprit		_worstSlice;
+	t_culprit		_worstCommand;
+
+	unsigned long	*_slowTicks[NB_PHASES];
+
+	static char const *const	_arrayPhaseNames[];
+
+	// Constructors
+	Watchdog(Watchdog const &src);
+
+	// Operators
+	Watchdog	&operator=(Watchdog const &rhs);
+
+	// Member functions
+	static void	copyName(char *const dst, std::string const *const src);
+
+public:
+	// Constructors
+	Watchdog(void);
+
+	// Destructors
+	virtual ~Watchdog(void);
+
+	// Member functions
+	void		command(std::string const &name, uint64_t const duration);
+	void		init(Metrics &metrics, uint64_t const threshold);
+	void		mark(int const phase, int const fd = -1, std::string const *const name = NULL);
+	void		start(void);
+
+	bool		finish(void);
+
+	std::string	report(void) const;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef WRITEFILEJOB_CLASS_HPP
+# define WRITEFILEJOB_CLASS_HPP
+
+# include <string>
+# include "class/Job.hpp"
+
+class WriteFileJob : public Job
+{
+private:
+	// Attributes
+	std::string	_path;
+	std::string	_error;
+
+protected:
+	// Attributes
+	std::string	_data;
+
+public:
+	// Constructors
+	WriteFileJob(User *const user, t_done const done, std::string const &path, std::string const &data);
+
+	// Destructors
+	virtual ~WriteFileJob(void);
+
+	// Member functions
+	virtual void	execute(void);
+
+	// Accessors
+	std::string const	&getPath(void) const;
+	std::string const	&getData(void) const;
+	std::string const	&getError(void) const;
+};
+
+#endif
@@ -1,6 +1,13 @@
 #include <string>
 
+# ifndef PASSWORD_COST
+#  define PASSWORD_COST 10
+# endif
+
 namespace ft
 {
+bool		checkPassword(std::string const &password, std::string const &hash);
+std::string	hashPassword(std::string const &password);
+bool		match(std::string const &mask, std::string const &str);
 std::string	toString(int const nb);
 }
@@ -0,0 +1,549 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+# ifndef BUFFER_SIZE
+#  define BUFFER_SIZE 4096
+# endif
+
+// The longest wait for an expected line, in milliseconds.
+# ifndef EXPECT_TIMEOUT
+#  define EXPECT_TIMEOUT 3000
+# endif
+
+// The longest wait for two servers to link, in milliseconds.
+# ifndef LINK_TIMEOUT
+#  define LINK_TIMEOUT 8000
+# endif
+
+# define PASSWORD "pw"
+# define LINK_PASSWORD "mithril"
+
+/*
+	Multi-node test of the links between servers, on loopback.
+
+	Starts ircserv nodes from generated configuration files, connects
+	clients to them and checks that what a server is told reaches the
+	others. Every check prints a line, and the exit status tells if one
+	of them failed.
+
+	Scenarios:
+		propagation	erebor and ironhills link to moria, which already has
+					an user in a channel: the burst tells them both, then
+					JOIN, PRIVMSG, NICK, PART, QUIT and KILL are sent to
+					one server and seen from the two others
+		collision	erebor has a carol before moria starts and gets another
+					one, then they link: the younger carol is killed and
+					both servers keep the older one
+*/
+
+enum	e_node
+{
+	MORIA,
+	EREBOR,
+	IRONHILLS
+};
+
+struct	t_node
+{
+	std::string	name;
+	uint16_t	port;
+	std::string	links;
+	unsigned	linkRetry;
+	pid_t		pid;
+};
+
+struct	t_client
+{
+	int			fd;
+	std::string	nickname;
+	std::string	input;
+	std::string	line;
+};
+
+struct	t_options
+{
+	std::string	binary;
+	std::string	directory;
+	uint16_t	port;
+};
+
+struct	t_test
+{
+	t_options			opt;
+	std::vector<t_node>	nodes;
+	size_t				checks;
+	size_t				failures;
+};
+
+// ************************************************************************** //
+//                                  Helpers                                   //
+// ************************************************************************** //
+
+/**
+ * @brief	The time of a monotonic clock, in milliseconds.
+ */
+inline static uint64_t	__now(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000UL + static_cast<uint64_t>(ts.tv_nsec) / 1000000UL;
+}
+
+inline static std::string	__toString(uint64_t nb)
+{
+	char	buff[24];
+	char	*ptr;
+
+	ptr = buff + sizeof(buff);
+	do
+		*--ptr = static_cast<char>('0' + nb % 10);
+	while (nb /= 10);
+	return std::string(ptr, buff + sizeof(buff));
+}
+
+inline static bool	__fail(std::string const &msg)
+{
+	std::cerr << "linktest: " << msg << '\n';
+	return false;
+}
+
+inline static void	__usage(void)
+{
+	std::cerr
+	<< "usage: ircserv-linktest [options]\n"
+	<< "  -b <binary>      server to run (./ircserv)\n"
+	<< "  -d <directory>   where the configuration files and logs are written (/tmp)\n"
+	<< "  -p <port>        the nodes listen on the next ports (16700)\n";
+}
+
+inline static bool	__parseOptions(int const argc, char *const *const argv, t_options &opt)
+{
+	int	c;
+
+	opt.binary = "./ircserv";
+	opt.directory = "/tmp";
+	opt.port = 16700;
+	while ((c = getopt(argc, argv, "b:d:p:")) != -1)
+	{
+		switch (c)
+		{
+			case 'b': opt.binary = optarg; break ;
+			case 'd': opt.directory = optarg; break ;
+			case 'p': opt.port = static_cast<uint16_t>(std::strtoul(optarg, NULL, 10)); break ;
+			default:
+				__usage();
+				return false;
+		}
+	}
+	if (opt.binary.empty() || opt.directory.empty() || !opt.port || opt.port > 65532)
+	{
+		__usage();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief	Count a check, telling whether it passed.
+ */
+inline static void	__check(t_test &t, std::string const &name, bool const isOk)
+{
+	++t.checks;
+	if (!isOk)
+		++t.failures;
+	std::cout << (isOk ? "ok    " : "FAIL  ") << name << '\n';
+}
+
+// ************************************************************************** //
+//                                   Nodes                                    //
+// ************************************************************************** //
+
+inline static int	__dial(uint16_t const port)
+{
+	sockaddr_in	addr;
+	int			fd;
+
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd == -1)
+		return -1;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+	if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ * @brief	Write the configuration file of a node and run it, its logs
+ * 			going to `<directory>/linktest-<name>.log`.
+ *
+ * @return	true once the node listens, false otherwise.
+ */
+inline static bool	__start(t_test const &t, t_node &node)
+{
+	std::string const	config = t.opt.directory + "/linktest-" + node.name + ".conf";
+	std::string const	log = t.opt.directory + "/linktest-" + node.name + ".log";
+	std::string const	port = __toString(node.port);
+	std::ofstream		outfile;
+	uint64_t			deadline;
+	int					fd;
+
+	outfile.open(config.c_str());
+	if (!outfile.is_open())
+		return __fail(config + ": cannot be written");
+	outfile
+	<< "server_name = " << node.name << ".test\n"
+	<< "server_description = " << node.name << '\n'
+	<< "link_password = " LINK_PASSWORD "\n"
+	<< "links = " << node.links << '\n'
+	<< "link_retry = " << node.linkRetry << '\n';
+	outfile.close();
+
+	node.pid = fork();
+	if (node.pid == -1)
+		return __fail("fork: " + std::string(strerror(errno)));
+	if (!node.pid)
+	{
+		fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd != -1)
+		{
+			dup2(fd, STDOUT_FILENO);
+			dup2(fd, STDERR_FILENO);
+			close(fd);
+		}
+		execl(t.opt.binary.c_str(), t.opt.binary.c_str(), port.c_str(), PASSWORD, config.c_str(), static_cast<char *>(NULL));
+		_exit(127);
+	}
+	for (deadline = __now() + EXPECT_TIMEOUT ; (fd = __dial(node.port)) == -1 ; usleep(50000))
+		if (__now() > deadline || waitpid(node.pid, NULL, WNOHANG) == node.pid)
+		{
+			node.pid = -1;
+			return __fail(node.name + ": not listening, see " + log);
+		}
+	close(fd);
+	return true;
+}
+
+/**
+ * @brief	Stop a node as an operator would, killing it if it takes too long.
+ */
+inline static void	__stop(t_node &node)
+{
+	uint64_t	deadline;
+
+	if (node.pid <= 0)
+		return ;
+	kill(node.pid, SIGINT);
+	for (deadline = __now() + EXPECT_TIMEOUT ; waitpid(node.pid, NULL, WNOHANG) != node.pid ; usleep(50000))
+		if (__now() > deadline)
+		{
+			kill(node.pid, SIGKILL);
+			waitpid(node.pid, NULL, 0);
+			break ;
+		}
+	node.pid = -1;
+}
+
+inline static void	__stopAll(t_test &t)
+{
+	std::vector<t_node>::iterator	it;
+
+	for (it = t.nodes.begin() ; it != t.nodes.end() ; ++it)
+		__stop(*it);
+}
+
+// ************************************************************************** //
+//                                  Clients                                   //
+// ************************************************************************** //
+
+inline static bool	__send(t_client &client, std::string const &line)
+{
+	std::string const	msg = line + "\r\n";
+
+	return client.fd != -1 && send(client.fd, msg.data(), msg.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(msg.size());
+}
+
+/**
+ * @brief	Read the lines a client receives, skipping them until one comes
+ * 			from the given source and contains the given text. The line
+ * 			is kept in `client.line`.
+ *
+ * @param	client The client reading.
+ * @param	source The nickname or server the line comes from, any if empty.
+ * @param	text The text the line contains.
+ * @param	timeout The longest wait, in milliseconds.
+ *
+ * @return	true if such a line came in time, false otherwise.
+ */
+inline static bool	__expect(t_client &client, std::string const &source, std::string const &text, uint64_t const timeout = EXPECT_TIMEOUT)
+{
+	uint64_t const			deadline = __now() + timeout;
+	uint64_t				now;
+	std::string::size_type	pos;
+	pollfd					pfd;
+	char					buff[BUFFER_SIZE];
+	ssize_t					ret;
+
+	while (true)
+	{
+		while ((pos = client.input.find('\n')) != std::string::npos)
+		{
+			client.line = client.input.substr(0, pos);
+			client.input.erase(0, pos + 1);
+			if ((source.empty() || (!client.line.compare(0, source.size() + 1, ':' + source) &&
+					client.line.find_first_of("! ", 1) == source.size() + 1)) &&
+				client.line.find(text) != std::string::npos)
+				return true;
+		}
+		now = __now();
+		if (client.fd == -1 || now >= deadline)
+			return false;
+		pfd.fd = client.fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, static_cast<int>(deadline - now)) <= 0)
+			return false;
+		ret = recv(client.fd, buff, sizeof(buff), 0);
+		if (ret <= 0)
+		{
+			close(client.fd);
+			client.fd = -1;
+			continue ;
+		}
+		client.input.append(buff, static_cast<size_t>(ret));
+	}
+}
+
+/**
+ * @brief	Connect a client to a node and register it.
+ *
+ * @return	true if it is welcomed, false otherwise.
+ */
+inline static bool	__connect(t_node const &node, t_client &client, std::string const &nickname, std::string const &username)
+{
+	client.fd = __dial(node.port);
+	client.nickname = nickname;
+	client.input.clear();
+	if (client.fd == -1)
+		return __fail(node.name + ": cannot be connected to");
+	if (!__send(client, "PASS " PASSWORD) ||
+		!__send(client, "NICK " + nickname) ||
+		!__send(client, "USER " + username + " 0 * :linktest") ||
+		!__expect(client, "", " 001 " + nickname + ' '))
+		return __fail(node.name + ": " + nickname + " is not welcomed");
+	return true;
+}
+
+inline static void	__disconnect(t_client &client)
+{
+	if (client.fd != -1)
+		close(client.fd);
+	client.fd = -1;
+}
+
+/**
+ * @brief	Ask a server about a nickname with WHOIS until it is known, or
+ * 			unknown, by it: the servers learn of each other's users late.
+ *
+ * @param	client The client asking.
+ * @param	nickname The nickname to ask about.
+ * @param	isKnown Whether the nickname is waited to be known or unknown.
+ * @param	timeout The longest wait, in milliseconds.
+ *
+ * @return	true if the server gave the answer waited for in time,
+ * 			false otherwise. The last 311 line, if any, is kept in
+ * 			`client.line`.
+ */
+inline static bool	__whois(t_client &client, std::string const &nickname, bool const isKnown, uint64_t const timeout = EXPECT_TIMEOUT)
+{
+	uint64_t const	deadline = __now() + timeout;
+	bool			isFound;
+
+	do
+	{
+		if (!__send(client, "WHOIS " + nickname))
+			return false;
+		do
+			if (!__expect(client, "", ' ' + client.nickname + ' ' + nickname + ' '))
+				return false;
+		while (client.line.find(" 311 ") == std::string::npos && client.line.find(" 401 ") == std::string::npos);
+		isFound = client.line.find(" 311 ") != std::string::npos;
+		if (isFound == isKnown)
+			return true;
+		// The rest of the answer.
+		if (isFound && !__expect(client, "", " 318 " + client.nickname + ' ' + nickname + ' '))
+			return false;
+		usleep(100000);
+	}
+	while (__now() < deadline);
+	return false;
+}
+
+// ************************************************************************** //
+//                                 Scenarios                                  //
+// ************************************************************************** //
+
+inline static bool	__propagation(t_test &t)
+{
+	t_client	alice;
+	t_client	bob;
+	t_client	dain;
+	t_client	fili;
+	bool		isOk;
+
+	t.nodes[EREBOR].links = "127.0.0.1:" + __toString(t.nodes[MORIA].port);
+	t.nodes[IRONHILLS].links = t.nodes[EREBOR].links;
+	if (!__start(t, t.nodes[MORIA]) ||
+		!__connect(t.nodes[MORIA], alice, "alice", "alice") ||
+		!__send(alice, "JOIN #hall") ||
+		!__expect(alice, "", " 366 alice #hall ") ||
+		!__start(t, t.nodes[EREBOR]) ||
+		!__start(t, t.nodes[IRONHILLS]) ||
+		!__connect(t.nodes[EREBOR], bob, "bob", "bob") ||
+		!__connect(t.nodes[IRONHILLS], dain, "dain", "dain"))
+		return false;
+
+	__check(t, "burst: users", __whois(bob, "alice", true, LINK_TIMEOUT) && __whois(dain, "alice", true, LINK_TIMEOUT));
+	__check(t, "burst: channels",
+		__send(bob, "JOIN #hall") && __expect(bob, "", " 353 bob ") && bob.line.find("@alice") != std::string::npos);
+	__check(t, "burst: users of the other links", __whois(dain, "bob", true));
+
+	__send(dain, "JOIN #hall");
+	__check(t, "JOIN", __expect(alice, "dain", "JOIN #hall") && __expect(bob, "dain", "JOIN #hall"));
+	__send(dain, "PRIVMSG #hall :hi all");
+	__check(t, "PRIVMSG to a channel", __expect(alice, "dain", "PRIVMSG #hall :hi all") && __expect(bob, "dain", "PRIVMSG #hall :hi all"));
+	__send(bob, "PRIVMSG dain :psst");
+	__check(t, "PRIVMSG to an user two links away", __expect(dain, "bob", "PRIVMSG dain :psst"));
+
+	__send(dain, "NICK thorin");
+	isOk = __expect(alice, "dain", "NICK thorin") && __expect(bob, "dain", "NICK thorin");
+	dain.nickname = "thorin";
+	__send(bob, "PRIVMSG thorin :renamed?");
+	__check(t, "NICK", isOk && __expect(dain, "bob", "PRIVMSG thorin :renamed?") && __whois(bob, "dain", false));
+	__send(bob, "NICK alice");
+	__check(t, "NICK of a remote user refused", __expect(bob, "", " 433 bob alice "));
+
+	__send(bob, "PART #hall :bye");
+	__check(t, "PART", __expect(alice, "bob", "PART #hall") && __expect(dain, "bob", "PART #hall"));
+
+	isOk = __connect(t.nodes[IRONHILLS], fili, "fili", "fili") &&
+		__send(fili, "JOIN #hall") && __expect(alice, "fili", "JOIN #hall");
+	__send(fili, "QUIT :gone");
+	__check(t, "QUIT", isOk && __expect(alice, "fili", "QUIT") && __whois(bob, "fili", false));
+	__disconnect(fili);
+
+	__send(alice, "OPER admin admin");
+	isOk = __expect(alice, "", " 381 alice ");
+	__send(alice, "KILL thorin :begone");
+	__check(t, "KILL", isOk && __expect(dain, "", "Closing Link") &&
+		__expect(alice, "thorin", "QUIT") && __whois(bob, "thorin", false));
+
+	__disconnect(alice);
+	__disconnect(bob);
+	__disconnect(dain);
+	__stopAll(t);
+	return true;
+}
+
+/**
+ * @brief	Link two servers having each an user with the same nickname,
+ * 			registered a few seconds apart: erebor fails to link to moria
+ * 			first, and tries again once both carols are registered.
+ */
+inline static bool	__collision(t_test &t)
+{
+	t_client	older;
+	t_client	younger;
+	t_client	gimli;
+	t_client	balin;
+	bool		isKilled;
+	bool		isSettled;
+
+	t.nodes[EREBOR].links = "127.0.0.1:" + __toString(t.nodes[MORIA].port);
+	t.nodes[EREBOR].linkRetry = 3;
+	if (!__start(t, t.nodes[EREBOR]) ||
+		!__connect(t.nodes[EREBOR], older, "carol", "older"))
+		return false;
+	// The timestamps are in seconds.
+	usleep(1200000);
+	if (!__start(t, t.nodes[MORIA]) ||
+		!__connect(t.nodes[MORIA], younger, "carol", "younger") ||
+		!__connect(t.nodes[MORIA], gimli, "gimli", "gimli") ||
+		!__connect(t.nodes[EREBOR], balin, "balin", "balin"))
+		return false;
+
+	isKilled = __expect(younger, "", "Nick collision", LINK_TIMEOUT);
+	__check(t, "collision: the younger user is killed", isKilled);
+	// A link keeps the order of the lines: what the servers told each other
+	// about carol is handled once a message went each way, both servers
+	// knowing of the other's user.
+	isSettled = __whois(balin, "gimli", true) && __whois(gimli, "balin", true) &&
+		__send(balin, "PRIVMSG gimli :settled?") && __expect(gimli, "balin", "PRIVMSG gimli :settled?") &&
+		__send(gimli, "PRIVMSG balin :settled?") && __expect(balin, "gimli", "PRIVMSG balin :settled?");
+	__check(t, "collision: the older user is kept", isSettled &&
+		__send(older, "PING :alive") && __expect(older, "", "PONG", EXPECT_TIMEOUT) && older.line.find(":alive") != std::string::npos);
+	__check(t, "collision: settled the same way on both servers",
+		__whois(gimli, "carol", true) && gimli.line.find(" carol older ") != std::string::npos &&
+		__whois(balin, "carol", true) && balin.line.find(" carol older ") != std::string::npos);
+
+	__disconnect(older);
+	__disconnect(younger);
+	__disconnect(gimli);
+	__disconnect(balin);
+	__stopAll(t);
+	return true;
+}
+
+int	main(int const argc, char *const *const argv)
+{
+	t_test	t;
+	t_node	node;
+	bool	isDone;
+
+	t.checks = 0;
+	t.failures = 0;
+	if (!__parseOptions(argc, argv, t.opt))
+		return EXIT_FAILURE;
+
+	node.pid = -1;
+	node.linkRetry = 1;
+	node.name = "moria";
+	node.port = static_cast<uint16_t>(t.opt.port + 1);
+	t.nodes.push_back(node);
+	node.name = "erebor";
+	node.port = static_cast<uint16_t>(t.opt.port + 2);
+	t.nodes.push_back(node);
+	node.name = "ironhills";
+	node.port = static_cast<uint16_t>(t.opt.port + 3);
+	t.nodes.push_back(node);
+
+	isDone = __propagation(t);
+	__stopAll(t);
+	isDone = isDone && __collision(t);
+	__stopAll(t);
+	if (!isDone)
+		return EXIT_FAILURE;
+	std::cout << t.checks - t.failures << '/' << t.checks << " checks passed\n";
+	return t.failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,611 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+# ifndef BUFFER_SIZE
+#  define BUFFER_SIZE 4096
+# endif
+
+# ifndef MAX_CONNECTING
+#  define MAX_CONNECTING 64
+# endif
+
+/*
+	Loopback load generator for ircserv.
+
+	Opens N clients, registers them with PASS/NICK/USER, optionally makes them
+	join channels, then drives timestamped PRIVMSG traffic at a target rate.
+	Every delivered message is timed against the timestamp it carries,
+	and the run is summarized as a single CSV line on stdout.
+
+	Modes:
+		dm			each client messages the next one
+		channel		each message is sent to a channel and fanned out to its members
+		reconnect	clients quit and register again as fast as possible,
+					the registration time being the measured latency
+*/
+
+enum	e_clientState
+{
+	DISCONNECTED,
+	CONNECTING,
+	REGISTERING,
+	JOINING,
+	READY
+};
+
+enum	e_phase
+{
+	SETUP,
+	TRAFFIC,
+	DRAIN
+};
+
+struct	t_client
+{
+	int			fd;
+	int			state;
+	int			channel;
+	unsigned	generation;
+	uint64_t	connectStart;
+	std::string	nickname;
+	std::string	input;
+	std::string	output;
+};
+
+struct	t_options
+{
+	std::string	host;
+	uint16_t	port;
+	std::string	password;
+	std::string	scenario;
+	std::string	mode;
+	size_t		clients;
+	size_t		minChanSize;
+	size_t		maxChanSize;
+	double		rate;
+	double		duration;
+	size_t		payload;
+	bool		header;
+};
+
+struct	t_bench
+{
+	t_options				opt;
+	std::vector<t_client>	clients;
+	std::vector<std::vector<size_t> >	channels;
+	std::vector<uint64_t>	latencies;
+	int						phase;
+	size_t					connecting;
+	size_t					sent;
+	size_t					received;
+	size_t					registrations;
+};
+
+// ************************************************************************** //
+//                                  Helpers                                   //
+// ************************************************************************** //
+
+inline static uint64_t	__now(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000UL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+inline static std::string	__toString(uint64_t nb)
+{
+	char	buff[24];
+	char	*ptr;
+
+	ptr = buff + sizeof(buff);
+	do
+		*--ptr = static_cast<char>('0' + nb % 10);
+	while (nb /= 10);
+	return std::string(ptr, buff + sizeof(buff));
+}
+
+inline static bool	__fail(std::string const &msg)
+{
+	std::cerr << "loadgen: " << msg << '\n';
+	return false;
+}
+
+inline static void	__usage(void)
+{
+	std::cerr
+	<< "usage: ircserv-loadgen [options]\n"
+	<< "  -H <host>        server address (127.0.0.1)\n"
+	<< "  -p <port>        server port (6667)\n"
+	<< "  -P <password>    server password, none if empty ()\n"
+	<< "  -n <name>        scenario name printed in the CSV (mode)\n"
+	<< "  -m <mode>        dm | channel | reconnect (dm)\n"
+	<< "  -c <clients>     number of simulated clients (100)\n"
+	<< "  -s <min[:max]>   channel size, uniformly distributed (10)\n"
+	<< "  -r <rate>        messages sent per second, all clients together (1000)\n"
+	<< "  -d <seconds>     traffic duration (5)\n"
+	<< "  -b <bytes>       message payload size (32)\n"
+	<< "  -t               print the CSV header first\n";
+}
+
+inline static bool	__parseOptions(int const argc, char *const *const argv, t_options &opt)
+{
+	int		c;
+	char	*end;
+
+	opt.host = "127.0.0.1";
+	opt.port = 6667;
+	opt.mode = "dm";
+	opt.clients = 100;
+	opt.minChanSize = 10;
+	opt.maxChanSize = 10;
+	opt.rate = 1000.0;
+	opt.duration = 5.0;
+	opt.payload = 32;
+	opt.header = false;
+	while ((c = getopt(argc, argv, "H:p:P:n:m:c:s:r:d:b:t")) != -1)
+	{
+		switch (c)
+		{
+			case 'H': opt.host = optarg; break ;
+			case 'p': opt.port = static_cast<uint16_t>(std::strtoul(optarg, NULL, 10)); break ;
+			case 'P': opt.password = optarg; break ;
+			case 'n': opt.scenario = optarg; break ;
+			case 'm': opt.mode = optarg; break ;
+			case 'c': opt.clients = std::strtoul(optarg, NULL, 10); break ;
+			case 's':
+				opt.minChanSize = std::strtoul(optarg, &end, 10);
+				opt.maxChanSize = (*end == ':' ? std::strtoul(end + 1, NULL, 10) : opt.minChanSize);
+				break ;
+			case 'r': opt.rate = std::strtod(optarg, NULL); break ;
+			case 'd': opt.duration = std::strtod(optarg, NULL); break ;
+			case 'b': opt.payload = std::strtoul(optarg, NULL, 10); break ;
+			case 't': opt.header = true; break ;
+			default:
+				__usage();
+				return false;
+		}
+	}
+	if (opt.scenario.empty())
+		opt.scenario = opt.mode;
+	if ((opt.mode != "dm" && opt.mode != "channel" && opt.mode != "reconnect") ||
+		opt.clients < 2 || !opt.minChanSize || opt.maxChanSize < opt.minChanSize ||
+		opt.rate <= 0.0 || opt.duration <= 0.0)
+	{
+		__usage();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief	Compute the given percentile of the sorted latencies, in microseconds.
+ */
+inline static uint64_t	__percentile(std::vector<uint64_t> const &sorted, double const p)
+{
+	size_t	idx;
+
+	if (sorted.empty())
+		return 0;
+	idx = static_cast<size_t>(p * static_cast<double>(sorted.size()));
+	if (idx >= sorted.size())
+		idx = sorted.size() - 1;
+	return sorted[idx] / 1000;
+}
+
+// ************************************************************************** //
+//                                Connections                                 //
+// ************************************************************************** //
+
+inline static bool	__connect(t_bench &b, t_client &client)
+{
+	sockaddr_in	addr;
+	int			optval;
+
+	client.fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (client.fd == -1)
+		return __fail("socket: " + std::string(strerror(errno)));
+	optval = 1;
+	setsockopt(client.fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+	fcntl(client.fd, F_SETFL, O_NONBLOCK);
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(b.opt.port);
+	addr.sin_addr.s_addr = inet_addr(b.opt.host.c_str());
+	if (connect(client.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1 && errno != EINPROGRESS)
+		return __fail("connect: " + std::string(strerror(errno)));
+
+	client.state = CONNECTING;
+	client.connectStart = __now();
+	client.nickname = "lg" + __toString(static_cast<uint64_t>(getpid())) + 'c' + __toString(static_cast<uint64_t>(&client - &b.clients[0])) + 'g' + __toString(client.generation++);
+	client.input.clear();
+	client.output.clear();
+	if (!b.opt.password.empty())
+		client.output += "PASS " + b.opt.password + "\r\n";
+	client.output += "NICK " + client.nickname + "\r\n";
+	client.output += "USER " + client.nickname + " 0 * :ircserv load generator\r\n";
+	++b.connecting;
+	return true;
+}
+
+inline static void	__disconnect(t_bench &b, t_client &client)
+{
+	if (client.state == CONNECTING || client.state == REGISTERING)
+		--b.connecting;
+	close(client.fd);
+	client.fd = -1;
+	client.state = DISCONNECTED;
+}
+
+/**
+ * @brief	Open new connections for the disconnected clients,
+ * 			without letting more than MAX_CONNECTING registrations in flight.
+ */
+inline static bool	__connectPending(t_bench &b)
+{
+	std::vector<t_client>::iterator	it;
+
+	for (it = b.clients.begin() ; it != b.clients.end() && b.connecting < MAX_CONNECTING ; ++it)
+		if (it->state == DISCONNECTED && !__connect(b, *it))
+			return false;
+	return true;
+}
+
+// ************************************************************************** //
+//                                  Traffic                                   //
+// ************************************************************************** //
+
+inline static void	__onRegistered(t_bench &b, t_client &client)
+{
+	--b.connecting;
+	++b.registrations;
+	if (b.opt.mode == "reconnect")
+	{
+		if (b.phase == TRAFFIC)
+			b.latencies.push_back(__now() - client.connectStart);
+		client.state = READY;
+		if (b.phase != SETUP)
+		{
+			client.output += "QUIT :reconnecting\r\n";
+			send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+			__disconnect(b, client);
+		}
+	}
+	else if (b.opt.mode == "channel")
+	{
+		client.state = JOINING;
+		client.output += "JOIN #lg" + __toString(static_cast<uint64_t>(client.channel)) + "\r\n";
+	}
+	else
+		client.state = READY;
+}
+
+inline static void	__onPrivmsg(t_bench &b, std::string const &line)
+{
+	std::string::size_type	pos;
+	uint64_t				sentAt;
+	uint64_t				now;
+
+	pos = line.find(" :", 1);
+	if (pos == std::string::npos || b.phase == SETUP)
+		return ;
+	now = __now();
+	sentAt = std::strtoul(line.c_str() + pos + 2, NULL, 10);
+	if (!sentAt || sentAt > now)
+		return ;
+	++b.received;
+	b.latencies.push_back(now - sentAt);
+}
+
+/**
+ * @brief	Handle a line received by a client.
+ *
+ * @return	false if the server refused something, true otherwise.
+ */
+inline static bool	__onLine(t_bench &b, t_client &client, std::string const &line)
+{
+	std::string::size_type	begin;
+	std::string::size_type	end;
+	std::string				command;
+
+	begin = 0;
+	if (!line.compare(0, 1, ":"))
+		begin = line.find(' ') + 1;
+	end = line.find(' ', begin);
+	command = line.substr(begin, end - begin);
+
+	if (command == "PING")
+		client.output += "PONG" + line.substr(end) + "\r\n";
+	else if (command == "PRIVMSG")
+		__onPrivmsg(b, line);
+	else if (command == "001")
+		__onRegistered(b, client);
+	else if (command == "366" && client.state == JOINING)
+		client.state = READY;
+	else if (command == "ERROR" || (command.size() == 3 && (command[0] == '4' || command[0] == '5')))
+		return __fail(client.nickname + ": " + line);
+	return true;
+}
+
+inline static bool	__onReadable(t_bench &b, t_client &client)
+{
+	char					buff[BUFFER_SIZE];
+	ssize_t					retRecv;
+	std::string::size_type	pos;
+	std::string::size_type	start;
+
+	retRecv = recv(client.fd, buff, BUFFER_SIZE, MSG_DONTWAIT);
+	if (retRecv <= 0)
+	{
+		if (retRecv == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return true;
+		return __fail(client.nickname + ": connection closed by the server");
+	}
+	client.input.append(buff, static_cast<size_t>(retRecv));
+	for (start = 0 ; (pos = client.input.find('\n', start)) != std::string::npos ; start = pos + 1)
+	{
+		if (!__onLine(b, client, client.input.substr(start, pos - start - (pos > start && client.input[pos - 1] == '\r'))))
+			return false;
+		if (client.fd == -1)
+			return true;
+	}
+	client.input.erase(0, start);
+	return true;
+}
+
+inline static bool	__onWritable(t_client &client)
+{
+	ssize_t	retSend;
+
+	if (client.state == CONNECTING)
+		client.state = REGISTERING;
+	retSend = send(client.fd, client.output.data(), client.output.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+	if (retSend == -1)
+	{
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+			return true;
+		return __fail(client.nickname + ": send: " + std::string(strerror(errno)));
+	}
+	client.output.erase(0, static_cast<size_t>(retSend));
+	return true;
+}
+
+/**
+ * @brief	Run one iteration of the event loop over every connected client.
+ */
+inline static bool	__pump(t_bench &b, int const timeout)
+{
+	std::vector<pollfd>		pollfds;
+	std::vector<size_t>		owners;
+	pollfd					pfd;
+	size_t					idx;
+	int						retPoll;
+
+	for (idx = 0 ; idx < b.clients.size() ; ++idx)
+	{
+		if (b.clients[idx].fd == -1)
+			continue ;
+		pfd.fd = b.clients[idx].fd;
+		pfd.events = POLLIN;
+		if (!b.clients[idx].output.empty() || b.clients[idx].state == CONNECTING)
+			pfd.events |= POLLOUT;
+		pfd.revents = 0;
+		pollfds.push_back(pfd);
+		owners.push_back(idx);
+	}
+	if (pollfds.empty())
+		return true;
+	retPoll = poll(&pollfds[0], pollfds.size(), timeout);
+	if (retPoll == -1)
+		return errno == EINTR || __fail("poll: " + std::string(strerror(errno)));
+	for (idx = 0 ; idx < pollfds.size() ; ++idx)
+	{
+		t_client	&client = b.clients[owners[idx]];
+
+		if (pollfds[idx].revents & (POLLERR | POLLHUP) && !(pollfds[idx].revents & POLLIN))
+			return __fail(client.nickname + ": connection failed");
+		if ((pollfds[idx].revents & POLLOUT) && !__onWritable(client))
+			return false;
+		if (client.fd != -1 && (pollfds[idx].revents & POLLIN) && !__onReadable(b, client))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief	Queue the next timestamped message on one of the clients.
+ */
+inline static void	__sendOne(t_bench &b)
+{
+	std::string	target;
+	std::string	text;
+	size_t		sender;
+	size_t		chan;
+
+	if (b.opt.mode == "channel")
+	{
+		chan = b.sent % b.channels.size();
+		sender = b.channels[chan][(b.sent / b.channels.size()) % b.channels[chan].size()];
+		target = "#lg" + __toString(chan);
+	}
+	else
+	{
+		sender = b.sent % b.clients.size();
+		target = b.clients[(sender + 1) % b.clients.size()].nickname;
+	}
+	text = __toString(__now()) + ' ' + __toString(b.sent);
+	if (text.size() < b.opt.payload)
+		text.append(b.opt.payload - text.size(), 'x');
+	b.clients[sender].output += "PRIVMSG " + target + " :" + text + "\r\n";
+	++b.sent;
+}
+
+// ************************************************************************** //
+//                                 Scenarios                                  //
+// ************************************************************************** //
+
+/**
+ * @brief	Split the clients in channels which sizes are uniformly
+ * 			distributed between the minimum and the maximum channel size.
+ */
+inline static void	__makeChannels(t_bench &b)
+{
+	size_t	idx;
+	size_t	size;
+
+	srand(42);
+	for (idx = 0 ; idx < b.clients.size() ; )
+	{
+		size = b.opt.minChanSize + static_cast<size_t>(rand()) % (b.opt.maxChanSize - b.opt.minChanSize + 1);
+		b.channels.push_back(std::vector<size_t>());
+		for ( ; idx < b.clients.size() && size ; ++idx, --size)
+		{
+			b.clients[idx].channel = static_cast<int>(b.channels.size() - 1);
+			b.channels.back().push_back(idx);
+		}
+	}
+}
+
+inline static bool	__allReady(t_bench const &b)
+{
+	std::vector<t_client>::const_iterator	cit;
+
+	for (cit = b.clients.begin() ; cit != b.clients.end() ; ++cit)
+		if (cit->state != READY)
+			return false;
+	return true;
+}
+
+inline static bool	__setup(t_bench &b)
+{
+	uint64_t const	deadline = __now() + 60 * 1000000000UL;
+
+	while (!__allReady(b))
+	{
+		if (__now() > deadline)
+			return __fail("timed out while registering the clients");
+		if (!__connectPending(b) || !__pump(b, 10))
+			return false;
+	}
+	return true;
+}
+
+inline static bool	__traffic(t_bench &b)
+{
+	uint64_t const	start = __now();
+	uint64_t const	length = static_cast<uint64_t>(b.opt.duration * 1e9);
+	uint64_t		now;
+	size_t			due;
+
+	b.phase = TRAFFIC;
+	b.registrations = 0;
+	if (b.opt.mode == "reconnect")
+	{
+		for (std::vector<t_client>::iterator it = b.clients.begin() ; it != b.clients.end() ; ++it)
+		{
+			send(it->fd, "QUIT :reconnecting\r\n", 20, MSG_NOSIGNAL);
+			__disconnect(b, *it);
+		}
+	}
+	for (now = start ; now - start < length ; now = __now())
+	{
+		if (b.opt.mode == "reconnect")
+		{
+			if (!__connectPending(b))
+				return false;
+		}
+		else
+		{
+			due = static_cast<size_t>(static_cast<double>(now - start) / 1e9 * b.opt.rate);
+			while (b.sent < due)
+				__sendOne(b);
+		}
+		if (!__pump(b, 1))
+			return false;
+	}
+
+	// Let the in-flight messages arrive before counting them,
+	// until nothing has been received for a second.
+	b.phase = DRAIN;
+	for (now = __now(), due = b.received ; __now() - now < 1000000000UL && b.opt.mode != "reconnect" ; )
+	{
+		if (!__pump(b, 10))
+			return false;
+		if (b.received != due)
+		{
+			now = __now();
+			due = b.received;
+		}
+	}
+	return true;
+}
+
+inline static void	__report(t_bench &b)
+{
+	double		delivered;
+
+	if (b.opt.header)
+		std::cout << "scenario,mode,clients,channels,duration_s,sent,received,msgs_per_sec,p50_us,p99_us,p999_us\n";
+	delivered = static_cast<double>(b.opt.mode == "reconnect" ? b.registrations : b.received);
+	std::sort(b.latencies.begin(), b.latencies.end());
+	std::cout
+	<< b.opt.scenario << ','
+	<< b.opt.mode << ','
+	<< b.clients.size() << ','
+	<< b.channels.size() << ','
+	<< b.opt.duration << ','
+	<< (b.opt.mode == "reconnect" ? b.registrations : b.sent) << ','
+	<< static_cast<size_t>(delivered) << ','
+	<< static_cast<size_t>(delivered / b.opt.duration) << ','
+	<< __percentile(b.latencies, 0.50) << ','
+	<< __percentile(b.latencies, 0.99) << ','
+	<< __percentile(b.latencies, 0.999) << '\n';
+}
+
+int	main(int const argc, char *const *const argv)
+{
+	t_bench							b;
+	std::vector<t_client>::iterator	it;
+
+	b.phase = SETUP;
+	b.connecting = 0;
+	b.sent = 0;
+	b.received = 0;
+	b.registrations = 0;
+	if (!__parseOptions(argc, argv, b.opt))
+		return EXIT_FAILURE;
+
+	b.clients.resize(b.opt.clients);
+	for (it = b.clients.begin() ; it != b.clients.end() ; ++it)
+	{
+		it->fd = -1;
+		it->state = DISCONNECTED;
+		it->channel = -1;
+		it->generation = 0;
+		it->connectStart = 0;
+	}
+	if (b.opt.mode == "channel")
+		__makeChannels(b);
+
+	if (!__setup(b) || !__traffic(b))
+		return EXIT_FAILURE;
+	__report(b);
+	for (it = b.clients.begin() ; it != b.clients.end() ; ++it)
+		if (it->fd != -1)
+			close(it->fd);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,835 @@
+#include <malloc.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <streambuf>
+#include "class/Server.hpp"
+#include "ft.hpp"
+
+#define ROOM_SIZE	25
+#define SNAPSHOT_CHANNELS	100000
+#define SNAPSHOT_FILE	"/tmp/ircserv-microbench.snap"
+
+/*
+	In-process microbenchmarks of the server hot paths.
+
+	Synthetic users are inserted straight into the server lookups, without
+	any socket, and every benchmark is repeated until it ran for long enough.
+	Allocations are counted by replacing the global operator new, which also
+	tracks the live heap, giving the memory a registered user costs.
+	Results are written as JSON, to compare runs before and after a change.
+*/
+
+bool	g_interrupted = false;
+bool	g_upgrade = false;
+
+static size_t	g_allocs = 0;
+static size_t	g_liveBytes = 0;
+
+void	*operator new(size_t size) throw(std::bad_alloc)
+{
+	void	*ptr;
+
+	++g_allocs;
+	ptr = std::malloc(size ? size : 1);
+	if (!ptr)
+		throw std::bad_alloc();
+	g_liveBytes += malloc_usable_size(ptr);
+	return ptr;
+}
+
+void	operator delete(void *ptr) throw()
+{
+	if (ptr)
+		g_liveBytes -= malloc_usable_size(ptr);
+	std::free(ptr);
+}
+
+/**
+ * @brief	Stream buffer throwing away everything, to mute the server logs
+ * 			while still paying for their formatting.
+ */
+class NullBuffer : public std::streambuf
+{
+protected:
+	int	overflow(int c)
+	{
+		return c;
+	}
+};
+
+class Microbench
+{
+private:
+	typedef void	(Microbench::*t_bench)(size_t const iterations);
+
+	struct	t_result
+	{
+		std::string	name;
+		size_t		iterations;
+		double		nsPerOp;
+		double		allocsPerOp;
+	};
+
+	Server					_server;
+	Server					_snapshotServer;
+	std::vector<Channel *>	_snapshotChannels;
+	size_t					_snapshotBytes;
+	User					*_sender;
+	Channel					*_channel;
+	std::vector<t_result>	_results;
+	std::vector<std::string>	_nicknames;
+	std::string				_msg;
+	std::string				_lines;
+	std::string				_linesUtf8;
+	std::string				_text;
+	SpamFilter				_spamFilterFew;
+	uint64_t				_minTime;
+	size_t					_sink;
+	size_t					_bytesPerUser;
+
+	static std::pair<char const *, t_bench> const	_arrayBenchs[];
+	static char const *const						_arrayCmdNames[];
+
+	static uint64_t	now(void);
+
+	Channel	&addChannel(std::string const &name);
+	User	&addUser(std::string const &nickname);
+	void	judge(char const *const line, size_t const iterations);
+	void	scanLines(LineScanner::t_scan const scan, std::string const &buff, size_t const iterations);
+	void	snapshot(size_t const every, size_t const iterations);
+
+	void	benchChannelIteration(size_t const iterations);
+	void	benchDispatch(size_t const iterations);
+	void	benchChannelMembership(size_t const iterations);
+	void	benchJudge(size_t const iterations);
+	void	benchJudgePrivmsg(size_t const iterations);
+	void	benchJudgeBurst(size_t const iterations);
+	void	benchLineScanScalar(size_t const iterations);
+	void	benchLineScanSse2(size_t const iterations);
+	void	benchLineScanAvx2(size_t const iterations);
+	void	benchLineScanUtf8(size_t const iterations);
+	void	benchLookupUsers(size_t const iterations);
+	void	benchMonitorRename(size_t const iterations);
+	void	benchReplyNumeric(size_t const iterations);
+	void	benchReplyPush(size_t const iterations);
+	void	benchSpamFilter(size_t const iterations);
+	void	benchSpamFilterFew(size_t const iterations);
+	void	benchSpamFilterScalar(size_t const iterations);
+	void	benchTaggedBroadcast(size_t const iterations);
+	void	benchSnapshotUpdate(size_t const iterations);
+	void	benchSnapshotUpdateAll(size_t const iterations);
+	void	benchSnapshotWrite(size_t const iterations);
+	void	benchSnapshotLoad(size_t const iterations);
+	void	benchHistoryAppend(size_t const iterations);
+	void	benchChathistoryLatest(size_t const iterations);
+	void	run(std::string const &name, t_bench const bench);
+
+	Microbench(Microbench const &src);
+	Microbench	&operator=(Microbench const &rhs);
+
+public:
+	Microbench(uint64_t const minTime);
+	~Microbench(void);
+
+	bool	init(size_t const nbUsers, size_t const channelSize, size_t const channelsPerUser);
+	void	runAll(std::string const &filter);
+	void	print(std::ostream &os) const;
+};
+
+std::pair<char const *, Microbench::t_bench> const	Microbench::_arrayBenchs[] = {
+	std::make_pair("judge_ping", &Microbench::benchJudge),
+	std::make_pair("judge_privmsg", &Microbench::benchJudgePrivmsg),
+	std::make_pair("judge_burst", &Microbench::benchJudgeBurst),
+	std::make_pair("dispatch_lookup_cmds", &Microbench::benchDispatch),
+	std::make_pair("channel_iteration", &Microbench::benchChannelIteration),
+	std::make_pair("channel_membership", &Microbench::benchChannelMembership),
+	std::make_pair("lookup_users", &Microbench::benchLookupUsers),
+	std::make_pair("reply_push", &Microbench::benchReplyPush),
+	std::make_pair("reply_numeric", &Microbench::benchReplyNumeric),
+	std::make_pair("line_scan_scalar", &Microbench::benchLineScanScalar),
+	std::make_pair("line_scan_sse2", &Microbench::benchLineScanSse2),
+	std::make_pair("line_scan_avx2", &Microbench::benchLineScanAvx2),
+	std::make_pair("line_scan_utf8", &Microbench::benchLineScanUtf8),
+	std::make_pair("spam_filter", &Microbench::benchSpamFilter),
+	std::make_pair("spam_filter_scalar", &Microbench::benchSpamFilterScalar),
+	std::make_pair("spam_filter_few", &Microbench::benchSpamFilterFew),
+	std::make_pair("snapshot_update", &Microbench::benchSnapshotUpdate),
+	std::make_pair("snapshot_update_all", &Microbench::benchSnapshotUpdateAll),
+	std::make_pair("snapshot_write", &Microbench::benchSnapshotWrite),
+	std::make_pair("snapshot_load", &Microbench::benchSnapshotLoad),
+	std::make_pair("history_append", &Microbench::benchHistoryAppend),
+	std::make_pair("chathistory_latest", &Microbench::benchChathistoryLatest),
+	std::make_pair("tagged_broadcast", &Microbench::benchTaggedBroadcast),
+	std::make_pair("monitor_rename", &Microbench::benchMonitorRename),
+	std::make_pair(static_cast<char const *>(NULL), static_cast<t_bench>(NULL))
+};
+
+char const *const	Microbench::_arrayCmdNames[] = {
+	"PRIVMSG", "JOIN", "PING", "MODE", "NICK", "PART", "WHOIS", "UNKNOWN", NULL
+};
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+Microbench::Microbench(uint64_t const minTime) :
+	_server(),
+	_snapshotServer(),
+	_snapshotChannels(),
+	_snapshotBytes(0),
+	_sender(NULL),
+	_channel(NULL),
+	_results(),
+	_nicknames(),
+	_msg(),
+	_lines(),
+	_linesUtf8(),
+	_text(),
+	_spamFilterFew(),
+	_minTime(minTime),
+	_sink(0),
+	_bytesPerUser(0) {}
+
+Microbench::~Microbench(void)
+{
+	Channel::track(false);
+	unlink(SNAPSHOT_FILE);
+}
+
+// ************************************************************************** //
+//                              Private Methods                               //
+// ************************************************************************** //
+
+uint64_t	Microbench::now(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000UL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/**
+ * @brief	Get a channel of the server, creating it if needed.
+ */
+Channel	&Microbench::addChannel(std::string const &name)
+{
+	Channel	chan(name);
+
+	return this->_server._lookupChannels.insert(std::pair<Identifier const, Channel>(chan.getNameId(), chan)).first->second;
+}
+
+/**
+ * @brief	Insert a registered user without socket in the server.
+ */
+User	&Microbench::addUser(std::string const &nickname)
+{
+	this->_server._users.push_back(User());
+	User	&user = this->_server._users.back();
+
+	user.setNickname(nickname);
+	user.setUsername(nickname);
+	user.setHostname("client-" + ft::toString(static_cast<int>(this->_nicknames.size() % 64)) + ".example.net");
+	user.setRealname("Microbench user");
+	user.setState(User::REGISTERED);
+	user.setMask();
+	this->_server._lookupUsers.insert(std::pair<Identifier const, User *const>(user.getNicknameId(), &user));
+	this->_nicknames.push_back(nickname);
+	return user;
+}
+
+/**
+ * @brief	Process the same line again and again, as many event loop
+ * 			iterations would, resetting the arena after each.
+ */
+void	Microbench::judge(char const *const line, size_t const iterations)
+{
+	size_t	idx;
+
+	// judge() stops on users without socket, any other value does.
+	this->_sender->setSocket(0);
+	for (idx = 0 ; idx < iterations ; ++idx)
+	{
+		this->_msg = line;
+		this->_server.judge(*this->_sender, this->_msg);
+		this->_sender->setMsg("");
+		Arena::tick().reset();
+	}
+	this->_sender->setSocket(-1);
+}
+
+void	Microbench::benchJudge(size_t const iterations)
+{
+	this->judge("PING :microbench\r\n", iterations);
+}
+
+void	Microbench::benchJudgePrivmsg(size_t const iterations)
+{
+	// The sender is alone in #microbench, so nothing is sent.
+	this->judge("PRIVMSG #microbench :hello world, this is the microbench speaking\r\n", iterations);
+}
+
+void	Microbench::benchJudgeBurst(size_t const iterations)
+{
+	// A busy read: many lines at once, all to be found in the same buffer.
+	this->judge(
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PRIVMSG #microbench :hello world, this is the microbench speaking\r\n"
+		"PING :microbench", iterations);
+}
+
+/**
+ * @brief	Find the lines of a buffer again and again, resetting the arena
+ * 			after each pass.
+ */
+void	Microbench::scanLines(LineScanner::t_scan const scan, std::string const &buff, size_t const iterations)
+{
+	size_t	idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+	{
+		{
+			LineScanner::t_lines	lines;
+
+			scan(buff.data(), buff.size(), lines);
+			this->_sink += lines.size();
+		}
+		Arena::tick().reset();
+	}
+}
+
+void	Microbench::benchLineScanScalar(size_t const iterations)
+{
+	this->scanLines(&LineScanner::scanScalar, this->_lines, iterations);
+}
+
+void	Microbench::benchLineScanSse2(size_t const iterations)
+{
+	this->scanLines(&LineScanner::scanSse2, this->_lines, iterations);
+}
+
+void	Microbench::benchLineScanAvx2(size_t const iterations)
+{
+	this->scanLines(LineScanner::hasAvx2() ? &LineScanner::scanAvx2 : &LineScanner::scanSse2, this->_lines, iterations);
+}
+
+void	Microbench::benchLineScanUtf8(size_t const iterations)
+{
+	this->scanLines(&LineScanner::scan, this->_linesUtf8, iterations);
+}
+
+void	Microbench::benchDispatch(size_t const iterations)
+{
+	std::vector<std::string>	cmdNames;
+	size_t						idx;
+
+	for (idx = 0 ; Microbench::_arrayCmdNames[idx] ; ++idx)
+		cmdNames.push_back(Microbench::_arrayCmdNames[idx]);
+	// Only the lookups are of interest, not the setup above.
+	g_allocs = 0;
+	for (idx = 0 ; idx < iterations ; ++idx)
+		this->_sink += (this->_server._lookupCmds.find(cmdNames[idx % cmdNames.size()]) != this->_server._lookupCmds.end());
+}
+
+void	Microbench::benchChannelIteration(size_t const iterations)
+{
+	std::map<Identifier const, User *const>::const_iterator	cit;
+	Channel const											&chan = *this->_channel;
+	size_t													idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+		for (cit = chan.begin() ; cit != chan.end() ; ++cit)
+			this->_sink += cit->second->getNickname().size();
+}
+
+void	Microbench::benchChannelMembership(size_t const iterations)
+{
+	std::list<User>::const_iterator	cit;
+	size_t							idx;
+
+	for (idx = 0, cit = this->_server._users.begin() ; idx < iterations ; ++idx, ++cit)
+	{
+		if (cit == this->_server._users.end())
+			cit = this->_server._users.begin();
+		this->_sink += (this->_channel->find(cit->getNicknameId()) != this->_channel->end());
+	}
+}
+
+void	Microbench::benchLookupUsers(size_t const iterations)
+{
+	size_t	idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+		this->_sink += (this->_server._lookupUsers.find(Identifier::find(this->_nicknames[(idx * 7919) % this->_nicknames.size()])) != this->_server._lookupUsers.end());
+}
+
+void	Microbench::benchReplyPush(size_t const iterations)
+{
+	size_t	idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+	{
+		this->_server.replyPush(*this->_sender, ":microbench!microbench@localhost PRIVMSG #bench :hello world");
+		if (!(idx % 16))
+			this->_sender->setMsg("");
+	}
+	this->_sender->setMsg("");
+}
+
+void	Microbench::benchSpamFilter(size_t const iterations)
+{
+	size_t	idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+		this->_sink += this->_server._spamFilter.match(this->_text.data(), this->_text.size()).action;
+}
+
+void	Microbench::benchSpamFilterFew(size_t const iterations)
+{
+	size_t	idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+		this->_sink += this->_spamFilterFew.match(this->_text.data(), this->_text.size()).action;
+}
+
+void	Microbench::benchSpamFilterScalar(size_t const iterations)
+{
+	size_t	idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+		this->_sink += this->_server._spamFilter.matchScalar(this->_text.data(), this->_text.size()).action;
+}
+
+/**
+ * @brief	Change the limit of one channel out of `every`, then encode the
+ * 			changed channels into the snapshot, as the event loop does every
+ * 			`snapshot_interval`.
+ */
+void	Microbench::snapshot(size_t const every, size_t const iterations)
+{
+	size_t	idx;
+	size_t	jdx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+	{
+		for (jdx = idx % every ; jdx < SNAPSHOT_CHANNELS ; jdx += every)
+			this->_snapshotChannels[jdx]->setLimit(static_cast<unsigned int>(idx));
+		this->_sink += this->_snapshotServer.updateSnapshot();
+	}
+}
+
+void	Microbench::benchSnapshotUpdateAll(size_t const iterations)
+{
+	this->snapshot(1, iterations);
+}
+
+void	Microbench::benchSnapshotUpdate(size_t const iterations)
+{
+	this->snapshot(100, iterations);
+}
+
+/**
+ * @brief	Put the snapshot together and write it to the disk, synced then
+ * 			renamed, as the worker thread does.
+ */
+void	Microbench::benchSnapshotWrite(size_t const iterations)
+{
+	size_t	idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+	{
+		SnapshotJob	file(NULL, SNAPSHOT_FILE, this->_snapshotServer._snapshotRecords);
+
+		file.execute();
+		this->_sink += file.getError().size();
+	}
+}
+
+/**
+ * @brief	Load the snapshot into dormant channels, as on startup.
+ */
+void	Microbench::benchSnapshotLoad(size_t const iterations)
+{
+	size_t	idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+	{
+		this->_snapshotServer._snapshotRecords.clear();
+		this->_snapshotServer.loadSnapshot();
+		this->_sink += this->_snapshotServer._snapshotRecords.size();
+	}
+}
+
+/**
+ * @brief	Keep a message in the history of #bench, as PRIVMSG does.
+ */
+void	Microbench::benchHistoryAppend(size_t const iterations)
+{
+	ArenaString const	line(":microbench!microbench@client-0.example.net PRIVMSG #bench :hello world, this is the microbench speaking");
+	size_t				idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+	{
+		TaggedLine const	tagged(line, this->_server._history.newMsgid(), this->_server._clock->milliseconds());
+
+		this->_server.keepHistory(*this->_channel, tagged);
+	}
+	Arena::tick().reset();
+}
+
+void	Microbench::benchChathistoryLatest(size_t const iterations)
+{
+	// The history of #microbench is full: CHATHISTORY_LIMIT messages are sent.
+	this->judge("CHATHISTORY LATEST #microbench * 1000\r\n", iterations);
+}
+
+/**
+ * @brief	Tag a message for each member of #bench, as PRIVMSG does:
+ * 			the members share 4 sets of capabilities, so the message is
+ * 			tagged 3 times whatever the size of the channel.
+ */
+void	Microbench::benchTaggedBroadcast(size_t const iterations)
+{
+	ArenaString const										line(":microbench!microbench@client-0.example.net PRIVMSG #bench :hello world, this is the microbench speaking");
+	std::map<Identifier const, User *const>::const_iterator	cit;
+	size_t													idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+	{
+		TaggedLine	tagged(line, this->_server._history.newMsgid(), this->_server._clock->milliseconds());
+
+		for (cit = this->_channel->begin() ; cit != this->_channel->end() ; ++cit)
+			this->_sink += tagged.get(cit->second->getCaps()).size();
+	}
+	Arena::tick().reset();
+}
+
+/**
+ * @brief	Rename the sender back and forth, as NICK does, each of its two
+ * 			nicknames being monitored by 16 users: only the watchers of the
+ * 			nicknames are told, whatever the number of users.
+ * 			The users have no socket, so their sends fail at once.
+ */
+void	Microbench::benchMonitorRename(size_t const iterations)
+{
+	static char const *const	nicknames[] = {"microbench", "microbench2"};
+	size_t						idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+	{
+		this->_server.rename(*this->_sender, nicknames[(idx + 1) % 2]);
+		this->_sender->setMsg("");
+	}
+	if (iterations % 2)
+		this->_server.rename(*this->_sender, nicknames[0]);
+	this->_sender->setMsg("");
+	Arena::tick().reset();
+}
+
+void	Microbench::benchReplyNumeric(size_t const iterations)
+{
+	std::string const	channelName("#bench");
+	size_t				idx;
+
+	for (idx = 0 ; idx < iterations ; ++idx)
+	{
+		this->_server.replyNumeric<Server::RPL_TOPIC>(*this->_sender, channelName, "hello world");
+		if (!(idx % 16))
+			this->_sender->setMsg("");
+	}
+	this->_sender->setMsg("");
+}
+
+/**
+ * @brief	Run a benchmark with more and more iterations,
+ * 			until it lasts at least the minimum time.
+ */
+void	Microbench::run(std::string const &name, t_bench const bench)
+{
+	t_result	result;
+	uint64_t	start;
+	uint64_t	elapsed;
+	size_t		allocs;
+	size_t		iterations;
+
+	(this->*bench)(16);
+	for (iterations = 16 ; ; iterations *= 2)
+	{
+		g_allocs = 0;
+		start = Microbench::now();
+		(this->*bench)(iterations);
+		elapsed = Microbench::now() - start;
+		allocs = g_allocs;
+		if (elapsed >= this->_minTime)
+			break ;
+	}
+	result.name = name;
+	result.iterations = iterations;
+	result.nsPerOp = static_cast<double>(elapsed) / static_cast<double>(iterations);
+	result.allocsPerOp = static_cast<double>(allocs) / static_cast<double>(iterations);
+	this->_results.push_back(result);
+}
+
+// ************************************************************************** //
+//                               Public Methods                               //
+// ************************************************************************** //
+
+/**
+ * @brief	Populate the server with a sender and synthetic users,
+ * 			the first `channelSize` of them being members of the same channel,
+ * 			and each of them being member of `channelsPerUser` other channels
+ * 			of ROOM_SIZE members.
+ * 			The live heap they take, the lookups and channels included,
+ * 			gives the memory per user.
+ */
+bool	Microbench::init(size_t const nbUsers, size_t const channelSize, size_t const channelsPerUser)
+{
+	static unsigned int const	caps[] = {0U, User::SERVER_TIME, User::SERVER_TIME | User::MESSAGE_TAGS, ~0U};
+	size_t						liveBytes;
+	size_t						idx;
+	size_t						room;
+
+	if (!this->_server.init(""))
+		return false;
+	this->_nicknames.reserve(nbUsers + 1);
+	liveBytes = g_liveBytes;
+	this->_sender = &this->addUser("microbench");
+	this->_channel = &this->addChannel("#bench");
+
+	for (idx = 0 ; idx < nbUsers ; ++idx)
+	{
+		User	&user = this->addUser("user" + ft::toString(static_cast<int>(idx)));
+
+		if (idx < channelSize)
+		{
+			// A quarter of the members asked for no capability.
+			user.setCaps(caps[idx % 4]);
+			this->_channel->addUser(user);
+			user.addChannel(*this->_channel);
+		}
+		for (room = 0 ; room < channelsPerUser ; ++room)
+		{
+			Channel	&chan = this->addChannel("#room-" + ft::toString(static_cast<int>((room * nbUsers + idx) / ROOM_SIZE)));
+
+			chan.addUser(user);
+			user.addChannel(chan);
+		}
+	}
+	this->_bytesPerUser = (g_liveBytes - liveBytes) / (nbUsers + 1);
+
+	// 16 users monitoring each nickname the sender takes.
+	for (idx = 0 ; idx < 32 && idx < nbUsers ; ++idx)
+	{
+		Identifier const	nickname(std::string(idx % 2 ? "microbench2" : "microbench"));
+		User				&watcher = *this->_server._lookupUsers.find(Identifier::find(this->_nicknames[idx + 1]))->second;
+
+		watcher.addMonitor(nickname);
+		this->_server._lookupWatchers[nickname].insert(&watcher);
+	}
+
+	Channel	&solo = this->addChannel("#microbench");
+
+	solo.addUser(*this->_sender);
+	this->_sender->addChannel(solo);
+
+	// The history, as configured by default, with #microbench full.
+	if (!this->_server._history.init(std::strtoul(this->_server._config["history_memory"].c_str(), NULL, 10),
+		std::strtoul(this->_server._config["history_size"].c_str(), NULL, 10), 1UL))
+		return false;
+	for (idx = 0 ; idx < 1000 ; ++idx)
+	{
+		ArenaString const	line(ArenaString(":microbench!microbench@client-0.example.net PRIVMSG #microbench :hello world, this is message ") +
+			ft::toString(static_cast<int>(idx)));
+		TaggedLine const	tagged(line, this->_server._history.newMsgid(), this->_server._clock->milliseconds());
+
+		this->_server.keepHistory(solo, tagged);
+	}
+	Arena::tick().reset();
+
+	// 1000 patterns of 8 to 15 letters, none of them in the message.
+	std::vector<std::string>	patterns;
+	std::string					error;
+	unsigned long				seed;
+
+	for (idx = 0, seed = 42 ; idx < 1000 ; ++idx)
+	{
+		patterns.push_back("drop ");
+		for (room = 0 ; room < 6 + idx % 8 ; ++room)
+		{
+			seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+			patterns.back() += static_cast<char>('a' + (seed >> 33) % 26);
+		}
+		patterns.back() += "zq";
+	}
+	if (!this->_server._spamFilter.compile(patterns, error))
+		return false;
+	// A few links and words, starting with a few bytes only.
+	patterns.clear();
+	patterns.push_back("drop https://bit.ly/");
+	patterns.push_back("drop discord.gg/");
+	patterns.push_back("drop free nitro");
+	patterns.push_back("kill $$$");
+	patterns.push_back("warn viagra");
+	patterns.push_back("warn xxx");
+	if (!this->_spamFilterFew.compile(patterns, error))
+		return false;
+	while (this->_text.size() < 400)
+		this->_text += "hello world, did anyone see the match yesterday? ";
+
+	// About a busy read: 4 KiB of lines, ASCII only or with some UTF-8.
+	while (this->_lines.size() < 4096)
+	{
+		this->_lines += ":" + this->_nicknames[this->_lines.size() % this->_nicknames.size()] + " PRIVMSG #bench :hello world, this is the microbench speaking\r\n";
+		this->_linesUtf8 += ":" + this->_nicknames[this->_linesUtf8.size() % this->_nicknames.size()] + " PRIVMSG #bench :h\xc3\xa9llo w\xc3\xb6rld, \xe2\x82\xac\xf0\x9f\x98\x80 speaking\r\n";
+	}
+
+	// The channels of the snapshot: a topic each, some with a key and a limit, or a ban.
+	if (!this->_snapshotServer.init(""))
+		return false;
+	this->_snapshotServer._config["snapshot_file"] = SNAPSHOT_FILE;
+	Channel::track(true);
+	this->_snapshotChannels.reserve(SNAPSHOT_CHANNELS);
+	for (idx = 0 ; idx < SNAPSHOT_CHANNELS ; ++idx)
+	{
+		Channel	chan("#chan-" + ft::toString(static_cast<int>(idx)));
+
+		chan.setTopic("Welcome to " + chan.getName() + ", please read the rules before talking");
+		chan.setModes(Channel::INSIDE_ONLY | Channel::TOPIC_LOCK);
+		chan.setTimestamp(1700000000 + static_cast<time_t>(idx));
+		if (!(idx % 4))
+		{
+			chan.addModes(Channel::KEY | Channel::LIMIT);
+			chan.setKey("mellon");
+			chan.setLimit(50U);
+		}
+		if (!(idx % 8))
+			chan.addBan("*!*@spammer-" + ft::toString(static_cast<int>(idx)) + ".example.net");
+		this->_snapshotChannels.push_back(&this->_snapshotServer._lookupChannels.insert(std::pair<Identifier const, Channel>(chan.getNameId(), chan)).first->second);
+	}
+
+	this->_snapshotServer.updateSnapshot();
+
+	SnapshotJob	file(NULL, SNAPSHOT_FILE, this->_snapshotServer._snapshotRecords);
+
+	file.execute();
+	this->_snapshotBytes = file.getData().size();
+	return file.getError().empty();
+}
+
+void	Microbench::runAll(std::string const &filter)
+{
+	size_t	idx;
+
+	for (idx = 0 ; Microbench::_arrayBenchs[idx].first ; ++idx)
+		if (filter.empty() || std::string(Microbench::_arrayBenchs[idx].first).find(filter) != std::string::npos)
+			this->run(Microbench::_arrayBenchs[idx].first, Microbench::_arrayBenchs[idx].second);
+}
+
+void	Microbench::print(std::ostream &os) const
+{
+	std::vector<t_result>::const_iterator	cit;
+
+	os << "{\n  \"benchmarks\": [\n";
+	for (cit = this->_results.begin() ; cit != this->_results.end() ; ++cit)
+		os
+		<< "    {\"name\": \"" << cit->name
+		<< "\", \"iterations\": " << cit->iterations
+		<< ", \"ns_per_op\": " << cit->nsPerOp
+		<< ", \"allocs_per_op\": " << cit->allocsPerOp
+		<< (cit + 1 == this->_results.end() ? "}\n" : "},\n");
+	os
+	<< "  ],\n  \"memory\": {\"users\": " << this->_nicknames.size()
+	<< ", \"sizeof_user\": " << sizeof(User)
+	<< ", \"bytes_per_user\": " << this->_bytesPerUser
+	<< "},\n  \"line_scanner\": {\"name\": \"" << LineScanner::getName()
+	<< "\", \"buffer_bytes\": " << this->_lines.size()
+	<< "},\n  \"spam_filter\": {\"patterns\": " << this->_server._spamFilter.getSize()
+	<< ", \"text_bytes\": " << this->_text.size()
+	<< "},\n  \"snapshot\": {\"channels\": " << this->_snapshotChannels.size()
+	<< ", \"bytes\": " << this->_snapshotBytes
+	<< "}\n}\n";
+}
+
+// ************************************************************************** //
+//                                    Main                                    //
+// ************************************************************************** //
+
+int	main(int const argc, char *const *const argv)
+{
+	NullBuffer		nullBuffer;
+	std::streambuf	*stdoutBuffer;
+	std::string		output;
+	std::string		filter;
+	std::ofstream	ofs;
+	size_t			nbUsers;
+	size_t			channelSize;
+	size_t			channelsPerUser;
+	uint64_t		minTime;
+	int				c;
+
+	nbUsers = 10000;
+	channelSize = 1000;
+	channelsPerUser = 4;
+	minTime = 200;
+	while ((c = getopt(argc, argv, "o:f:u:c:j:t:")) != -1)
+	{
+		switch (c)
+		{
+			case 'o': output = optarg; break ;
+			case 'f': filter = optarg; break ;
+			case 'u': nbUsers = std::strtoul(optarg, NULL, 10); break ;
+			case 'c': channelSize = std::strtoul(optarg, NULL, 10); break ;
+			case 'j': channelsPerUser = std::strtoul(optarg, NULL, 10); break ;
+			case 't': minTime = std::strtoul(optarg, NULL, 10); break ;
+			default:
+				std::cerr
+				<< "usage: ircserv-microbench [-o <file.json>] [-f <filter>] [-u <users>] [-c <channel size>] [-j <channels per user>] [-t <min ms>]\n";
+				return EXIT_FAILURE;
+		}
+	}
+
+	Microbench	bench(minTime * 1000000UL);
+
+	stdoutBuffer = std::cout.rdbuf(&nullBuffer);
+	if (!bench.init(nbUsers ? nbUsers : 1, channelSize, channelsPerUser))
+	{
+		std::cout.rdbuf(stdoutBuffer);
+		std::cerr << "microbench: failed to initialize the server\n";
+		return EXIT_FAILURE;
+	}
+	bench.runAll(filter);
+	std::cout.rdbuf(stdoutBuffer);
+
+	if (output.empty())
+		bench.print(std::cout);
+	else
+	{
+		ofs.open(output.c_str());
+		if (!ofs)
+		{
+			std::cerr << "microbench: " << output << ": cannot open\n";
+			return EXIT_FAILURE;
+		}
+		bench.print(ofs);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,419 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+#include "class/Capture.hpp"
+#include "ft.hpp"
+
+# ifndef BUFFER_SIZE
+#  define BUFFER_SIZE 4096
+# endif
+
+/*
+	Replay of the captures written by ircserv (see capture_file).
+
+	Every captured connection is opened again over loopback, and its inbound
+	bytes are sent with the captured timing, scaled by the speed factor.
+	Every Nth chunk ending a line is followed by a PING probe, which PONG
+	gives the latency of the server under this load.
+	The run is summarized as a single CSV line on stdout.
+*/
+
+struct	t_record
+{
+	int				type;
+	unsigned long	id;
+	uint64_t		time;
+	std::string		data;
+};
+
+struct	t_conn
+{
+	int			fd;
+	bool		closing;
+	std::string	input;
+	std::string	output;
+};
+
+struct	t_options
+{
+	std::string					host;
+	uint16_t					port;
+	double						speed;
+	unsigned long				probeEvery;
+	bool						header;
+	std::vector<std::string>	files;
+};
+
+struct	t_replay
+{
+	t_options							opt;
+	std::vector<t_record>				records;
+	std::map<unsigned long, t_conn>		conns;
+	std::map<std::string, uint64_t>		probes;
+	std::vector<uint64_t>				latencies;
+	unsigned long						nbConns;
+	unsigned long						nbLines;
+	unsigned long						nbBytes;
+	unsigned long						nbProbes;
+};
+
+// ************************************************************************** //
+//                                  Helpers                                   //
+// ************************************************************************** //
+
+inline static uint64_t	__now(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000UL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+inline static bool	__fail(std::string const &msg)
+{
+	std::cerr << "replay: " << msg << '\n';
+	return false;
+}
+
+inline static void	__usage(void)
+{
+	std::cerr
+	<< "usage: ircserv-replay [options] <capture> [<capture> ...]\n"
+	<< "  -H <host>        server address (127.0.0.1)\n"
+	<< "  -p <port>        server port (6667)\n"
+	<< "  -s <speed>       speed factor, 0 replaying as fast as possible (1)\n"
+	<< "  -l <n>           send a latency probe every n chunks, 0 disabling them (16)\n"
+	<< "  -t               print the CSV header first\n"
+	<< "Rotated captures are given oldest first.\n";
+}
+
+inline static bool	__parseOptions(int const argc, char *const *const argv, t_options &opt)
+{
+	int	c;
+
+	opt.host = "127.0.0.1";
+	opt.port = 6667;
+	opt.speed = 1.0;
+	opt.probeEvery = 16;
+	opt.header = false;
+	while ((c = getopt(argc, argv, "H:p:s:l:t")) != -1)
+	{
+		switch (c)
+		{
+			case 'H': opt.host = optarg; break ;
+			case 'p': opt.port = static_cast<uint16_t>(std::strtoul(optarg, NULL, 10)); break ;
+			case 's': opt.speed = std::strtod(optarg, NULL); break ;
+			case 'l': opt.probeEvery = std::strtoul(optarg, NULL, 10); break ;
+			case 't': opt.header = true; break ;
+			default:
+				__usage();
+				return false;
+		}
+	}
+	for ( ; optind < argc ; ++optind)
+		opt.files.push_back(argv[optind]);
+	if (opt.files.empty() || opt.speed < 0.0)
+	{
+		__usage();
+		return false;
+	}
+	return true;
+}
+
+inline static uint64_t	__percentile(std::vector<uint64_t> const &sorted, double const p)
+{
+	size_t	idx;
+
+	if (sorted.empty())
+		return 0;
+	idx = static_cast<size_t>(p * static_cast<double>(sorted.size()));
+	if (idx >= sorted.size())
+		idx = sorted.size() - 1;
+	return sorted[idx] / 1000;
+}
+
+// ************************************************************************** //
+//                                  Loading                                   //
+// ************************************************************************** //
+
+inline static bool	__getVarint(std::string const &content, size_t &pos, uint64_t &value)
+{
+	unsigned int	shift;
+
+	for (value = 0, shift = 0 ; pos < content.size() && shift < 64 ; shift += 7)
+	{
+		value |= static_cast<uint64_t>(content[pos] & 0x7F) << shift;
+		if (!(content[pos++] & 0x80))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * @brief	Load the records of a capture file, timed in microseconds
+ * 			from the start of the first file.
+ */
+inline static bool	__load(t_replay &r, std::string const &path, uint64_t &time)
+{
+	std::ifstream	ifs(path.c_str(), std::ios::binary);
+	std::string		content;
+	t_record		record;
+	uint64_t		value;
+	size_t			pos;
+
+	if (!ifs)
+		return __fail(path + ": cannot open");
+	content.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+	if (content.compare(0, CAPTURE_MAGIC_SIZE, CAPTURE_MAGIC))
+		return __fail(path + ": not a capture");
+	for (pos = CAPTURE_MAGIC_SIZE + 8 ; pos < content.size() ; )
+	{
+		record.type = content[pos++];
+		if (!__getVarint(content, pos, value))
+			break ;
+		record.id = value;
+		if (!__getVarint(content, pos, value))
+			break ;
+		time += value;
+		record.time = time;
+		record.data.clear();
+		if (record.type == Capture::DATA)
+		{
+			if (!__getVarint(content, pos, value) || pos + value > content.size())
+				break ;
+			record.data = content.substr(pos, value);
+			pos += value;
+		}
+		r.records.push_back(record);
+	}
+	if (pos < content.size())
+		return __fail(path + ": truncated record");
+	return true;
+}
+
+// ************************************************************************** //
+//                                Connections                                 //
+// ************************************************************************** //
+
+inline static bool	__connect(t_replay &r, t_conn &conn)
+{
+	sockaddr_in	addr;
+	int			optval;
+
+	conn.fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (conn.fd == -1)
+		return __fail("socket: " + std::string(strerror(errno)));
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(r.opt.port);
+	addr.sin_addr.s_addr = inet_addr(r.opt.host.c_str());
+	if (connect(conn.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1)
+		return __fail("connect: " + std::string(strerror(errno)));
+	optval = 1;
+	setsockopt(conn.fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+	fcntl(conn.fd, F_SETFL, O_NONBLOCK);
+	conn.closing = false;
+	++r.nbConns;
+	return true;
+}
+
+inline static t_conn	*__getConn(t_replay &r, unsigned long const id)
+{
+	std::map<unsigned long, t_conn>::iterator	it;
+
+	it = r.conns.find(id);
+	if (it != r.conns.end())
+		return &it->second;
+	it = r.conns.insert(std::make_pair(id, t_conn())).first;
+	if (!__connect(r, it->second))
+		return NULL;
+	return &it->second;
+}
+
+inline static void	__onLine(t_replay &r, std::string const &line)
+{
+	std::map<std::string, uint64_t>::iterator	it;
+	std::string::size_type						pos;
+
+	pos = line.find("replay_probe_");
+	if (pos == std::string::npos || line.find("PONG") == std::string::npos)
+		return ;
+	it = r.probes.find(line.substr(pos, line.find_first_of("\r ", pos) - pos));
+	if (it == r.probes.end())
+		return ;
+	r.latencies.push_back(__now() - it->second);
+	r.probes.erase(it);
+}
+
+/**
+ * @brief	Exchange data with every connection, closing the ones
+ * 			which output is sent after their capture ended.
+ */
+inline static bool	__pump(t_replay &r, int const timeout)
+{
+	std::map<unsigned long, t_conn>::iterator	it;
+	std::vector<pollfd>							pollfds;
+	std::vector<t_conn *>						owners;
+	pollfd										pfd;
+	char										buff[BUFFER_SIZE];
+	ssize_t										ret;
+	size_t										idx;
+	std::string::size_type						pos;
+
+	for (it = r.conns.begin() ; it != r.conns.end() ; ++it)
+	{
+		pfd.fd = it->second.fd;
+		pfd.events = POLLIN | (it->second.output.empty() ? 0 : POLLOUT);
+		pfd.revents = 0;
+		pollfds.push_back(pfd);
+		owners.push_back(&it->second);
+	}
+	if (pollfds.empty())
+		return true;
+	if (poll(&pollfds[0], pollfds.size(), timeout) == -1)
+		return errno == EINTR || __fail("poll: " + std::string(strerror(errno)));
+	for (idx = 0 ; idx < pollfds.size() ; ++idx)
+	{
+		t_conn	&conn = *owners[idx];
+
+		if (pollfds[idx].revents & POLLOUT)
+		{
+			ret = send(conn.fd, conn.output.data(), conn.output.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+			if (ret > 0)
+				conn.output.erase(0, static_cast<size_t>(ret));
+		}
+		if (pollfds[idx].revents & (POLLIN | POLLHUP | POLLERR))
+		{
+			ret = recv(conn.fd, buff, BUFFER_SIZE, MSG_DONTWAIT);
+			if (ret > 0)
+				conn.input.append(buff, static_cast<size_t>(ret));
+			else if (!ret || (errno != EAGAIN && errno != EWOULDBLOCK))
+				conn.closing = true, conn.output.clear();
+			for ( ; (pos = conn.input.find('\n')) != std::string::npos ; conn.input.erase(0, pos + 1))
+				__onLine(r, conn.input.substr(0, pos));
+		}
+	}
+	for (it = r.conns.begin() ; it != r.conns.end() ; )
+	{
+		if (it->second.closing && it->second.output.empty())
+		{
+			close(it->second.fd);
+			r.conns.erase(it++);
+		}
+		else
+			++it;
+	}
+	return true;
+}
+
+// ************************************************************************** //
+//                                   Replay                                   //
+// ************************************************************************** //
+
+inline static bool	__replay(t_replay &r, uint64_t &elapsed)
+{
+	std::vector<t_record>::const_iterator	cit;
+	uint64_t const							start = __now();
+	uint64_t								due;
+	uint64_t								now;
+	unsigned long							chunks;
+	std::string								probe;
+	t_conn									*conn;
+
+	for (cit = r.records.begin(), chunks = 0 ; cit != r.records.end() ; ++cit)
+	{
+		due = (r.opt.speed ? start + static_cast<uint64_t>(static_cast<double>(cit->time) * 1000.0 / r.opt.speed) : 0);
+		for (now = __now() ; now < due ; now = __now())
+			if (!__pump(r, static_cast<int>(std::min<uint64_t>((due - now) / 1000000, 10))))
+				return false;
+		if (cit->type == Capture::CLOSE)
+		{
+			if (r.conns.count(cit->id))
+				r.conns[cit->id].closing = true;
+			continue ;
+		}
+		conn = __getConn(r, cit->id);
+		if (!conn)
+			return false;
+		if (cit->type != Capture::DATA)
+			continue ;
+		conn->output += cit->data;
+		r.nbBytes += cit->data.size();
+		r.nbLines += static_cast<unsigned long>(std::count(cit->data.begin(), cit->data.end(), '\n'));
+		if (r.opt.probeEvery && !(++chunks % r.opt.probeEvery) && *cit->data.rbegin() == '\n')
+		{
+			probe = "replay_probe_" + ft::toString(static_cast<int>(r.nbProbes++));
+			conn->output += "PING :" + probe + "\r\n";
+			r.probes[probe] = __now();
+		}
+		if (!__pump(r, 0))
+			return false;
+	}
+	elapsed = __now() - start;
+
+	// Let the last probes come back, and the connections be closed.
+	for (now = __now() ; __now() - now < 2000000000UL && (!r.probes.empty() || !r.conns.empty()) ; )
+		if (!__pump(r, 10))
+			return false;
+	return true;
+}
+
+inline static void	__report(t_replay &r, uint64_t const elapsed)
+{
+	double const	seconds = static_cast<double>(elapsed) / 1e9;
+
+	if (r.opt.header)
+		std::cout << "capture,records,connections,lines,bytes,speed,duration_s,lines_per_sec,probes,p50_us,p99_us,p999_us\n";
+	std::sort(r.latencies.begin(), r.latencies.end());
+	std::cout
+	<< r.opt.files.front() << ','
+	<< r.records.size() << ','
+	<< r.nbConns << ','
+	<< r.nbLines << ','
+	<< r.nbBytes << ','
+	<< r.opt.speed << ','
+	<< seconds << ','
+	<< static_cast<unsigned long>(seconds > 0.0 ? static_cast<double>(r.nbLines) / seconds : 0.0) << ','
+	<< r.latencies.size() << ','
+	<< __percentile(r.latencies, 0.50) << ','
+	<< __percentile(r.latencies, 0.99) << ','
+	<< __percentile(r.latencies, 0.999) << '\n';
+}
+
+int	main(int const argc, char *const *const argv)
+{
+	t_replay								r;
+	std::vector<std::string>::const_iterator	cit;
+	uint64_t								time;
+	uint64_t								elapsed;
+
+	r.nbConns = 0;
+	r.nbLines = 0;
+	r.nbBytes = 0;
+	r.nbProbes = 0;
+	if (!__parseOptions(argc, argv, r.opt))
+		return EXIT_FAILURE;
+	for (cit = r.opt.files.begin(), time = 0 ; cit != r.opt.files.end() ; ++cit)
+		if (!__load(r, *cit, time))
+			return EXIT_FAILURE;
+	if (!__replay(r, elapsed))
+		return EXIT_FAILURE;
+	__report(r, elapsed);
+	return EXIT_SUCCESS;
+}
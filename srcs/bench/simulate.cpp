@@ -0,0 +1,401 @@
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <iostream>
+#include <streambuf>
+#include "class/Server.hpp"
+#include "class/SimClock.hpp"
+#include "class/SimTransport.hpp"
+#include "ft.hpp"
+
+/*
+	Deterministic simulation of a crowd of clients, without any socket.
+
+	The server runs on an in-memory network (SimTransport) and a virtual
+	clock (SimClock), its jobs being run inline: the same options always
+	give the same run, byte for byte, which the checksum of everything
+	the clients received tells.
+
+	Phases:
+		register	every client registers and joins its channel
+		traffic		every round, some clients message their channel
+					or another client, then one virtual second elapses
+		idle		nobody talks any more and the virtual time flies,
+					the silent clients not answering the PINGs until
+					their connection times out
+	The run is summarized as a single CSV line on stdout.
+*/
+
+bool	g_interrupted = false;
+bool	g_upgrade = false;
+
+/**
+ * @brief	Stream buffer throwing away everything, to mute the server logs
+ * 			while still paying for their formatting.
+ */
+class NullBuffer : public std::streambuf
+{
+protected:
+	int	overflow(int c)
+	{
+		return c;
+	}
+};
+
+class Simulation
+{
+private:
+	struct	t_client
+	{
+		int			fd;
+		bool		isSilent;
+		bool		isClosed;
+		std::string	nickname;
+		std::string	input;
+	};
+
+	SimClock				_clock;
+	SimTransport			_network;
+	Server					_server;
+	std::vector<t_client>	_clients;
+	std::string				_received;
+	uint64_t				_seed;
+	uint64_t				_checksum;
+	unsigned long			_ticks;
+	unsigned long			_registered;
+	unsigned long			_sent;
+	unsigned long			_delivered;
+	unsigned long			_pings;
+	unsigned long			_timedOut;
+	unsigned long			_lost;
+
+	Simulation(Simulation const &src);
+	Simulation	&operator=(Simulation const &rhs);
+
+	unsigned long	random(unsigned long const bound);
+
+	void	onLine(t_client &client, std::string const &line);
+
+	bool	settle(void);
+	bool	step(bool &isQuiet);
+
+public:
+	Simulation(uint64_t const seed);
+	~Simulation(void);
+
+	bool	init(void);
+	bool	registerAll(size_t const nbClients, size_t const channelSize, unsigned int const silentPercent);
+	bool	traffic(unsigned int const rounds, unsigned int const talkPercent, size_t const channelSize);
+	bool	idle(time_t const secondsPerTick);
+	void	stop(void);
+	void	print(std::ostream &os, double const wallTime) const;
+};
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+Simulation::Simulation(uint64_t const seed) :
+	_clock(1000000000),
+	_network(),
+	_server(),
+	_clients(),
+	_received(),
+	_seed(seed),
+	_checksum(14695981039346656037UL),
+	_ticks(0UL),
+	_registered(0UL),
+	_sent(0UL),
+	_delivered(0UL),
+	_pings(0UL),
+	_timedOut(0UL),
+	_lost(0UL) {}
+
+Simulation::~Simulation(void) {}
+
+// ************************************************************************** //
+//                              Private Methods                               //
+// ************************************************************************** //
+
+/**
+ * @brief	Draw a number, the same sequence coming out of the same seed.
+ */
+unsigned long	Simulation::random(unsigned long const bound)
+{
+	this->_seed = this->_seed * 6364136223846793005UL + 1442695040888963407UL;
+	return static_cast<unsigned long>(this->_seed >> 33) % bound;
+}
+
+void	Simulation::onLine(t_client &client, std::string const &line)
+{
+	std::string::size_type	pos;
+
+	pos = (line[0] == ':' ? line.find(' ') + 1 : 0);
+	if (!line.compare(pos, 4, "001 "))
+		++this->_registered;
+	else if (!line.compare(pos, 8, "PRIVMSG "))
+		++this->_delivered;
+	else if (!line.compare(pos, 5, "PING "))
+	{
+		++this->_pings;
+		if (!client.isSilent)
+			this->_network.write(client.fd, "PONG :" + client.nickname + "\r\n");
+	}
+}
+
+/**
+ * @brief	Run a loop iteration, then let every client read its replies.
+ *
+ * @param	isQuiet Set to false if any client received anything.
+ *
+ * @return	true if success, false otherwise.
+ */
+bool	Simulation::step(bool &isQuiet)
+{
+	std::vector<t_client>::iterator	it;
+	std::string::size_type			pos;
+	size_t							idx;
+
+	if (!this->_server.tick())
+		return false;
+	++this->_ticks;
+	for (it = this->_clients.begin() ; it != this->_clients.end() ; ++it)
+	{
+		if (it->isClosed)
+			continue ;
+		this->_received.clear();
+		if (!this->_network.read(it->fd, this->_received))
+		{
+			it->isClosed = true;
+			++*(it->isSilent ? &this->_timedOut : &this->_lost);
+		}
+		if (this->_received.empty())
+			continue ;
+		isQuiet = false;
+		for (idx = 0 ; idx < this->_received.size() ; ++idx)
+			this->_checksum = (this->_checksum ^ static_cast<unsigned char>(this->_received[idx])) * 1099511628211UL;
+		it->input += this->_received;
+		for ( ; (pos = it->input.find("\r\n")) != std::string::npos ; it->input.erase(0, pos + 2))
+			this->onLine(*it, it->input.substr(0, pos));
+	}
+	return true;
+}
+
+/**
+ * @brief	Run loop iterations until the clients stop receiving anything.
+ * 			The replies of the jobs come one iteration after their command,
+ * 			hence the two quiet iterations in a row.
+ *
+ * @return	true if success, false otherwise.
+ */
+bool	Simulation::settle(void)
+{
+	unsigned int	quietSteps;
+	bool			isQuiet;
+
+	for (quietSteps = 0 ; quietSteps < 2 ; )
+	{
+		isQuiet = true;
+		if (!this->step(isQuiet))
+			return false;
+		quietSteps = (isQuiet ? quietSteps + 1 : 0);
+	}
+	return true;
+}
+
+// ************************************************************************** //
+//                               Public Methods                               //
+// ************************************************************************** //
+
+/**
+ * @brief	Start the server on the simulated network and clock.
+ * 			The DNS lookups are off, and the jobs run inline,
+ * 			to keep every run the same.
+ */
+bool	Simulation::init(void)
+{
+	this->_server.setClock(this->_clock);
+	this->_server.setTransport(this->_network);
+	if (!this->_server.init(""))
+		return false;
+	this->_server._config["workers"] = "0";
+	this->_server._config["dns_timeout"] = "0";
+	this->_server._config["metrics_listen"] = "";
+	this->_server._config["capture_file"] = "";
+	return this->_server.start(6667);
+}
+
+/**
+ * @brief	Connect and register the clients, every `channelSize` of them
+ * 			joining the same channel.
+ */
+bool	Simulation::registerAll(size_t const nbClients, size_t const channelSize, unsigned int const silentPercent)
+{
+	sockaddr_in	addr = {};
+	t_client	client;
+	size_t		idx;
+
+	addr.sin_family = AF_INET;
+	this->_clients.reserve(nbClients);
+	for (idx = 0 ; idx < nbClients ; ++idx)
+	{
+		addr.sin_addr.s_addr = htonl(static_cast<uint32_t>(0x0A000000 + idx));
+		client.fd = this->_network.connect(addr);
+		client.isSilent = (this->random(100) < silentPercent);
+		client.isClosed = false;
+		client.nickname = "sim" + ft::toString(static_cast<int>(idx));
+		this->_network.write(client.fd,
+			"NICK " + client.nickname + "\r\n"
+			"USER " + client.nickname + " 0 * :Simulated client\r\n"
+			"JOIN #sim" + ft::toString(static_cast<int>(idx / channelSize)) + "\r\n");
+		this->_clients.push_back(client);
+	}
+	return this->settle();
+}
+
+/**
+ * @brief	Make some clients talk, then let a virtual second elapse,
+ * 			as many times as there are rounds.
+ */
+bool	Simulation::traffic(unsigned int const rounds, unsigned int const talkPercent, size_t const channelSize)
+{
+	std::vector<t_client>::const_iterator	cit;
+	unsigned int							round;
+	std::string								target;
+
+	for (round = 0 ; round < rounds ; ++round)
+	{
+		for (cit = this->_clients.begin() ; cit != this->_clients.end() ; ++cit)
+		{
+			if (cit->isClosed || this->random(100) >= talkPercent)
+				continue ;
+			if (this->random(2))
+				target = "#sim" + ft::toString(static_cast<int>(static_cast<size_t>(cit - this->_clients.begin()) / channelSize));
+			else
+				target = this->_clients[this->random(this->_clients.size())].nickname;
+			this->_network.write(cit->fd, "PRIVMSG " + target + " :round " + ft::toString(static_cast<int>(round)) + "\r\n");
+			++this->_sent;
+		}
+		if (!this->settle())
+			return false;
+		this->_clock.advance(1);
+	}
+	return true;
+}
+
+/**
+ * @brief	Let the virtual time fly, `secondsPerTick` per loop iteration,
+ * 			until every silent client timed out.
+ */
+bool	Simulation::idle(time_t const secondsPerTick)
+{
+	time_t const	end = this->_clock.now() + 2 * std::strtol(this->_server._config["timeout"].c_str(), NULL, 10);
+	bool			isQuiet;
+
+	while (this->_clock.now() < end)
+	{
+		this->_clock.advance(secondsPerTick);
+		if (!this->step(isQuiet))
+			return false;
+	}
+	return this->settle();
+}
+
+void	Simulation::stop(void)
+{
+	this->_server.stop();
+}
+
+void	Simulation::print(std::ostream &os, double const wallTime) const
+{
+	os
+	<< this->_clients.size() << ','
+	<< this->_ticks << ','
+	<< this->_clock.now() - 1000000000 << ','
+	<< wallTime << ','
+	<< this->_registered << ','
+	<< this->_sent << ','
+	<< this->_delivered << ','
+	<< this->_pings << ','
+	<< this->_timedOut << ','
+	<< this->_lost << ','
+	<< std::hex << this->_checksum << std::dec << '\n';
+}
+
+// ************************************************************************** //
+//                                    Main                                    //
+// ************************************************************************** //
+
+inline static double	__now(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+int	main(int const argc, char *const *const argv)
+{
+	NullBuffer		nullBuffer;
+	std::streambuf	*stdoutBuffer;
+	size_t			nbClients;
+	size_t			channelSize;
+	unsigned int	rounds;
+	unsigned int	talkPercent;
+	unsigned int	silentPercent;
+	time_t			idleStep;
+	uint64_t		seed;
+	double			start;
+	bool			isHeader;
+	bool			isSuccess;
+	int				c;
+
+	nbClients = 100000;
+	channelSize = 10;
+	rounds = 10;
+	talkPercent = 10;
+	silentPercent = 10;
+	idleStep = 5;
+	seed = 42;
+	isHeader = false;
+	while ((c = getopt(argc, argv, "c:s:r:m:q:i:S:t")) != -1)
+	{
+		switch (c)
+		{
+			case 'c': nbClients = std::strtoul(optarg, NULL, 10); break ;
+			case 's': channelSize = std::strtoul(optarg, NULL, 10); break ;
+			case 'r': rounds = static_cast<unsigned int>(std::strtoul(optarg, NULL, 10)); break ;
+			case 'm': talkPercent = static_cast<unsigned int>(std::strtoul(optarg, NULL, 10)); break ;
+			case 'q': silentPercent = static_cast<unsigned int>(std::strtoul(optarg, NULL, 10)); break ;
+			case 'i': idleStep = std::strtol(optarg, NULL, 10); break ;
+			case 'S': seed = std::strtoull(optarg, NULL, 10); break ;
+			case 't': isHeader = true; break ;
+			default:
+				std::cerr
+				<< "usage: ircserv-sim [-c <clients>] [-s <channel size>] [-r <rounds>] [-m <% talking per round>]"
+				<< " [-q <% silent>] [-i <idle seconds per tick>] [-S <seed>] [-t]\n";
+				return EXIT_FAILURE;
+		}
+	}
+
+	Simulation	sim(seed);
+
+	start = __now();
+	stdoutBuffer = std::cout.rdbuf(&nullBuffer);
+	isSuccess = sim.init() &&
+		sim.registerAll(nbClients, channelSize ? channelSize : 1, silentPercent) &&
+		sim.traffic(rounds, talkPercent, channelSize ? channelSize : 1) &&
+		sim.idle(idleStep > 0 ? idleStep : 1);
+	sim.stop();
+	std::cout.rdbuf(stdoutBuffer);
+	if (!isSuccess)
+	{
+		std::cerr << "sim: the server failed\n";
+		return EXIT_FAILURE;
+	}
+	if (isHeader)
+		std::cout << "clients,ticks,virtual_s,wall_s,registered,sent,delivered,pings,timed_out,lost,checksum\n";
+	sim.print(std::cout, __now() - start);
+	return EXIT_SUCCESS;
+}
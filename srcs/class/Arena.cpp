@@ -0,0 +1,189 @@
+#include "class/Arena.hpp"
+
+/**
+ * Every allocation is aligned for any type.
+ */
+#define ALIGN(size)	(((size) + 15UL) & ~15UL)
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+Arena::Arena(void) :
+	_chunks(),
+	_blocks(),
+	_chunk(0UL),
+	_used(0UL),
+	_peak(0UL),
+	_heapAllocs(0UL),
+	_last(NULL) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+Arena::~Arena(void)
+{
+	std::vector<char *>::iterator	it;
+
+	this->reset();
+	for (it = this->_chunks.begin() ; it != this->_chunks.end() ; ++it)
+		delete[] *it;
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Take some memory from the arena, getting a new chunk from the heap
+ * 			only when the ones already got are full.
+ * 
+ * @param	size The number of bytes to take.
+ * 
+ * @return	A pointer to the memory taken.
+ */
+void	*Arena::allocate(size_t const size)
+{
+	size_t const	aligned = ALIGN(size ? size : 1UL);
+
+	if (aligned > ARENA_CHUNK_SIZE)
+	{
+		this->_blocks.reserve(this->_blocks.size() + 1);
+		this->_blocks.push_back(new char[aligned]);
+		++this->_heapAllocs;
+		return this->_blocks.back();
+	}
+	if (this->_chunks.empty() || this->_used + aligned > ARENA_CHUNK_SIZE)
+	{
+		if (!this->_chunks.empty())
+			++this->_chunk;
+		if (this->_chunk == this->_chunks.size())
+		{
+			this->_chunks.reserve(this->_chunks.size() + 1);
+			this->_chunks.push_back(new char[ARENA_CHUNK_SIZE]);
+			++this->_heapAllocs;
+		}
+		this->_used = 0UL;
+	}
+	this->_last = this->_chunks[this->_chunk] + this->_used;
+	this->_used += aligned;
+	return this->_last;
+}
+
+/**
+ * @brief	Give some memory back to the arena.
+ * 			Only the last allocation is actually given back, the other ones
+ * 			waiting for the next reset.
+ * 
+ * @param	ptr The memory to give back.
+ */
+void	Arena::deallocate(void *const ptr)
+{
+	if (ptr && ptr == this->_last)
+	{
+		this->_used = static_cast<size_t>(this->_last - this->_chunks[this->_chunk]);
+		this->_last = NULL;
+	}
+}
+
+/**
+ * @brief	Give back all the memory taken from the arena,
+ * 			keeping the chunks for the next allocations.
+ */
+void	Arena::reset(void)
+{
+	std::vector<char *>::iterator	it;
+
+	if (this->used() > this->_peak)
+		this->_peak = this->used();
+	for (it = this->_blocks.begin() ; it != this->_blocks.end() ; ++it)
+		delete[] *it;
+	this->_blocks.clear();
+	this->_chunk = 0UL;
+	this->_used = 0UL;
+	this->_last = NULL;
+}
+
+/**
+ * @brief	Get the number of bytes taken from the chunks since the last reset.
+ * 
+ * @return	The number of bytes taken.
+ */
+size_t	Arena::used(void) const
+{
+	return this->_chunk * ARENA_CHUNK_SIZE + this->_used;
+}
+
+/**
+ * @brief	Get the arena of the event loop iterations, reset at the end of each.
+ * 
+ * @return	The arena of the iterations.
+ */
+Arena	&Arena::tick(void)
+{
+	static Arena	arena;
+
+	return arena;
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+size_t const	&Arena::getPeak(void) const
+{
+	return this->_peak;
+}
+
+unsigned long const	&Arena::getHeapAllocs(void) const
+{
+	return this->_heapAllocs;
+}
+
+// ************************************************************************* //
+//                                 Operators                                 //
+// ************************************************************************* //
+
+ArenaString	operator+(ArenaString const &lhs, std::string const &rhs)
+{
+	ArenaString	str;
+
+	str.reserve(lhs.size() + rhs.size());
+	str.append(lhs).append(rhs.data(), rhs.size());
+	return str;
+}
+
+ArenaString	operator+(std::string const &lhs, ArenaString const &rhs)
+{
+	ArenaString	str;
+
+	str.reserve(lhs.size() + rhs.size());
+	str.append(lhs.data(), lhs.size()).append(rhs);
+	return str;
+}
+
+ArenaString	&operator+=(ArenaString &lhs, std::string const &rhs)
+{
+	return lhs.append(rhs.data(), rhs.size());
+}
+
+bool	operator==(ArenaString const &lhs, std::string const &rhs)
+{
+	return lhs.size() == rhs.size() && !lhs.compare(0, lhs.size(), rhs.data(), rhs.size());
+}
+
+bool	operator==(std::string const &lhs, ArenaString const &rhs)
+{
+	return rhs == lhs;
+}
+
+bool	operator!=(ArenaString const &lhs, std::string const &rhs)
+{
+	return !(lhs == rhs);
+}
+
+bool	operator!=(std::string const &lhs, ArenaString const &rhs)
+{
+	return !(rhs == lhs);
+}
@@ -0,0 +1,225 @@
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "class/Capture.hpp"
+#include "ft.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+Capture::Capture(void) :
+	_path(),
+	_buffer(),
+	_lookupIds(),
+	_fd(-1),
+	_nextId(0UL),
+	_rotations(0U),
+	_maxSize(0),
+	_size(0),
+	_last(0),
+	_lastFlush(0) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+Capture::~Capture(void)
+{
+	this->stop();
+}
+
+// ************************************************************************** //
+//                          Private Member Functions                          //
+// ************************************************************************** //
+
+void	Capture::putVarint(uint64_t value)
+{
+	for ( ; value >= 0x80 ; value >>= 7)
+		this->_buffer += static_cast<char>((value & 0x7F) | 0x80);
+	this->_buffer += static_cast<char>(value);
+}
+
+/**
+ * @brief	Append the common part of a record to the buffer.
+ * 
+ * @param	type The type of the record.
+ * @param	socket The socket of the connection.
+ */
+void	Capture::record(int const type, int const socket)
+{
+	uint64_t const	now = Capture::microseconds();
+
+	this->_buffer += static_cast<char>(type);
+	this->putVarint(this->_lookupIds[socket]);
+	this->putVarint(now > this->_last ? now - this->_last : 0);
+	this->_last = now;
+}
+
+/**
+ * @brief	Write the buffered records, rotating the file beforehand
+ * 			if it would grow over its maximum size.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Capture::flush(void)
+{
+	std::string	rotated;
+	ssize_t		ret;
+	size_t		written;
+
+	this->_lastFlush = Capture::microseconds();
+	if (this->_buffer.empty() || this->_fd == -1)
+		return true;
+	if (this->_maxSize && this->_size > CAPTURE_MAGIC_SIZE + 8 && this->_size + this->_buffer.size() > this->_maxSize)
+	{
+		::close(this->_fd);
+		this->_fd = -1;
+		rotated = this->_path + '.' + ft::toString(static_cast<int>(++this->_rotations));
+		if (std::rename(this->_path.c_str(), rotated.c_str()) || !this->openFile())
+			return false;
+	}
+	for (written = 0 ; written < this->_buffer.size() ; written += static_cast<size_t>(ret))
+	{
+		ret = write(this->_fd, this->_buffer.data() + written, this->_buffer.size() - written);
+		if (ret == -1 && errno != EINTR)
+			return false;
+		if (ret == -1)
+			ret = 0;
+	}
+	this->_size += this->_buffer.size();
+	this->_buffer.clear();
+	return true;
+}
+
+/**
+ * @brief	Create the capture file, and write its header.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Capture::openFile(void)
+{
+	uint64_t	start;
+	int			idx;
+
+	this->_fd = ::open(this->_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if (this->_fd == -1)
+		return false;
+	start = Capture::microseconds();
+	// After a rotation, the buffered records are still timed from the previous one.
+	if (!this->_last)
+		this->_last = start;
+	this->_buffer.insert(0, CAPTURE_MAGIC);
+	for (idx = 0 ; idx < 8 ; ++idx)
+		this->_buffer.insert(CAPTURE_MAGIC_SIZE + static_cast<size_t>(idx), 1, static_cast<char>(start >> (idx * 8)));
+	this->_size = 0;
+	return true;
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Start capturing.
+ * 
+ * @param	path The path of the capture file.
+ * @param	maxSize The size over which the file is rotated, 0 meaning never.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Capture::init(std::string const &path, size_t const maxSize)
+{
+	this->_path = path;
+	this->_maxSize = maxSize;
+	this->_buffer.reserve(CAPTURE_BUFFER_SIZE * 2);
+	return this->openFile();
+}
+
+bool	Capture::isEnabled(void) const
+{
+	return this->_fd != -1;
+}
+
+/**
+ * @brief	Record a new connection.
+ * 
+ * @param	socket The socket of the connection.
+ */
+void	Capture::open(int const socket)
+{
+	if (this->_fd == -1)
+		return ;
+	this->_lookupIds[socket] = this->_nextId++;
+	this->record(OPEN, socket);
+}
+
+/**
+ * @brief	Record bytes received from a connection.
+ * 
+ * @param	socket The socket of the connection.
+ * @param	bytes The received bytes.
+ * @param	size The number of received bytes.
+ */
+void	Capture::data(int const socket, char const *const bytes, size_t const size)
+{
+	if (this->_fd == -1)
+		return ;
+	this->record(DATA, socket);
+	this->putVarint(size);
+	this->_buffer.append(bytes, size);
+	if (this->_buffer.size() >= CAPTURE_BUFFER_SIZE && !this->flush())
+		this->stop();
+}
+
+/**
+ * @brief	Record the end of a connection.
+ * 
+ * @param	socket The socket of the connection.
+ */
+void	Capture::close(int const socket)
+{
+	if (this->_fd == -1)
+		return ;
+	this->record(CLOSE, socket);
+	this->_lookupIds.erase(socket);
+}
+
+/**
+ * @brief	Write the buffered records if they are older than a second,
+ * 			so that a quiet server still gets its capture on disk.
+ */
+void	Capture::tick(void)
+{
+	if (this->_fd != -1 && !this->_buffer.empty() &&
+		Capture::microseconds() - this->_lastFlush >= 1000000UL && !this->flush())
+		this->stop();
+}
+
+/**
+ * @brief	Write the remaining records and close the capture file.
+ */
+void	Capture::stop(void)
+{
+	if (this->_fd == -1)
+		return ;
+	this->flush();
+	::close(this->_fd);
+	this->_fd = -1;
+	this->_lookupIds.clear();
+}
+
+/**
+ * @brief	Get the wall clock time.
+ * 
+ * @return	The time in microseconds.
+ */
+uint64_t	Capture::microseconds(void)
+{
+	struct timeval	tv;
+
+	gettimeofday(&tv, NULL);
+	return static_cast<uint64_t>(tv.tv_sec) * 1000000UL + static_cast<uint64_t>(tv.tv_usec);
+}
@@ -1,14 +1,49 @@
 #include "class/Channel.hpp"
+#include "ft.hpp"
 
 // ************************************************************************** //
 //                             Private Attributes                             //
 // ************************************************************************** //
 
+unsigned long	Channel::_revisions = 0UL;
+unsigned long	Channel::_takenRevision = 0UL;
+bool			Channel::_isTracked = false;
+
+/**
+ * The names of the channels created, changed or destroyed since the changes
+ * were last taken, while they are tracked. A channel is only told once:
+ * a revision above the one the changes were taken at means it already was.
+ */
+std::vector<Identifier>	Channel::_changes;
+
 /**
  * The available modes are:
- * - no any for now
+ * 	- b: ban mask
+ * 	- i: invite only
+ * 	- k: key
+ * 	- l: user limit
+ * 	- m: moderated
+ * 	- n: no messages from outside
+ * 	- o: channel operator
+ * 	- s: secret
+ * 	- t: topic settable by channel operators only
+ * 	- v: voice
  */
-std::string const	Channel::_availableModes("");
+std::string const	Channel::_availableModes("biklmnostv");
+
+Channel::t_modeDef const	Channel::_arrayModes[] = {
+	{'b', 0U, LIST},
+	{'i', INVITE_ONLY, FLAG},
+	{'k', KEY, PARAM},
+	{'l', LIMIT, PARAM_SET},
+	{'m', MODERATED, FLAG},
+	{'n', INSIDE_ONLY, FLAG},
+	{'o', CHANOP, MEMBER},
+	{'s', SECRET, FLAG},
+	{'t', TOPIC_LOCK, FLAG},
+	{'v', VOICE, MEMBER},
+	{0, 0U, FLAG}
+};
 
 // ************************************************************************** //
 //                                Constructors                                //
@@ -17,8 +52,19 @@ std::string const	Channel::_availableModes("");
 Channel::Channel(std::string const &name) :
 	_name(name),
 	_topic(),
-	_modes(),
-	_lookupUsers() {}
+	_key(),
+	_modes(0U),
+	_limit(0U),
+	_timestamp(0),
+	_revision(++Channel::_revisions),
+	_banList(),
+	_history(),
+	_lookupUsers(),
+	_lookupMemberModes()
+{
+	if (Channel::_isTracked)
+		Channel::_changes.push_back(this->_name);
+}
 
 // ************************************************************************* //
 //                                Destructors                                //
@@ -26,13 +72,72 @@ Channel::Channel(std::string const &name) :
 
 Channel::~Channel(void)
 {
+	if (Channel::_isTracked && this->_revision <= Channel::_takenRevision)
+		Channel::_changes.push_back(this->_name);
+	this->_lookupMemberModes.clear();
 	this->_lookupUsers.clear();
 }
 
+// ************************************************************************* //
+//                          Private Member Functions                         //
+// ************************************************************************* //
+
+/**
+ * @brief	Tell the settings of the channel changed, for the snapshot
+ * 			to encode it again.
+ */
+void	Channel::touch(void)
+{
+	if (Channel::_isTracked && this->_revision <= Channel::_takenRevision)
+		Channel::_changes.push_back(this->_name);
+	this->_revision = ++Channel::_revisions;
+}
+
 // ************************************************************************* //
 //                          Public Member Functions                          //
 // ************************************************************************* //
 
+/**
+ * @brief	Add a mask to the ban list of the channel.
+ * 
+ * @param	mask The mask to ban.
+ * 
+ * @return	Either true if the mask has been added, or false if it was already there.
+ */
+bool	Channel::addBan(std::string const &mask)
+{
+	if (std::find(this->_banList.begin(), this->_banList.end(), mask) != this->_banList.end())
+		return false;
+	this->_banList.push_back(mask);
+	this->touch();
+	return true;
+}
+
+/**
+ * @brief	Set some member modes (channel operator, voice) for a member.
+ * 
+ * @param	user The member to set the modes for.
+ * @param	modes The bits of the modes to set.
+ */
+void	Channel::addMemberModes(User const &user, unsigned int const modes)
+{
+	std::map<User const *const, unsigned int>::iterator	it = this->_lookupMemberModes.find(&user);
+
+	if (it != this->_lookupMemberModes.end())
+		it->second |= modes;
+}
+
+/**
+ * @brief	Set some modes of the channel.
+ * 
+ * @param	modes The bits of the modes to set.
+ */
+void	Channel::addModes(unsigned int const modes)
+{
+	this->_modes |= modes;
+	this->touch();
+}
+
 /**
  * @brief	Add a new user to the channel,
  * 			or modify the user known as its nickname
@@ -42,7 +147,8 @@ Channel::~Channel(void)
  */
 void	Channel::addUser(User &user)
 {
-	this->_lookupUsers.insert(std::pair<std::string const, User *const>(user.getNickname(), &user));
+	this->_lookupUsers.insert(std::pair<Identifier const, User *const>(user.getNicknameId(), &user));
+	this->_lookupMemberModes.insert(std::pair<User const *const, unsigned int>(&user, 0U));
 }
 
 /**
@@ -50,7 +156,7 @@ void	Channel::addUser(User &user)
  * 
  * @return	An iterator to the first user of the channel.
  */
-std::map<std::string const, User *const>::iterator	Channel::begin(void)
+std::map<Identifier const, User *const>::iterator	Channel::begin(void)
 {
 	return this->_lookupUsers.begin();
 }
@@ -60,19 +166,125 @@ std::map<std::string const, User *const>::iterator	Channel::begin(void)
  * 
  * @return	A const_iterator to the first user of the channel.
  */
-std::map<std::string const, User *const>::const_iterator	Channel::begin(void) const
+std::map<Identifier const, User *const>::const_iterator	Channel::begin(void) const
 {
 	return this->_lookupUsers.begin();
 }
 
+/**
+ * @brief	Remove a mask from the ban list of the channel.
+ * 
+ * @param	mask The mask to unban.
+ * 
+ * @return	Either true if the mask has been removed, or false if it was not there.
+ */
+bool	Channel::delBan(std::string const &mask)
+{
+	std::vector<std::string>::iterator	it = std::find(this->_banList.begin(), this->_banList.end(), mask);
+
+	if (it == this->_banList.end())
+		return false;
+	this->_banList.erase(it);
+	this->touch();
+	return true;
+}
+
+/**
+ * @brief	Unset some member modes (channel operator, voice) for a member.
+ * 
+ * @param	user The member to unset the modes for.
+ * @param	modes The bits of the modes to unset.
+ */
+void	Channel::delMemberModes(User const &user, unsigned int const modes)
+{
+	std::map<User const *const, unsigned int>::iterator	it = this->_lookupMemberModes.find(&user);
+
+	if (it != this->_lookupMemberModes.end())
+		it->second &= ~modes;
+}
+
+/**
+ * @brief	Unset some modes of the channel.
+ * 
+ * @param	modes The bits of the modes to unset.
+ */
+void	Channel::delModes(unsigned int const modes)
+{
+	this->_modes &= ~modes;
+	this->touch();
+}
+
 /**
  * @brief	Remove an user from the channel.
  * 
  * @param	nickname The nickname of the user to remove.
  */
-void	Channel::delUser(std::string const &nickname)
+void	Channel::delUser(Identifier const &nickname)
+{
+	std::map<Identifier const, User *const>::iterator	it = this->_lookupUsers.find(nickname);
+
+	if (it == this->_lookupUsers.end())
+		return ;
+	this->_lookupMemberModes.erase(it->second);
+	this->_lookupUsers.erase(it);
+}
+
+/**
+ * @brief	Restore the settings of the channel from a state written by save().
+ * 
+ * @param	state The state to read from.
+ */
+void	Channel::load(StateReader &state)
+{
+	uint64_t	nbBans;
+
+	this->setName(state.getString());
+	this->_topic = state.getString();
+	this->_key = state.getString();
+	this->_modes = static_cast<unsigned int>(state.getVarint());
+	this->_limit = static_cast<unsigned int>(state.getVarint());
+	this->_timestamp = static_cast<time_t>(state.getVarint());
+	this->_banList.clear();
+	for (nbBans = state.getVarint() ; nbBans && state.isValid() ; --nbBans)
+		this->_banList.push_back(state.getString());
+	this->touch();
+}
+
+/**
+ * @brief	Index a member under its new nickname, keeping its modes.
+ * 
+ * @param	nickname The former nickname of the member.
+ * @param	user The member, already renamed.
+ */
+void	Channel::renameUser(Identifier const &nickname, User &user)
 {
-	this->_lookupUsers.erase(nickname);
+	std::map<Identifier const, User *const>::iterator	it = this->_lookupUsers.find(nickname);
+
+	if (it == this->_lookupUsers.end() || it->second != &user)
+		return ;
+	this->_lookupUsers.erase(it);
+	this->_lookupUsers.insert(std::pair<Identifier const, User *const>(user.getNicknameId(), &user));
+}
+
+/**
+ * @brief	Write the settings of the channel: its name, topic, key, modes,
+ * 			limit, timestamp and bans, but not its members.
+ * 
+ * @param	state The state to write to.
+ */
+void	Channel::save(StateWriter &state) const
+{
+	std::vector<std::string>::const_iterator	it;
+
+	state.putString(this->_name.getName());
+	state.putString(this->_topic);
+	state.putString(this->_key);
+	state.putVarint(this->_modes);
+	state.putVarint(this->_limit);
+	state.putVarint(static_cast<uint64_t>(this->_timestamp));
+	state.putVarint(this->_banList.size());
+	for (it = this->_banList.begin() ; it != this->_banList.end() ; ++it)
+		state.putString(*it);
 }
 
 /**
@@ -90,7 +302,7 @@ bool	Channel::empty(void) const
  * 
  * @return	An iterator to the post-last user of the channel.
  */
-std::map<std::string const, User *const>::iterator	Channel::end(void)
+std::map<Identifier const, User *const>::iterator	Channel::end(void)
 {
 	return this->_lookupUsers.end();
 }
@@ -100,7 +312,7 @@ std::map<std::string const, User *const>::iterator	Channel::end(void)
  * 
  * @return	A const_iterator to the post-last user of the channel.
  */
-std::map<std::string const, User *const>::const_iterator	Channel::end(void) const
+std::map<Identifier const, User *const>::const_iterator	Channel::end(void) const
 {
 	return this->_lookupUsers.end();
 }
@@ -113,11 +325,24 @@ std::map<std::string const, User *const>::const_iterator	Channel::end(void) cons
  * @return	Either an iterator to the user with the given nickname,
  * 			or the end() iterator if no user with the given nickname is found.
  */
-std::map<std::string const, User *const>::iterator	Channel::find(std::string const &nickname)
+std::map<Identifier const, User *const>::iterator	Channel::find(Identifier const &nickname)
 {
 	return this->_lookupUsers.find(nickname);
 }
 
+/**
+ * @brief	Get an iterator to an user with a given nickname, casefolded.
+ * 
+ * @param	nickname The nickname of the user to find.
+ * 
+ * @return	Either an iterator to the user with the given nickname,
+ * 			or the end() iterator if no user with the given nickname is found.
+ */
+std::map<Identifier const, User *const>::iterator	Channel::find(std::string const &nickname)
+{
+	return this->_lookupUsers.find(Identifier::find(nickname));
+}
+
 /**
  * @brief	Get a const_iterator to an user with a given nickname.
  * 
@@ -126,11 +351,148 @@ std::map<std::string const, User *const>::iterator	Channel::find(std::string con
  * @return	Either a const_iterator to the user with the given nickname,
  * 			or the end() const_iterator if no user with the given nickname is found.
  */
-std::map<std::string const, User *const>::const_iterator	Channel::find(std::string const &nickname) const
+std::map<Identifier const, User *const>::const_iterator	Channel::find(Identifier const &nickname) const
 {
 	return this->_lookupUsers.find(nickname);
 }
 
+/**
+ * @brief	Get a const_iterator to an user with a given nickname, casefolded.
+ * 
+ * @param	nickname The nickname of the user to find.
+ * 
+ * @return	Either a const_iterator to the user with the given nickname,
+ * 			or the end() const_iterator if no user with the given nickname is found.
+ */
+std::map<Identifier const, User *const>::const_iterator	Channel::find(std::string const &nickname) const
+{
+	return this->_lookupUsers.find(Identifier::find(nickname));
+}
+
+/**
+ * @brief	Get the definition of a channel mode from its letter.
+ * 
+ * @param	letter The letter of the mode.
+ * 
+ * @return	The definition of the mode, or NULL if there is no such mode.
+ */
+Channel::t_modeDef const	*Channel::getModeDef(char const letter)
+{
+	unsigned int	idx;
+
+	for (idx = 0U ; Channel::_arrayModes[idx].letter ; ++idx)
+		if (Channel::_arrayModes[idx].letter == letter)
+			return &Channel::_arrayModes[idx];
+	return NULL;
+}
+
+/**
+ * @brief	Get the member modes (channel operator, voice) of a member.
+ * 
+ * @param	user The member to get the modes of.
+ * 
+ * @return	The bits of the member modes, 0 if the user is not a member.
+ */
+unsigned int	Channel::getMemberModes(User const &user) const
+{
+	std::map<User const *const, unsigned int>::const_iterator	cit = this->_lookupMemberModes.find(&user);
+
+	if (cit == this->_lookupMemberModes.end())
+		return 0U;
+	return cit->second;
+}
+
+/**
+ * @brief	Get the letters of the modes set for the channel, as in RPL_CHANNELMODEIS.
+ * 
+ * @param	withParams Whether to append the parameters of the modes (key, limit).
+ * 
+ * @return	The mode string of the channel.
+ */
+std::string	Channel::getModeString(bool const withParams) const
+{
+	std::string		modeString("+");
+	std::string		params;
+	unsigned int	idx;
+
+	for (idx = 0U ; Channel::_arrayModes[idx].letter ; ++idx)
+	{
+		if (Channel::_arrayModes[idx].type == LIST || Channel::_arrayModes[idx].type == MEMBER ||
+			!(this->_modes & Channel::_arrayModes[idx].bit))
+			continue ;
+		modeString += Channel::_arrayModes[idx].letter;
+		if (withParams && Channel::_arrayModes[idx].bit == KEY)
+			params += ' ' + this->_key;
+		else if (withParams && Channel::_arrayModes[idx].bit == LIMIT)
+			params += ' ' + ft::toString(this->_limit);
+	}
+	return modeString + params;
+}
+
+/**
+ * @brief	Check if a mode is set for the channel.
+ * 
+ * @param	mode The bit of the mode to check.
+ * 
+ * @return	Either true if the mode is set, or false if not.
+ */
+bool	Channel::hasMode(unsigned int const mode) const
+{
+	return this->_modes & mode;
+}
+
+/**
+ * @brief	Check if an user matches one of the masks of the ban list.
+ * 
+ * @param	user The user to check.
+ * 
+ * @return	Either true if the user is banned, or false if not.
+ */
+bool	Channel::isBanned(User const &user) const
+{
+	std::vector<std::string>::const_iterator	cit;
+
+	for (cit = this->_banList.begin() ; cit != this->_banList.end() ; ++cit)
+		if (ft::match(*cit, user.getMask()))
+			return true;
+	return false;
+}
+
+/**
+ * @brief	Get the number of members of the channel.
+ * 
+ * @return	The number of members of the channel.
+ */
+size_t	Channel::size(void) const
+{
+	return this->_lookupUsers.size();
+}
+
+/**
+ * @brief	Take the names of the channels created, changed or destroyed
+ * 			since the previous call, a name possibly coming more than once.
+ * 
+ * @param	changes The vector to swap the names into, cleared first.
+ */
+void	Channel::takeChanges(std::vector<Identifier> &changes)
+{
+	changes.clear();
+	changes.swap(Channel::_changes);
+	Channel::_takenRevision = Channel::_revisions;
+}
+
+/**
+ * @brief	Start or stop telling the changes of the channels, for the snapshot.
+ * 
+ * @param	isTracked Whether to tell them.
+ */
+void	Channel::track(bool const isTracked)
+{
+	Channel::_isTracked = isTracked;
+	Channel::_changes.clear();
+	Channel::_takenRevision = Channel::_revisions;
+}
+
 // ************************************************************************* //
 //                                 Accessors                                 //
 // ************************************************************************* //
@@ -140,16 +502,58 @@ std::string const	&Channel::getAvailableModes(void)
 	return Channel::_availableModes;
 }
 
-std::string const	&Channel::getModes(void) const
+std::vector<std::string> const	&Channel::getBanList(void) const
+{
+	return this->_banList;
+}
+
+/**
+ * @brief	Get the messages sent to the channel lately, see History.
+ */
+History::Ring const	&Channel::getHistory(void) const
+{
+	return this->_history;
+}
+
+History::Ring	&Channel::getHistory(void)
+{
+	return this->_history;
+}
+
+std::string const	&Channel::getKey(void) const
+{
+	return this->_key;
+}
+
+unsigned int const	&Channel::getLimit(void) const
+{
+	return this->_limit;
+}
+
+unsigned int const	&Channel::getModes(void) const
 {
 	return this->_modes;
 }
 
 std::string const	&Channel::getName(void) const
+{
+	return this->_name.getName();
+}
+
+Identifier const	&Channel::getNameId(void) const
 {
 	return this->_name;
 }
 
+/**
+ * @brief	Get when the channel was created, the oldest side keeping its modes
+ * 			when two servers of the network merge their channel.
+ */
+time_t const	&Channel::getTimestamp(void) const
+{
+	return this->_timestamp;
+}
+
 std::string const	&Channel::getTopic(void) const
 {
 	return this->_topic;
@@ -161,15 +565,38 @@ std::string const	&Channel::getTopic(void) const
 
 void	Channel::setName(std::string const &name)
 {
-	this->_name = name;
+	this->_name = Identifier(name);
+	if (Channel::_isTracked)
+		Channel::_changes.push_back(this->_name);
+	this->touch();
 }
 
 void	Channel::setTopic(std::string const &topic)
 {
 	this->_topic = topic;
+	this->touch();
+}
+
+void	Channel::setKey(std::string const &key)
+{
+	this->_key = key;
+	this->touch();
 }
 
-void	Channel::setModes(std::string const &modes)
+void	Channel::setLimit(unsigned int const limit)
+{
+	this->_limit = limit;
+	this->touch();
+}
+
+void	Channel::setModes(unsigned int const modes)
 {
 	this->_modes = modes;
+	this->touch();
+}
+
+void	Channel::setTimestamp(time_t const timestamp)
+{
+	this->_timestamp = timestamp;
+	this->touch();
 }
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include "class/CheckPasswordJob.hpp"
+#include "ft.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+CheckPasswordJob::CheckPasswordJob(User *const user, t_done const done, std::string const &password, std::string const &hash, std::string const &name) :
+	Job(user, done),
+	_password(password),
+	_hash(hash),
+	_name(name),
+	_isValid(false) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+CheckPasswordJob::~CheckPasswordJob(void)
+{
+	std::fill(this->_password.begin(), this->_password.end(), '\0');
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Check the password against the hash, then wipe it out.
+ * 			Run on a worker thread.
+ */
+void	CheckPasswordJob::execute(void)
+{
+	this->_isValid = !this->_hash.empty() && ft::checkPassword(this->_password, this->_hash);
+	std::fill(this->_password.begin(), this->_password.end(), '\0');
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+bool const	&CheckPasswordJob::getIsValid(void) const
+{
+	return this->_isValid;
+}
+
+std::string const	&CheckPasswordJob::getName(void) const
+{
+	return this->_name;
+}
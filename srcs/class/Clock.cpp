@@ -0,0 +1,41 @@
+#include <sys/time.h> // gettimeofday
+#include "class/Clock.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+Clock::Clock(void) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+Clock::~Clock(void) {}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Get the current time.
+ * 
+ * @return	The number of seconds since the Epoch.
+ */
+time_t	Clock::now(void) const
+{
+	return time(NULL);
+}
+
+/**
+ * @brief	Get the current time, to the millisecond.
+ * 
+ * @return	The number of milliseconds since the Epoch.
+ */
+uint64_t	Clock::milliseconds(void) const
+{
+	timeval	tv;
+
+	gettimeofday(&tv, NULL);
+	return static_cast<uint64_t>(tv.tv_sec) * 1000UL + static_cast<uint64_t>(tv.tv_usec) / 1000UL;
+}
@@ -148,7 +148,36 @@ std::pair<std::string const, std::string const>	Config::_arrayValues[] = {
 	std::pair<std::string const, std::string const>("ping", "10"),
 	std::pair<std::string const, std::string const>("timeout", "30"),
 	std::pair<std::string const, std::string const>("backlog", "1024"),
-	std::pair<std::string const, std::string const>("oper_admin", "admin"),
+	std::pair<std::string const, std::string const>("workers", "4"),
+	std::pair<std::string const, std::string const>("register_timeout", "10"),
+	std::pair<std::string const, std::string const>("auth_attempts", "3"),
+	std::pair<std::string const, std::string const>("auth_window", "60"),
+	std::pair<std::string const, std::string const>("dns_timeout", "5"),
+	std::pair<std::string const, std::string const>("dns_ttl", "3600"),
+	std::pair<std::string const, std::string const>("dns_negative_ttl", "300"),
+	std::pair<std::string const, std::string const>("metrics_listen", ""),
+	std::pair<std::string const, std::string const>("slow_tick", "100"),
+	std::pair<std::string const, std::string const>("slow_tick_log_interval", "10"),
+	std::pair<std::string const, std::string const>("capture_file", ""),
+	std::pair<std::string const, std::string const>("capture_max_size", "67108864"),
+	std::pair<std::string const, std::string const>("spam_filter", ""),
+	std::pair<std::string const, std::string const>("snapshot_file", ""),
+	std::pair<std::string const, std::string const>("snapshot_interval", "60"),
+	std::pair<std::string const, std::string const>("history_memory", "67108864"),
+	std::pair<std::string const, std::string const>("history_size", "16384"),
+	std::pair<std::string const, std::string const>("nick_length", "30"),
+	std::pair<std::string const, std::string const>("channel_length", "50"),
+	std::pair<std::string const, std::string const>("max_modes", "4"),
+	std::pair<std::string const, std::string const>("targmax", "JOIN:10,KICK:4,PART:10,PRIVMSG:4"),
+	std::pair<std::string const, std::string const>("max_monitor", "100"),
+	std::pair<std::string const, std::string const>("server_description", "ircserv"),
+	std::pair<std::string const, std::string const>("link_password", ""),
+	std::pair<std::string const, std::string const>("links", ""),
+	std::pair<std::string const, std::string const>("link_retry", "30"),
+	std::pair<std::string const, std::string const>("upgrade_wait", "10"),
+	std::pair<std::string const, std::string const>("sendq", "262144"),
+	std::pair<std::string const, std::string const>("link_sendq", "1048576"),
+	std::pair<std::string const, std::string const>("oper_admin", "$2b$10$47rVqxE25dCTprAhfruiJ.bC.Io6aoyY3x873OWHipsh8REhKxPqm"),
 	// std::pair<std::string const, std::string const>("oper_name", "admin"),
 	// std::pair<std::string const, std::string const>("oper_password", "admin"),
 	std::pair<std::string const, std::string const>("", "")
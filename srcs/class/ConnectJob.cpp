@@ -0,0 +1,56 @@
+#include "class/ConnectJob.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+ConnectJob::ConnectJob(t_done const done, Transport &transport, std::string const &host, uint16_t const port) :
+	Job(NULL, done),
+	_transport(transport),
+	_host(host),
+	_port(port),
+	_fd(-1),
+	_error() {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+ConnectJob::~ConnectJob(void) {}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Open the connection to the server to link.
+ * 			Run on a worker thread.
+ */
+void	ConnectJob::execute(void)
+{
+	this->_fd = this->_transport.connect(this->_host, this->_port, this->_error);
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+std::string const	&ConnectJob::getError(void) const
+{
+	return this->_error;
+}
+
+int const	&ConnectJob::getFd(void) const
+{
+	return this->_fd;
+}
+
+std::string const	&ConnectJob::getHost(void) const
+{
+	return this->_host;
+}
+
+uint16_t const	&ConnectJob::getPort(void) const
+{
+	return this->_port;
+}
@@ -0,0 +1,468 @@
+#include <cstring> // memcpy
+#include <new> // bad_alloc
+#include "class/History.hpp"
+
+/**
+ * Every message starts aligned for its header.
+ */
+#define ALIGN(size)	(((size) + 7UL) & ~7UL)
+
+/**
+ * No ring, at either end of the list of the rings by last message.
+ */
+#define NONE		static_cast<size_t>(-1)
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+History::History(void) :
+	_memory(NULL),
+	_ringSize(0UL),
+	_rings(),
+	_free(),
+	_newest(NONE),
+	_oldest(NONE),
+	_nextMsgid(1UL),
+	_evictions(0UL) {}
+
+History::Ring::Ring(void) :
+	_pool(NULL),
+	_index(0UL) {}
+
+History::Ring::Ring(Ring const &src __attribute__((unused))) :
+	_pool(NULL),
+	_index(0UL) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+History::~History(void)
+{
+	this->stop();
+}
+
+History::Ring::~Ring(void)
+{
+	if (this->_pool)
+		this->_pool->release(this->_index);
+}
+
+// ************************************************************************* //
+//                                 Operators                                 //
+// ************************************************************************* //
+
+History::Ring	&History::Ring::operator=(Ring const &rhs __attribute__((unused)))
+{
+	return *this;
+}
+
+// ************************************************************************* //
+//                          Private Member Functions                         //
+// ************************************************************************* //
+
+/**
+ * @brief	Give a ring to a channel without history: a free one, or else
+ * 			the one of the channel that got a message the longest ago.
+ * 
+ * @param	ring The history of the channel.
+ */
+void	History::acquire(Ring &ring)
+{
+	size_t	index;
+
+	if (this->_free.empty())
+	{
+		index = this->_oldest;
+		this->unlink(index);
+		this->_rings[index].owner->_pool = NULL;
+		++this->_evictions;
+	}
+	else
+	{
+		index = this->_free.back();
+		this->_free.pop_back();
+	}
+
+	t_ring	&state = this->_rings[index];
+
+	state.owner = &ring;
+	state.head = 0UL;
+	state.tail = 0UL;
+	state.end = this->_ringSize;
+	state.count = 0UL;
+	this->pushNewest(index);
+	ring._pool = this;
+	ring._index = index;
+}
+
+/**
+ * @brief	Take a ring back from the channel destroyed that had it.
+ * 
+ * @param	index The index of the ring.
+ */
+void	History::release(size_t const index)
+{
+	this->unlink(index);
+	this->_rings[index].owner = NULL;
+	this->_free.push_back(index);
+}
+
+/**
+ * @brief	Take a ring out of the list of the rings by last message.
+ * 
+ * @param	index The index of the ring.
+ */
+void	History::unlink(size_t const index)
+{
+	t_ring	&state = this->_rings[index];
+
+	if (state.older != NONE)
+		this->_rings[state.older].newer = state.newer;
+	else
+		this->_oldest = state.newer;
+	if (state.newer != NONE)
+		this->_rings[state.newer].older = state.older;
+	else
+		this->_newest = state.older;
+	state.older = NONE;
+	state.newer = NONE;
+}
+
+/**
+ * @brief	Put a ring at the end of the list of the rings by last message,
+ * 			as the one that got a message the most recently.
+ * 
+ * @param	index The index of the ring.
+ */
+void	History::pushNewest(size_t const index)
+{
+	t_ring	&state = this->_rings[index];
+
+	state.older = this->_newest;
+	state.newer = NONE;
+	if (this->_newest != NONE)
+		this->_rings[this->_newest].newer = index;
+	else
+		this->_oldest = index;
+	this->_newest = index;
+}
+
+/**
+ * @brief	Find the first message of a ring past a msgid or a time.
+ * 
+ * @param	state The ring.
+ * @param	byTime Whether the key is a time (in milliseconds) or a msgid.
+ * @param	key The msgid or the time.
+ * @param	isStrict Whether the message is past the key if it is the key
+ * 			itself.
+ * 
+ * @return	The position of the message among the ones of the ring,
+ * 			or the number of messages if none is past the key.
+ */
+size_t	History::bound(t_ring const &state, bool const byTime, uint64_t const key, bool const isStrict) const
+{
+	t_entry const	*entry;
+	uint64_t		value;
+	size_t			pos;
+	size_t			idx;
+
+	for (idx = 0UL, pos = state.head ; idx < state.count ; ++idx)
+	{
+		entry = this->at(state, pos);
+		value = byTime ? entry->time : entry->msgid;
+		if (value > key || (!isStrict && value == key))
+			return idx;
+		pos += entry->length;
+		if (pos == state.end)
+			pos = 0UL;
+	}
+	return state.count;
+}
+
+/**
+ * @brief	Get the message at some offset of a ring.
+ * 
+ * @param	state The ring.
+ * @param	pos The offset of the message, in bytes.
+ * 
+ * @return	The message.
+ */
+History::t_entry const	*History::at(t_ring const &state, size_t const pos) const
+{
+	return reinterpret_cast<t_entry const *>(this->_memory + (&state - &this->_rings[0]) * this->_ringSize + pos);
+}
+
+/**
+ * @brief	Get a message of a ring, counting from its oldest one.
+ * 
+ * @param	state The ring.
+ * @param	pos The offset of the oldest message, in bytes.
+ * @param	nb The number of messages to skip.
+ * 
+ * @return	The message.
+ */
+History::t_entry const	*History::skip(t_ring const &state, size_t pos, size_t nb) const
+{
+	for ( ; nb ; --nb)
+	{
+		pos += this->at(state, pos)->length;
+		if (pos == state.end)
+			pos = 0UL;
+	}
+	return this->at(state, pos);
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Store a message in the history of a channel, overwriting its
+ * 			oldest messages if its ring is full. A channel without history
+ * 			gets a ring first.
+ * 			A message longer than HISTORY_LINE_LENGTH is cut.
+ * 
+ * @param	ring The history of the channel.
+ * @param	msgid The msgid of the message, see newMsgid().
+ * @param	time The time of the message, in milliseconds.
+ * @param	line The message, as sent to the members of the channel.
+ * @param	size The size of the message.
+ */
+void	History::append(Ring &ring, uint64_t const msgid, uint64_t const time, char const *const line, size_t const size)
+{
+	size_t const	kept = size < HISTORY_LINE_LENGTH ? size : HISTORY_LINE_LENGTH;
+	size_t const	length = ALIGN(sizeof(t_entry) + kept);
+	t_entry			*entry;
+
+	if (msgid >= this->_nextMsgid)
+		this->_nextMsgid = msgid + 1UL;
+	if (!this->_memory)
+		return ;
+	if (ring._pool != this)
+		this->acquire(ring);
+	else if (ring._index != this->_newest)
+	{
+		this->unlink(ring._index);
+		this->pushNewest(ring._index);
+	}
+
+	t_ring	&state = this->_rings[ring._index];
+
+	// Make room at the tail, wrapping to the start of the ring if the end
+	// is too short, and dropping the oldest messages in the way.
+	for (;;)
+	{
+		if (!state.count)
+		{
+			state.head = 0UL;
+			state.tail = 0UL;
+			state.end = this->_ringSize;
+		}
+		if (!state.count || state.head < state.tail)
+		{
+			if (length <= this->_ringSize - state.tail)
+				break ;
+			state.end = state.tail;
+			state.tail = 0UL;
+		}
+		else if (length <= state.head - state.tail)
+			break ;
+		else
+		{
+			state.head += this->at(state, state.head)->length;
+			--state.count;
+			if (state.head == state.end)
+			{
+				state.head = 0UL;
+				state.end = this->_ringSize;
+			}
+		}
+	}
+	entry = const_cast<t_entry *>(this->at(state, state.tail));
+	entry->msgid = msgid;
+	entry->time = time;
+	entry->size = static_cast<uint32_t>(kept);
+	entry->length = static_cast<uint32_t>(length);
+	std::memcpy(entry + 1, line, kept);
+	state.tail += length;
+	++state.count;
+}
+
+/**
+ * @brief	Allocate the rings of the history, dropping the previous ones.
+ * 			The history is disabled if the memory cannot hold a single ring.
+ * 
+ * @param	memory The most bytes all the rings take.
+ * @param	ringSize The bytes of a ring, rounded up so that the longest
+ * 			message fits.
+ * @param	firstMsgid The msgid of the first message.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	History::init(size_t const memory, size_t const ringSize, uint64_t const firstMsgid)
+{
+	size_t const	smallest = ALIGN(sizeof(t_entry) + HISTORY_LINE_LENGTH);
+	size_t			nb;
+	size_t			idx;
+
+	this->stop();
+	this->_ringSize = ringSize < smallest ? smallest : ALIGN(ringSize);
+	if (firstMsgid > this->_nextMsgid)
+		this->_nextMsgid = firstMsgid;
+	nb = memory / this->_ringSize;
+	if (!nb)
+		return true;
+	try
+	{
+		this->_rings.resize(nb);
+		this->_free.reserve(nb);
+		// Untouched, the memory of the rings is not taken from the system yet.
+		this->_memory = new char[nb * this->_ringSize];
+	}
+	catch (std::bad_alloc const &)
+	{
+		this->stop();
+		return false;
+	}
+	for (idx = nb ; idx ; --idx)
+	{
+		this->_rings[idx - 1].owner = NULL;
+		this->_rings[idx - 1].older = NONE;
+		this->_rings[idx - 1].newer = NONE;
+		this->_free.push_back(idx - 1);
+	}
+	return true;
+}
+
+/**
+ * @brief	Drop every ring, the channels having them losing their history.
+ */
+void	History::stop(void)
+{
+	std::vector<t_ring>::iterator	it;
+
+	for (it = this->_rings.begin() ; it != this->_rings.end() ; ++it)
+		if (it->owner)
+			it->owner->_pool = NULL;
+	delete[] this->_memory;
+	this->_memory = NULL;
+	std::vector<t_ring>().swap(this->_rings);
+	std::vector<size_t>().swap(this->_free);
+	this->_newest = NONE;
+	this->_oldest = NONE;
+}
+
+/**
+ * @brief	Select messages of the history of a channel, oldest first:
+ * 			- LATEST the most recent ones past the key,
+ * 			- BEFORE the most recent ones before the key,
+ * 			- AFTER the oldest ones past the key.
+ * 			The next ones are got by next().
+ * 
+ * @param	ring The history of the channel.
+ * @param	way Which messages to select.
+ * @param	byTime Whether the key is a time (in milliseconds) or a msgid.
+ * @param	key The msgid or the time, 0 selecting every message.
+ * @param	limit The most messages to select.
+ * @param	first Where to put the first message selected.
+ * 
+ * @return	The number of messages selected.
+ */
+size_t	History::select(Ring const &ring, e_select const way, bool const byTime, uint64_t const key, size_t const limit, t_entry const *&first) const
+{
+	size_t	start;
+	size_t	end;
+
+	first = NULL;
+	if (ring._pool != this)
+		return 0UL;
+
+	t_ring const	&state = this->_rings[ring._index];
+
+	if (way == BEFORE)
+	{
+		end = this->bound(state, byTime, key, false);
+		start = end > limit ? end - limit : 0UL;
+	}
+	else
+	{
+		start = this->bound(state, byTime, key, true);
+		end = state.count - start > limit ? start + limit : state.count;
+		if (way == LATEST && end < state.count)
+		{
+			start += state.count - end;
+			end = state.count;
+		}
+	}
+	if (start < end)
+		first = this->skip(state, state.head, start);
+	return end - start;
+}
+
+/**
+ * @brief	Get the message following another one in the history of
+ * 			a channel, see select().
+ * 
+ * @param	ring The history of the channel.
+ * @param	entry A message of the history, but its last one.
+ * 
+ * @return	The next message.
+ */
+History::t_entry const	*History::next(Ring const &ring, t_entry const *const entry) const
+{
+	t_ring const	&state = this->_rings[ring._index];
+	size_t			pos;
+
+	pos = static_cast<size_t>(reinterpret_cast<char const *>(entry) - reinterpret_cast<char const *>(this->at(state, 0UL))) + entry->length;
+	if (pos == state.end)
+		pos = 0UL;
+	return this->at(state, pos);
+}
+
+/**
+ * @brief	Get the msgid of a new message.
+ * 
+ * @return	The msgid, greater than every one got or stored before.
+ */
+uint64_t	History::newMsgid(void)
+{
+	return this->_nextMsgid++;
+}
+
+/**
+ * @brief	Get how much of the memory of the history the channels took.
+ * 
+ * @return	The number of bytes of the rings taken.
+ */
+size_t	History::used(void) const
+{
+	return (this->_rings.size() - this->_free.size()) * this->_ringSize;
+}
+
+/**
+ * @brief	Get the text of a message of the history.
+ * 
+ * @param	entry The message.
+ * 
+ * @return	Its `entry->size` bytes.
+ */
+char const	*History::getLine(t_entry const *const entry)
+{
+	return reinterpret_cast<char const *>(entry + 1);
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+size_t const	&History::getRingSize(void) const
+{
+	return this->_ringSize;
+}
+
+unsigned long const	&History::getEvictions(void) const
+{
+	return this->_evictions;
+}
@@ -0,0 +1,333 @@
+#include "class/Identifier.hpp"
+
+#define FNV_OFFSET_BASIS	14695981039346656037UL
+#define FNV_PRIME			1099511628211UL
+
+#define INITIAL_BUCKETS		64
+
+/**
+ * Casefold a character following the rfc1459 casemapping,
+ * where [\]^ are the uppercase of {|}~.
+ */
+#define FOLD(c)	((c) >= 'A' && (c) <= '^' ? static_cast<char>((c) + 'a' - 'A') : (c))
+
+// ************************************************************************** //
+//                             Private Attributes                             //
+// ************************************************************************** //
+
+/**
+ * The interned names, chained by hash of their casefolded form.
+ * The number of buckets is a power of 2, doubled when it gets lower
+ * than the number of names.
+ */
+std::vector<Identifier::t_entry *>	Identifier::_buckets(INITIAL_BUCKETS, static_cast<Identifier::t_entry *>(NULL));
+
+size_t								Identifier::_size = 0UL;
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+Identifier::Identifier(t_entry *const entry) :
+	_entry(entry),
+	_hash(entry ? entry->hash : 0UL)
+{
+	if (this->_entry)
+		++this->_entry->refs;
+}
+
+Identifier::Identifier(void) :
+	_entry(NULL),
+	_hash(0UL) {}
+
+/**
+ * @brief	Intern a name, or share it if an equal one (casefolded) is
+ * 			already interned, keeping the spelling it was first interned with.
+ * 
+ * @param	name The name to intern.
+ */
+Identifier::Identifier(std::string const &name) :
+	_entry(NULL),
+	_hash(Identifier::hash(name.data(), name.size()))
+{
+	t_entry					**slot = Identifier::lookup(name.data(), name.size(), this->_hash);
+	std::vector<t_entry *>	buckets;
+	t_entry					*entry;
+	t_entry					*next;
+	size_t					idx;
+
+	if (*slot)
+	{
+		this->_entry = *slot;
+		++this->_entry->refs;
+		return ;
+	}
+	this->_entry = new t_entry;
+	this->_entry->next = NULL;
+	this->_entry->hash = this->_hash;
+	this->_entry->refs = 1UL;
+	this->_entry->name = name;
+	*slot = this->_entry;
+	if (++Identifier::_size <= Identifier::_buckets.size())
+		return ;
+
+	buckets.resize(Identifier::_buckets.size() * 2, NULL);
+	for (idx = 0UL ; idx < Identifier::_buckets.size() ; ++idx)
+	{
+		for (entry = Identifier::_buckets[idx] ; entry ; entry = next)
+		{
+			next = entry->next;
+			entry->next = buckets[entry->hash & (buckets.size() - 1)];
+			buckets[entry->hash & (buckets.size() - 1)] = entry;
+		}
+	}
+	Identifier::_buckets.swap(buckets);
+}
+
+Identifier::Identifier(Identifier const &src) :
+	_entry(src._entry),
+	_hash(src._hash)
+{
+	if (this->_entry)
+		++this->_entry->refs;
+}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+Identifier::~Identifier(void)
+{
+	this->release();
+}
+
+// ************************************************************************* //
+//                                 Operators                                 //
+// ************************************************************************* //
+
+Identifier	&Identifier::operator=(Identifier const &rhs)
+{
+	if (rhs._entry)
+		++rhs._entry->refs;
+	this->release();
+	this->_entry = rhs._entry;
+	this->_hash = rhs._hash;
+	return *this;
+}
+
+bool	Identifier::operator==(Identifier const &rhs) const
+{
+	return this->_entry == rhs._entry;
+}
+
+bool	Identifier::operator!=(Identifier const &rhs) const
+{
+	return this->_entry != rhs._entry;
+}
+
+/**
+ * @brief	Order the names by hash, then casefolded for the ones sharing
+ * 			a hash, so the order does not depend on the addresses.
+ * 			The empty handle comes first.
+ */
+bool	Identifier::operator<(Identifier const &rhs) const
+{
+	if (this->_entry == rhs._entry)
+		return false;
+	if (!this->_entry || !rhs._entry)
+		return !this->_entry;
+	if (this->_hash != rhs._hash)
+		return this->_hash < rhs._hash;
+	return Identifier::compare(this->_entry->name, rhs._entry->name.data(), rhs._entry->name.size()) < 0;
+}
+
+// ************************************************************************* //
+//                          Private Member Functions                         //
+// ************************************************************************* //
+
+/**
+ * @brief	Drop the handle, forgetting the name if nothing refers to it any more.
+ */
+void	Identifier::release(void)
+{
+	t_entry	**slot;
+
+	if (!this->_entry)
+		return ;
+	if (!--this->_entry->refs)
+	{
+		slot = &Identifier::_buckets[this->_entry->hash & (Identifier::_buckets.size() - 1)];
+		while (*slot != this->_entry)
+			slot = &(*slot)->next;
+		*slot = this->_entry->next;
+		--Identifier::_size;
+		delete this->_entry;
+	}
+	this->_entry = NULL;
+	this->_hash = 0UL;
+}
+
+/**
+ * @brief	Compare two names casefolded.
+ * 
+ * @param	lhs The first name to compare.
+ * @param	rhs The second name to compare.
+ * @param	size The length of the second name.
+ * 
+ * @return	A negative value if lhs comes first, a positive one if rhs does,
+ * 			or 0 if they are equal.
+ */
+int	Identifier::compare(std::string const &lhs, char const *const rhs, size_t const size)
+{
+	size_t	idx;
+	char	l;
+	char	r;
+
+	for (idx = 0UL ; idx < lhs.size() && idx < size ; ++idx)
+	{
+		l = FOLD(lhs[idx]);
+		r = FOLD(rhs[idx]);
+		if (l != r)
+			return static_cast<unsigned char>(l) - static_cast<unsigned char>(r);
+	}
+	return (lhs.size() > size) - (lhs.size() < size);
+}
+
+/**
+ * @brief	Compute the FNV-1a hash of a name casefolded.
+ * 
+ * @param	name The name to hash.
+ * @param	size The length of the name.
+ * 
+ * @return	The hash of the name.
+ */
+unsigned long	Identifier::hash(char const *const name, size_t const size)
+{
+	unsigned long	hash;
+	size_t			idx;
+
+	for (hash = FNV_OFFSET_BASIS, idx = 0UL ; idx < size ; ++idx)
+		hash = (hash ^ static_cast<unsigned char>(FOLD(name[idx]))) * FNV_PRIME;
+	return hash;
+}
+
+/**
+ * @brief	Find where a name is, or would be, chained in the table.
+ * 
+ * @param	name The name to look for.
+ * @param	size The length of the name.
+ * @param	hash The hash of the name.
+ * 
+ * @return	The link to the entry of the name, pointing to NULL if there is none.
+ */
+Identifier::t_entry	**Identifier::lookup(char const *const name, size_t const size, unsigned long const hash)
+{
+	t_entry	**slot;
+
+	for (slot = &Identifier::_buckets[hash & (Identifier::_buckets.size() - 1)] ; *slot ; slot = &(*slot)->next)
+		if ((*slot)->hash == hash && !Identifier::compare((*slot)->name, name, size))
+			break ;
+	return slot;
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Check if the handle refers to no name.
+ * 
+ * @return	Either true if the handle is empty, or false if not.
+ */
+bool	Identifier::empty(void) const
+{
+	return !this->_entry;
+}
+
+/**
+ * @brief	Get a handle to an already interned name, without interning it.
+ * 			As a name that is not interned cannot be a key of any index,
+ * 			the empty handle returned then is found in none.
+ * 
+ * @param	name The name to look for.
+ * 
+ * @return	Either a handle to the interned name, or an empty handle.
+ */
+Identifier	Identifier::find(std::string const &name)
+{
+	return Identifier(*Identifier::lookup(name.data(), name.size(), Identifier::hash(name.data(), name.size())));
+}
+
+/**
+ * @brief	Get a handle to an already interned name, without interning it.
+ * 
+ * @param	name The name to look for.
+ * 
+ * @return	Either a handle to the interned name, or an empty handle.
+ */
+Identifier	Identifier::find(ArenaString const &name)
+{
+	return Identifier(*Identifier::lookup(name.data(), name.size(), Identifier::hash(name.data(), name.size())));
+}
+
+/**
+ * @brief	Casefold a name following the rfc1459 casemapping.
+ * 
+ * @param	name The name to casefold.
+ * 
+ * @return	The casefolded name.
+ */
+std::string	Identifier::fold(std::string const &name)
+{
+	std::string				folded(name);
+	std::string::iterator	it;
+
+	for (it = folded.begin() ; it != folded.end() ; ++it)
+		*it = FOLD(*it);
+	return folded;
+}
+
+/**
+ * @brief	Get the number of interned names.
+ * 
+ * @return	The number of interned names.
+ */
+size_t	Identifier::size(void)
+{
+	return Identifier::_size;
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+/**
+ * @brief	Get the spelling of the name, or an empty string for the empty handle.
+ */
+std::string const	&Identifier::getName(void) const
+{
+	static std::string const	none;
+
+	return this->_entry ? this->_entry->name : none;
+}
+
+unsigned long	Identifier::getHash(void) const
+{
+	return this->_hash;
+}
+
+// ************************************************************************* //
+//                                  Mutators                                 //
+// ************************************************************************* //
+
+/**
+ * @brief	Change the spelling of the name, for every handle to it.
+ * 			The new spelling is ignored if it is not the same name casefolded.
+ * 
+ * @param	name The new spelling of the name.
+ */
+void	Identifier::setName(std::string const &name)
+{
+	if (this->_entry && !Identifier::compare(this->_entry->name, name.data(), name.size()))
+		this->_entry->name = name;
+}
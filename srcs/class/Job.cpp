@@ -0,0 +1,29 @@
+#include "class/Job.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+Job::Job(User *const user, t_done const done) :
+	_user(user),
+	_done(done) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+Job::~Job(void) {}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+Job::t_done	Job::getDone(void) const
+{
+	return this->_done;
+}
+
+User	*Job::getUser(void) const
+{
+	return this->_user;
+}
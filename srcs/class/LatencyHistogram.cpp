@@ -0,0 +1,119 @@
+#include <algorithm>
+#include "class/LatencyHistogram.hpp"
+
+#define SUB_BUCKETS	(1UL << LATENCY_SUB_BUCKET_BITS)
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+LatencyHistogram::LatencyHistogram(void) :
+	_buckets((64 - LATENCY_SUB_BUCKET_BITS + 1) * SUB_BUCKETS, 0UL),
+	_count(0UL),
+	_max(0) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+LatencyHistogram::~LatencyHistogram(void) {}
+
+// ************************************************************************** //
+//                          Private Member Functions                          //
+// ************************************************************************** //
+
+/**
+ * @brief	Get the index of the bucket a value falls in.
+ * 			Values below SUB_BUCKETS have a bucket each, the other ones
+ * 			are indexed by their magnitude, then by their next most
+ * 			significant bits.
+ * 
+ * @param	value The value to get the bucket of.
+ * 
+ * @return	The index of the bucket.
+ */
+size_t	LatencyHistogram::bucketOf(uint64_t const value)
+{
+	unsigned int	shift;
+
+	if (value < SUB_BUCKETS)
+		return static_cast<size_t>(value);
+	shift = static_cast<unsigned int>(63 - __builtin_clzl(value)) - LATENCY_SUB_BUCKET_BITS;
+	return (shift + 1) * SUB_BUCKETS + static_cast<size_t>(value >> shift) - SUB_BUCKETS;
+}
+
+/**
+ * @brief	Get the highest value a bucket can hold.
+ * 
+ * @param	bucket The index of the bucket.
+ * 
+ * @return	The highest value of the bucket.
+ */
+uint64_t	LatencyHistogram::highestOf(size_t const bucket)
+{
+	size_t	shift;
+
+	if (bucket < SUB_BUCKETS)
+		return bucket;
+	shift = bucket / SUB_BUCKETS - 1;
+	return ((static_cast<uint64_t>(bucket % SUB_BUCKETS + SUB_BUCKETS + 1)) << shift) - 1;
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Record a value.
+ * 
+ * @param	value The value to record.
+ */
+void	LatencyHistogram::record(uint64_t const value)
+{
+	++this->_buckets[LatencyHistogram::bucketOf(value)];
+	++this->_count;
+	if (value > this->_max)
+		this->_max = value;
+}
+
+/**
+ * @brief	Get the value under which the given ratio of the recorded values are.
+ * 
+ * @param	p The ratio, between 0 and 1.
+ * 
+ * @return	The highest value of the bucket the percentile falls in,
+ * 			capped by the highest recorded value.
+ */
+uint64_t	LatencyHistogram::percentile(double const p) const
+{
+	unsigned long	rank;
+	unsigned long	cumulated;
+	size_t			idx;
+
+	if (!this->_count)
+		return 0;
+	rank = static_cast<unsigned long>(p * static_cast<double>(this->_count) + 0.5);
+	if (!rank)
+		rank = 1;
+	for (idx = 0, cumulated = 0 ; idx < this->_buckets.size() ; ++idx)
+	{
+		cumulated += this->_buckets[idx];
+		if (cumulated >= rank)
+			break ;
+	}
+	return std::min(LatencyHistogram::highestOf(idx), this->_max);
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+unsigned long const	&LatencyHistogram::getCount(void) const
+{
+	return this->_count;
+}
+
+uint64_t const	&LatencyHistogram::getMax(void) const
+{
+	return this->_max;
+}
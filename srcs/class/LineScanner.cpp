@@ -0,0 +1,239 @@
+#include "class/LineScanner.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+# define LINESCANNER_X86
+#endif
+
+// ************************************************************************** //
+//                             Private Attributes                             //
+// ************************************************************************** //
+
+LineScanner::t_scan const	LineScanner::_scan = LineScanner::select();
+char const *const			LineScanner::_name = LineScanner::selectName();
+
+// ************************************************************************* //
+//                          Private Member Functions                         //
+// ************************************************************************* //
+
+/**
+ * @brief	Decode some bytes one by one, adding the lines ending among them.
+ * 
+ * @param	data The buffer.
+ * @param	from The offset of the first byte to decode.
+ * @param	to The offset after the last byte to decode.
+ * @param	state Where the decoder is, carried over from the previous bytes.
+ * @param	lines Where to add the lines.
+ */
+void	LineScanner::scanBytes(char const *const data, size_t const from, size_t const to, t_state &state, t_lines &lines)
+{
+	t_line			line;
+	unsigned char	c;
+	size_t			idx;
+
+	for (idx = from ; idx < to ; ++idx)
+	{
+		c = static_cast<unsigned char>(data[idx]);
+		if (state.pending)
+		{
+			if (c >= state.lo && c <= state.hi)
+			{
+				--state.pending;
+				state.lo = 0x80;
+				state.hi = 0xBF;
+				continue ;
+			}
+			// The character is cut short, the byte starting a new one.
+			state.isUtf8 = false;
+			state.pending = 0;
+			state.lo = 0x80;
+			state.hi = 0xBF;
+		}
+		if (c == '\n')
+		{
+			line.end = idx;
+			line.isUtf8 = state.isUtf8;
+			lines.push_back(line);
+			state.isUtf8 = true;
+		}
+		else if (c < 0x80)
+			continue ;
+		else if (c >= 0xC2 && c <= 0xDF)
+			state.pending = 1;
+		else if (c >= 0xE0 && c <= 0xEF)
+		{
+			state.pending = 2;
+			// No overlong form, nor UTF-16 surrogate.
+			if (c == 0xE0)
+				state.lo = 0xA0;
+			else if (c == 0xED)
+				state.hi = 0x9F;
+		}
+		else if (c >= 0xF0 && c <= 0xF4)
+		{
+			state.pending = 3;
+			// No overlong form, nor code point above U+10FFFF.
+			if (c == 0xF0)
+				state.lo = 0x90;
+			else if (c == 0xF4)
+				state.hi = 0x8F;
+		}
+		else
+			state.isUtf8 = false;
+	}
+}
+
+/**
+ * @brief	Choose the fastest scan the CPU supports.
+ */
+LineScanner::t_scan	LineScanner::select(void)
+{
+	if (LineScanner::hasAvx2())
+		return &LineScanner::scanAvx2;
+	if (LineScanner::hasSse2())
+		return &LineScanner::scanSse2;
+	return &LineScanner::scanScalar;
+}
+
+char const	*LineScanner::selectName(void)
+{
+	if (LineScanner::hasAvx2())
+		return "avx2";
+	if (LineScanner::hasSse2())
+		return "sse2";
+	return "scalar";
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Find every complete line of a buffer, with the fastest scan
+ * 			the CPU supports.
+ * 
+ * @param	data The buffer, starting at the beginning of a line.
+ * @param	size The length of the buffer.
+ * @param	lines Where to add the lines: the offset of their '\n',
+ * 			and whether they are valid UTF-8.
+ */
+void	LineScanner::scan(char const *const data, size_t const size, t_lines &lines)
+{
+	LineScanner::_scan(data, size, lines);
+}
+
+void	LineScanner::scanScalar(char const *const data, size_t const size, t_lines &lines)
+{
+	t_state	state = {0, 0x80, 0xBF, true};
+
+	LineScanner::scanBytes(data, 0, size, state, lines);
+}
+
+#ifdef LINESCANNER_X86
+
+void	LineScanner::scanSse2(char const *const data, size_t const size, t_lines &lines)
+{
+	__m128i const	newline = _mm_set1_epi8('\n');
+	__m128i			block;
+	t_state			state = {0, 0x80, 0xBF, true};
+	t_line			line;
+	unsigned int	newlines;
+	size_t			idx;
+
+	for (idx = 0 ; idx + 16 <= size ; idx += 16)
+	{
+		block = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + idx));
+		// Bytes above 0x7F, or a character started in the previous block.
+		if (state.pending || _mm_movemask_epi8(block))
+		{
+			LineScanner::scanBytes(data, idx, idx + 16, state, lines);
+			continue ;
+		}
+		for (newlines = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline))) ; newlines ; newlines &= newlines - 1)
+		{
+			line.end = idx + static_cast<size_t>(__builtin_ctz(newlines));
+			line.isUtf8 = state.isUtf8;
+			lines.push_back(line);
+			state.isUtf8 = true;
+		}
+	}
+	LineScanner::scanBytes(data, idx, size, state, lines);
+}
+
+__attribute__((target("avx2")))
+void	LineScanner::scanAvx2(char const *const data, size_t const size, t_lines &lines)
+{
+	__m256i const	newline = _mm256_set1_epi8('\n');
+	__m256i			block;
+	t_state			state = {0, 0x80, 0xBF, true};
+	t_line			line;
+	unsigned int	newlines;
+	size_t			idx;
+
+	for (idx = 0 ; idx + 32 <= size ; idx += 32)
+	{
+		block = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data + idx));
+		// Bytes above 0x7F, or a character started in the previous block.
+		if (state.pending || _mm256_movemask_epi8(block))
+		{
+			LineScanner::scanBytes(data, idx, idx + 32, state, lines);
+			continue ;
+		}
+		for (newlines = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline))) ; newlines ; newlines &= newlines - 1)
+		{
+			line.end = idx + static_cast<size_t>(__builtin_ctz(newlines));
+			line.isUtf8 = state.isUtf8;
+			lines.push_back(line);
+			state.isUtf8 = true;
+		}
+	}
+	LineScanner::scanBytes(data, idx, size, state, lines);
+}
+
+bool	LineScanner::hasSse2(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+}
+
+bool	LineScanner::hasAvx2(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+#else
+
+void	LineScanner::scanSse2(char const *const data, size_t const size, t_lines &lines)
+{
+	LineScanner::scanScalar(data, size, lines);
+}
+
+void	LineScanner::scanAvx2(char const *const data, size_t const size, t_lines &lines)
+{
+	LineScanner::scanScalar(data, size, lines);
+}
+
+bool	LineScanner::hasSse2(void)
+{
+	return false;
+}
+
+bool	LineScanner::hasAvx2(void)
+{
+	return false;
+}
+
+#endif
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+/**
+ * @brief	Get the name of the scan in use: avx2, sse2 or scalar.
+ */
+char const	*LineScanner::getName(void)
+{
+	return LineScanner::_name;
+}
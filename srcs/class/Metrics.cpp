@@ -0,0 +1,256 @@
+#include <time.h>
+#include <sstream>
+#include "class/Metrics.hpp"
+
+// Upper bounds of the histogram buckets, terminated by a 0.
+double const	Metrics::secondsBounds[] = {
+	0.00001, 0.00005, 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0, 0.0
+};
+
+double const	Metrics::bytesBounds[] = {
+	64.0, 256.0, 1024.0, 4096.0, 16384.0, 65536.0, 262144.0, 1048576.0, 0.0
+};
+
+char const *const	Metrics::_arrayTypeNames[] = {
+	"counter",
+	"gauge",
+	"histogram"
+};
+
+inline static std::string	__toString(double const nb)
+{
+	std::ostringstream	oss;
+
+	oss.precision(12);
+	oss << nb;
+	return oss.str();
+}
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+Metrics::Metrics(void) :
+	_families(),
+	_lookupFamilies(),
+	_counters(),
+	_gauges(),
+	_histograms() {}
+
+Metrics::Histogram::Histogram(double const *const bounds) :
+	_bounds(bounds),
+	_buckets(),
+	_sum(0.0),
+	_count(0UL)
+{
+	size_t	idx;
+
+	for (idx = 0 ; bounds[idx] ; ++idx);
+	this->_buckets.resize(idx + 1, 0UL);
+}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+Metrics::~Metrics(void) {}
+
+// ************************************************************************** //
+//                          Private Member Functions                          //
+// ************************************************************************** //
+
+/**
+ * @brief	Get the family of the given metric name, creating it if needed.
+ */
+Metrics::t_family	&Metrics::family(std::string const &name, std::string const &help, int const type)
+{
+	std::map<std::string, size_t>::const_iterator	cit;
+	t_family										newFamily;
+
+	cit = this->_lookupFamilies.find(name);
+	if (cit != this->_lookupFamilies.end())
+		return this->_families[cit->second];
+	newFamily.name = name;
+	newFamily.help = help;
+	newFamily.type = type;
+	this->_lookupFamilies.insert(std::make_pair(name, this->_families.size()));
+	this->_families.push_back(newFamily);
+	return this->_families.back();
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Register a new counter.
+ * 
+ * @param	name The name of the metric.
+ * @param	help The description of the metric.
+ * @param	labels The labels of this series, such as `command="JOIN"`.
+ * 
+ * @return	The value to increment.
+ */
+unsigned long	*Metrics::addCounter(std::string const &name, std::string const &help, std::string const &labels)
+{
+	t_series	series;
+
+	this->_counters.push_back(0UL);
+	series.labels = labels;
+	series.counter = &this->_counters.back();
+	series.gauge = NULL;
+	series.histogram = NULL;
+	this->family(name, help, COUNTER).series.push_back(series);
+	return series.counter;
+}
+
+/**
+ * @brief	Register a new gauge.
+ * 
+ * @param	name The name of the metric.
+ * @param	help The description of the metric.
+ * @param	labels The labels of this series.
+ * 
+ * @return	The value to set.
+ */
+long	*Metrics::addGauge(std::string const &name, std::string const &help, std::string const &labels)
+{
+	t_series	series;
+
+	this->_gauges.push_back(0L);
+	series.labels = labels;
+	series.counter = NULL;
+	series.gauge = &this->_gauges.back();
+	series.histogram = NULL;
+	this->family(name, help, GAUGE).series.push_back(series);
+	return series.gauge;
+}
+
+/**
+ * @brief	Register a new histogram.
+ * 
+ * @param	name The name of the metric.
+ * @param	help The description of the metric.
+ * @param	bounds The upper bounds of the buckets, terminated by a 0.
+ * @param	labels The labels of this series.
+ * 
+ * @return	The histogram to observe values with.
+ */
+Metrics::Histogram	*Metrics::addHistogram(std::string const &name, std::string const &help, double const *const bounds, std::string const &labels)
+{
+	t_series	series;
+
+	this->_histograms.push_back(Histogram(bounds));
+	series.labels = labels;
+	series.counter = NULL;
+	series.gauge = NULL;
+	series.histogram = &this->_histograms.back();
+	this->family(name, help, HISTOGRAM).series.push_back(series);
+	return series.histogram;
+}
+
+/**
+ * @brief	Render every metric in the Prometheus text exposition format.
+ * 
+ * @return	The rendered metrics.
+ */
+std::string	Metrics::render(void) const
+{
+	std::string								out;
+	std::vector<t_family>::const_iterator	family;
+	std::vector<t_series>::const_iterator	series;
+	std::ostringstream						oss;
+
+	for (family = this->_families.begin() ; family != this->_families.end() ; ++family)
+	{
+		out += "# HELP " + family->name + ' ' + family->help + '\n';
+		out += "# TYPE " + family->name + ' ' + Metrics::_arrayTypeNames[family->type] + '\n';
+		for (series = family->series.begin() ; series != family->series.end() ; ++series)
+		{
+			if (series->histogram)
+			{
+				series->histogram->render(out, family->name, series->labels);
+				continue ;
+			}
+			oss.str("");
+			if (series->counter)
+				oss << *series->counter;
+			else
+				oss << *series->gauge;
+			out += family->name;
+			if (!series->labels.empty())
+				out += '{' + series->labels + '}';
+			out += ' ' + oss.str() + '\n';
+		}
+	}
+	return out;
+}
+
+/**
+ * @brief	Get the time of a monotonic clock, to measure durations.
+ * 
+ * @return	The time in seconds.
+ */
+double	Metrics::now(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief	Get the time of a monotonic clock, to time short operations.
+ * 
+ * @return	The time in nanoseconds.
+ */
+uint64_t	Metrics::nanoseconds(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000UL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/**
+ * @brief	Count a value in the first bucket it fits in.
+ * 
+ * @param	value The value to observe.
+ */
+void	Metrics::Histogram::observe(double const value)
+{
+	size_t	idx;
+
+	for (idx = 0 ; this->_bounds[idx] && value > this->_bounds[idx] ; ++idx);
+	++this->_buckets[idx];
+	this->_sum += value;
+	++this->_count;
+}
+
+/**
+ * @brief	Render the cumulative buckets, the sum and the count of the histogram.
+ * 
+ * @param	out The string to append the rendering to.
+ * @param	name The name of the metric.
+ * @param	labels The labels of the series.
+ */
+void	Metrics::Histogram::render(std::string &out, std::string const &name, std::string const &labels) const
+{
+	std::string const	prefix = labels.empty() ? "" : labels + ',';
+	std::string const	suffix = labels.empty() ? "" : '{' + labels + '}';
+	std::ostringstream	oss;
+	unsigned long		cumulated;
+	size_t				idx;
+
+	for (idx = 0, cumulated = 0 ; idx < this->_buckets.size() ; ++idx)
+	{
+		cumulated += this->_buckets[idx];
+		oss.str("");
+		oss << cumulated;
+		out += name + "_bucket{" + prefix + "le=\"" + (this->_bounds[idx] ? __toString(this->_bounds[idx]) : "+Inf") + "\"} " + oss.str() + '\n';
+	}
+	oss.str("");
+	oss << this->_count;
+	out += name + "_sum" + suffix + ' ' + __toString(this->_sum) + '\n';
+	out += name + "_count" + suffix + ' ' + oss.str() + '\n';
+}
@@ -0,0 +1,81 @@
+#include <cstring>
+#include "class/NumericArg.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+NumericArg::NumericArg(std::string const &str) :
+	_data(str.data()),
+	_size(str.size()),
+	_buff() {}
+
+NumericArg::NumericArg(ArenaString const &str) :
+	_data(str.data()),
+	_size(str.size()),
+	_buff() {}
+
+NumericArg::NumericArg(char const *const str) :
+	_data(str),
+	_size(strlen(str)),
+	_buff() {}
+
+NumericArg::NumericArg(char const c) :
+	_data(this->_buff),
+	_size(1UL),
+	_buff()
+{
+	this->_buff[0] = c;
+}
+
+NumericArg::NumericArg(unsigned long nb) :
+	_data(NULL),
+	_size(0UL),
+	_buff()
+{
+	char	*ptr = this->_buff + sizeof(this->_buff);
+
+	do
+	{
+		*--ptr = static_cast<char>('0' + nb % 10);
+		nb /= 10;
+	}
+	while (nb);
+	this->_data = ptr;
+	this->_size = static_cast<size_t>(this->_buff + sizeof(this->_buff) - ptr);
+}
+
+/**
+ * A parameter written in itself is written in the copy too.
+ */
+NumericArg::NumericArg(NumericArg const &src) :
+	_data(src._data),
+	_size(src._size),
+	_buff()
+{
+	if (src._data >= src._buff && src._data < src._buff + sizeof(src._buff))
+	{
+		memcpy(this->_buff, src._buff, sizeof(this->_buff));
+		this->_data = this->_buff + (src._data - src._buff);
+	}
+}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+NumericArg::~NumericArg(void) {}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+char const	*NumericArg::getData(void) const
+{
+	return this->_data;
+}
+
+size_t	NumericArg::getSize(void) const
+{
+	return this->_size;
+}
@@ -0,0 +1,51 @@
+#include <fstream>
+#include "class/ReadFileJob.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+ReadFileJob::ReadFileJob(User *const user, t_done const done, std::string const &path) :
+	Job(user, done),
+	_path(path),
+	_lines(),
+	_isOpen(false) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+ReadFileJob::~ReadFileJob(void) {}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Read the whole file, line by line.
+ * 			Run on a worker thread.
+ */
+void	ReadFileJob::execute(void)
+{
+	std::ifstream	infile;
+	std::string		line;
+
+	infile.open(this->_path.c_str());
+	this->_isOpen = infile.is_open();
+	while (infile.good() && std::getline(infile, line))
+		this->_lines.push_back(line);
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+bool const	&ReadFileJob::getIsOpen(void) const
+{
+	return this->_isOpen;
+}
+
+std::vector<std::string> const	&ReadFileJob::getLines(void) const
+{
+	return this->_lines;
+}
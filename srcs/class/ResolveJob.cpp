@@ -0,0 +1,88 @@
+#include <cstring>
+#include <netdb.h>
+#include <sys/socket.h>
+#include "class/ResolveJob.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+ResolveJob::ResolveJob(t_done const done, in_addr const &addr) :
+	Job(NULL, done),
+	_addr(addr),
+	_hostname() {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+ResolveJob::~ResolveJob(void) {}
+
+// ************************************************************************** //
+//                          Private Member Functions                          //
+// ************************************************************************** //
+
+/**
+ * @brief	Check that the resolved hostname is a valid one,
+ * 			and that it resolves back to the address it comes from.
+ * 
+ * @return	Either true if the hostname can be trusted, or false if not.
+ */
+bool	ResolveJob::confirm(void) const
+{
+	addrinfo			hints;
+	addrinfo			*res;
+	addrinfo const		*cur;
+	bool				ret;
+
+	if (this->_hostname.size() > 63 ||
+		this->_hostname.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.-") != std::string::npos)
+		return false;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	if (getaddrinfo(this->_hostname.c_str(), NULL, &hints, &res))
+		return false;
+	for (ret = false, cur = res ; !ret && cur ; cur = cur->ai_next)
+		ret = reinterpret_cast<sockaddr_in const *>(cur->ai_addr)->sin_addr.s_addr == this->_addr.s_addr;
+	freeaddrinfo(res);
+	return ret;
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Reverse-resolve the address, keeping the hostname only if it
+ * 			resolves back to the same address.
+ * 			Run on a worker thread.
+ */
+void	ResolveJob::execute(void)
+{
+	sockaddr_in	addr;
+	char		host[NI_MAXHOST];
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr = this->_addr;
+	if (getnameinfo(reinterpret_cast<sockaddr const *>(&addr), sizeof(addr), host, sizeof(host), NULL, 0, NI_NAMEREQD))
+		return ;
+	this->_hostname = host;
+	if (!this->confirm())
+		this->_hostname.clear();
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+in_addr const	&ResolveJob::getAddr(void) const
+{
+	return this->_addr;
+}
+
+std::string const	&ResolveJob::getHostname(void) const
+{
+	return this->_hostname;
+}
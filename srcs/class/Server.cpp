@@ -1,12 +1,15 @@
-#include <algorithm> // transform
+#include <algorithm> // min, transform
 #include <arpa/inet.h>
 #include <cerrno> // errno
+#include <climits> // PATH_MAX
 #include <cstring> // strerror()
 #include <sstream>
 #include <string>
 #include <netdb.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netinet/in.h>
+#include "class/ResolveJob.hpp"
 #include "class/Server.hpp"
 #include "ft.hpp"
 
@@ -15,11 +18,14 @@
 // ************************************************************************** //
 
 std::pair<std::string const, Server::t_fct const> const	Server::_arrayCmds[] = {
+	std::pair<std::string const, Server::t_fct const>(std::string("CAP"), &Server::CAP),
+	std::pair<std::string const, Server::t_fct const>(std::string("CHATHISTORY"), &Server::CHATHISTORY),
 	std::pair<std::string const, Server::t_fct const>(std::string("DIE"), &Server::DIE),
 	std::pair<std::string const, Server::t_fct const>(std::string("JOIN"), &Server::JOIN),
 	std::pair<std::string const, Server::t_fct const>(std::string("KICK"), &Server::KICK),
 	std::pair<std::string const, Server::t_fct const>(std::string("KILL"), &Server::KILL),
 	std::pair<std::string const, Server::t_fct const>(std::string("MODE"), &Server::MODE),
+	std::pair<std::string const, Server::t_fct const>(std::string("MONITOR"), &Server::MONITOR),
 	std::pair<std::string const, Server::t_fct const>(std::string("MOTD"), &Server::MOTD),
 	std::pair<std::string const, Server::t_fct const>(std::string("NICK"), &Server::NICK),
 	std::pair<std::string const, Server::t_fct const>(std::string("OPER"), &Server::OPER),
@@ -28,11 +34,35 @@ std::pair<std::string const, Server::t_fct const> const	Server::_arrayCmds[] = {
 	std::pair<std::string const, Server::t_fct const>(std::string("PING"), &Server::PING),
 	std::pair<std::string const, Server::t_fct const>(std::string("PRIVMSG"), &Server::PRIVMSG),
 	std::pair<std::string const, Server::t_fct const>(std::string("QUIT"), &Server::QUIT),
+	std::pair<std::string const, Server::t_fct const>(std::string("REHASH"), &Server::REHASH),
+	std::pair<std::string const, Server::t_fct const>(std::string("SERVER"), &Server::SERVER),
+	std::pair<std::string const, Server::t_fct const>(std::string("STATS"), &Server::STATS),
+	std::pair<std::string const, Server::t_fct const>(std::string("TOPIC"), &Server::TOPIC),
 	std::pair<std::string const, Server::t_fct const>(std::string("USER"), &Server::USER),
 	std::pair<std::string const, Server::t_fct const>(std::string("WHOIS"), &Server::WHOIS),
 	std::pair<std::string const, Server::t_fct const>(std::string(), NULL)
 };
 
+/**
+ * The commands a linked server sends, each with the server or the user
+ * it comes from.
+ */
+std::pair<std::string const, Server::t_linkFct const> const	Server::_arrayLinkCmds[] = {
+	std::pair<std::string const, Server::t_linkFct const>(std::string("ERROR"), &Server::linkERROR),
+	std::pair<std::string const, Server::t_linkFct const>(std::string("KICK"), &Server::linkKICK),
+	std::pair<std::string const, Server::t_linkFct const>(std::string("KILL"), &Server::linkKILL),
+	std::pair<std::string const, Server::t_linkFct const>(std::string("NICK"), &Server::linkNICK),
+	std::pair<std::string const, Server::t_linkFct const>(std::string("PART"), &Server::linkPART),
+	std::pair<std::string const, Server::t_linkFct const>(std::string("PING"), &Server::linkPING),
+	std::pair<std::string const, Server::t_linkFct const>(std::string("PONG"), &Server::linkPONG),
+	std::pair<std::string const, Server::t_linkFct const>(std::string("PRIVMSG"), &Server::linkPRIVMSG),
+	std::pair<std::string const, Server::t_linkFct const>(std::string("QUIT"), &Server::linkQUIT),
+	std::pair<std::string const, Server::t_linkFct const>(std::string("SERVER"), &Server::linkSERVER),
+	std::pair<std::string const, Server::t_linkFct const>(std::string("SJOIN"), &Server::linkSJOIN),
+	std::pair<std::string const, Server::t_linkFct const>(std::string("SQUIT"), &Server::linkSQUIT),
+	std::pair<std::string const, Server::t_linkFct const>(std::string(), NULL)
+};
+
 std::pair<uint const, char const *const> const	Server::_arrayLogMsgTypes[] = {
 	std::pair<uint const, char const *const>(ERROR, RED_FG " Errors " RESET),
 	std::pair<uint const, char const *const>(INTERNAL, WHITE_FG "Internal" RESET),
@@ -41,6 +71,31 @@ std::pair<uint const, char const *const> const	Server::_arrayLogMsgTypes[] = {
 	std::pair<uint const, char const *const>(0, NULL),
 };
 
+/**
+ * The only commands an user can run before being registered.
+ */
+char const *const	Server::_arrayRegistrationCmds[] = {
+	"CAP",
+	"NICK",
+	"PASS",
+	"PING",
+	"QUIT",
+	"SERVER",
+	"USER",
+	NULL
+};
+
+/**
+ * The commands taking several targets, with their limit, as in TARGMAX.
+ */
+std::pair<char const *const, size_t Server::t_limits::*const> const	Server::_arrayTargmax[] = {
+	std::pair<char const *const, size_t Server::t_limits::*const>("JOIN", &Server::t_limits::joinTargets),
+	std::pair<char const *const, size_t Server::t_limits::*const>("KICK", &Server::t_limits::kickTargets),
+	std::pair<char const *const, size_t Server::t_limits::*const>("PART", &Server::t_limits::partTargets),
+	std::pair<char const *const, size_t Server::t_limits::*const>("PRIVMSG", &Server::t_limits::privmsgTargets),
+	std::pair<char const *const, size_t Server::t_limits::*const>(NULL, NULL)
+};
+
 // ************************************************************************** //
 //                                Constructors                                //
 // ************************************************************************** //
@@ -48,12 +103,55 @@ std::pair<uint const, char const *const> const	Server::_arrayLogMsgTypes[] = {
 Server::Server(void) :
 	_state(STOPPED),
 	_socket(-1),
+	_metricsSocket(-1),
+	_systemClock(),
+	_clock(&this->_systemClock),
+	_tcpTransport(),
+	_transport(&this->_tcpTransport),
 	_config(),
+	_pool(),
+	_metrics(),
+	_stats(),
+	_currentCmdMetrics(NULL),
+	_isCmdError(false),
+	_watchdog(),
+	_slowTickLogTime(0),
+	_slowTicksNotLogged(0UL),
+	_capture(),
+	_spamFilter(),
+	_history(),
+	_configFile(),
+	_executable(),
 	_creationTime(),
+	_numericPrefix(),
+	_limits(),
+	_isupport(),
+	_jobsInFlight(0UL),
+	_upgradeDeadline(0),
+	_nextSnapshot(0),
+	_isSnapshotPending(false),
+	_isSnapshotStale(false),
 	_pollfds(),
+	_lookupPollfds(),
 	_users(),
+	_remoteUsers(),
+	_lookupCmds(),
+	_lookupLinkCmds(),
 	_lookupUsers(),
+	_lookupWatchers(),
+	_lookupSockets(),
 	_lookupChannels(),
+	_snapshotRecords(),
+	_lookupHostnames(),
+	_lookupResolving(),
+	_registrationTimers(),
+	_lookupRegistrationCmds(),
+	_lookupCmdMetrics(),
+	_metricsClients(),
+	_lookupLinks(),
+	_lookupServers(),
+	_lookupConnects(),
+	_lookupRemoteUsers(),
 	_banList() {}
 
 // ************************************************************************* //
@@ -66,6 +164,20 @@ Server::~Server(void) {}
 //                          Private Member Functions                          //
 // ************************************************************************** //
 
+/**
+ * @brief	Give a poll slot to a file descriptor.
+ * 
+ * @param	fd The file descriptor to poll.
+ * @param	events The events to poll for.
+ */
+void	Server::addPollfd(int const fd, short const events)
+{
+	this->_lookupPollfds[fd] = this->_pollfds.size();
+	this->_pollfds.push_back(pollfd());
+	this->_pollfds.back().fd = fd;
+	this->_pollfds.back().events = events;
+}
+
 /**
  * @brief	Add a user in the banlist.
  * 
@@ -78,232 +190,2036 @@ void	Server::addToBanList(User const &user)
 }
 
 /**
- * @brief Check the reponse of the client of the PING
+ * @brief	Count a new password attempt of an user against the rate limit.
+ * 
+ * @param	user The user attempting to authenticate.
+ * 
+ * @return	Either true if the user may try, or false if it reached the limit.
+ */
+bool	Server::allowAuthAttempt(User &user)
+{
+	user.newAuthAttempt(std::strtol(this->_config["auth_window"].c_str(), NULL, 10), this->_clock->now());
+	if (user.getAuthAttempts() > std::strtol(this->_config["auth_attempts"].c_str(), NULL, 10))
+	{
+		Server::logMsg(INTERNAL, "(" + ft::toString(user.getSocket()) + ") Too many password attempts");
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief	Run a job on the thread pool.
+ * 			The user the job belongs to, if any, is suspended until the job
+ * 			completes: its next lines stay buffered instead of being judged.
+ * 
+ * @param	job The job to run. The server takes its ownership.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::async(Job *const job)
+{
+	if (!this->_pool.push(job))
+	{
+		Server::logMsg(ERROR, "    ThreadPool: failed to push a job");
+		delete job;
+		return false;
+	}
+	++this->_jobsInFlight;
+	if (job->getUser())
+		job->getUser()->suspend();
+	return true;
+}
+
+/**
+ * @brief	Tell a newly linked server the state of the network, behind it
+ * 			excepted: the servers, nearest first for their uplink to be known,
+ * 			then the users, then the channels with their modes and members.
+ * 
+ * @param	link The connection to the newly linked server.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::burst(User &link)
+{
+	std::map<std::string const, t_server>::const_iterator		itServer;
+	std::list<User>::const_iterator								itUser;
+	std::map<Identifier const, Channel>::const_iterator		itChan;
+	std::map<Identifier const, User *const>::const_iterator	itMember;
+	ArenaString													head;
+	ArenaString													members;
+	unsigned int												memberModes;
+	unsigned int												hops;
+	bool														isFarther;
+
+	for (hops = 1U, isFarther = true ; isFarther ; ++hops)
+		for (isFarther = false, itServer = this->_lookupServers.begin() ; itServer != this->_lookupServers.end() ; ++itServer)
+		{
+			if (itServer->second.link == &link)
+				continue ;
+			isFarther |= itServer->second.hops > hops;
+			if (itServer->second.hops == hops &&
+				!this->replyPush(link, ArenaString(1, ':') + itServer->second.uplink + " SERVER " + itServer->first + ' ' + ft::toString(static_cast<int>(hops + 1)) + " :" + itServer->second.description))
+				return false;
+		}
+	for (itUser = this->_users.begin() ; itUser != this->_users.end() ; ++itUser)
+		if (itUser->getState() == User::REGISTERED && itUser->getSocket() != -1 &&
+			!this->replyPush(link, this->introduce(*itUser)))
+			return false;
+	for (itUser = this->_remoteUsers.begin() ; itUser != this->_remoteUsers.end() ; ++itUser)
+		if (itUser->getLink() != &link && !this->replyPush(link, this->introduce(*itUser)))
+			return false;
+	for (itChan = this->_lookupChannels.begin() ; itChan != this->_lookupChannels.end() ; ++itChan)
+	{
+		head = ArenaString(1, ':') + this->_config["server_name"] + " SJOIN " + ft::toString(static_cast<int>(itChan->second.getTimestamp())) + ' ' + itChan->second.getName() + ' ' + itChan->second.getModeString(true) + " :";
+		for (members.clear(), itMember = itChan->second.begin() ; itMember != itChan->second.end() ; ++itMember)
+		{
+			if (itMember->second->getLink() == &link)
+				continue ;
+			memberModes = itChan->second.getMemberModes(*itMember->second);
+			if (!members.empty())
+				members += ' ';
+			if (memberModes & Channel::CHANOP)
+				members += '@';
+			if (memberModes & Channel::VOICE)
+				members += '+';
+			members += itMember->second->getNickname();
+			// Big channels take several lines.
+			if (members.size() > MAX_LINE_LENGTH / 2)
+			{
+				if (!this->replyPush(link, head + members))
+					return false;
+				members.clear();
+			}
+		}
+		if (!members.empty() && !this->replyPush(link, head + members))
+			return false;
+	}
+	// Nothing to tell a server when this one knows only of itself.
+	if (link.getMsg().empty())
+		return true;
+	return this->replySend(link);
+}
+
+/**
+ * @brief	Register the connection a worker thread opened to a server to link,
+ * 			and start the handshake: the server has `register_timeout` seconds
+ * 			to answer it. A failed connection is tried again `link_retry`
+ * 			seconds later.
+ * 
+ * @param	job The completed ConnectJob.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::CONNECTdone(Job &job)
+{
+	ConnectJob const								&connect = static_cast<ConnectJob const &>(job);
+	std::string const								target = connect.getHost() + ':' + ft::toString(connect.getPort());
+	std::map<std::string const, t_connect>::iterator	it;
+	t_link											link;
+	time_t const									now = this->_clock->now();
+
+	it = this->_lookupConnects.find(target);
+	if (connect.getFd() == -1)
+	{
+		Server::logMsg(INTERNAL, "    Link to " + target + ": " + connect.getError());
+		if (it != this->_lookupConnects.end())
+		{
+			it->second.isPending = false;
+			it->second.nextAttempt = now + std::strtol(this->_config["link_retry"].c_str(), NULL, 10);
+		}
+		return true;
+	}
+	this->_users.push_back(User());
+	this->_users.back().setSocket(connect.getFd());
+	this->_users.back().setHostname(connect.getHost());
+	this->_users.back().updateLastActivity(now);
+	this->_users.back().setRegisterDeadline(now + std::strtol(this->_config["register_timeout"].c_str(), NULL, 10));
+	this->_lookupSockets.insert(std::pair<int const, User *const>(connect.getFd(), &this->_users.back()));
+	this->_registrationTimers.insert(std::pair<time_t const, int const>(this->_users.back().getRegisterDeadline(), connect.getFd()));
+	this->addPollfd(connect.getFd(), POLLIN | POLLOUT);
+	link.target = target;
+	link.isAuthenticated = false;
+	this->_lookupLinks.insert(std::make_pair(&this->_users.back(), link));
+	Server::logMsg(INTERNAL, "(" + ft::toString(connect.getFd()) + ") Connected to link " + target);
+	return this->linkHandshake(this->_users.back());
+}
+
+/**
+ * @brief	Store the hostname resolved by a worker thread in the cache,
+ * 			and give it to every user that was waiting for it.
+ * 			A failed lookup is cached too, for a shorter time.
+ * 
+ * @param	job The completed ResolveJob.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::DNSdone(Job &job)
+{
+	ResolveJob const												&resolve = static_cast<ResolveJob const &>(job);
+	std::map<in_addr_t const, std::pair<std::string, time_t> >::iterator	it;
+	std::multimap<in_addr_t const, User *const>::iterator			first;
+	std::multimap<in_addr_t const, User *const>::iterator			last;
+	User															*user;
+	time_t const													now = this->_clock->now();
+
+	if (this->_lookupHostnames.size() >= DNS_CACHE_SIZE)
+	{
+		for (it = this->_lookupHostnames.begin() ; it != this->_lookupHostnames.end() ; )
+			if (it->second.second <= now)
+				this->_lookupHostnames.erase(it++);
+			else
+				++it;
+		if (this->_lookupHostnames.size() >= DNS_CACHE_SIZE)
+			this->_lookupHostnames.clear();
+	}
+	this->_lookupHostnames[resolve.getAddr().s_addr] = std::pair<std::string, time_t>(resolve.getHostname(),
+		now + std::strtol(this->_config[resolve.getHostname().empty() ? "dns_negative_ttl" : "dns_ttl"].c_str(), NULL, 10));
+
+	first = this->_lookupResolving.lower_bound(resolve.getAddr().s_addr);
+	last = this->_lookupResolving.upper_bound(resolve.getAddr().s_addr);
+	while (first != last)
+	{
+		user = first->second;
+		this->_lookupResolving.erase(first++);
+		user->setIsResolving(false);
+		if (resolve.getHostname().empty())
+			Server::logMsg(INTERNAL, "(" + ft::toString(user->getSocket()) + ") Hostname not found, using " + user->getHostname());
+		else
+		{
+			user->setHostname(resolve.getHostname());
+			Server::logMsg(INTERNAL, "(" + ft::toString(user->getSocket()) + ") Hostname resolved: " + user->getHostname());
+		}
+		if (!this->registerUser(*user) ||
+			(!user->getMsg().empty() && !this->replySend(*user)))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Check the reponse of the client of the PING
+ * 
+ * @param user The user to check if the PING is correct
+ * @param params the value of the token send by ping
+ * 
+ * @return true if success, false otherwise.
+ */
+bool	Server::checkPONG(User &user, std::string const &params)
+{
+	ArenaString	line;
+
+	if (params.empty())
+		return false;
+	line.assign(params.data(), std::min(params.find('\n'), params.size()));
+	Server::logMsg(RECEIVED, "(" + ft::toString(user.getSocket()) + ") " + line);
+		if (*(line.end() - 1) == '\r')
+			line.erase(line.end() - 1);
+	line.erase(0, line.find(":") + 1);
+	if (user.getNickname() != line)
+		return false;
+	user.setWaitingForPong(ALIVETIME);
+	return true;
+}
+
+/**
+ * @brief	Connect to the servers to link that are not, unless an upgrade is
+ * 			waiting for the jobs in flight, and keep the links alive:
+ * 			a link idle for `ping` seconds is sent a PING, and one idle for
+ * 			`timeout` seconds is closed.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::checkLinks(void)
+{
+	long const										ping = std::strtol(this->_config["ping"].c_str(), NULL, 10);
+	long const										timeout = std::strtol(this->_config["timeout"].c_str(), NULL, 10);
+	std::map<std::string const, t_connect>::iterator	itConnect;
+	std::map<User *const, t_link>::const_iterator	itLink;
+	time_t const									now = this->_clock->now();
+	Job												*job;
+
+	for (itConnect = this->_lookupConnects.begin() ; itConnect != this->_lookupConnects.end() ; ++itConnect)
+	{
+		if (g_upgrade || itConnect->second.isPending || now < itConnect->second.nextAttempt)
+			continue ;
+		try
+		{
+			job = new ConnectJob(&Server::CONNECTdone, *this->_transport, itConnect->second.host, itConnect->second.port);
+		}
+		catch (std::exception const &e)
+		{
+			Server::logMsg(ERROR, "    Exception: " + std::string(e.what()));
+			return false;
+		}
+		itConnect->second.isPending = true;
+		if (!this->async(job))
+			return false;
+	}
+	for (itLink = this->_lookupLinks.begin() ; itLink != this->_lookupLinks.end() ; ++itLink)
+	{
+		if (itLink->first->getState() != User::LINK || itLink->first->getSocket() == -1)
+			continue ;
+		if (now - itLink->first->getLastActivity() >= timeout)
+		{
+			if (!this->dropLink(*itLink->first, "Ping timeout"))
+				return false;
+		}
+		else if (now - itLink->first->getLastActivity() >= ping && !itLink->first->getWaitingForPong())
+		{
+			if (!this->linkSend(*itLink->first, ArenaString("PING :") + this->_config["server_name"]))
+				return false;
+			itLink->first->setWaitingForPong(true);
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief	Run the completion callback of every job the workers are done with,
+ * 			then resume the processing of the lines their users sent meanwhile.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::collectJobs(void)
+{
+	std::deque<Job *>	completed;
+	std::string			msg;
+	Job					*job;
+	User				*user;
+	bool				ret;
+
+	if (!this->_pool.pop(completed))
+	{
+		Server::logMsg(ERROR, "eventfd: " + std::string(strerror(errno)));
+		return false;
+	}
+	this->_jobsInFlight -= completed.size();
+	for (ret = true ; !completed.empty() ; completed.pop_front())
+	{
+		job = completed.front();
+		user = job->getUser();
+		if (ret && !user && job->getDone())
+			ret = (this->*job->getDone())(*job);
+		else if (ret && user)
+		{
+			user->resume();
+			if (user->getSocket() != -1 && job->getDone())
+				ret = (this->*job->getDone())(*job);
+			if (ret && user->getSocket() != -1 && !user->getPendingJobs())
+			{
+				msg = user->getInput();
+				ret = this->judge(*user, msg);
+				user->setInput(msg);
+			}
+			if (ret && user->getSocket() != -1 && !user->getMsg().empty())
+				ret = this->replySend(*user);
+		}
+		delete job;
+	}
+	return ret;
+}
+
+/**
+ * @brief	Release the poll slot of a file descriptor,
+ * 			the last slot taking its place.
+ * 
+ * @param	fd The file descriptor to stop polling.
+ */
+void	Server::delPollfd(int const fd)
+{
+	std::map<int const, size_t>::iterator	it;
+
+	it = this->_lookupPollfds.find(fd);
+	if (it == this->_lookupPollfds.end())
+		return ;
+	this->_pollfds[it->second] = this->_pollfds.back();
+	this->_lookupPollfds[this->_pollfds.back().fd] = it->second;
+	this->_pollfds.pop_back();
+	this->_lookupPollfds.erase(it);
+}
+
+/**
+ * @brief	Close the connection of an user, and release its poll slot.
+ * 			The user stops monitoring at once, but is itself removed
+ * 			at the end of the current loop turn.
+ * 
+ * @param	user The user to disconnect.
+ */
+void	Server::disconnect(User &user)
+{
+	if (user.getSocket() == -1)
+		return ;
+	this->_capture.close(user.getSocket());
+	this->delPollfd(user.getSocket());
+	this->_lookupSockets.erase(user.getSocket());
+	this->_transport->close(user.getSocket());
+	user.setSocket(-1);
+	this->forgetWatcher(user);
+}
+
+/**
+ * @brief	Close a connection to a linked server, or to one failing to link.
+ * 			Once linked, the servers behind it and their users leave the
+ * 			network, the other links being told.
+ * 
+ * @param	link The connection to close.
+ * @param	reason Why the connection is closed.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::dropLink(User &link, std::string const &reason)
+{
+	std::map<User *const, t_link>::const_iterator	cit;
+	std::string const								name = this->_config["server_name"];
+
+	if (link.getSocket() == -1)
+		return true;
+	Server::logMsg(INTERNAL, "(" + ft::toString(link.getSocket()) + ") Link closed: " + reason);
+	cit = this->_lookupLinks.find(&link);
+	if (cit != this->_lookupLinks.end() && link.getState() == User::LINK &&
+		(!this->propagate(&link, ArenaString(1, ':') + name + " SQUIT " + cit->second.name + " :" + reason) ||
+			!this->squit(cit->second.name, reason)))
+		return false;
+	if (!this->replyPush(link, "ERROR :Closing Link: " + name + " (" + reason + ")") ||
+		!this->replySend(link))
+		return false;
+	this->disconnect(link);
+	return true;
+}
+
+/**
+ * @brief	Disconnect every user whose registration deadline has passed
+ * 			while it is still not registered.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::expireRegistrations(void)
+{
+	std::multimap<time_t const, int const>::iterator	it;
+	std::map<int const, User *const>::const_iterator	cit;
+	time_t const										now = this->_clock->now();
+
+	for (it = this->_registrationTimers.begin() ;
+		it != this->_registrationTimers.end() && it->first <= now ;
+		this->_registrationTimers.erase(it++))
+	{
+		cit = this->_lookupSockets.find(it->second);
+		if (cit == this->_lookupSockets.end() ||
+			cit->second->getState() == User::REGISTERED ||
+			cit->second->getState() == User::LINK ||
+			cit->second->getRegisterDeadline() != it->first)
+			continue ;
+		Server::logMsg(INTERNAL, "(" + ft::toString(it->second) + ") Registration timed out");
+		if (!this->replyPush(*cit->second, "Error :Closing Link: " + this->_config["server_name"] + " (Registration timed out)") ||
+			!this->replySend(*cit->second))
+			return false;
+		this->disconnect(*cit->second);
+	}
+	return true;
+}
+
+/**
+ * @brief	Forget a closed connection to a linked server, the server it was
+ * 			configured from, if any, being tried again `link_retry` seconds later.
+ * 
+ * @param	link The closed connection.
+ */
+void	Server::forgetLink(User &link)
+{
+	std::map<User *const, t_link>::iterator				it;
+	std::map<std::string const, t_connect>::iterator	itConnect;
+
+	it = this->_lookupLinks.find(&link);
+	if (it == this->_lookupLinks.end())
+		return ;
+	itConnect = this->_lookupConnects.find(it->second.target);
+	if (itConnect != this->_lookupConnects.end())
+	{
+		itConnect->second.isPending = false;
+		itConnect->second.nextAttempt = this->_clock->now() + std::strtol(this->_config["link_retry"].c_str(), NULL, 10);
+	}
+	this->_lookupLinks.erase(it);
+}
+
+/**
+ * @brief	Find an user of the servers behind a link.
+ * 
+ * @param	link The link the user is reached through.
+ * @param	nickname The nickname of the user.
+ * 
+ * @return	The user, or NULL if the link has no such user.
+ */
+User	*Server::findRemote(User const &link, ArenaString const &nickname)
+{
+	std::map<Identifier const, User *const>::const_iterator	cit;
+
+	cit = this->_lookupUsers.find(Identifier::find(nickname));
+	if (cit == this->_lookupUsers.end() || cit->second->getSocket() != -1 || cit->second->getLink() != &link)
+		return NULL;
+	return cit->second;
+}
+
+/**
+ * @brief	Stop waiting for the hostname of an user to be resolved.
+ * 			The lookup keeps running, and its result is still cached.
+ * 
+ * @param	user The user to stop waiting for.
+ */
+void	Server::forgetResolving(User &user)
+{
+	std::multimap<in_addr_t const, User *const>::iterator	it;
+	std::multimap<in_addr_t const, User *const>::iterator	last;
+
+	if (!user.getIsResolving())
+		return ;
+	it = this->_lookupResolving.lower_bound(user.getAddr().sin_addr.s_addr);
+	last = this->_lookupResolving.upper_bound(user.getAddr().sin_addr.s_addr);
+	for ( ; it != last ; ++it)
+		if (it->second == &user)
+		{
+			this->_lookupResolving.erase(it);
+			break ;
+		}
+	user.setIsResolving(false);
+}
+
+/**
+ * @brief	Determine what to do depending on the given `msg`.
+ * 			Only complete lines are processed, and the processing stops
+ * 			as soon as the user gets suspended by a pending job:
+ * 			what is left in `msg` has to be kept for later.
+ * 
+ * @param	user The user that sent the message.
+ * @param	msg The raw message received from a client.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::judge(User &user, std::string &msg)
+{
+	ArenaString													line;
+	ArenaString													prefix;
+	ArenaString													cmdName;
+	ArenaString													params;
+	LineScanner::t_lines										lines;
+	LineScanner::t_lines::const_iterator						itLine;
+	size_t														consumed;
+	std::map<std::string const, t_fct const>::const_iterator	it;
+	std::map<std::string const, t_cmdMetrics>::iterator			cmdMetrics;
+	uint64_t													start;
+
+	LineScanner::scan(msg.data(), msg.size(), lines);
+	for (itLine = lines.begin(), consumed = 0 ;
+		itLine != lines.end() && !user.getPendingJobs() && user.getSocket() != -1 ;
+		consumed = itLine->end + 1, ++itLine)
+	{
+		line.assign(msg.data() + consumed, itLine->end - consumed);
+		if (!itLine->isUtf8)
+			++*this->_stats.nonUtf8Lines;
+		if (!line.empty() && *(line.end() - 1) == '\r')
+			line.erase(line.end() - 1);
+		// The tags a client sends are of no use to this server.
+		if (line[0] == '@')
+			line.erase(0, line.find_first_not_of(' ', line.find(' ')));
+		if (user.getState() == User::LINK)
+		{
+			if (!this->linkJudge(user, line))
+				return false;
+			continue ;
+		}
+		prefix.clear();
+		if (line[0] == ':')
+			prefix = line.substr(1, line.find(' ') - 1);
+		cmdName = line.substr(prefix.length(), line.find(' ', prefix.length()));
+		if (cmdName.empty())
+			continue;
+		std::transform<ArenaString::iterator, ArenaString::iterator, int (*)(int const)>(cmdName.begin(), cmdName.end(), cmdName.begin(), ::toupper);
+		params = line.substr(cmdName.length());
+		params.erase(0, params.find_first_not_of(' '));
+		params.erase(params.find_last_not_of(' ') + 1);
+		it = this->_lookupCmds.find(std::string(cmdName.data(), cmdName.size()));
+		cmdMetrics = this->_lookupCmdMetrics.find(it == this->_lookupCmds.end() ? std::string() : it->first);
+		++*cmdMetrics->second.linesIn;
+		// The replies are counted against the command causing them.
+		this->_currentCmdMetrics = &cmdMetrics->second;
+		if (it == this->_lookupCmds.end())
+			Server::logMsg(RECEIVED, "(" + ft::toString(user.getSocket()) + ") " + cmdName + ' ' + params + RED_FG " Unknown" RESET);
+		else if (user.getState() != User::REGISTERED &&
+			this->_lookupRegistrationCmds.find(it->first) == this->_lookupRegistrationCmds.end())
+		{
+			Server::logMsg(RECEIVED, "(" + ft::toString(user.getSocket()) + ") " + cmdName + ' ' + params + RED_FG " Unregistered" RESET);
+			if (!this->replyNumeric<ERR_NOTREGISTERED>(user))
+				return false;
+		}
+		else
+		{
+			Server::logMsg(RECEIVED, "(" + ft::toString(user.getSocket()) + ") " + cmdName + ' ' + params);
+			this->_isCmdError = false;
+			start = Metrics::nanoseconds();
+			if (!(this->*it->second)(user, params))
+				return false;
+			start = Metrics::nanoseconds() - start;
+			cmdMetrics->second.latency.record(start);
+			this->_watchdog.command(it->first, start);
+			++*cmdMetrics->second.calls;
+			if (this->_isCmdError)
+				++*cmdMetrics->second.errors;
+		}
+		// The empty name, standing for no command, always sorts first.
+		this->_currentCmdMetrics = &this->_lookupCmdMetrics.begin()->second;
+	}
+	msg.erase(0, consumed);
+	return true;
+}
+
+/**
+ * @brief	Get the line introducing an user to a linked server.
+ * 
+ * @param	user The user to introduce.
+ * 
+ * @return	The NICK line, from the server of the user.
+ */
+ArenaString	Server::introduce(User const &user)
+{
+	std::map<std::string const, t_server>::const_iterator	cit;
+	unsigned int											hops;
+
+	hops = 1U;
+	if (user.isRemote() && (cit = this->_lookupServers.find(*user.getServer())) != this->_lookupServers.end())
+		hops = cit->second.hops + 1;
+	return ArenaString(1, ':') + (user.isRemote() ? *user.getServer() : this->_config["server_name"]) +
+		" NICK " + user.getNickname() + ' ' + ft::toString(static_cast<int>(hops)) +
+		' ' + ft::toString(static_cast<int>(user.getTimestamp())) + ' ' + user.getModeString() +
+		' ' + user.getUsername() + ' ' + user.getHostname() + " :" + user.getRealname();
+}
+
+/**
+ * @brief	Register the metrics of the server, keeping the handles
+ * 			the hot paths update.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::initMetrics(void)
+{
+	std::map<std::string const, t_fct const>::const_iterator	cit;
+	t_cmdMetrics												cmdMetrics;
+	int															idx;
+
+	try
+	{
+		this->_stats.connections = this->_metrics.addCounter("ircserv_connections_total", "Accepted client connections.");
+		this->_stats.registrations = this->_metrics.addCounter("ircserv_registrations_total", "Completed client registrations.");
+		this->_stats.bytesIn = this->_metrics.addCounter("ircserv_received_bytes_total", "Bytes received from the clients.");
+		this->_stats.bytesOut = this->_metrics.addCounter("ircserv_sent_bytes_total", "Bytes sent to the clients.");
+		this->_stats.nonUtf8Lines = this->_metrics.addCounter("ircserv_non_utf8_lines_total", "Lines received that are not valid UTF-8.");
+		this->_stats.users = this->_metrics.addGauge("ircserv_users", "Connected clients.");
+		this->_stats.channels = this->_metrics.addGauge("ircserv_channels", "Existing channels.");
+		this->_stats.arenaHeapAllocs = this->_metrics.addCounter("ircserv_arena_heap_allocations_total", "Chunks and blocks the per-iteration arena got from the heap.");
+		this->_stats.arenaPeak = this->_metrics.addGauge("ircserv_arena_peak_bytes", "Most bytes the per-iteration arena handed out in a single iteration.");
+		for (idx = SpamFilter::WARN ; idx <= SpamFilter::KILL ; ++idx)
+			this->_stats.spamMatches[idx] = this->_metrics.addCounter("ircserv_spam_filter_matches_total", "Messages caught by the spam filter, by action taken.", std::string("action=\"") + SpamFilter::getActionName(static_cast<SpamFilter::e_action>(idx)) + '"');
+		this->_stats.spamPatterns = this->_metrics.addGauge("ircserv_spam_filter_patterns", "Patterns of the spam filter.");
+		this->_stats.servers = this->_metrics.addGauge("ircserv_servers", "Other servers of the network.");
+		this->_stats.remoteUsers = this->_metrics.addGauge("ircserv_remote_users", "Users of the other servers of the network.");
+		this->_stats.historyBytes = this->_metrics.addGauge("ircserv_history_bytes", "Bytes of the message history taken by the channels.");
+		this->_stats.historyEvictions = this->_metrics.addCounter("ircserv_history_evictions_total", "Channels that lost their history to another one, the memory being full.");
+		this->_stats.sendq = this->_metrics.addHistogram("ircserv_sendq_bytes", "Size of the replies queued for a client when flushed.", Metrics::bytesBounds);
+		this->_stats.pollWait = this->_metrics.addHistogram("ircserv_poll_wait_seconds", "Time spent waiting in poll().", Metrics::secondsBounds);
+		this->_stats.loopIteration = this->_metrics.addHistogram("ircserv_loop_iteration_seconds", "Duration of an event loop iteration.", Metrics::secondsBounds);
+		for (cit = this->_lookupCmds.begin() ; cit != this->_lookupCmds.end() ; ++cit)
+		{
+			cmdMetrics.linesIn = this->_metrics.addCounter("ircserv_lines_in_total", "Lines received, by command.", "command=\"" + cit->first + '"');
+			cmdMetrics.linesOut = this->_metrics.addCounter("ircserv_lines_out_total", "Lines replied, by command that caused them.", "command=\"" + cit->first + '"');
+			cmdMetrics.calls = this->_metrics.addCounter("ircserv_command_calls_total", "Commands run, by command.", "command=\"" + cit->first + '"');
+			cmdMetrics.errors = this->_metrics.addCounter("ircserv_command_errors_total", "Commands answered with an error reply, by command.", "command=\"" + cit->first + '"');
+			this->_lookupCmdMetrics.insert(std::make_pair(cit->first, cmdMetrics));
+		}
+		// Unknown commands, and the lines sent out of any command (PING checks, async replies, ...)
+		cmdMetrics.linesIn = this->_metrics.addCounter("ircserv_lines_in_total", "", "command=\"other\"");
+		cmdMetrics.linesOut = this->_metrics.addCounter("ircserv_lines_out_total", "", "command=\"other\"");
+		cmdMetrics.calls = this->_metrics.addCounter("ircserv_command_calls_total", "", "command=\"other\"");
+		cmdMetrics.errors = this->_metrics.addCounter("ircserv_command_errors_total", "", "command=\"other\"");
+		this->_lookupCmdMetrics.insert(std::make_pair(std::string(), cmdMetrics));
+	}
+	catch (std::exception const &e)
+	{
+		Server::logMsg(ERROR, std::string("    Exception: ") + e.what());
+		return false;
+	}
+	this->_currentCmdMetrics = &this->_lookupCmdMetrics[std::string()];
+	this->_watchdog.init(this->_metrics, static_cast<uint64_t>(std::strtol(this->_config["slow_tick"].c_str(), NULL, 10)) * 1000000UL);
+	return true;
+}
+
+/**
+ * @brief	Read the limits advertised in RPL_ISUPPORT from the configuration,
+ * 			and write the tokens of RPL_ISUPPORT once for all the users, at most
+ * 			13 of them on a line. The entries of `targmax` naming a command
+ * 			without several targets are ignored.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::initSupport(void)
+{
+	std::string const			&targmax = this->_config["targmax"];
+	std::string const			&modes = Channel::getAvailableModes();
+	std::vector<std::string>	tokens;
+	std::vector<std::string>	lines;
+	std::string					chanModes[4];
+	std::string					prefix[2];
+	std::string					entry;
+	std::string::size_type		pos;
+	std::string::size_type		end;
+	Channel::t_modeDef const	*def;
+	t_limits					limits;
+	size_t						idx;
+
+	limits.nicknameLength = std::strtoul(this->_config["nick_length"].c_str(), NULL, 10);
+	limits.channelLength = std::strtoul(this->_config["channel_length"].c_str(), NULL, 10);
+	limits.modes = std::strtoul(this->_config["max_modes"].c_str(), NULL, 10);
+	limits.monitors = std::strtoul(this->_config["max_monitor"].c_str(), NULL, 10);
+	for (idx = 0UL ; Server::_arrayTargmax[idx].first ; ++idx)
+		limits.*Server::_arrayTargmax[idx].second = 0UL;
+	try
+	{
+		for (pos = 0UL ; pos < targmax.size() ; pos = end + 1)
+		{
+			end = std::min(targmax.find(',', pos), targmax.size());
+			entry = targmax.substr(pos, end - pos);
+			for (idx = 0UL ; Server::_arrayTargmax[idx].first && entry.compare(0, entry.find(':'), Server::_arrayTargmax[idx].first) ; ++idx);
+			if (!Server::_arrayTargmax[idx].first || entry.find(':') == std::string::npos)
+			{
+				Server::logMsg(ERROR, "Config: targmax: " + entry + " ignored");
+				continue ;
+			}
+			limits.*Server::_arrayTargmax[idx].second = std::strtoul(entry.c_str() + entry.find(':') + 1, NULL, 10);
+		}
+
+		// The channel modes by type: lists, parameter to set and unset, to set only, and without parameter.
+		for (idx = 0UL ; idx < modes.size() ; ++idx)
+		{
+			def = Channel::getModeDef(modes[idx]);
+			if (def->type == Channel::MEMBER)
+			{
+				prefix[0] += def->letter;
+				prefix[1] += def->bit == Channel::CHANOP ? '@' : '+';
+			}
+			else
+				chanModes[def->type == Channel::LIST ? 0 : def->type == Channel::PARAM ? 1 : def->type == Channel::PARAM_SET ? 2 : 3] += def->letter;
+		}
+		tokens.push_back("CASEMAPPING=rfc1459");
+		tokens.push_back("CHANMODES=" + chanModes[0] + ',' + chanModes[1] + ',' + chanModes[2] + ',' + chanModes[3]);
+		if (limits.channelLength)
+			tokens.push_back("CHANNELLEN=" + ft::toString(static_cast<int>(limits.channelLength)));
+		tokens.push_back("CHANTYPES=#");
+		tokens.push_back("CHATHISTORY=" + ft::toString(CHATHISTORY_LIMIT));
+		tokens.push_back("LINELEN=" + ft::toString(MAX_LINE_LENGTH + 2));
+		tokens.push_back(limits.modes ? "MODES=" + ft::toString(static_cast<int>(limits.modes)) : std::string("MODES"));
+		tokens.push_back(limits.monitors ? "MONITOR=" + ft::toString(static_cast<int>(limits.monitors)) : std::string("MONITOR"));
+		if (limits.nicknameLength)
+			tokens.push_back("NICKLEN=" + ft::toString(static_cast<int>(limits.nicknameLength)));
+		tokens.push_back("PREFIX=(" + prefix[0] + ')' + prefix[1]);
+		for (entry = "TARGMAX=", idx = 0UL ; Server::_arrayTargmax[idx].first ; ++idx)
+		{
+			if (idx)
+				entry += ',';
+			entry += std::string(Server::_arrayTargmax[idx].first) + ':';
+			if (limits.*Server::_arrayTargmax[idx].second)
+				entry += ft::toString(static_cast<int>(limits.*Server::_arrayTargmax[idx].second));
+		}
+		tokens.push_back(entry);
+
+		for (idx = 0UL ; idx < tokens.size() ; ++idx)
+		{
+			if (!(idx % 13))
+				lines.push_back(tokens[idx]);
+			else
+				lines.back() += ' ' + tokens[idx];
+		}
+	}
+	catch (std::exception const &e)
+	{
+		Server::logMsg(ERROR, std::string("    Exception: ") + e.what());
+		return false;
+	}
+	this->_limits = limits;
+	this->_isupport.swap(lines);
+	return true;
+}
+
+/**
+ * @brief	Start what serves the clients besides the listening socket:
+ * 			the snapshot, the history, the thread pool, the metrics and
+ * 			the capture.
+ * 			The thread pool eventfd directly follows the listening socket
+ * 			in the poll slots.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::launch(void)
+{
+	char	path[PATH_MAX];
+	ssize_t	size;
+
+	// Read now, the path still names the new binary once it replaced this one.
+	size = readlink("/proc/self/exe", path, sizeof(path) - 1);
+	if (size > 0)
+		this->_executable.assign(path, static_cast<size_t>(size));
+	if (!this->_config["snapshot_file"].empty())
+	{
+		Channel::track(true);
+		this->loadSnapshot();
+		this->_nextSnapshot = this->_clock->now() + std::strtol(this->_config["snapshot_interval"].c_str(), NULL, 10);
+	}
+	// The msgids keep growing across restarts, short of a million messages a second.
+	if (!this->_history.init(static_cast<size_t>(std::strtol(this->_config["history_memory"].c_str(), NULL, 10)),
+		static_cast<size_t>(std::strtol(this->_config["history_size"].c_str(), NULL, 10)), static_cast<uint64_t>(this->_clock->now()) << 20))
+	{
+		Server::logMsg(ERROR, "History: init: " + std::string(strerror(ENOMEM)));
+		this->stop();
+		return false;
+	}
+	if (!this->_pool.init(static_cast<uint>(std::strtol(this->_config["workers"].c_str(), NULL, 10))))
+	{
+		Server::logMsg(ERROR, "ThreadPool: init: " + std::string(strerror(errno)));
+		this->stop();
+		return false;
+	}
+	Server::logMsg(INTERNAL, "(" + ft::toString(this->_pool.getEventFd()) + ") Thread pool started");
+	this->addPollfd(this->_pool.getEventFd(), POLLIN);
+	if (!this->listenMetrics())
+	{
+		this->stop();
+		return false;
+	}
+	if (!this->_config["capture_file"].empty())
+	{
+		if (!this->_capture.init(this->_config["capture_file"], static_cast<size_t>(std::strtol(this->_config["capture_max_size"].c_str(), NULL, 10))))
+		{
+			Server::logMsg(ERROR, "capture: " + this->_config["capture_file"] + ": " + std::string(strerror(errno)));
+			this->stop();
+			return false;
+		}
+		Server::logMsg(INTERNAL, "    Capturing the inbound traffic into " + this->_config["capture_file"]);
+	}
+	this->_state = RUNNING;
+	return true;
+}
+
+/**
+ * @brief	Open the metrics socket, if metrics_listen is set: either
+ * 			`unix:<path>` for an Unix socket, or `<address>:<port>`
+ * 			for a TCP socket on a loopback address.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::listenMetrics(void)
+{
+	std::string const		listenOn = this->_config["metrics_listen"];
+	std::string::size_type	pos;
+	sockaddr_un				addrUnix;
+	sockaddr_in				addrInet;
+	sockaddr				*addr;
+	socklen_t				addrlen;
+	int						optval;
+
+	// The socket handed over by the previous process is kept as is.
+	if (this->_metricsSocket != -1)
+	{
+		this->addPollfd(this->_metricsSocket, POLLIN);
+		return true;
+	}
+	if (listenOn.empty())
+		return true;
+	if (!listenOn.compare(0, 5, "unix:"))
+	{
+		std::memset(&addrUnix, 0, sizeof(addrUnix));
+		addrUnix.sun_family = AF_UNIX;
+		if (listenOn.size() - 5 >= sizeof(addrUnix.sun_path))
+		{
+			Server::logMsg(ERROR, "metrics_listen: path too long");
+			return false;
+		}
+		listenOn.copy(addrUnix.sun_path, listenOn.size() - 5, 5);
+		unlink(addrUnix.sun_path);
+		addr = reinterpret_cast<sockaddr *>(&addrUnix);
+		addrlen = sizeof(addrUnix);
+	}
+	else
+	{
+		pos = listenOn.rfind(':');
+		std::memset(&addrInet, 0, sizeof(addrInet));
+		addrInet.sin_family = AF_INET;
+		addrInet.sin_addr.s_addr = inet_addr(listenOn.substr(0, pos).c_str());
+		addrInet.sin_port = htons(static_cast<uint16_t>(std::strtol(listenOn.c_str() + pos + 1, NULL, 10)));
+		if (pos == std::string::npos || (ntohl(addrInet.sin_addr.s_addr) >> 24) != 127)
+		{
+			Server::logMsg(ERROR, "metrics_listen: expected unix:<path> or <loopback address>:<port>");
+			return false;
+		}
+		addr = reinterpret_cast<sockaddr *>(&addrInet);
+		addrlen = sizeof(addrInet);
+	}
+
+	this->_metricsSocket = socket(addr->sa_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	optval = 1;
+	if (this->_metricsSocket == -1 ||
+		(addr->sa_family == AF_INET && setsockopt(this->_metricsSocket, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval))) ||
+		bind(this->_metricsSocket, addr, addrlen) ||
+		listen(this->_metricsSocket, SOMAXCONN))
+	{
+		Server::logMsg(ERROR, "metrics: " + std::string(strerror(errno)));
+		return false;
+	}
+	Server::logMsg(INTERNAL, "(" + ft::toString(this->_metricsSocket) + ") Metrics served on " + listenOn);
+	this->addPollfd(this->_metricsSocket, POLLIN);
+	return true;
+}
+
+/**
+ * @brief	Introduce this server to a server to link, with the link password.
+ * 
+ * @param	link The connection to the server to link.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkHandshake(User &link)
+{
+	return this->replyPush(link, "PASS " + this->_config["link_password"] + " TS") &&
+		this->replyPush(link, "SERVER " + this->_config["server_name"] + " 1 :" + this->_config["server_description"]) &&
+		this->replySend(link);
+}
+
+/**
+ * @brief	Process a line received from a linked server: its source is the
+ * 			server or the user it comes from, the linked server by default.
+ * 			A command this server does not know is ignored.
+ * 
+ * @param	link The connection the line was received on.
+ * @param	line The line, without its CRLF.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkJudge(User &link, ArenaString const &line)
+{
+	std::map<std::string const, t_linkFct const>::const_iterator	it;
+	ArenaString														source;
+	ArenaString														cmdName;
+	ArenaString														params;
+	ArenaString::size_type											pos;
+	ArenaString::size_type											end;
+
+	pos = 0;
+	if (!line.empty() && line[0] == ':')
+	{
+		pos = line.find(' ');
+		source = line.substr(1, pos - 1);
+		pos = line.find_first_not_of(' ', pos);
+	}
+	else
+		source.assign(this->_lookupLinks[&link].name.data(), this->_lookupLinks[&link].name.size());
+	if (pos == ArenaString::npos || line.empty())
+		return true;
+	end = line.find(' ', pos);
+	cmdName = line.substr(pos, end - pos);
+	std::transform<ArenaString::iterator, ArenaString::iterator, int (*)(int const)>(cmdName.begin(), cmdName.end(), cmdName.begin(), ::toupper);
+	if (end != ArenaString::npos)
+		params = line.substr(end + 1);
+	params.erase(0, params.find_first_not_of(' '));
+	params.erase(params.find_last_not_of(' ') + 1);
+	it = this->_lookupLinkCmds.find(std::string(cmdName.data(), cmdName.size()));
+	if (it == this->_lookupLinkCmds.end())
+	{
+		Server::logMsg(RECEIVED, "(" + ft::toString(link.getSocket()) + ") " + line + RED_FG " Unknown" RESET);
+		return true;
+	}
+	Server::logMsg(RECEIVED, "(" + ft::toString(link.getSocket()) + ") " + line);
+	return (this->*it->second)(link, source, params);
+}
+
+/**
+ * @brief	Send a line to a linked server at once.
+ * 
+ * @param	link The connection to the linked server.
+ * @param	line The line to send.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkSend(User &link, ArenaString const &line)
+{
+	if (link.getSocket() == -1)
+		return true;
+	return this->replyPush(link, line) && this->replySend(link);
+}
+
+/**
+ * @brief	Send to an user client what its socket could not take yet, once
+ * 			it is writable again. The connection is closed when its send
+ * 			queue passes `sendq` bytes (`link_sendq` for a linked server),
+ * 			the other end being too slow to follow.
+ * 
+ * @param	user The user to send its queue to.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::flushUser(User &user)
+{
+	unsigned long	sendqMax;
+	ssize_t			retSend;
+	bool			isLink;
+
+	if (user.getSendq().empty() || user.getSocket() == -1)
+		return true;
+	if (this->_pollfds[this->_lookupPollfds[user.getSocket()]].revents & POLLOUT)
+	{
+		retSend = this->_transport->send(user.getSocket(), user.getSendq().data(), user.getSendq().size());
+		if (retSend < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+		{
+			Server::logMsg(ERROR, "    send: " + std::string(strerror(errno)));
+			user.eraseSendq(user.getSendq().size());
+			return true;
+		}
+		if (retSend > 0)
+		{
+			*this->_stats.bytesOut += static_cast<unsigned long>(retSend);
+			user.eraseSendq(static_cast<size_t>(retSend));
+		}
+	}
+	isLink = !this->_lookupLinks.empty() && this->_lookupLinks.count(&user);
+	sendqMax = std::strtoul(this->_config[isLink ? "link_sendq" : "sendq"].c_str(), NULL, 10);
+	if (user.getSendq().size() <= sendqMax)
+		return true;
+	if (isLink)
+		return this->dropLink(user, "SendQ exceeded");
+	Server::logMsg(INTERNAL, "(" + ft::toString(user.getSocket()) + ") SendQ exceeded");
+	if (user.getState() == User::REGISTERED && !this->_lookupLinks.empty() &&
+		!this->propagate(NULL, ArenaString(1, ':') + user.getNickname() + " QUIT :SendQ exceeded"))
+		return false;
+	this->disconnect(user);
+	return this->quitChannels(user, "SendQ exceeded");
+}
+
+/**
+ * @brief	Replace the patterns of the spam filter with the lines of a file.
+ * 			The current patterns are kept if the file is not valid.
+ * 
+ * @param	file The ReadFileJob that read the pattern file.
+ * @param	error Set to the reason of the failure, if any.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::loadSpamFilter(ReadFileJob const &file, std::string &error)
+{
+	if (file.getIsOpen() == false)
+	{
+		error = "cannot be opened";
+		return false;
+	}
+	try
+	{
+		if (!this->_spamFilter.compile(file.getLines(), error))
+			return false;
+	}
+	catch (std::exception const &e)
+	{
+		error = std::string("exception: ") + e.what();
+		return false;
+	}
+	*this->_stats.spamPatterns = static_cast<long>(this->_spamFilter.getSize());
+	Server::logMsg(INTERNAL, "Spam filter: " + ft::toString(static_cast<int>(this->_spamFilter.getSize())) + " patterns loaded");
+	return true;
+}
+
+/**
+ * @brief	Log the cause of a slow tick of the event loop.
+ * 			At most one slow tick is logged every slow_tick_log_interval
+ * 			seconds, the next log telling how many were not.
+ */
+void	Server::logSlowTick(void)
+{
+	time_t const	now = this->_clock->now();
+
+	if (now < this->_slowTickLogTime)
+	{
+		++this->_slowTicksNotLogged;
+		return ;
+	}
+	if (this->_slowTicksNotLogged)
+		Server::logMsg(ERROR, this->_watchdog.report() + " (" + ft::toString(static_cast<int>(this->_slowTicksNotLogged)) + " more since the last report)");
+	else
+		Server::logMsg(ERROR, this->_watchdog.report());
+	this->_slowTickLogTime = now + std::strtol(this->_config["slow_tick_log_interval"].c_str(), NULL, 10);
+	this->_slowTicksNotLogged = 0;
+}
+
+/**
+ * @brief	Write a formated log message to the standard output.
+ * 
+ * @param	msg The message to write.
+ */
+void	Server::logMsg(uint const type, std::string const &msg)
+{
+	this->logMsg(type, msg.data(), msg.size());
+}
+
+void	Server::logMsg(uint const type, ArenaString const &msg)
+{
+	this->logMsg(type, msg.data(), msg.size());
+}
+
+void	Server::logMsg(uint const type, char const *const msg)
+{
+	this->logMsg(type, msg, strlen(msg));
+}
+
+void	Server::logMsg(uint const type, char const *const msg, size_t const size)
+{
+	char			nowtime[64];
+	time_t const	rawtime = this->_clock->now();
+
+	strftime(nowtime, 64, "%Y/%m/%d %H:%M:%S", localtime(&rawtime));
+	std::cout << "[" << nowtime << "][" << this->_lookupLogMsgTypes[type] << "] ";
+	std::cout.write(msg, static_cast<std::streamsize>(size)) << '\n';
+}
+
+/**
+ * @brief	Append a notice from the server to the message to send to an user.
+ * 
+ * @param	user The user to send the notice to.
+ * @param	text The text of the notice.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::notice(User &user, std::string const &text)
+{
+	return this->replyPush(user, this->_numericPrefix + "NOTICE " + user.getNickname() + " :" + text);
+}
+
+/**
+ * @brief	Append a FAIL reply to the message to send to an user client,
+ * 			marking the running command as failed.
+ * 
+ * @param	user The user to send the reply to.
+ * @param	text The command, the code, the context and the description.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::fail(User &user, std::string const &text)
+{
+	this->_isCmdError = true;
+	return this->replyPush(user, this->_numericPrefix + "FAIL " + text);
+}
+
+/**
+ * @brief	Keep a message sent to a channel in its history,
+ * 			with the msgid and the time it was sent with.
+ * 
+ * @param	channel The channel.
+ * @param	line The message, as sent to the members of the channel.
+ */
+void	Server::keepHistory(Channel &channel, TaggedLine const &line)
+{
+	this->_history.append(channel.getHistory(), line.getMsgid(), line.getTime(), line.getLine().data(), line.getLine().size());
+}
+
+/**
+ * @brief	Send a line to the members of a channel connected to this server.
+ * 
+ * @param	channel The channel.
+ * @param	except The member not to send the line to, if any.
+ * @param	line The line to send.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::localSend(Channel const &channel, User const *const except, ArenaString const &line)
+{
+	std::map<Identifier const, User *const>::const_iterator	cit;
+
+	for (cit = channel.begin() ; cit != channel.end() ; ++cit)
+		if (cit->second != except && cit->second->getSocket() != -1 &&
+			(!this->replyPush(*cit->second, line) || !this->replySend(*cit->second)))
+			return false;
+	return true;
+}
+
+/**
+ * @brief	Send a message to the members of a channel connected to this server,
+ * 			each with the tags it asked for.
+ * 
+ * @param	channel The channel.
+ * @param	except The member not to send the message to, if any.
+ * @param	line The message, tagged once for each set of tags.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::localSend(Channel const &channel, User const *const except, TaggedLine &line)
+{
+	std::map<Identifier const, User *const>::const_iterator	cit;
+
+	for (cit = channel.begin() ; cit != channel.end() ; ++cit)
+		if (cit->second != except && cit->second->getSocket() != -1 &&
+			(!this->replyPush(*cit->second, line.get(cit->second->getCaps())) || !this->replySend(*cit->second)))
+			return false;
+	return true;
+}
+
+/**
+ * @brief	Send a line to every linked server.
+ * 
+ * @param	from The link the line comes from, not to send it back to.
+ * @param	line The line to send.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::propagate(User const *const from, ArenaString const &line)
+{
+	std::map<User *const, t_link>::const_iterator	cit;
+
+	for (cit = this->_lookupLinks.begin() ; cit != this->_lookupLinks.end() ; ++cit)
+		if (cit->first != from && cit->first->getState() == User::LINK &&
+			!this->linkSend(*cit->first, line))
+			return false;
+	return true;
+}
+
+/**
+ * @brief	Send a line to the linked servers a channel has members behind,
+ * 			once each whatever their number of members.
+ * 
+ * @param	channel The channel.
+ * @param	from The link the line comes from, not to send it back to.
+ * @param	line The line to send.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::propagateChannel(Channel const &channel, User const *const from, ArenaString const &line)
+{
+	std::vector<User *, ArenaAllocator<User *> >				links;
+	std::vector<User *, ArenaAllocator<User *> >::const_iterator	itLink;
+	std::map<Identifier const, User *const>::const_iterator	cit;
+	User														*link;
+
+	if (this->_lookupServers.empty())
+		return true;
+	for (cit = channel.begin() ; cit != channel.end() ; ++cit)
+	{
+		if (cit->second->getSocket() != -1 || !cit->second->isRemote())
+			continue ;
+		link = cit->second->getLink();
+		if (link != from && std::find(links.begin(), links.end(), link) == links.end())
+			links.push_back(link);
+	}
+	for (itLink = links.begin() ; itLink != links.end() ; ++itLink)
+		if (!this->linkSend(**itLink, line))
+			return false;
+	return true;
+}
+
+/**
+ * @brief	Tell the members of the channels of an user that is gone,
+ * 			either of another server or disconnected, that it quit.
+ * 
+ * @param	user The user that quit.
+ * @param	reason Why it quit.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::quitChannels(User &user, std::string const &reason)
+{
+	std::set<User *>											usersToNotice;
+	std::set<User *>::const_iterator							cit;
+	std::map<Identifier const, Channel *const>::const_iterator	itChan;
+	std::map<Identifier const, User *const>::const_iterator	itUser;
+
+	for (itChan = user.getLookupChannels().begin() ; itChan != user.getLookupChannels().end() ; ++itChan)
+		for (itUser = itChan->second->begin() ; itUser != itChan->second->end() ; ++itUser)
+			if (itUser->second->getSocket() != -1)
+				usersToNotice.insert(itUser->second);
+	for (cit = usersToNotice.begin() ; cit != usersToNotice.end() ; ++cit)
+		if (!this->replyPush(**cit, ":" + user.getMask() + " QUIT :" + reason) ||
+			!this->replySend(**cit))
+			return false;
+	return true;
+}
+
+/**
+ * @brief	Check every user socket connection, receive messages from
+ * 			each of them, and process the received messages.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::recvAll(void)
+{
+	long const					ping = std::strtol(this->_config["ping"].c_str(), NULL, 10);
+	long const					timeout = std::strtol(this->_config["timeout"].c_str(), NULL, 10);
+	char						buff[BUFFER_SIZE + 1];
+	ssize_t						retRecv;
+	std::string													msg;
+	std::list<User>::iterator									it;
+	std::map<Identifier const, Channel *const>::const_iterator	itChan;
+	std::map<Identifier const, Channel>::iterator				chan;
+	double														pollStart;
+	time_t														now;
+	bool														isClosed;
+
+	this->_watchdog.mark(Watchdog::WAIT);
+	pollStart = Metrics::now();
+	if (this->_transport->poll(&_pollfds[0], _pollfds.size(), static_cast<int>(timeout)) == -1)
+	{
+		// A signal (SIGUSR2) is handled between two iterations.
+		if (errno == EINTR)
+			return true;
+		Server::logMsg(ERROR, "poll: " + std::string(strerror(errno)));
+		return false;
+	}
+	this->_stats.pollWait->observe(Metrics::now() - pollStart);
+	this->_watchdog.mark(Watchdog::DISPATCH);
+	// The thread pool eventfd always directly follows the listening socket.
+	if ((this->_pollfds[1].revents & POLLIN) && !this->collectJobs())
+		return false;
+	this->_watchdog.mark(Watchdog::TIMERS);
+	this->_capture.tick();
+	if (!this->serveMetrics() ||
+		!this->expireRegistrations() ||
+		!this->checkLinks() ||
+		!this->snapshot())
+		return false;
+	for (it = this->_users.begin() ; it != this->_users.end() ; )
+	{
+		this->_watchdog.mark(Watchdog::FLUSH, it->getSocket(), &it->getNickname());
+		if (!this->flushUser(*it))
+			return false;
+		this->_watchdog.mark(Watchdog::READ, it->getSocket(), &it->getNickname());
+		msg = it->getInput();
+		retRecv = this->_transport->recv(it->getSocket(), buff, BUFFER_SIZE);
+		while (retRecv > 0)
+		{
+			*this->_stats.bytesIn += static_cast<unsigned long>(retRecv);
+			this->_capture.data(it->getSocket(), buff, static_cast<size_t>(retRecv));
+			msg.append(buff, static_cast<size_t>(retRecv));
+			// Only the new bytes can complete a line.
+			if (memchr(buff, '\n', static_cast<size_t>(retRecv)))
+				break ;
+			retRecv = this->_transport->recv(it->getSocket(), buff, BUFFER_SIZE);
+		}
+		// A linked server closing its end is told at once, not by a ping timeout.
+		isClosed = !this->_lookupLinks.empty() && this->_lookupLinks.count(&*it) &&
+			(retRecv == 0 || (retRecv == -1 && errno != EAGAIN && errno != EWOULDBLOCK));
+		this->_watchdog.mark(Watchdog::TIMERS, it->getSocket(), &it->getNickname());
+		now = this->_clock->now();
+		if (it->getIsResolving() && now >= it->getResolveDeadline())
+		{
+			this->forgetResolving(*it);
+			Server::logMsg(INTERNAL, "(" + ft::toString(it->getSocket()) + ") Hostname lookup timed out, using " + it->getHostname());
+			if (!this->registerUser(*it))
+				return false;
+		}
+		if (now - it->getLastActivity() >= ping && it->getState() != User::LINK)
+		{
+			if (!it->getWaitingForPong())
+				this->checkStillAlive(*it);
+			else if ((it->getWaitingForPong() && now - it->getLastActivity() >= timeout) || (!msg.empty() && !this->checkPONG(*it, msg))) 
+			{
+				Server::logMsg(INTERNAL, "(" + ft::toString(it->getSocket()) + ") Connection lost");
+				if (it->getState() == User::REGISTERED &&
+					!this->propagate(NULL, ArenaString(1, ':') + it->getNickname() + " QUIT :Ping timeout"))
+					return false;
+				this->disconnect(*it);
+			}
+			msg.clear();
+		}
+		else
+		{
+			this->_watchdog.mark(Watchdog::DISPATCH, it->getSocket(), &it->getNickname());
+			// Judged by the upgraded server, not to start a job the upgrade would wait for.
+			if (!g_upgrade && !this->judge(*it, msg))
+				return false;
+			this->_watchdog.mark(Watchdog::FLUSH, it->getSocket(), &it->getNickname());
+			if (!it->getMsg().empty() && !this->replySend(*it))
+				return false;
+		}
+		if (isClosed && !this->dropLink(*it, "Connection closed"))
+			return false;
+		it->setInput(msg);
+		if (retRecv > 0)
+		{
+			it->updateLastActivity(now);
+		}
+		if (it->getSocket() == -1 && !it->getPendingJobs())
+		{
+			// Leaving every channel is the tail of a QUIT or a KILL.
+			this->_watchdog.mark(Watchdog::DISPATCH, -1, &it->getNickname());
+			this->forgetResolving(*it);
+			if (!this->_lookupLinks.empty())
+				this->forgetLink(*it);
+			for (itChan = it->getLookupChannels().begin() ; itChan != it->getLookupChannels().end() ; ++itChan)
+			{
+				chan = this->_lookupChannels.find(itChan->first);
+				if (chan == this->_lookupChannels.end())
+					continue ;
+				chan->second.delUser(it->getNicknameId());
+				if (chan->second.empty())
+					this->_lookupChannels.erase(chan);
+			}
+			if (!this->forgetNickname(*it))
+				return false;
+			it = this->_users.erase(it);
+		}
+		else
+			++it;
+		msg.clear();
+	}
+	return true;
+}
+
+/**
+ * @brief	Complete the registration of an user, sending it the welcome burst,
+ * 			with the features and limits of the server (RPL_ISUPPORT).
+ * 			Nothing is done until the user has a nickname, the USER
+ * 			command succeeded, the hostname of the user is known, and
+ * 			the capability negotiation it started, if any, ended.
+ * 
+ * @param	user The user to register.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::registerUser(User &user)
+{
+	ArenaString									motdParams;
+	std::vector<std::string>::const_iterator	cit;
+
+	if (user.getState() != User::AUTHENTICATED || user.getIsResolving() || user.getIsNegotiating() ||
+		user.getNicknameId().empty() || user.getRealname().empty())
+		return true;
+	user.setState(User::REGISTERED);
+	user.setMask();
+	++*this->_stats.registrations;
+	if ((!this->_lookupLinks.empty() && !this->propagate(NULL, this->introduce(user))) ||
+		!this->notifyWatchers(user.getNicknameId(), true, user.getMask()))
+		return false;
+
+	if (!this->replyNumeric<RPL_WELCOME>(user, user.getMask()) ||
+		!this->replyNumeric<RPL_YOURHOST>(user, this->_config["server_name"], this->_config["server_version"]) ||
+		!this->replyNumeric<RPL_CREATED>(user, this->_creationTime) ||
+		!this->replyNumeric<RPL_MYINFO>(user, this->_config["server_name"], this->_config["server_version"], User::getAvailableModes(), Channel::getAvailableModes()))
+		return false;
+	for (cit = this->_isupport.begin() ; cit != this->_isupport.end() ; ++cit)
+		if (!this->replyNumeric<RPL_ISUPPORT>(user, *cit))
+			return false;
+	return this->MOTD(user, motdParams);
+}
+
+/**
+ * @brief	Forget an user of another server, removing it from its channels,
+ * 			its watchers being told it is gone.
+ * 
+ * @param	user The user to forget.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::removeRemoteUser(User &user)
+{
+	std::map<User const *const, std::list<User>::iterator>::iterator	it;
+	std::map<Identifier const, Channel *const>::const_iterator			itChan;
+	std::map<Identifier const, Channel>::iterator						chan;
+
+	for (itChan = user.getLookupChannels().begin() ; itChan != user.getLookupChannels().end() ; ++itChan)
+	{
+		chan = this->_lookupChannels.find(itChan->first);
+		if (chan == this->_lookupChannels.end())
+			continue ;
+		chan->second.delUser(user.getNicknameId());
+		if (chan->second.empty())
+			this->_lookupChannels.erase(chan);
+	}
+	if (!this->forgetNickname(user))
+		return false;
+	it = this->_lookupRemoteUsers.find(&user);
+	if (it == this->_lookupRemoteUsers.end())
+		return true;
+	this->_remoteUsers.erase(it->second);
+	this->_lookupRemoteUsers.erase(it);
+	return true;
+}
+
+/**
+ * @brief	Change the nickname of an user, indexing it under its new one,
+ * 			and tell it and the members of its channels connected to this server,
+ * 			then the watchers of both nicknames.
+ * 
+ * @param	user The user to rename.
+ * @param	nickname The new nickname, known to be free.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::rename(User &user, std::string const &nickname)
+{
+	Identifier const											former(user.getNicknameId());
+	std::string const											formerName(user.getNickname());
+	std::string const											line = ':' + user.getMask() + " NICK " + nickname;
+	std::set<User *>											usersToNotice;
+	std::set<User *>::const_iterator							cit;
+	std::map<Identifier const, Channel *const>::const_iterator	itChan;
+	std::map<Identifier const, User *const>::const_iterator	itUser;
+	std::map<Identifier const, User *const>::iterator			it;
+
+	it = this->_lookupUsers.find(former);
+	if (it != this->_lookupUsers.end() && it->second == &user)
+		this->_lookupUsers.erase(it);
+	user.setNickname(nickname);
+	this->_lookupUsers.insert(std::pair<Identifier const, User *const>(user.getNicknameId(), &user));
+	for (itChan = user.getLookupChannels().begin() ; itChan != user.getLookupChannels().end() ; ++itChan)
+	{
+		itChan->second->renameUser(former, user);
+		for (itUser = itChan->second->begin() ; itUser != itChan->second->end() ; ++itUser)
+			if (itUser->second != &user && itUser->second->getSocket() != -1)
+				usersToNotice.insert(itUser->second);
+	}
+	if (user.getState() == User::REGISTERED)
+	{
+		if (!this->replyPush(user, line))
+			return false;
+		for (cit = usersToNotice.begin() ; cit != usersToNotice.end() ; ++cit)
+			if (!this->replyPush(**cit, line) || !this->replySend(**cit))
+				return false;
+	}
+	user.setMask();
+	// Changing the case of a nickname is no news to its watchers.
+	if (user.getState() == User::REGISTERED && former != user.getNicknameId() &&
+		(!this->notifyWatchers(former, false, formerName) ||
+		!this->notifyWatchers(user.getNicknameId(), true, user.getMask())))
+		return false;
+	return true;
+}
+
+/**
+ * @brief	Free the nickname of an user leaving, its watchers being told
+ * 			it is gone if it was registered.
+ * 			Nothing is done if the nickname is already taken by another user.
+ * 
+ * @param	user The user leaving.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::forgetNickname(User &user)
+{
+	std::map<Identifier const, User *const>::iterator	it;
+
+	it = this->_lookupUsers.find(user.getNicknameId());
+	if (it == this->_lookupUsers.end() || it->second != &user)
+		return true;
+	this->_lookupUsers.erase(it);
+	if (user.getState() != User::REGISTERED)
+		return true;
+	return this->notifyWatchers(user.getNicknameId(), false, user.getNickname());
+}
+
+/**
+ * @brief	Remove an user from the watchers index, for every nickname
+ * 			it monitors, then empty its own list.
+ * 
+ * @param	user The user to stop monitoring.
+ */
+void	Server::forgetWatcher(User &user)
+{
+	std::set<Identifier>::const_iterator						cit;
+	std::map<Identifier const, std::set<User *> >::iterator	it;
+
+	for (cit = user.getMonitors().begin() ; cit != user.getMonitors().end() ; ++cit)
+	{
+		it = this->_lookupWatchers.find(*cit);
+		if (it == this->_lookupWatchers.end())
+			continue ;
+		it->second.erase(&user);
+		if (it->second.empty())
+			this->_lookupWatchers.erase(it);
+	}
+	user.clearMonitors();
+}
+
+/**
+ * @brief	Tell the users monitoring a nickname that it is now used,
+ * 			or no longer. Only its watchers are looked at, however many
+ * 			users the server has.
+ * 
+ * @param	nickname The nickname.
+ * @param	isOnline Whether an user now has the nickname.
+ * @param	target The mask of the user having the nickname,
+ * 			or the nickname when it is no longer used.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::notifyWatchers(Identifier const &nickname, bool const isOnline, std::string const &target)
+{
+	std::map<Identifier const, std::set<User *> >::const_iterator	it;
+	std::set<User *>::const_iterator								cit;
+
+	it = this->_lookupWatchers.find(nickname);
+	if (it == this->_lookupWatchers.end())
+		return true;
+	for (cit = it->second.begin() ; cit != it->second.end() ; ++cit)
+		if (!(isOnline ? this->replyNumeric<RPL_MONONLINE>(**cit, target) : this->replyNumeric<RPL_MONOFFLINE>(**cit, target)) ||
+			!this->replySend(**cit))
+			return false;
+	return true;
+}
+
+/**
+ * @brief	Write a numeric reply straight into the message to send to an user
+ * 			client: the server prefix, the code, the nickname of the user,
+ * 			then the text with each '%' replaced by a parameter, in order.
+ * 			The line is cut to MAX_LINE_LENGTH, without splitting a character.
+ * 			See replyNumeric() for the typed version.
  * 
- * @param user The user to check if the PING is correct
- * @param params the value of the token send by ping
+ * @param	user The user to send the reply to.
+ * @param	rplNo The code of the reply.
+ * @param	format The text of the reply.
+ * @param	args The parameters of the reply.
+ * @param	nbArgs The number of parameters.
  * 
- * @return true if success, false otherwise.
+ * @return	true if success, false otherwise.
  */
-bool	Server::checkPONG(User &user, std::string const &params)
+bool	Server::pushNumeric(User &user, e_rplNo const rplNo, char const *const format, NumericArg const *const *const args, size_t const nbArgs)
 {
-	std::string	line;
+	char			line[MAX_LINE_LENGTH];
+	char const		*cit;
+	char const		*end;
+	size_t			size;
+	size_t			idx;
+	size_t			start;
+	unsigned char	lead;
 
-	if (params.empty())
-		return false;
-	line = params.substr(0, params.find('\n'));
-	Server::logMsg(RECEIVED, "(" + ft::toString(user.getSocket()) + ") " + line);
-		if (*(line.end() - 1) == '\r')
-			line.erase(line.end() - 1);
-	line.erase(0, line.find(":") + 1);
-	if (user.getNickname().compare(line) != 0)
-		return false;
-	user.setWaitingForPong(ALIVETIME);
-	return true;
+	size = std::min(this->_numericPrefix.size(), sizeof(line) - 4);
+	memcpy(line, this->_numericPrefix.data(), size);
+	line[size++] = static_cast<char>('0' + rplNo / 100);
+	line[size++] = static_cast<char>('0' + rplNo / 10 % 10);
+	line[size++] = static_cast<char>('0' + rplNo % 10);
+	line[size++] = ' ';
+	Server::appendLine(line, size, user.getNickname().data(), user.getNickname().size());
+	Server::appendLine(line, size, " ", 1);
+	for (cit = format, idx = 0 ; *cit ; cit = end + 1)
+	{
+		end = strchr(cit, '%');
+		if (!end || idx == nbArgs)
+		{
+			Server::appendLine(line, size, cit, strlen(cit));
+			break ;
+		}
+		Server::appendLine(line, size, cit, static_cast<size_t>(end - cit));
+		Server::appendLine(line, size, args[idx]->getData(), args[idx]->getSize());
+		++idx;
+	}
+	// A full line may have been cut in the middle of its last character.
+	if (size == sizeof(line))
+	{
+		for (start = size - 1 ; start && (line[start] & 0xC0) == 0x80 ; --start);
+		lead = static_cast<unsigned char>(line[start]);
+		if (size - start < static_cast<size_t>(lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1))
+			size = start;
+	}
+	return this->replyPush(user, line, size);
 }
 
 /**
- * @brief	Determine what to do depending on the given `msg`.
+ * @brief	Append a line to the message to send to an user client.
  * 
- * @param	user The user that sent the message.
- * @param	msg The raw message received from a client.
+ * @param	line The line to append.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::judge(User &user, std::string &msg)
+bool	Server::replyPush(User &user, std::string const &line)
 {
-	std::string													line;
-	std::string													prefix;
-	std::string													cmdName;
-	std::string													params;
-	std::map<std::string const, t_fct const>::const_iterator	it;
+	return this->replyPush(user, line.data(), line.size());
+}
 
-	do
+bool	Server::replyPush(User &user, ArenaString const &line)
+{
+	return this->replyPush(user, line.data(), line.size());
+}
+
+bool	Server::replyPush(User &user, char const *const line)
+{
+	return this->replyPush(user, line, strlen(line));
+}
+
+bool	Server::replyPush(User &user, char const *const line, size_t const size)
+{
+	char const	*code;
+
+	// An user of another server is sent its messages by the link to it.
+	if (user.getSocket() == -1 && user.isRemote())
+		return true;
+	// An error numeric (4xx, 5xx) marks the running command as failed.
+	code = line;
+	if (size && *line == ':')
 	{
-		line = msg.substr(0, msg.find('\n'));
-		if (*(line.end() - 1) == '\r')
-			line.erase(line.end() - 1);
-		if (line[0] == ':')
-			prefix = line.substr(1, line.find(' ') - 1);
-		cmdName = line.substr(prefix.length(), line.find(' ', prefix.length()));
-		if (cmdName.empty())
-			continue;
-		std::transform<std::string::iterator, std::string::iterator, int (*)(int const)>(cmdName.begin(), cmdName.end(), cmdName.begin(), ::toupper);
-		params = line.substr(cmdName.length());
-		params.erase(0, params.find_first_not_of(' '));
-		params.erase(params.find_last_not_of(' ') + 1);
-		it = this->_lookupCmds.find(cmdName);
-		if (it == this->_lookupCmds.end())
-			Server::logMsg(RECEIVED, "(" + ft::toString(user.getSocket()) + ") " + cmdName + ' ' + params + RED_FG " Unknown" RESET);
-		else
-		{
-			Server::logMsg(RECEIVED, "(" + ft::toString(user.getSocket()) + ") " + cmdName + ' ' + params);
-			if (!(this->*it->second)(user, params))
-				return false;
-		}
-		msg.erase(0, msg.find('\n') + 1);
-	} while (!msg.empty());
+		code = static_cast<char const *>(memchr(line, ' ', size));
+		code = (code ? code + 1 : line + size);
+	}
+	if (line + size - code > 3 && (code[0] == '4' || code[0] == '5') &&
+		isdigit(code[1]) && isdigit(code[2]) && code[3] == ' ')
+		this->_isCmdError = true;
+	++*this->_currentCmdMetrics->linesOut;
+	try
+	{
+		if (!user.getMsg().empty())
+			user.appendMsg("\n", 1);
+		user.appendMsg(line, size);
+	}
+	catch (std::exception const &e)
+	{
+		Server::logMsg(ERROR, "    Exception: " + std::string(e.what()));
+		return false;
+	}
 	return true;
 }
 
 /**
- * @brief	Write a formated log message to the standard output.
+ * @brief	Append some text to a line of MAX_LINE_LENGTH, as much as it fits.
  * 
- * @param	msg The message to write.
+ * @param	line The line to append the text to.
+ * @param	size The length of the line, updated.
+ * @param	data The text to append.
+ * @param	len The length of the text.
  */
-void	Server::logMsg(uint const type, std::string const &msg)
+void	Server::appendLine(char *const line, size_t &size, char const *const data, size_t const len)
 {
-	char	nowtime[64];
-	time_t	rawtime;
+	size_t const	n = std::min(len, MAX_LINE_LENGTH - size);
 
-	time(&rawtime);
-	strftime(nowtime, 64, "%Y/%m/%d %H:%M:%S", localtime(&rawtime));
-	std::cout << "[" << nowtime << "][" << this->_lookupLogMsgTypes[type] << "] " << msg << '\n';
+	memcpy(line + size, data, n);
+	size += n;
 }
 
 /**
- * @brief	Check every user socket connection, receive messages from
- * 			each of them, and process the received messages.
+ * @brief	Send a reply message to an user client.
+ * 
+ * @param	user The user to send the reply message to.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::recvAll(void)
+bool	Server::replySend(User &user)
 {
-	char						buff[BUFFER_SIZE + 1];
-	ssize_t						retRecv;
-	std::string					msg;
-	std::list<User>::iterator	it;
+	std::string const	&msgToSend = user.getMsg();
+	std::string const	origin = "(" + ft::toString(user.getSocket()) + ") ";
+	ArenaString			line;
+	char const			*c_msgToSend;
+	size_t				size;
+	size_t				pos;
+	size_t				end;
+	ssize_t				retSend;
 
-	if (poll(&_pollfds[0], _pollfds.size(), static_cast<int>(std::strtol(this->_config["timeout"].c_str(), NULL, 10))) == -1)
+	if (user.getSocket() == -1 && user.isRemote())
+		return true;
+	user.appendMsg("\r\n", 2);
+	c_msgToSend = msgToSend.data();
+	size = msgToSend.size();
+	this->_stats.sendq->observe(static_cast<double>(size));
+	// Nothing is sent ahead of what the socket still has to take.
+	while (size > 0 && user.getSendq().empty())
 	{
-		Server::logMsg(ERROR, "poll: " + std::string(strerror(errno)));
-		return false;
+		retSend = this->_transport->send(user.getSocket(), c_msgToSend, size);
+		// The other end is not waited for, the rest being sent by flushUser().
+		if (retSend < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			break ;
+		if (retSend < 0)
+		{
+			Server::logMsg(ERROR, "    send: " + std::string(strerror(errno)));
+			user.setMsg("");
+			return true;
+		}
+		*this->_stats.bytesOut += static_cast<unsigned long>(retSend);
+		c_msgToSend += retSend;
+		size -= static_cast<size_t>(retSend);
 	}
-	for (it = this->_users.begin() ; it != this->_users.end() ; ++it)
+	// Past its limit the connection is closed anyway, the rest is not kept.
+	if (size > 0 && user.getSendq().size() <= std::strtoul(this->_config[this->_lookupLinks.count(&user) ? "link_sendq" : "sendq"].c_str(), NULL, 10))
+		user.appendSendq(c_msgToSend, size);
+	for (pos = 0 ; pos < msgToSend.size() ; pos = end + 1)
 	{
-		retRecv = recv(it->getSocket(), buff, BUFFER_SIZE, MSG_DONTWAIT);
-		while (retRecv > 0)
+		end = msgToSend.find('\n', pos);
+		line.assign(origin.data(), origin.size());
+		line.append(msgToSend.data() + pos, end - pos - (end + 1 == msgToSend.size()));
+		Server::logMsg(SENT, line);
+	}
+	user.setMsg("");
+	return true;
+}
+
+/**
+ * @brief	Accept the metrics scrapers, and answer each complete request
+ * 			with the metrics rendered in the Prometheus text format.
+ * 			Every connection is closed once its answer is sent.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::serveMetrics(void)
+{
+	std::map<int const, std::pair<std::string, std::string> >::iterator	it;
+	std::string															body;
+	char																buff[BUFFER_SIZE];
+	ssize_t																ret;
+	int																	fd;
+	bool																isDone;
+
+	// The metrics socket, when enabled, always directly follows the thread pool eventfd.
+	if (this->_metricsSocket == -1)
+		return true;
+	if (this->_pollfds[2].revents & POLLIN)
+		while ((fd = accept(this->_metricsSocket, NULL, NULL)) != -1)
 		{
-			buff[retRecv] = 0;
-			msg.append(buff);
-			if (msg.find("\r\n") != std::string::npos)
-				break ;
-			retRecv = recv(it->getSocket(), buff, BUFFER_SIZE, MSG_DONTWAIT);
+			fcntl(fd, F_SETFL, O_NONBLOCK);
+			this->_metricsClients.insert(std::make_pair(fd, std::pair<std::string, std::string>()));
+			this->addPollfd(fd, POLLIN);
 		}
-		time_t	time_tmp;
-		time(&time_tmp);
-		if (time_tmp - it->getLastActivity() >= std::strtol(this->_config["ping"].c_str(), NULL, 10))
+
+	for (it = this->_metricsClients.begin() ; it != this->_metricsClients.end() ; )
+	{
+		std::string	&request = it->second.first;
+		std::string	&response = it->second.second;
+
+		isDone = false;
+		if (response.empty())
 		{
-			if (!it->getWaitingForPong())
-				this->checkStillAlive(*it);
-			else if ((it->getWaitingForPong() && time_tmp - it->getLastActivity() >= std::strtol(this->_config["timeout"].c_str(), NULL, 10)) || (!msg.empty() && !this->checkPONG(*it, msg))) 
+			ret = recv(it->first, buff, BUFFER_SIZE, MSG_DONTWAIT);
+			if (ret > 0)
+				request.append(buff, static_cast<size_t>(ret));
+			else if (!ret || (errno != EAGAIN && errno != EWOULDBLOCK))
+				isDone = true;
+			if (request.size() > BUFFER_SIZE)
+				isDone = true;
+			else if (request.find("\r\n\r\n") != std::string::npos || request.find("\n\n") != std::string::npos)
 			{
-				Server::logMsg(INTERNAL, "(" + ft::toString(it->getSocket()) + ") Connection lost");
-				close(it->getSocket());
-				it->setSocket(-1);
+				*this->_stats.users = static_cast<long>(this->_users.size());
+				*this->_stats.channels = static_cast<long>(this->_lookupChannels.size());
+				*this->_stats.servers = static_cast<long>(this->_lookupServers.size());
+				*this->_stats.remoteUsers = static_cast<long>(this->_remoteUsers.size());
+				*this->_stats.historyBytes = static_cast<long>(this->_history.used());
+				*this->_stats.historyEvictions = this->_history.getEvictions();
+				*this->_stats.arenaHeapAllocs = Arena::tick().getHeapAllocs();
+				*this->_stats.arenaPeak = static_cast<long>(Arena::tick().getPeak());
+				body = this->_metrics.render();
+				response = "HTTP/1.0 200 OK\r\n"
+					"Content-Type: text/plain; version=0.0.4\r\n"
+					"Content-Length: " + ft::toString(static_cast<int>(body.size())) + "\r\n"
+					"Connection: close\r\n\r\n" + body;
 			}
 		}
-		else if (!this->judge(*it, msg) || (!it->getMsg().empty() && !this->replySend(*it)))
-			return false;
-		if (retRecv > 0)
+		if (!isDone && !response.empty())
 		{
-			it->updateLastActivity();
+			ret = send(it->first, response.data(), response.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+			if (ret > 0)
+				response.erase(0, static_cast<size_t>(ret));
+			else if (errno != EAGAIN && errno != EWOULDBLOCK)
+				isDone = true;
+			if (response.empty())
+				isDone = true;
 		}
-		if (it->getSocket() == -1)
+		if (!isDone)
 		{
-			this->_lookupUsers.erase(it->getNickname());
-			it = this->_users.erase(it);
+			++it;
+			continue ;
 		}
-		msg.clear();
+		this->delPollfd(it->first);
+		close(it->first);
+		this->_metricsClients.erase(it++);
 	}
 	return true;
 }
 
 /**
- * @brief	Append a line to the message to send to an user client.
+ * @brief	Take the action of the spam filter against the sender of a message.
+ * 			A warned message is still delivered, a dropped one is not,
+ * 			and a killed sender is disconnected, the operators being told.
+ * 			Every catch is logged, to tune the patterns.
  * 
- * @param	line The line to append.
+ * @param	user The user that sent the message.
+ * @param	match What the spam filter found in the message.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::replyPush(User &user, std::string const &line)
+bool	Server::spamCaught(User &user, SpamFilter::t_match const &match)
 {
-	try
+	std::string const			text = std::string("Spam filter: ") + SpamFilter::getActionName(match.action) + ' ' + user.getMask() + " for \"" + this->_spamFilter.getPattern(match.pattern) + '"';
+	std::list<User>::iterator	it;
+
+	++*this->_stats.spamMatches[match.action];
+	Server::logMsg(INTERNAL, "(" + ft::toString(user.getSocket()) + ") " + text);
+	if (match.action != SpamFilter::KILL)
+		return true;
+	for (it = this->_users.begin() ; it != this->_users.end() ; ++it)
+		if (it->hasMode(User::OPERATOR) && it->getSocket() != -1 &&
+			(!this->notice(*it, text) || !this->replySend(*it)))
+			return false;
+	return this->kill(user, this->_config["server_name"], this->_config["server_name"], "Spam");
+}
+
+/**
+ * @brief	Split the parameters of a line from a linked server, the one
+ * 			starting with ':' taking the rest of the line.
+ * 
+ * @param	params The parameters.
+ * @param	args Where to add them.
+ */
+void	Server::splitParams(ArenaString const &params, t_params &args)
+{
+	ArenaString::size_type	pos;
+	ArenaString::size_type	end;
+
+	for (pos = params.find_first_not_of(' ') ; pos != ArenaString::npos ; pos = params.find_first_not_of(' ', end))
 	{
-		if (!user.getMsg().empty())
-			user.setMsg(user.getMsg() + '\n');
-		user.setMsg(user.getMsg() + line);
+		if (params[pos] == ':')
+		{
+			args.push_back(params.substr(pos + 1));
+			return ;
+		}
+		end = params.find(' ', pos);
+		args.push_back(params.substr(pos, end - pos));
+		if (end == ArenaString::npos)
+			return ;
 	}
-	catch (std::exception const &e)
+}
+
+/**
+ * @brief	Forget a server that left the network, with the servers behind it
+ * 			and their users, the members of their channels being told.
+ * 
+ * @param	name The name of the server.
+ * @param	reason Why it left.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::squit(std::string const &name, std::string const &reason)
+{
+	std::set<std::string>									gone;
+	std::set<std::string>::const_iterator					cit;
+	std::map<std::string const, t_server>::iterator			it;
+	std::list<User>::iterator								itUser;
+	bool													isGrown;
+
+	// The servers behind a gone server are gone too.
+	for (gone.insert(name), isGrown = true ; isGrown ; )
+		for (isGrown = false, it = this->_lookupServers.begin() ; it != this->_lookupServers.end() ; ++it)
+			if (!gone.count(it->first) && gone.count(it->second.uplink))
+				isGrown = gone.insert(it->first).second;
+	for (itUser = this->_remoteUsers.begin() ; itUser != this->_remoteUsers.end() ; )
 	{
-		Server::logMsg(ERROR, "    Exception: " + std::string(e.what()));
-		return false;
+		User	&user = *itUser++;
+
+		if (!gone.count(*user.getServer()))
+			continue ;
+		it = this->_lookupServers.find(*user.getServer());
+		if (!this->quitChannels(user, it->second.uplink + ' ' + it->first) ||
+			!this->removeRemoteUser(user))
+			return false;
+	}
+	for (cit = gone.begin() ; cit != gone.end() ; ++cit)
+	{
+		Server::logMsg(INTERNAL, "    Server " + *cit + " left the network: " + reason);
+		this->_lookupServers.erase(*cit);
 	}
 	return true;
 }
 
 /**
- * @brief	Send a reply message to an user client.
+ * @brief	Start the reverse lookup of the hostname of a new user,
+ * 			its IP address being used meanwhile.
+ * 			Answers come from the cache when possible, and concurrent lookups
+ * 			of the same address are merged into one.
  * 
- * @param	user The user to send the reply message to.
+ * @param	user The user to resolve the hostname of.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::replySend(User &user)
+bool	Server::resolve(User &user)
 {
-	std::string	line;
-	std::string	msgToSend = user.getMsg() + "\r\n";
-	char const	*c_msgToSend = msgToSend.c_str();
-	size_t		size = msgToSend.size();
-	ssize_t		retSend;
+	in_addr_t const														addr = user.getAddr().sin_addr.s_addr;
+	long const															timeout = std::strtol(this->_config["dns_timeout"].c_str(), NULL, 10);
+	time_t const														now = this->_clock->now();
+	std::map<in_addr_t const, std::pair<std::string, time_t> >::const_iterator	cit;
+	Job																	*job;
 
-	while (size > 0)
+	user.setHostname(inet_ntoa(user.getAddr().sin_addr));
+	if (timeout <= 0)
+		return true;
+	cit = this->_lookupHostnames.find(addr);
+	if (cit != this->_lookupHostnames.end() && cit->second.second > now)
 	{
-		retSend = send(user.getSocket(), c_msgToSend, size, 0);
-		if (retSend < 0)
-		{
-			Server::logMsg(ERROR, "    send: " + std::string(strerror(errno)));
-			user.setMsg("");
+		if (!cit->second.first.empty())
+			user.setHostname(cit->second.first);
+		return true;
+	}
+	try
+	{
+		user.setIsResolving(true);
+		user.setResolveDeadline(now + timeout);
+		this->_lookupResolving.insert(std::pair<in_addr_t const, User *const>(addr, &user));
+		if (this->_lookupResolving.count(addr) > 1)
 			return true;
-		}
-		c_msgToSend += retSend;
-		size -= static_cast<size_t>(retSend);
+		job = new ResolveJob(&Server::DNSdone, user.getAddr().sin_addr);
 	}
-	while (!msgToSend.empty())
+	catch (std::exception const &e)
 	{
-		line = msgToSend.substr(0, msgToSend.find('\n'));
-		msgToSend.erase(0, msgToSend.find('\n') + 1);
-		if (msgToSend.empty())
-			line.erase(line.end() - 1);
-		Server::logMsg(SENT, "(" + ft::toString(user.getSocket()) + ") " + line);
+		Server::logMsg(ERROR, "    Exception: " + std::string(e.what()));
+		return false;
 	}
-	user.setMsg("");
+	return this->async(job);
+}
+
+/**
+ * @brief	Run one iteration of the event loop.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::tick(void)
+{
+	double	iterationStart;
+
+	iterationStart = Metrics::now();
+	this->_watchdog.start();
+	if (!this->welcomeDwarves() ||
+		!this->recvAll())
+		return false;
+	// Nothing parsed or built during the iteration outlives it.
+	Arena::tick().reset();
+	if (this->_watchdog.finish())
+		this->logSlowTick();
+	this->_stats.loopIteration->observe(Metrics::now() - iterationStart);
 	return true;
 }
 
 /**
- * @brief	Accept the new clients connection and create users for each one.
+ * @brief	Accept every pending client connection and create users for each one.
+ * 			A new user has `register_timeout` seconds to get registered.
+ * 			None is accepted while an upgrade is waiting for the jobs in flight.
  * 
  * @return	true if success, false otherwise.
  */
 bool	Server::welcomeDwarves(void)
 {
 	sockaddr_in	addr = {};
-	socklen_t	addrlen = sizeof(addr);
 	int			newUser;
+	time_t		now;
 
-	newUser = accept(this->_socket, reinterpret_cast<sockaddr *>(&addr), &addrlen);
-	if (newUser != -1)
+	// While an upgrade is waiting, the connections are left to the upgraded server.
+	if (g_upgrade)
+		return true;
+	while ((newUser = this->_transport->accept(this->_socket, addr)) != -1)
 	{
+		++*this->_stats.connections;
+		this->_capture.open(newUser);
+		now = this->_clock->now();
 		this->_users.push_back(User());
 		this->_users.back().setAddr(addr);
 		this->_users.back().setSocket(newUser);
-		this->_lookupUsers.insert(std::pair<std::string, User *const>(this->_users.back().getNickname(), &this->_users.back()));
-		this->_pollfds.push_back(pollfd());
-		this->_pollfds.back().fd = newUser;
-		this->_pollfds.back().events = POLLIN | POLLOUT;
-		fcntl(newUser, F_SETFL, O_NONBLOCK | O_DIRECT);
+		this->_users.back().updateLastActivity(now);
+		if (this->_config["server_password"].empty())
+			this->_users.back().setState(User::AUTHENTICATED);
+		this->_users.back().setRegisterDeadline(now + std::strtol(this->_config["register_timeout"].c_str(), NULL, 10));
+		this->_lookupSockets.insert(std::pair<int const, User *const>(newUser, &this->_users.back()));
+		this->_registrationTimers.insert(std::pair<time_t const, int const>(this->_users.back().getRegisterDeadline(), newUser));
+		this->addPollfd(newUser, POLLIN | POLLOUT);
 		Server::logMsg(INTERNAL, "(" + ft::toString(this->_users.back().getSocket()) + ") Connection established");
+		if (!this->resolve(this->_users.back()))
+			return false;
 	}
 	return true;
 }
@@ -314,20 +2230,42 @@ bool	Server::welcomeDwarves(void)
 
 /**
  * @brief	Configure the internal attributes of the server.
+ * 			The server password is only kept hashed.
+ * 
+ * @param	password The server password, either plaintext or already hashed.
+ * @param	configFile The configuration file to read.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::init(std::string const &password)
+bool	Server::init(std::string const &password, std::string const &configFile)
 {
-	char	nowtime[64];
-	time_t	rawtime;
-	uint	idx;
+	char					nowtime[64];
+	time_t const			rawtime = this->_clock->now();
+	uint					idx;
+	std::string				links;
+	std::string				target;
+	std::string::size_type	pos;
+	std::string::size_type	end;
+	t_connect				connect;
 
-	this->_config.init("config/default.conf");
-	this->_config["server_password"] = password;
-	time(&rawtime);
+	this->_configFile = configFile;
+	this->_config.init(configFile.c_str());
+	if (password.empty() || !password.compare(0, 4, "$2b$"))
+		this->_config["server_password"] = password;
+	else
+	{
+		this->_config["server_password"] = ft::hashPassword(password);
+		if (this->_config["server_password"].empty())
+		{
+			Server::logMsg(ERROR, "    Failed to hash the server password");
+			return false;
+		}
+	}
 	strftime(nowtime, 64, "%Y/%m/%d %H:%M:%S", localtime(&rawtime));
 	this->_creationTime = nowtime;
+	this->_numericPrefix = ':' + this->_config["server_name"] + ' ';
+	if (!this->initSupport())
+		return false;
 	for (idx = 0U ; Server::_arrayCmds[idx].second ; ++idx)
 		try
 		{
@@ -338,6 +2276,63 @@ bool	Server::init(std::string const &password)
 			Server::logMsg(ERROR, std::string("    Exception: ") + e.what());
 			return false;
 		}
+	for (idx = 0U ; Server::_arrayLinkCmds[idx].second ; ++idx)
+		try
+		{
+			this->_lookupLinkCmds.insert(Server::_arrayLinkCmds[idx]);
+		}
+		catch (std::exception const &e)
+		{
+			Server::logMsg(ERROR, std::string("    Exception: ") + e.what());
+			return false;
+		}
+	// The servers to link to: `host:port`, separated by commas.
+	links = this->_config["links"];
+	for (pos = 0 ; pos < links.size() ; pos = end + 1)
+	{
+		end = links.find(',', pos);
+		if (end == std::string::npos)
+			end = links.size();
+		target = links.substr(pos, end - pos);
+		target.erase(0, target.find_first_not_of(" \t"));
+		target.erase(target.find_last_not_of(" \t") + 1);
+		if (target.empty())
+			continue ;
+		connect.host = target.substr(0, target.rfind(':'));
+		connect.port = static_cast<uint16_t>(std::strtol(target.substr(target.rfind(':') + 1).c_str(), NULL, 10));
+		connect.nextAttempt = 0;
+		connect.isPending = false;
+		if (target.find(':') == std::string::npos || !connect.port)
+		{
+			Server::logMsg(ERROR, "    Bad link \"" + target + "\", expected host:port");
+			return false;
+		}
+		this->_lookupConnects.insert(std::make_pair(connect.host + ':' + ft::toString(connect.port), connect));
+	}
+	for (idx = 0U ; Server::_arrayRegistrationCmds[idx] ; ++idx)
+		try
+		{
+			this->_lookupRegistrationCmds.insert(Server::_arrayRegistrationCmds[idx]);
+		}
+		catch (std::exception const &e)
+		{
+			Server::logMsg(ERROR, std::string("    Exception: ") + e.what());
+			return false;
+		}
+	if (!this->initMetrics())
+		return false;
+	if (!this->_config["spam_filter"].empty())
+	{
+		ReadFileJob	file(NULL, NULL, this->_config["spam_filter"]);
+		std::string	error;
+
+		file.execute();
+		if (!this->loadSpamFilter(file, error))
+		{
+			Server::logMsg(ERROR, "    Spam filter: " + this->_config["spam_filter"] + ": " + error);
+			return false;
+		}
+	}
 	for (idx = 0U ; Server::_arrayLogMsgTypes[idx].second ; ++idx)
 		try
 		{
@@ -359,15 +2354,44 @@ bool	Server::init(std::string const &password)
  */
 bool	Server::run(void)
 {
-	static struct timespec			t0 = {0, 50000};
-	static struct timespec			t1 = {0, 0};
-	std::map<int, User>::iterator	it;
+	static struct timespec	t0 = {0, 50000};
+	static struct timespec	t1 = {0, 0};
+	time_t					now;
 
 	while (this->_state == RUNNING)
 	{
-		if (!this->welcomeDwarves() ||
-			!this->recvAll() ||
-			nanosleep(&t0, &t1) ||
+		if (!this->tick())
+		{
+			this->stop();
+			return false;
+		}
+		// The jobs in flight are tied to this process: the upgrade waits for them,
+		// no new one being started meanwhile, at most `upgrade_wait` seconds.
+		if (g_upgrade)
+		{
+			now = this->_clock->now();
+			if (!this->_upgradeDeadline)
+			{
+				this->_upgradeDeadline = now + std::strtol(this->_config["upgrade_wait"].c_str(), NULL, 10);
+				if (this->_jobsInFlight)
+					Server::logMsg(INTERNAL, "Upgrade waiting for " + ft::toString(static_cast<int>(this->_jobsInFlight)) + " jobs in flight");
+			}
+			if (!this->_jobsInFlight)
+			{
+				g_upgrade = false;
+				this->_upgradeDeadline = 0;
+				if (this->upgrade())
+					return true;
+			}
+			else if (now > this->_upgradeDeadline)
+			{
+				g_upgrade = false;
+				this->_upgradeDeadline = 0;
+				Server::logMsg(ERROR, "Upgrade abandoned: " + ft::toString(static_cast<int>(this->_jobsInFlight)) +
+					" jobs still in flight after " + this->_config["upgrade_wait"] + " seconds, still serving");
+			}
+		}
+		if ((nanosleep(&t0, &t1) && errno != EINTR) ||
 			g_interrupted == true)
 		{
 			this->stop();
@@ -377,6 +2401,28 @@ bool	Server::run(void)
 	return true;
 }
 
+/**
+ * @brief	Replace the wall clock the timers run on.
+ * 			To be called before init(), the clock outliving the server.
+ * 
+ * @param	clock The clock to use.
+ */
+void	Server::setClock(Clock &clock)
+{
+	this->_clock = &clock;
+}
+
+/**
+ * @brief	Replace the TCP network the clients connect through.
+ * 			To be called before start(), the transport outliving the server.
+ * 
+ * @param	transport The transport to use.
+ */
+void	Server::setTransport(Transport &transport)
+{
+	this->_transport = &transport;
+}
+
 /**
  * @brief	Start the server, configuring the socket and the port for listening.
  * 
@@ -386,48 +2432,18 @@ bool	Server::run(void)
  */
 bool	Server::start(uint16_t const port)
 {
-	int			optval;
-	sockaddr_in	addr;
+	std::string	error;
 
-	this->_socket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	this->_socket = this->_transport->listen(this->_config["host"], port, error);
 	if (this->_socket == -1)
 	{
-		Server::logMsg(ERROR, "socket: " + std::string(strerror(errno)));
-		return false;
-	}
-	Server::logMsg(INTERNAL, "(" + ft::toString(this->_socket) + ") Socket created");
-
-	optval = 1;
-	if (setsockopt(this->_socket, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)))
-	{
-		Server::logMsg(ERROR, "setsockopt: " + std::string(strerror(errno)));
-		this->stop();
-		return false;
-	}
-	Server::logMsg(INTERNAL, "(" + ft::toString(this->_socket) + ") Socket options set");
-
-	addr.sin_addr.s_addr = inet_addr(this->_config["host"].c_str());
-	addr.sin_port = htons(port);
-	addr.sin_family = AF_INET;
-	if (bind(this->_socket, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)))
-	{
-		Server::logMsg(ERROR, "bind: " + std::string(strerror(errno)));
+		Server::logMsg(ERROR, error);
 		this->stop();
 		return false;
 	}
-	Server::logMsg(INTERNAL, "(" + ft::toString(this->_socket) + ") Socket bound");
-	if (listen(this->_socket, SOMAXCONN))
-	{
-		Server::logMsg(ERROR, "listen: " + std::string(strerror(errno)));
-		this->stop();
-		return false;
-	}
-	Server::logMsg(INTERNAL, "(" + ft::toString(this->_socket) + ") Socket listening");
-	_pollfds.push_back(pollfd());
-	_pollfds.back().fd = this->_socket;
-	_pollfds.back().events = POLLIN | POLLOUT;
-	this->_state = RUNNING;
-	return true;
+	Server::logMsg(INTERNAL, "(" + ft::toString(this->_socket) + ") Socket listening on " + this->_config["host"] + ':' + ft::toString(port));
+	this->addPollfd(this->_socket, POLLIN | POLLOUT);
+	return this->launch();
 }
 
 /**
@@ -437,13 +2453,46 @@ bool	Server::start(uint16_t const port)
 void	Server::stop(void)
 {
 	Server::logMsg(INTERNAL, "    Server stopped");
+	this->_pool.stop();
+	this->_capture.stop();
+	// A server handed over leaves the snapshot to the new process.
+	if (this->_nextSnapshot && this->_state != HANDED_OVER)
+		this->writeSnapshot();
+	if (this->_nextSnapshot)
+		Channel::track(false);
+	this->_nextSnapshot = 0;
 	this->_lookupLogMsgTypes.clear();
 	this->_lookupChannels.clear();
+	this->_history.stop();
+	this->_snapshotRecords.clear();
+	this->_lookupResolving.clear();
+	this->_registrationTimers.clear();
+	this->_lookupSockets.clear();
+	this->_lookupPollfds.clear();
+	this->_pollfds.clear();
 	this->_lookupUsers.clear();
 	this->_lookupCmds.clear();
-	this->_users.clear();
+	this->_lookupLinkCmds.clear();
+	this->_lookupLinks.clear();
+	this->_lookupServers.clear();
+	this->_lookupConnects.clear();
+	this->_lookupRemoteUsers.clear();
+	this->_remoteUsers.clear();
+	for ( ; !this->_users.empty() ; this->_users.pop_front())
+		if (this->_users.front().getSocket() != -1)
+			this->_transport->close(this->_users.front().getSocket());
 	if (this->_socket != -1)
-		close(this->_socket);
+		this->_transport->close(this->_socket);
 	this->_socket = -1;
+	for ( ; !this->_metricsClients.empty() ; this->_metricsClients.erase(this->_metricsClients.begin()))
+		close(this->_metricsClients.begin()->first);
+	if (this->_metricsSocket != -1)
+	{
+		close(this->_metricsSocket);
+		// A socket handed over is the other process' too: its path is left.
+		if (this->_state != HANDED_OVER && !this->_config["metrics_listen"].compare(0, 5, "unix:"))
+			unlink(this->_config["metrics_listen"].c_str() + 5);
+	}
+	this->_metricsSocket = -1;
 	this->_state = STOPPED;
 }
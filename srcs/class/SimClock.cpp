@@ -0,0 +1,39 @@
+#include "class/SimClock.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+SimClock::SimClock(time_t const start) :
+	Clock(),
+	_now(start) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+SimClock::~SimClock(void) {}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Move the time forward.
+ * 
+ * @param	seconds The number of seconds to elapse.
+ */
+void	SimClock::advance(time_t const seconds)
+{
+	this->_now += seconds;
+}
+
+time_t	SimClock::now(void) const
+{
+	return this->_now;
+}
+
+uint64_t	SimClock::milliseconds(void) const
+{
+	return static_cast<uint64_t>(this->_now) * 1000UL;
+}
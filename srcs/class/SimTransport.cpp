@@ -0,0 +1,253 @@
+#include <cerrno>
+#include "class/SimTransport.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+SimTransport::SimTransport(void) :
+	Transport(),
+	_conns(),
+	_backlog(),
+	_realFds(),
+	_realIdx(),
+	_listener(-1),
+	_nextFd(SIM_FD_BASE) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+SimTransport::~SimTransport(void) {}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Open a connection to the server, pending until it gets accepted.
+ * 
+ * @param	addr The address of the client.
+ * 
+ * @return	The descriptor of the connection.
+ */
+int	SimTransport::connect(sockaddr_in const &addr)
+{
+	t_conn	&conn = this->_conns[this->_nextFd];
+
+	conn.addr = addr;
+	conn.isClientClosed = false;
+	conn.isServerClosed = false;
+	this->_backlog.push_back(this->_nextFd);
+	return this->_nextFd++;
+}
+
+/**
+ * @brief	Send data to the server, as the client.
+ * 
+ * @param	fd The descriptor of the connection.
+ * @param	data The data to send.
+ */
+void	SimTransport::write(int const fd, std::string const &data)
+{
+	std::map<int, t_conn>::iterator	it;
+
+	it = this->_conns.find(fd);
+	if (it != this->_conns.end() && !it->second.isServerClosed)
+		it->second.toServer += data;
+}
+
+/**
+ * @brief	Take everything the server sent, as the client.
+ * 			The connection is released once the server closed it
+ * 			and everything it sent was read.
+ * 
+ * @param	fd The descriptor of the connection.
+ * @param	data The string to append the received data to.
+ * 
+ * @return	Either true if the connection is still open, or false if not.
+ */
+bool	SimTransport::read(int const fd, std::string &data)
+{
+	std::map<int, t_conn>::iterator	it;
+
+	it = this->_conns.find(fd);
+	if (it == this->_conns.end())
+		return false;
+	data += it->second.toClient;
+	it->second.toClient.clear();
+	if (!it->second.isServerClosed)
+		return true;
+	this->_conns.erase(it);
+	return false;
+}
+
+/**
+ * @brief	Close a connection, as the client.
+ * 			The server reads the end of file once it received everything else.
+ * 
+ * @param	fd The descriptor of the connection.
+ */
+void	SimTransport::shutdown(int const fd)
+{
+	std::map<int, t_conn>::iterator	it;
+
+	it = this->_conns.find(fd);
+	if (it == this->_conns.end())
+		return ;
+	if (it->second.isServerClosed)
+		this->_conns.erase(it);
+	else
+		it->second.isClientClosed = true;
+}
+
+/**
+ * @brief	Get the number of connections at least one side still holds.
+ */
+size_t	SimTransport::size(void) const
+{
+	return this->_conns.size();
+}
+
+void	SimTransport::close(int const fd)
+{
+	std::map<int, t_conn>::iterator	it;
+
+	if (fd == this->_listener)
+	{
+		this->_listener = -1;
+		return ;
+	}
+	it = this->_conns.find(fd);
+	if (it == this->_conns.end())
+		return ;
+	if (it->second.isClientClosed)
+		this->_conns.erase(it);
+	else
+	{
+		it->second.isServerClosed = true;
+		it->second.toServer.clear();
+	}
+}
+
+int	SimTransport::accept(int const listener, sockaddr_in &addr)
+{
+	int	fd;
+
+	if (listener != this->_listener || this->_backlog.empty())
+	{
+		errno = EAGAIN;
+		return -1;
+	}
+	fd = this->_backlog.front();
+	this->_backlog.pop_front();
+	addr = this->_conns[fd].addr;
+	return fd;
+}
+
+/**
+ * @brief	The simulated network only has clients: no server can be linked.
+ */
+int	SimTransport::connect(std::string const &host __attribute__((unused)), uint16_t const port __attribute__((unused)), std::string &error)
+{
+	errno = ENETUNREACH;
+	error = "connect: no server to link on the simulated network";
+	return -1;
+}
+
+int	SimTransport::listen(std::string const &host __attribute__((unused)), uint16_t const port __attribute__((unused)), std::string &error)
+{
+	if (this->_listener != -1)
+	{
+		error = "listen: already listening";
+		return -1;
+	}
+	this->_listener = this->_nextFd++;
+	return this->_listener;
+}
+
+/**
+ * @brief	Tell which descriptors are ready, without ever waiting.
+ * 			The real descriptors mixed in are polled by the system.
+ */
+int	SimTransport::poll(pollfd *const fds, nfds_t const nfds, int const timeout __attribute__((unused)))
+{
+	std::map<int, t_conn>::const_iterator	cit;
+	nfds_t									idx;
+	int										ready;
+
+	this->_realFds.clear();
+	this->_realIdx.clear();
+	for (idx = 0, ready = 0 ; idx < nfds ; ++idx)
+	{
+		fds[idx].revents = 0;
+		if (fds[idx].fd < SIM_FD_BASE)
+		{
+			this->_realFds.push_back(fds[idx]);
+			this->_realIdx.push_back(idx);
+			continue ;
+		}
+		if (fds[idx].fd == this->_listener)
+			fds[idx].revents = (this->_backlog.empty() ? 0 : POLLIN);
+		else if ((cit = this->_conns.find(fds[idx].fd)) == this->_conns.end())
+			fds[idx].revents = POLLNVAL;
+		else
+			fds[idx].revents = static_cast<short>(
+				(cit->second.toServer.empty() ? 0 : POLLIN) |
+				(cit->second.isClientClosed ? POLLHUP : POLLOUT));
+		fds[idx].revents &= static_cast<short>(fds[idx].events | POLLHUP | POLLNVAL);
+		ready += (fds[idx].revents != 0);
+	}
+	if (this->_realFds.empty())
+		return ready;
+	if (::poll(&this->_realFds[0], this->_realFds.size(), 0) == -1)
+		return -1;
+	for (idx = 0 ; idx < this->_realFds.size() ; ++idx)
+	{
+		fds[this->_realIdx[idx]].revents = this->_realFds[idx].revents;
+		ready += (this->_realFds[idx].revents != 0);
+	}
+	return ready;
+}
+
+ssize_t	SimTransport::recv(int const fd, char *const buff, size_t const size)
+{
+	std::map<int, t_conn>::iterator	it;
+	size_t							len;
+
+	it = this->_conns.find(fd);
+	if (it == this->_conns.end() || it->second.isServerClosed)
+	{
+		errno = EBADF;
+		return -1;
+	}
+	if (it->second.toServer.empty())
+	{
+		if (it->second.isClientClosed)
+			return 0;
+		errno = EAGAIN;
+		return -1;
+	}
+	len = it->second.toServer.copy(buff, size);
+	it->second.toServer.erase(0, len);
+	return static_cast<ssize_t>(len);
+}
+
+ssize_t	SimTransport::send(int const fd, char const *const buff, size_t const size)
+{
+	std::map<int, t_conn>::iterator	it;
+
+	it = this->_conns.find(fd);
+	if (it == this->_conns.end() || it->second.isServerClosed)
+	{
+		errno = EBADF;
+		return -1;
+	}
+	if (it->second.isClientClosed)
+	{
+		errno = EPIPE;
+		return -1;
+	}
+	it->second.toClient.append(buff, size);
+	return static_cast<ssize_t>(size);
+}
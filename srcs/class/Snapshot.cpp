@@ -0,0 +1,260 @@
+#include <algorithm> // sort, unique
+#include <cerrno>
+#include <cstdio> // rename
+#include <cstring> // strerror
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "class/Server.hpp"
+#include "ft.hpp"
+
+/*
+	Snapshot: the settings of the channels (topic, key, modes, limit,
+	timestamp and bans, not the members) survive a restart, or a crash,
+	in the `snapshot_file`, see SnapshotJob for its format.
+
+	Every `snapshot_interval` seconds, the event loop encodes again the
+	channels created, changed or destroyed meanwhile (Channel::takeChanges()),
+	into the records of the snapshot, then a worker thread puts the records
+	together into a temporary file, renamed over the snapshot once synced.
+	Nothing is written if no channel changed.
+	On startup, the channels of the snapshot are dormant: they come back
+	with their settings once someone joins them, and are only decoded then.
+*/
+
+// ************************************************************************** //
+//                          Private Member Functions                          //
+// ************************************************************************** //
+
+/**
+ * @brief	Tell a dormant channel is live again, or replaced by the one of
+ * 			the network: it is no longer kept once it disappears.
+ * 
+ * @param	name The name of the channel.
+ */
+void	Server::forgetDormant(Identifier const &name)
+{
+	SnapshotJob::t_records::iterator	record = this->_snapshotRecords.find(name);
+
+	if (record != this->_snapshotRecords.end())
+		record->second.isDormant = false;
+}
+
+/**
+ * @brief	Read the channels of the snapshot, mapped in memory, as dormant
+ * 			channels, only their names being decoded. A missing snapshot is
+ * 			an empty one, and a corrupt one is moved aside to
+ * 			`<snapshot_file>.corrupt`.
+ */
+void	Server::loadSnapshot(void)
+{
+	std::string const					&path = this->_config["snapshot_file"];
+	double const						start = Metrics::now();
+	SnapshotJob::t_record const			dormant = {std::string(), true};
+	SnapshotJob::t_records::iterator	record;
+	std::string							error;
+	std::string							magic;
+	std::string							settings;
+	struct stat							st;
+	void								*data;
+	uint64_t							nb;
+	bool								isValid;
+	int									fd;
+
+	fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+	{
+		if (errno != ENOENT)
+			Server::logMsg(ERROR, "Snapshot: " + path + ": " + std::string(strerror(errno)));
+		return ;
+	}
+	data = MAP_FAILED;
+	if (fstat(fd, &st) == -1)
+		error = strerror(errno);
+	else if (!st.st_size)
+		error = "empty file";
+	else if ((data = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+		error = strerror(errno);
+	close(fd);
+	if (!error.empty())
+	{
+		Server::logMsg(ERROR, "Snapshot: " + path + ": " + error);
+		return ;
+	}
+	madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+	StateReader	state(static_cast<char const *>(data), static_cast<size_t>(st.st_size));
+
+	magic = state.getString();
+	isValid = magic == SNAPSHOT_MAGIC;
+	for (nb = isValid ? state.getVarint() : 0UL ; nb && isValid ; --nb)
+	{
+		settings = state.getString();
+
+		StateReader	name(settings.data(), settings.size());
+
+		// The snapshot is sorted, each channel goes at the end of the lookup.
+		record = this->_snapshotRecords.insert(this->_snapshotRecords.end(), std::make_pair(Identifier(name.getString()), dormant));
+		record->second.data.swap(settings);
+		isValid = state.isValid() && name.isValid() && !record->first.empty();
+	}
+	isValid = isValid && state.isValid() && state.atEnd();
+	munmap(data, static_cast<size_t>(st.st_size));
+	if (!isValid)
+	{
+		this->_snapshotRecords.clear();
+		Server::logMsg(ERROR, "Snapshot: " + path + " is corrupt, moved to " + path + ".corrupt");
+		std::rename(path.c_str(), (path + ".corrupt").c_str());
+		return ;
+	}
+	Server::logMsg(INTERNAL, "    Snapshot: " + ft::toString(static_cast<int>(this->_snapshotRecords.size())) + " channels loaded from " +
+		path + " in " + ft::toString(static_cast<int>((Metrics::now() - start) * 1e6)) + " us");
+}
+
+/**
+ * @brief	Write a snapshot by a worker thread, if `snapshot_interval`
+ * 			seconds elapsed since the previous one, the previous one is
+ * 			written already, and no upgrade is waiting for the jobs in flight.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::snapshot(void)
+{
+	time_t const	now = this->_clock->now();
+	Job				*job;
+
+	if (g_upgrade || !this->_nextSnapshot || this->_isSnapshotPending || now < this->_nextSnapshot)
+		return true;
+	this->_nextSnapshot = now + std::strtol(this->_config["snapshot_interval"].c_str(), NULL, 10);
+	if (!this->updateSnapshot())
+		return true;
+	try
+	{
+		job = new SnapshotJob(&Server::SNAPSHOTdone, this->_config["snapshot_file"], this->_snapshotRecords);
+	}
+	catch (std::exception const &e)
+	{
+		Server::logMsg(ERROR, "    Exception: " + std::string(e.what()));
+		return false;
+	}
+	this->_isSnapshotStale = false;
+	this->_isSnapshotPending = true;
+	return this->async(job);
+}
+
+/**
+ * @brief	Encode again the channels created, changed or destroyed since
+ * 			the previous call into the records of the snapshot, a dormant
+ * 			channel nobody could join being kept.
+ * 			No worker thread may be writing the records meanwhile.
+ * 
+ * @return	true if the snapshot file is to be written again,
+ * 			false if it is still up to date.
+ */
+bool	Server::updateSnapshot(void)
+{
+	SnapshotJob::t_record const							live = {std::string(), false};
+	std::vector<Identifier>								changes;
+	std::vector<Identifier>::const_iterator				name;
+	std::map<Identifier const, Channel>::const_iterator	chan;
+	SnapshotJob::t_records::iterator					record;
+
+	Channel::takeChanges(changes);
+	std::sort(changes.begin(), changes.end());
+	changes.erase(std::unique(changes.begin(), changes.end()), changes.end());
+	for (name = changes.begin() ; name != changes.end() ; ++name)
+	{
+		chan = this->_lookupChannels.find(*name);
+		record = this->_snapshotRecords.find(*name);
+		if (chan == this->_lookupChannels.end())
+		{
+			if (record != this->_snapshotRecords.end() && !record->second.isDormant)
+			{
+				this->_snapshotRecords.erase(record);
+				this->_isSnapshotStale = true;
+			}
+			continue ;
+		}
+		if (record == this->_snapshotRecords.end())
+			record = this->_snapshotRecords.insert(std::make_pair(chan->first, live)).first;
+
+		StateWriter	settings;
+
+		chan->second.save(settings);
+		record->second.data = settings.getData();
+		record->second.isDormant = false;
+		this->_isSnapshotStale = true;
+	}
+	return this->_isSnapshotStale;
+}
+
+/**
+ * @brief	Give a channel about to be created the settings it had in the
+ * 			snapshot, if it is dormant there.
+ * 
+ * @param	channel The channel about to be created.
+ * 
+ * @return	true if the channel got its settings back, false otherwise.
+ */
+bool	Server::wakeChannel(Channel &channel)
+{
+	SnapshotJob::t_records::const_iterator	record = this->_snapshotRecords.find(channel.getNameId());
+
+	if (record == this->_snapshotRecords.end() || !record->second.isDormant)
+		return false;
+
+	StateReader	state(record->second.data.data(), record->second.data.size());
+	Channel		settings;
+
+	settings.load(state);
+	if (!state.isValid() || !state.atEnd() || settings.getNameId() != channel.getNameId())
+	{
+		Server::logMsg(ERROR, "Snapshot: " + channel.getName() + " is corrupt, created again");
+		return false;
+	}
+	channel = settings;
+	return true;
+}
+
+/**
+ * @brief	Write a snapshot right away, on the event loop, if a channel
+ * 			changed since the previous one.
+ */
+void	Server::writeSnapshot(void)
+{
+	// The snapshot in flight may never have been written.
+	if (this->_isSnapshotPending)
+		this->_isSnapshotStale = true;
+	this->_isSnapshotPending = false;
+	if (!this->updateSnapshot())
+		return ;
+
+	SnapshotJob	file(NULL, this->_config["snapshot_file"], this->_snapshotRecords);
+
+	this->_isSnapshotStale = false;
+	file.execute();
+	this->SNAPSHOTdone(file);
+}
+
+/**
+ * @brief	Tell how writing a snapshot went. A snapshot that could not be
+ * 			written is written again next time, even if nothing changed.
+ * 
+ * @param	job The completed SnapshotJob.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::SNAPSHOTdone(Job &job)
+{
+	WriteFileJob const	&file = static_cast<WriteFileJob const &>(job);
+
+	this->_isSnapshotPending = false;
+	if (!file.getError().empty())
+	{
+		Server::logMsg(ERROR, "Snapshot: " + file.getPath() + ": " + file.getError());
+		this->_isSnapshotStale = true;
+		return true;
+	}
+	Server::logMsg(INTERNAL, "    Snapshot: " + ft::toString(static_cast<int>(this->_snapshotRecords.size())) + " channels (" +
+		ft::toString(static_cast<int>(file.getData().size())) + " bytes) written to " + file.getPath());
+	return true;
+}
@@ -0,0 +1,41 @@
+#include "class/SnapshotJob.hpp"
+#include "class/StateWriter.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+SnapshotJob::SnapshotJob(t_done const done, std::string const &path, t_records const &records) :
+	WriteFileJob(NULL, done, path, std::string()),
+	_records(records) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+SnapshotJob::~SnapshotJob(void) {}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Put the records together, then replace the snapshot file with them.
+ * 			Run on a worker thread.
+ */
+void	SnapshotJob::execute(void)
+{
+	StateWriter					state;
+	t_records::const_iterator	cit;
+	size_t						size;
+
+	for (cit = this->_records.begin(), size = 0UL ; cit != this->_records.end() ; ++cit)
+		size += cit->second.data.size() + 2UL;
+	state.reserve(size + sizeof(SNAPSHOT_MAGIC) + 10UL);
+	state.putString(SNAPSHOT_MAGIC);
+	state.putVarint(this->_records.size());
+	for (cit = this->_records.begin() ; cit != this->_records.end() ; ++cit)
+		state.putString(cit->second.data);
+	this->_data = state.getData();
+	WriteFileJob::execute();
+}
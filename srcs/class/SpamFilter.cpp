@@ -0,0 +1,346 @@
+#include <algorithm> // swap, swap_ranges
+#include <cctype>
+#include <map>
+#include <queue>
+#include "class/SpamFilter.hpp"
+#include "ft.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+# define SPAMFILTER_X86
+#endif
+
+// ************************************************************************** //
+//                             Private Attributes                             //
+// ************************************************************************** //
+
+bool const	SpamFilter::_hasSsse3 = SpamFilter::detectSsse3();
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+SpamFilter::SpamFilter(void) :
+	_patterns(),
+	_actions(),
+	_delta(),
+	_outActions(),
+	_outPatterns(),
+	_classes(),
+	_nbClasses(1UL),
+	_starts(),
+	_lowNibbles(),
+	_highNibbles(),
+	_isSelective(false) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+SpamFilter::~SpamFilter(void) {}
+
+// ************************************************************************* //
+//                          Private Member Functions                         //
+// ************************************************************************* //
+
+/**
+ * @brief	Skip the bytes no pattern starts with, one at a time.
+ * 
+ * @return	The offset of the next byte a pattern starts with,
+ * 			or `size` if there is none.
+ */
+size_t	SpamFilter::skipScalar(char const *const data, size_t idx, size_t const size) const
+{
+	while (idx < size && !this->_starts[static_cast<unsigned char>(data[idx])])
+		++idx;
+	return idx;
+}
+
+#ifdef SPAMFILTER_X86
+
+/**
+ * @brief	Skip the bytes no pattern starts with, 16 at a time.
+ * 			A byte is a candidate when the bucket of its high nibble is
+ * 			among the buckets of its low nibble: a few bytes no pattern
+ * 			starts with may be candidates too, the automaton sorting them out.
+ * 
+ * @return	The offset of the next candidate byte, or `size` if there is none.
+ */
+__attribute__((target("ssse3")))
+size_t	SpamFilter::skipSsse3(char const *const data, size_t idx, size_t const size) const
+{
+	__m128i const	lowNibbles = _mm_loadu_si128(reinterpret_cast<__m128i const *>(this->_lowNibbles));
+	__m128i const	highNibbles = _mm_loadu_si128(reinterpret_cast<__m128i const *>(this->_highNibbles));
+	__m128i const	nibble = _mm_set1_epi8(0x0f);
+	__m128i const	zero = _mm_setzero_si128();
+	__m128i			block;
+	__m128i			buckets;
+	unsigned int	candidates;
+
+	for ( ; idx + 16 <= size ; idx += 16)
+	{
+		block = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + idx));
+		buckets = _mm_and_si128(
+			_mm_shuffle_epi8(lowNibbles, _mm_and_si128(block, nibble)),
+			_mm_shuffle_epi8(highNibbles, _mm_and_si128(_mm_srli_epi16(block, 4), nibble)));
+		candidates = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(buckets, zero))) ^ 0xFFFFU;
+		if (candidates)
+			return idx + static_cast<size_t>(__builtin_ctz(candidates));
+	}
+	return this->skipScalar(data, idx, size);
+}
+
+bool	SpamFilter::detectSsse3(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("ssse3");
+}
+
+#else
+
+size_t	SpamFilter::skipSsse3(char const *const data, size_t idx, size_t const size) const
+{
+	return this->skipScalar(data, idx, size);
+}
+
+bool	SpamFilter::detectSsse3(void)
+{
+	return false;
+}
+
+#endif
+
+/**
+ * @brief	Run the automaton over a text, stopping at the first pattern
+ * 			asking to kill.
+ * 
+ * @param	simd Whether to skip the text 16 bytes at a time.
+ * 
+ * @return	The most severe action of the patterns found,
+ * 			and the first pattern found asking for it.
+ */
+SpamFilter::t_match	SpamFilter::run(char const *const data, size_t const size, bool const simd) const
+{
+	t_match		best = {NONE, 0UL};
+	uint32_t	state;
+	size_t		idx;
+
+	if (this->_patterns.empty())
+		return best;
+	for (idx = 0UL, state = 0U ; idx < size ; )
+	{
+		if (!state)
+		{
+			idx = simd && this->_isSelective ? this->skipSsse3(data, idx, size) : this->skipScalar(data, idx, size);
+			if (idx == size)
+				break ;
+		}
+		state = this->_delta[state * this->_nbClasses + this->_classes[static_cast<unsigned char>(data[idx++])]];
+		if (this->_outActions[state] > best.action)
+		{
+			best.action = static_cast<e_action>(this->_outActions[state]);
+			best.pattern = this->_outPatterns[state];
+			if (best.action == KILL)
+				break ;
+		}
+	}
+	return best;
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Compile the lines of a pattern file, replacing the current patterns
+ * 			only if all of them are valid.
+ * 			Each line is an action (warn, drop or kill) followed by the text
+ * 			to look for; empty lines and lines starting with '#' are ignored.
+ * 
+ * @param	lines The lines of the pattern file.
+ * @param	error Set to the reason of the failure, if any.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	SpamFilter::compile(std::vector<std::string> const &lines, std::string &error)
+{
+	SpamFilter									filter;
+	std::vector<std::map<uint16_t, uint32_t> >	trie(1);
+	std::vector<uint32_t>						fail(1, 0U);
+	std::queue<uint32_t>						bfs;
+	std::map<uint16_t, uint32_t>::const_iterator	cit;
+	std::string									line;
+	std::string									action;
+	std::string									pattern;
+	std::string::size_type						pos;
+	size_t										idx;
+	size_t										jdx;
+	uint32_t									state;
+	unsigned char								c;
+
+	for (idx = 0UL ; idx < lines.size() ; ++idx)
+	{
+		line = lines[idx];
+		line.erase(0, line.find_first_not_of(" \t"));
+		line.erase(line.find_last_not_of(" \t\r") + 1);
+		if (line.empty() || line[0] == '#')
+			continue ;
+		pos = line.find_first_of(" \t");
+		action = line.substr(0, pos);
+		pattern = pos == std::string::npos ? std::string() : line.substr(line.find_first_not_of(" \t", pos));
+		if (action == "warn")
+			filter._actions.push_back(WARN);
+		else if (action == "drop")
+			filter._actions.push_back(DROP);
+		else if (action == "kill")
+			filter._actions.push_back(KILL);
+		else
+		{
+			error = "line " + ft::toString(static_cast<int>(idx + 1)) + ": unknown action \"" + action + '"';
+			return false;
+		}
+		if (pattern.empty())
+		{
+			error = "line " + ft::toString(static_cast<int>(idx + 1)) + ": missing pattern";
+			return false;
+		}
+		for (jdx = 0UL ; jdx < pattern.size() ; ++jdx)
+		{
+			c = static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(pattern[jdx])));
+			pattern[jdx] = static_cast<char>(c);
+			if (!filter._classes[c])
+				filter._classes[c] = static_cast<uint16_t>(filter._nbClasses++);
+		}
+		filter._patterns.push_back(pattern);
+	}
+	// Both cases of a letter are the same byte to the automaton.
+	for (idx = 'A' ; idx <= 'Z' ; ++idx)
+		filter._classes[idx] = filter._classes[std::tolower(static_cast<int>(idx))];
+
+	// The trie of the patterns, each node being a state.
+	filter._outActions.push_back(NONE);
+	filter._outPatterns.push_back(0U);
+	for (idx = 0UL ; idx < filter._patterns.size() ; ++idx)
+	{
+		for (jdx = 0UL, state = 0U ; jdx < filter._patterns[idx].size() ; ++jdx)
+		{
+			c = static_cast<unsigned char>(filter._patterns[idx][jdx]);
+			cit = trie[state].find(filter._classes[c]);
+			if (cit != trie[state].end())
+			{
+				state = cit->second;
+				continue ;
+			}
+			trie[state].insert(std::make_pair(filter._classes[c], static_cast<uint32_t>(trie.size())));
+			state = static_cast<uint32_t>(trie.size());
+			trie.push_back(std::map<uint16_t, uint32_t>());
+			fail.push_back(0U);
+			filter._outActions.push_back(NONE);
+			filter._outPatterns.push_back(0U);
+		}
+		if (filter._actions[idx] > filter._outActions[state])
+		{
+			filter._outActions[state] = static_cast<unsigned char>(filter._actions[idx]);
+			filter._outPatterns[state] = static_cast<uint32_t>(idx);
+		}
+		c = static_cast<unsigned char>(filter._patterns[idx][0]);
+		filter._starts[c] = true;
+		filter._starts[std::toupper(c)] = true;
+	}
+	for (idx = 0UL ; idx < 256UL ; ++idx)
+		if (filter._starts[idx])
+		{
+			filter._lowNibbles[idx & 0x0f] |= static_cast<unsigned char>(1U << ((idx >> 4) & 7));
+			filter._highNibbles[idx >> 4] |= static_cast<unsigned char>(1U << ((idx >> 4) & 7));
+		}
+	// With most bytes being candidates, skipping would only slow the automaton.
+	for (idx = 0UL, jdx = 0UL ; idx < 256UL ; ++idx)
+		jdx += (filter._lowNibbles[idx & 0x0f] & filter._highNibbles[idx >> 4]) != 0;
+	filter._isSelective = jdx <= SPAMFILTER_MAX_CANDIDATES;
+
+	// Breadth first, the failure of a state is known before its children.
+	filter._delta.assign(trie.size() * filter._nbClasses, 0U);
+	for (cit = trie[0].begin() ; cit != trie[0].end() ; ++cit)
+	{
+		filter._delta[cit->first] = cit->second;
+		bfs.push(cit->second);
+	}
+	for ( ; !bfs.empty() ; bfs.pop())
+	{
+		state = bfs.front();
+		if (filter._outActions[fail[state]] > filter._outActions[state])
+		{
+			filter._outActions[state] = filter._outActions[fail[state]];
+			filter._outPatterns[state] = filter._outPatterns[fail[state]];
+		}
+		for (idx = 0UL ; idx < filter._nbClasses ; ++idx)
+			filter._delta[state * filter._nbClasses + idx] = filter._delta[fail[state] * filter._nbClasses + idx];
+		for (cit = trie[state].begin() ; cit != trie[state].end() ; ++cit)
+		{
+			fail[cit->second] = filter._delta[fail[state] * filter._nbClasses + cit->first];
+			filter._delta[state * filter._nbClasses + cit->first] = cit->second;
+			bfs.push(cit->second);
+		}
+	}
+	this->swap(filter);
+	return true;
+}
+
+/**
+ * @brief	Exchange the patterns of two filters.
+ */
+void	SpamFilter::swap(SpamFilter &other)
+{
+	this->_patterns.swap(other._patterns);
+	this->_actions.swap(other._actions);
+	this->_delta.swap(other._delta);
+	this->_outActions.swap(other._outActions);
+	this->_outPatterns.swap(other._outPatterns);
+	std::swap_ranges(this->_classes, this->_classes + 256, other._classes);
+	std::swap(this->_nbClasses, other._nbClasses);
+	std::swap_ranges(this->_starts, this->_starts + 256, other._starts);
+	std::swap_ranges(this->_lowNibbles, this->_lowNibbles + 16, other._lowNibbles);
+	std::swap_ranges(this->_highNibbles, this->_highNibbles + 16, other._highNibbles);
+	std::swap(this->_isSelective, other._isSelective);
+}
+
+/**
+ * @brief	Look for the patterns in a text, with the fastest skip
+ * 			the CPU supports.
+ * 
+ * @param	data The text.
+ * @param	size The length of the text.
+ * 
+ * @return	The most severe action of the patterns found,
+ * 			NONE if there is none.
+ */
+SpamFilter::t_match	SpamFilter::match(char const *const data, size_t const size) const
+{
+	return this->run(data, size, SpamFilter::_hasSsse3);
+}
+
+SpamFilter::t_match	SpamFilter::matchScalar(char const *const data, size_t const size) const
+{
+	return this->run(data, size, false);
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+std::string const	&SpamFilter::getPattern(size_t const idx) const
+{
+	return this->_patterns[idx];
+}
+
+size_t	SpamFilter::getSize(void) const
+{
+	return this->_patterns.size();
+}
+
+char const	*SpamFilter::getActionName(e_action const action)
+{
+	static char const *const	names[] = {"none", "warn", "drop", "kill"};
+
+	return names[action];
+}
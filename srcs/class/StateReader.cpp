@@ -0,0 +1,78 @@
+#include "class/StateReader.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+StateReader::StateReader(char const *const data, size_t const size) :
+	_data(data),
+	_size(size),
+	_pos(0UL),
+	_isValid(true) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+StateReader::~StateReader(void) {}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Read an unsigned integer.
+ * 
+ * @return	The integer, or 0 if the reader is or becomes invalid.
+ */
+uint64_t	StateReader::getVarint(void)
+{
+	uint64_t		value;
+	unsigned int	shift;
+	unsigned char	byte;
+
+	for (value = 0U, shift = 0U ; this->_isValid ; shift += 7U)
+	{
+		if (this->_pos == this->_size || shift > 63U)
+			break ;
+		byte = static_cast<unsigned char>(this->_data[this->_pos++]);
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return value;
+	}
+	this->_isValid = false;
+	return 0U;
+}
+
+/**
+ * @brief	Read a string.
+ * 
+ * @return	The string, or an empty one if the reader is or becomes invalid.
+ */
+std::string	StateReader::getString(void)
+{
+	uint64_t const	size = this->getVarint();
+	size_t			pos;
+
+	if (!this->_isValid || size > this->_size - this->_pos)
+	{
+		this->_isValid = false;
+		return std::string();
+	}
+	pos = this->_pos;
+	this->_pos += static_cast<size_t>(size);
+	return std::string(this->_data + pos, static_cast<size_t>(size));
+}
+
+/**
+ * @return	true if every byte was read, false otherwise.
+ */
+bool	StateReader::atEnd(void) const
+{
+	return this->_pos == this->_size;
+}
+
+bool	StateReader::isValid(void) const
+{
+	return this->_isValid;
+}
@@ -0,0 +1,67 @@
+#include "class/StateWriter.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+StateWriter::StateWriter(void) :
+	_data() {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+StateWriter::~StateWriter(void) {}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Append an unsigned integer, in as few bytes as it takes.
+ * 
+ * @param	value The integer to append.
+ */
+void	StateWriter::putVarint(uint64_t value)
+{
+	for ( ; value >= 0x80 ; value >>= 7)
+		this->_data += static_cast<char>((value & 0x7F) | 0x80);
+	this->_data += static_cast<char>(value);
+}
+
+/**
+ * @brief	Append a string, preceded by its size.
+ * 
+ * @param	str The string to append.
+ */
+void	StateWriter::putString(std::string const &str)
+{
+	this->putVarint(str.size());
+	this->_data.append(str);
+}
+
+void	StateWriter::putString(char const *const data, size_t const size)
+{
+	this->putVarint(size);
+	this->_data.append(data, size);
+}
+
+/**
+ * @brief	Make room for the bytes about to be appended,
+ * 			sparing the reallocations of a big state.
+ * 
+ * @param	size The expected size of the whole buffer.
+ */
+void	StateWriter::reserve(size_t const size)
+{
+	this->_data.reserve(size);
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+std::string const	&StateWriter::getData(void) const
+{
+	return this->_data;
+}
@@ -0,0 +1,115 @@
+#include <cstring> // memcpy
+#include <ctime> // gmtime_r, strftime
+#include "class/TaggedLine.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+TaggedLine::TaggedLine(ArenaString const &line, uint64_t const msgid, uint64_t const time) :
+	_line(line),
+	_msgid(msgid),
+	_time(time),
+	_lines() {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+TaggedLine::~TaggedLine(void) {}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Get the line to send to an user, with the tags it asked for.
+ * 
+ * @param	caps The capabilities of the user.
+ * 
+ * @return	The tagged line.
+ */
+ArenaString const	&TaggedLine::get(unsigned int const caps)
+{
+	unsigned int const	idx = caps & (User::MESSAGE_TAGS | User::SERVER_TIME);
+	char				tags[TAGS_LENGTH];
+	size_t				size;
+
+	if (!idx)
+		return this->_line;
+	if (this->_lines[idx].empty())
+	{
+		size = TaggedLine::putTags(tags, idx, this->_msgid, this->_time);
+		this->_lines[idx].reserve(size + this->_line.size());
+		this->_lines[idx].assign(tags, size);
+		this->_lines[idx] += this->_line;
+	}
+	return this->_lines[idx];
+}
+
+/**
+ * @brief	Write the tags of a message an user asked for:
+ * 			its time (server-time) and its msgid, in hexadecimal (message-tags).
+ * 
+ * @param	tags Where to write the tags, at least TAGS_LENGTH bytes.
+ * @param	caps The capabilities of the user.
+ * @param	msgid The msgid of the message.
+ * @param	time The time of the message, in milliseconds.
+ * 
+ * @return	The size of the tags, with the space following them,
+ * 			0 if the user asked for none.
+ */
+size_t	TaggedLine::putTags(char *const tags, unsigned int const caps, uint64_t const msgid, uint64_t const time)
+{
+	static char const	digits[] = "0123456789abcdef";
+	time_t const		seconds = static_cast<time_t>(time / 1000UL);
+	unsigned int const	ms = static_cast<unsigned int>(time % 1000UL);
+	tm					date;
+	size_t				size;
+	int					shift;
+
+	if (!(caps & (User::MESSAGE_TAGS | User::SERVER_TIME)))
+		return 0UL;
+	size = 0UL;
+	tags[size++] = '@';
+	if (caps & User::SERVER_TIME)
+	{
+		gmtime_r(&seconds, &date);
+		size += strftime(tags + size, TAGS_LENGTH - size, "time=%Y-%m-%dT%H:%M:%S.", &date);
+		tags[size++] = static_cast<char>('0' + ms / 100);
+		tags[size++] = static_cast<char>('0' + ms / 10 % 10);
+		tags[size++] = static_cast<char>('0' + ms % 10);
+		tags[size++] = 'Z';
+	}
+	if (caps & User::MESSAGE_TAGS)
+	{
+		if (caps & User::SERVER_TIME)
+			tags[size++] = ';';
+		memcpy(tags + size, "msgid=", 6);
+		size += 6;
+		for (shift = 60 ; shift > 0 && !(msgid >> shift) ; shift -= 4);
+		for ( ; shift >= 0 ; shift -= 4)
+			tags[size++] = digits[(msgid >> shift) & 0xF];
+	}
+	tags[size++] = ' ';
+	return size;
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+ArenaString const	&TaggedLine::getLine(void) const
+{
+	return this->_line;
+}
+
+uint64_t const	&TaggedLine::getMsgid(void) const
+{
+	return this->_msgid;
+}
+
+uint64_t const	&TaggedLine::getTime(void) const
+{
+	return this->_time;
+}
@@ -0,0 +1,136 @@
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "class/TcpTransport.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+TcpTransport::TcpTransport(void) :
+	Transport() {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+TcpTransport::~TcpTransport(void) {}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+void	TcpTransport::close(int const fd)
+{
+	::close(fd);
+}
+
+/**
+ * @brief	Accept a pending connection, made non-blocking.
+ * 
+ * @param	listener The listening socket.
+ * @param	addr The address of the client.
+ * 
+ * @return	The socket of the connection, or -1 if none is pending.
+ */
+int	TcpTransport::accept(int const listener, sockaddr_in &addr)
+{
+	socklen_t	addrlen = sizeof(addr);
+	int			fd;
+
+	fd = ::accept(listener, reinterpret_cast<sockaddr *>(&addr), &addrlen);
+	if (fd != -1)
+		fcntl(fd, F_SETFL, O_NONBLOCK);
+	return fd;
+}
+
+/**
+ * @brief	Open a connection to a remote server, made non-blocking once
+ * 			established: the call blocks until then, so it is run by a worker.
+ * 
+ * @param	host The IP address to connect to.
+ * @param	port The port to connect to.
+ * @param	error The failed call and its reason, on failure.
+ * 
+ * @return	The socket of the connection, or -1 on failure.
+ */
+int	TcpTransport::connect(std::string const &host, uint16_t const port, std::string &error)
+{
+	sockaddr_in	addr;
+	int			fd;
+
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd == -1)
+	{
+		error = "socket: " + std::string(strerror(errno));
+		return -1;
+	}
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_addr.s_addr = inet_addr(host.c_str());
+	addr.sin_port = htons(port);
+	addr.sin_family = AF_INET;
+	if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)))
+		error = "connect: " + std::string(strerror(errno));
+	else if (fcntl(fd, F_SETFL, O_NONBLOCK))
+		error = "fcntl: " + std::string(strerror(errno));
+	else
+		return fd;
+	::close(fd);
+	return -1;
+}
+
+/**
+ * @brief	Create a non-blocking socket listening on an address.
+ * 
+ * @param	host The IP address to listen on.
+ * @param	port The port to listen on.
+ * @param	error The failed call and its reason, on failure.
+ * 
+ * @return	The listening socket, or -1 on failure.
+ */
+int	TcpTransport::listen(std::string const &host, uint16_t const port, std::string &error)
+{
+	sockaddr_in	addr;
+	int			optval;
+	int			fd;
+
+	fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	if (fd == -1)
+	{
+		error = "socket: " + std::string(strerror(errno));
+		return -1;
+	}
+	optval = 1;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_addr.s_addr = inet_addr(host.c_str());
+	addr.sin_port = htons(port);
+	addr.sin_family = AF_INET;
+	if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)))
+		error = "setsockopt: " + std::string(strerror(errno));
+	else if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)))
+		error = "bind: " + std::string(strerror(errno));
+	else if (::listen(fd, SOMAXCONN))
+		error = "listen: " + std::string(strerror(errno));
+	else
+		return fd;
+	::close(fd);
+	return -1;
+}
+
+int	TcpTransport::poll(pollfd *const fds, nfds_t const nfds, int const timeout)
+{
+	return ::poll(fds, nfds, timeout);
+}
+
+ssize_t	TcpTransport::recv(int const fd, char *const buff, size_t const size)
+{
+	return ::recv(fd, buff, size, MSG_DONTWAIT);
+}
+
+ssize_t	TcpTransport::send(int const fd, char const *const buff, size_t const size)
+{
+	return ::send(fd, buff, size, MSG_NOSIGNAL);
+}
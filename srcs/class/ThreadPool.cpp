@@ -0,0 +1,211 @@
+#include <cerrno>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "class/ThreadPool.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+ThreadPool::ThreadPool(void) :
+	_threads(),
+	_pending(),
+	_completed(),
+	_mutex(),
+	_cond(),
+	_eventfd(-1),
+	_stopping(false)
+{
+	pthread_mutex_init(&this->_mutex, NULL);
+	pthread_cond_init(&this->_cond, NULL);
+}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+ThreadPool::~ThreadPool(void)
+{
+	this->stop();
+	pthread_cond_destroy(&this->_cond);
+	pthread_mutex_destroy(&this->_mutex);
+}
+
+// ************************************************************************** //
+//                          Private Member Functions                          //
+// ************************************************************************** //
+
+/**
+ * @brief	Worker loop: wait for a pending job, execute it,
+ * 			then post it to the completion queue and wake the event loop up.
+ * 
+ * @param	arg The ThreadPool the worker belongs to.
+ * 
+ * @return	Always NULL.
+ */
+void	*ThreadPool::routine(void *arg)
+{
+	ThreadPool *const	pool = static_cast<ThreadPool *>(arg);
+	Job					*job;
+	uint64_t const		one = 1;
+
+	pthread_mutex_lock(&pool->_mutex);
+	while (true)
+	{
+		while (!pool->_stopping && pool->_pending.empty())
+			pthread_cond_wait(&pool->_cond, &pool->_mutex);
+		if (pool->_stopping)
+			break ;
+		job = pool->_pending.front();
+		pool->_pending.pop_front();
+		pthread_mutex_unlock(&pool->_mutex);
+
+		job->execute();
+
+		pthread_mutex_lock(&pool->_mutex);
+		pool->_completed.push_back(job);
+		if (write(pool->_eventfd, &one, sizeof(one)) == -1 && errno != EAGAIN)
+			break ;
+	}
+	pthread_mutex_unlock(&pool->_mutex);
+	return NULL;
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Create the completion eventfd and spawn the workers.
+ * 
+ * @param	nbWorkers The number of worker threads to spawn,
+ * 			0 running the jobs on the calling thread.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	ThreadPool::init(unsigned int const nbWorkers)
+{
+	pthread_t		thread;
+	unsigned int	idx;
+
+	this->_eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (this->_eventfd == -1)
+		return false;
+	this->_stopping = false;
+	for (idx = 0U ; idx < nbWorkers ; ++idx)
+	{
+		if (pthread_create(&thread, NULL, &ThreadPool::routine, this))
+		{
+			this->stop();
+			return false;
+		}
+		this->_threads.push_back(thread);
+	}
+	return true;
+}
+
+/**
+ * @brief	Drain the eventfd and take every completed job.
+ * 			Run on the event loop once the eventfd is readable.
+ * 
+ * @param	completed The container to append the completed jobs to.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	ThreadPool::pop(std::deque<Job *> &completed)
+{
+	uint64_t	count;
+
+	if (read(this->_eventfd, &count, sizeof(count)) == -1 && errno != EAGAIN)
+		return false;
+	pthread_mutex_lock(&this->_mutex);
+	completed.insert(completed.end(), this->_completed.begin(), this->_completed.end());
+	this->_completed.clear();
+	pthread_mutex_unlock(&this->_mutex);
+	return true;
+}
+
+/**
+ * @brief	Hand a job over to the workers.
+ * 			Without workers, the job is run right away by the caller,
+ * 			and still given back by pop() only, as if a worker had run it.
+ * 			The pool owns the job until it is given back by pop().
+ * 
+ * @param	job The job to run.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	ThreadPool::push(Job *const job)
+{
+	uint64_t const	one = 1;
+
+	if (this->_eventfd == -1)
+		return false;
+	if (this->_threads.empty())
+	{
+		job->execute();
+		try
+		{
+			this->_completed.push_back(job);
+		}
+		catch (std::exception const &e)
+		{
+			return false;
+		}
+		if (write(this->_eventfd, &one, sizeof(one)) == -1 && errno != EAGAIN)
+		{
+			this->_completed.pop_back();
+			return false;
+		}
+		return true;
+	}
+	pthread_mutex_lock(&this->_mutex);
+	try
+	{
+		this->_pending.push_back(job);
+	}
+	catch (std::exception const &e)
+	{
+		pthread_mutex_unlock(&this->_mutex);
+		return false;
+	}
+	pthread_cond_signal(&this->_cond);
+	pthread_mutex_unlock(&this->_mutex);
+	return true;
+}
+
+/**
+ * @brief	Join every worker and release the jobs that never completed.
+ */
+void	ThreadPool::stop(void)
+{
+	std::vector<pthread_t>::iterator	it;
+	std::deque<Job *>::iterator			job;
+
+	pthread_mutex_lock(&this->_mutex);
+	this->_stopping = true;
+	pthread_cond_broadcast(&this->_cond);
+	pthread_mutex_unlock(&this->_mutex);
+	for (it = this->_threads.begin() ; it != this->_threads.end() ; ++it)
+		pthread_join(*it, NULL);
+	this->_threads.clear();
+	for (job = this->_pending.begin() ; job != this->_pending.end() ; ++job)
+		delete *job;
+	this->_pending.clear();
+	for (job = this->_completed.begin() ; job != this->_completed.end() ; ++job)
+		delete *job;
+	this->_completed.clear();
+	if (this->_eventfd != -1)
+		close(this->_eventfd);
+	this->_eventfd = -1;
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+int const	&ThreadPool::getEventFd(void) const
+{
+	return this->_eventfd;
+}
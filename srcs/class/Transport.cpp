@@ -0,0 +1,13 @@
+#include "class/Transport.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+Transport::Transport(void) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+Transport::~Transport(void) {}
@@ -0,0 +1,582 @@
+#include <algorithm> // min
+#include <cerrno>
+#include <csignal> // kill
+#include <cstring> // memcpy, memset, strerror
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "class/Server.hpp"
+#include "ft.hpp"
+
+extern char	**environ;
+
+/*
+	Hot upgrade: the running server hands itself over to a new process,
+	through an Unix socket (the channel), without its clients noticing.
+
+	The channel carries, in order:
+		header:	the size of the state, then the number of file descriptors,
+				each on 8 bytes in the byte order of the host
+		state:	see saveState()
+		fds:	the listening socket, the metrics socket if any, then the
+				sockets of the users, up to UPGRADE_FDS_PER_MSG per message
+				(SCM_RIGHTS), each message carrying a single byte
+	then the new process sends back a single byte once it resumed.
+	In the state, a socket is its index among the file descriptors,
+	the listening socket being 0: a list of entries starting with a socket
+	ends with a 0.
+*/
+
+// ************************************************************************** //
+//                              Static Functions                              //
+// ************************************************************************** //
+
+inline static bool	__sendAll(int const channel, char const *data, size_t size)
+{
+	ssize_t	ret;
+
+	while (size)
+	{
+		ret = send(channel, data, size, MSG_NOSIGNAL);
+		if (ret == -1 && errno == EINTR)
+			continue ;
+		if (ret <= 0)
+			return false;
+		data += ret;
+		size -= static_cast<size_t>(ret);
+	}
+	return true;
+}
+
+inline static bool	__recvAll(int const channel, char *data, size_t size)
+{
+	ssize_t	ret;
+
+	while (size)
+	{
+		ret = recv(channel, data, size, 0);
+		if (ret == -1 && errno == EINTR)
+			continue ;
+		if (ret <= 0)
+			return false;
+		data += ret;
+		size -= static_cast<size_t>(ret);
+	}
+	return true;
+}
+
+// ************************************************************************** //
+//                          Private Member Functions                          //
+// ************************************************************************** //
+
+/**
+ * @brief	Receive the state and the file descriptors of the server
+ * 			handing itself over.
+ * 
+ * @param	channel The socket to the previous process.
+ * @param	state Set to the state.
+ * @param	fds Filled with the file descriptors, in the order they were sent,
+ * 			even on failure for them to be closed.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::recvHandover(int const channel, std::string &state, std::vector<int> &fds)
+{
+	union
+	{
+		char	buff[CMSG_SPACE(sizeof(int) * UPGRADE_FDS_PER_MSG)];
+		cmsghdr	align;
+	}			control;
+	uint64_t	header[2];
+	int			received[UPGRADE_FDS_PER_MSG];
+	msghdr		msg;
+	iovec		iov;
+	cmsghdr		*cmsg;
+	ssize_t		ret;
+	size_t		nb;
+	char		byte;
+
+	if (!__recvAll(channel, reinterpret_cast<char *>(header), sizeof(header)))
+		return false;
+	state.resize(static_cast<size_t>(header[0]));
+	if (!state.empty() && !__recvAll(channel, &state[0], state.size()))
+		return false;
+	while (fds.size() < header[1])
+	{
+		std::memset(&msg, 0, sizeof(msg));
+		iov.iov_base = &byte;
+		iov.iov_len = 1UL;
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1UL;
+		msg.msg_control = control.buff;
+		msg.msg_controllen = sizeof(control.buff);
+		while ((ret = recvmsg(channel, &msg, MSG_CMSG_CLOEXEC)) == -1 && errno == EINTR)
+			;
+		if (ret != 1)
+			return false;
+		for (cmsg = CMSG_FIRSTHDR(&msg) ; cmsg ; cmsg = CMSG_NXTHDR(&msg, cmsg))
+		{
+			if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+				continue ;
+			nb = std::min((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int), static_cast<size_t>(UPGRADE_FDS_PER_MSG));
+			std::memcpy(received, CMSG_DATA(cmsg), nb * sizeof(int));
+			fds.insert(fds.end(), received, received + nb);
+		}
+		if (msg.msg_flags & MSG_CTRUNC)
+			return false;
+	}
+	return fds.size() == header[1];
+}
+
+/**
+ * @brief	Rebuild the users, the links and the channels from the state
+ * 			of the previous process, its header excepted, see resume().
+ * 
+ * @param	state The state, past its header.
+ * @param	fds The file descriptors received with the state.
+ * 
+ * @return	true if success, false if the state is malformed.
+ */
+bool	Server::restoreState(StateReader &state, std::vector<int> const &fds)
+{
+	std::vector<User *>									users(fds.size(), static_cast<User *>(NULL));
+	std::map<std::string const, t_connect>::iterator	itConnect;
+	std::map<std::string const, t_server>::iterator		itServer;
+	std::map<Identifier const, User *const>::iterator	itUser;
+	std::set<Identifier>::const_iterator				itMonitor;
+	std::string											name;
+	std::string											line;
+	uint64_t											idx;
+	uint64_t											nb;
+	uint64_t											nbMembers;
+	uint64_t											msgid;
+	uint64_t											time;
+	unsigned int										modes;
+	User												*user;
+	Channel												channel;
+	std::map<Identifier const, Channel>::iterator		chan;
+	t_link												link;
+	t_server											server;
+
+	for (nb = state.getVarint() ; nb && state.isValid() ; --nb)
+		this->_banList.push_back(state.getString());
+
+	// The local users and links, in the order they were served.
+	while ((idx = state.getVarint()))
+	{
+		if (idx >= users.size() || users[idx])
+			return false;
+		this->_users.push_back(User());
+		user = &this->_users.back();
+		user->load(state);
+		user->setSocket(fds[idx]);
+		users[idx] = user;
+		this->_lookupSockets.insert(std::pair<int const, User *const>(fds[idx], user));
+		if (!user->getNicknameId().empty())
+			this->_lookupUsers.insert(std::pair<Identifier const, User *const>(user->getNicknameId(), user));
+		for (itMonitor = user->getMonitors().begin() ; itMonitor != user->getMonitors().end() ; ++itMonitor)
+			this->_lookupWatchers[*itMonitor].insert(user);
+		if (user->getState() != User::REGISTERED && user->getState() != User::LINK)
+			this->_registrationTimers.insert(std::pair<time_t const, int const>(user->getRegisterDeadline(), fds[idx]));
+		this->addPollfd(fds[idx], POLLIN | POLLOUT);
+		this->_capture.open(fds[idx]);
+	}
+	while ((idx = state.getVarint()))
+	{
+		if (idx >= users.size() || !users[idx])
+			return false;
+		link.name = state.getString();
+		link.target = state.getString();
+		link.isAuthenticated = state.getVarint() != 0U;
+		this->_lookupLinks.insert(std::make_pair(users[idx], link));
+		// A server this one connected to is not connected to again.
+		itConnect = this->_lookupConnects.find(link.target);
+		if (itConnect != this->_lookupConnects.end())
+			itConnect->second.isPending = true;
+	}
+
+	// The rest of the network.
+	while ((idx = state.getVarint()))
+	{
+		if (idx >= users.size() || !users[idx])
+			return false;
+		name = state.getString();
+		server.link = users[idx];
+		server.uplink = state.getString();
+		server.description = state.getString();
+		server.hops = static_cast<unsigned int>(state.getVarint());
+		this->_lookupServers.insert(std::make_pair(name, server));
+	}
+	while ((idx = state.getVarint()))
+	{
+		if (idx >= users.size() || !users[idx])
+			return false;
+		this->_remoteUsers.push_back(User());
+		user = &this->_remoteUsers.back();
+		this->_lookupRemoteUsers.insert(std::make_pair(user, --this->_remoteUsers.end()));
+		user->load(state);
+		itServer = this->_lookupServers.find(state.getString());
+		if (itServer == this->_lookupServers.end())
+			return false;
+		user->setLink(users[idx]);
+		user->setServer(&itServer->first);
+		this->_lookupUsers.insert(std::pair<Identifier const, User *const>(user->getNicknameId(), user));
+	}
+
+	// The channels with their history, a member no longer known being left out.
+	for (nb = state.getVarint() ; nb && state.isValid() ; --nb)
+	{
+		channel.load(state);
+		chan = this->_lookupChannels.insert(std::pair<Identifier const, Channel>(channel.getNameId(), channel)).first;
+		this->forgetDormant(channel.getNameId());
+		for (nbMembers = state.getVarint() ; nbMembers && state.isValid() ; --nbMembers)
+		{
+			name = state.getString();
+			modes = static_cast<unsigned int>(state.getVarint());
+			itUser = this->_lookupUsers.find(Identifier::find(name));
+			if (itUser == this->_lookupUsers.end())
+				continue ;
+			chan->second.addUser(*itUser->second);
+			chan->second.addMemberModes(*itUser->second, modes);
+			itUser->second->addChannel(chan->second);
+		}
+		for (nbMembers = state.getVarint() ; nbMembers && state.isValid() ; --nbMembers)
+		{
+			msgid = state.getVarint();
+			time = state.getVarint();
+			line = state.getString();
+			this->_history.append(chan->second.getHistory(), msgid, time, line.data(), line.size());
+		}
+		if (chan->second.empty())
+			this->_lookupChannels.erase(chan);
+	}
+	return state.isValid() && state.atEnd();
+}
+
+/**
+ * @brief	Write everything the new process needs to resume serving, and
+ * 			list the file descriptors to pass it: the listening socket, the
+ * 			metrics socket, then the sockets of the users.
+ * 			The header comes first: the magic, the server password (hashed),
+ * 			the configuration file, the creation time, and whether the metrics
+ * 			socket is passed. Then the server bans, the local users, the links,
+ * 			the servers and the users behind them, and the channels with
+ * 			their history.
+ * 			An user already disconnected is left out.
+ * 
+ * @param	state The state to write to.
+ * @param	fds Filled with the file descriptors to pass.
+ */
+void	Server::saveState(StateWriter &state, std::vector<int> &fds)
+{
+	std::map<User const *, size_t>						lookupIndexes;
+	std::map<User const *, size_t>::const_iterator		itIndex;
+	std::list<std::string>::const_iterator				itBan;
+	std::list<User>::const_iterator						itUser;
+	std::map<User *const, t_link>::const_iterator		itLink;
+	std::map<std::string const, t_server>::const_iterator	itServer;
+	std::map<Identifier const, Channel>::const_iterator	itChan;
+	std::map<Identifier const, User *const>::const_iterator	itMember;
+	History::t_entry const								*entry;
+	size_t												nb;
+
+	state.reserve(256UL * (this->_users.size() + this->_remoteUsers.size()) + 128UL * this->_lookupChannels.size() + this->_history.used());
+	fds.push_back(this->_socket);
+	if (this->_metricsSocket != -1)
+		fds.push_back(this->_metricsSocket);
+	state.putString(UPGRADE_MAGIC);
+	state.putString(this->_config["server_password"]);
+	state.putString(this->_configFile);
+	state.putString(this->_creationTime);
+	state.putVarint(this->_metricsSocket != -1);
+
+	state.putVarint(this->_banList.size());
+	for (itBan = this->_banList.begin() ; itBan != this->_banList.end() ; ++itBan)
+		state.putString(*itBan);
+	for (itUser = this->_users.begin() ; itUser != this->_users.end() ; ++itUser)
+	{
+		if (itUser->getSocket() == -1)
+			continue ;
+		lookupIndexes[&*itUser] = fds.size();
+		state.putVarint(fds.size());
+		fds.push_back(itUser->getSocket());
+		itUser->save(state);
+	}
+	state.putVarint(0U);
+	for (itLink = this->_lookupLinks.begin() ; itLink != this->_lookupLinks.end() ; ++itLink)
+	{
+		itIndex = lookupIndexes.find(itLink->first);
+		if (itIndex == lookupIndexes.end())
+			continue ;
+		state.putVarint(itIndex->second);
+		state.putString(itLink->second.name);
+		state.putString(itLink->second.target);
+		state.putVarint(itLink->second.isAuthenticated);
+	}
+	state.putVarint(0U);
+
+	for (itServer = this->_lookupServers.begin() ; itServer != this->_lookupServers.end() ; ++itServer)
+	{
+		itIndex = lookupIndexes.find(itServer->second.link);
+		if (itIndex == lookupIndexes.end())
+			continue ;
+		state.putVarint(itIndex->second);
+		state.putString(itServer->first);
+		state.putString(itServer->second.uplink);
+		state.putString(itServer->second.description);
+		state.putVarint(itServer->second.hops);
+	}
+	state.putVarint(0U);
+	for (itUser = this->_remoteUsers.begin() ; itUser != this->_remoteUsers.end() ; ++itUser)
+	{
+		itIndex = lookupIndexes.find(itUser->getLink());
+		if (itIndex == lookupIndexes.end() || !this->_lookupServers.count(*itUser->getServer()))
+			continue ;
+		state.putVarint(itIndex->second);
+		itUser->save(state);
+		state.putString(*itUser->getServer());
+	}
+	state.putVarint(0U);
+
+	state.putVarint(this->_lookupChannels.size());
+	for (itChan = this->_lookupChannels.begin() ; itChan != this->_lookupChannels.end() ; ++itChan)
+	{
+		itChan->second.save(state);
+		state.putVarint(itChan->second.size());
+		for (itMember = itChan->second.begin() ; itMember != itChan->second.end() ; ++itMember)
+		{
+			state.putString(itMember->second->getNickname());
+			state.putVarint(itChan->second.getMemberModes(*itMember->second));
+		}
+		nb = this->_history.select(itChan->second.getHistory(), History::LATEST, false, 0UL, ~0UL, entry);
+		state.putVarint(nb);
+		for ( ; nb ; --nb)
+		{
+			state.putVarint(entry->msgid);
+			state.putVarint(entry->time);
+			state.putString(History::getLine(entry), entry->size);
+			if (nb > 1)
+				entry = this->_history.next(itChan->second.getHistory(), entry);
+		}
+	}
+}
+
+/**
+ * @brief	Send the state and the file descriptors to the new process.
+ * 
+ * @param	channel The socket to the new process.
+ * @param	state The state.
+ * @param	fds The file descriptors.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::sendHandover(int const channel, std::string const &state, std::vector<int> const &fds)
+{
+	union
+	{
+		char	buff[CMSG_SPACE(sizeof(int) * UPGRADE_FDS_PER_MSG)];
+		cmsghdr	align;
+	}				control;
+	uint64_t const	header[2] = {state.size(), fds.size()};
+	msghdr			msg;
+	iovec			iov;
+	cmsghdr			*cmsg;
+	ssize_t			ret;
+	size_t			idx;
+	size_t			nb;
+	char			byte;
+
+	if (!__sendAll(channel, reinterpret_cast<char const *>(header), sizeof(header)) ||
+		!__sendAll(channel, state.data(), state.size()))
+		return false;
+	for (idx = 0UL, byte = 0 ; idx < fds.size() ; idx += nb)
+	{
+		nb = std::min(fds.size() - idx, static_cast<size_t>(UPGRADE_FDS_PER_MSG));
+		std::memset(&msg, 0, sizeof(msg));
+		std::memset(&control, 0, sizeof(control));
+		iov.iov_base = &byte;
+		iov.iov_len = 1UL;
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1UL;
+		msg.msg_control = control.buff;
+		msg.msg_controllen = CMSG_SPACE(sizeof(int) * nb);
+		cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nb);
+		std::memcpy(CMSG_DATA(cmsg), &fds[idx], sizeof(int) * nb);
+		while ((ret = sendmsg(channel, &msg, MSG_NOSIGNAL)) == -1 && errno == EINTR)
+			;
+		if (ret != 1)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief	Hand the server over to a new process running the binary this one
+ * 			was started from, which may have been replaced meanwhile.
+ * 			The sockets of the clients are passed over, never shut down:
+ * 			the bytes they send meanwhile wait in the kernel for the new process.
+ * 			On failure, the new process is killed, and this one goes on serving.
+ * 
+ * @return	true if the new process resumed serving, false otherwise.
+ */
+bool	Server::upgrade(void)
+{
+	double const		start = Metrics::now();
+	std::string			channelArg;
+	StateWriter			state;
+	std::vector<int>	fds;
+	std::vector<pollfd>::const_iterator	it;
+	char				*argv[4];
+	int					channel[2];
+	int					ret;
+	int					polled;
+	pid_t				pid;
+	pollfd				ack;
+	char				byte;
+	bool				isResumed;
+
+	Server::logMsg(INTERNAL, "    Upgrading to " + this->_executable);
+	if (this->_executable.empty())
+	{
+		Server::logMsg(ERROR, "    Upgrade failed: the path of the binary is unknown, still serving");
+		return false;
+	}
+	// The dormant channels are only in the snapshot, read by the new process.
+	if (this->_nextSnapshot)
+		this->writeSnapshot();
+	this->saveState(state, fds);
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, channel))
+	{
+		Server::logMsg(ERROR, "socketpair: " + std::string(strerror(errno)));
+		return false;
+	}
+	// Only the end of the new process is inherited: the sockets go through it.
+	fcntl(channel[0], F_SETFD, FD_CLOEXEC);
+	for (it = this->_pollfds.begin() ; it != this->_pollfds.end() ; ++it)
+		fcntl(it->fd, F_SETFD, FD_CLOEXEC);
+	// The new process starts its own capture, over the same file.
+	this->_capture.stop();
+
+	channelArg = ft::toString(channel[1]);
+	argv[0] = const_cast<char *>(this->_executable.c_str());
+	argv[1] = const_cast<char *>("--upgrade");
+	argv[2] = const_cast<char *>(channelArg.c_str());
+	argv[3] = NULL;
+	ret = posix_spawn(&pid, this->_executable.c_str(), NULL, NULL, argv, environ);
+	close(channel[1]);
+	isResumed = !ret && Server::sendHandover(channel[0], state.getData(), fds);
+	if (isResumed)
+	{
+		ack.fd = channel[0];
+		ack.events = POLLIN;
+		while ((polled = poll(&ack, 1, UPGRADE_TIMEOUT)) == -1 && errno == EINTR)
+			;
+		isResumed = polled == 1 && read(channel[0], &byte, 1) == 1;
+	}
+	close(channel[0]);
+	if (!isResumed)
+	{
+		Server::logMsg(ERROR, "    Upgrade failed: " + std::string(ret ? strerror(ret) : "the new process did not resume") + ", still serving");
+		if (!ret)
+		{
+			::kill(pid, SIGKILL);
+			waitpid(pid, NULL, 0);
+		}
+		if (!this->_config["capture_file"].empty() &&
+			!this->_capture.init(this->_config["capture_file"], static_cast<size_t>(std::strtol(this->_config["capture_max_size"].c_str(), NULL, 10))))
+			Server::logMsg(ERROR, "capture: " + this->_config["capture_file"] + ": " + std::string(strerror(errno)));
+		return false;
+	}
+	Server::logMsg(INTERNAL, "    Handed " + ft::toString(static_cast<int>(fds.size())) + " sockets over to process " +
+		ft::toString(pid) + " in " + ft::toString(static_cast<int>((Metrics::now() - start) * 1e6)) + " us");
+	this->_state = HANDED_OVER;
+	return true;
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Resume serving in place of the server handing itself over,
+ * 			instead of starting: see upgrade().
+ * 			The configuration file is read again, the listening socket and
+ * 			the metrics socket are the ones of the previous process.
+ * 
+ * @param	channel The socket to the previous process.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::resume(int const channel)
+{
+	double const		start = Metrics::now();
+	char const			ack = 1;
+	std::string			data;
+	std::vector<int>	fds;
+	std::string			magic;
+	std::string			password;
+	std::string			configFile;
+	size_t				idx;
+	bool				hasMetrics;
+
+	if (!Server::recvHandover(channel, data, fds) || fds.empty())
+	{
+		Server::logMsg(ERROR, "    Upgrade: the state could not be received");
+		for (idx = 0UL ; idx < fds.size() ; ++idx)
+			close(fds[idx]);
+		close(channel);
+		return false;
+	}
+	{
+		StateReader	state(data.data(), data.size());
+
+		magic = state.getString();
+		password = state.getString();
+		configFile = state.getString();
+		if (magic != UPGRADE_MAGIC || !state.isValid() || !this->init(password, configFile))
+		{
+			Server::logMsg(ERROR, "    Upgrade: bad state header");
+			for (idx = 0UL ; idx < fds.size() ; ++idx)
+				close(fds[idx]);
+			close(channel);
+			return false;
+		}
+		this->_creationTime = state.getString();
+		hasMetrics = state.getVarint() != 0U;
+		this->_socket = fds[0];
+		this->addPollfd(this->_socket, POLLIN | POLLOUT);
+		if (hasMetrics && fds.size() > 1)
+			this->_metricsSocket = fds[1];
+		// Until resumed, the sockets are the previous process' too.
+		this->_state = HANDED_OVER;
+		if (!this->launch())
+		{
+			close(channel);
+			return false;
+		}
+		if (!this->restoreState(state, fds))
+		{
+			Server::logMsg(ERROR, "    Upgrade: bad state");
+			this->_state = HANDED_OVER;
+			this->stop();
+			close(channel);
+			return false;
+		}
+	}
+	if (write(channel, &ack, 1) != 1)
+	{
+		Server::logMsg(ERROR, "    Upgrade: the previous process is gone");
+		this->_state = HANDED_OVER;
+		this->stop();
+		close(channel);
+		return false;
+	}
+	close(channel);
+	Server::logMsg(INTERNAL, "(" + ft::toString(this->_socket) + ") Resumed with " + ft::toString(static_cast<int>(this->_users.size())) +
+		" connections and " + ft::toString(static_cast<int>(this->_lookupChannels.size())) + " channels in " +
+		ft::toString(static_cast<int>((Metrics::now() - start) * 1e6)) + " us");
+	return true;
+}
@@ -1,4 +1,3 @@
-#include <unistd.h>
 #include "class/User.hpp"
 #include "class/Server.hpp"
 
@@ -14,46 +13,84 @@
  */
 std::string const	User::_availableModes("aio");
 
+std::pair<char const, unsigned int const> const	User::_arrayModes[] = {
+	std::pair<char const, unsigned int const>('a', AWAY),
+	std::pair<char const, unsigned int const>('i', INVISIBLE),
+	std::pair<char const, unsigned int const>('o', OPERATOR),
+	std::pair<char const, unsigned int const>(0, 0U)
+};
+
+/**
+ * The capabilities offered by CAP LS, in the order they are listed.
+ */
+std::pair<char const *const, unsigned int const> const	User::_arrayCaps[] = {
+	std::pair<char const *const, unsigned int const>("batch", BATCH),
+	std::pair<char const *const, unsigned int const>("echo-message", ECHO_MESSAGE),
+	std::pair<char const *const, unsigned int const>("message-tags", MESSAGE_TAGS),
+	std::pair<char const *const, unsigned int const>("multi-prefix", MULTI_PREFIX),
+	std::pair<char const *const, unsigned int const>("server-time", SERVER_TIME),
+	std::pair<char const *const, unsigned int const>(NULL, 0U)
+};
+
 std::string const	User::_availableNicknameChars("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_");
 
+std::string const	User::_noHostname;
+std::string const	User::_noNickname("*");
+
+/**
+ * The hostnames of the users, each stored once however many users share it,
+ * with the number of users sharing it.
+ */
+std::map<std::string const, unsigned long>	User::_lookupHostnames;
+
 // ************************************************************************** //
 //                                Constructors                                //
 // ************************************************************************** //
 
 User::User(sockaddr_in const &addr, int sockfd) :
-	_addr(addr),
 	_socket(sockfd),
-	_nickname("*"),
-	_username(),
-	_servname(),
-	_realname(),
-	_password(),
-	_awayMsg(),
-	_modes(),
-	_msg(),
-	_isRegistered(),
+	_state(CONNECTED),
+	_modes(0U),
+	_caps(0U),
+	_pendingJobs(0U),
+	_isNegotiating(false),
+	_isResolving(),
 	_waitingForPong(ALIVETIME),
+	_lastActivity(0),
+	_nickname(),
+	_mask(),
+	_msg(),
+	_input(),
+	_sendq(),
+	_hostname(NULL),
+	_identity(new t_identity()),
 	_lookupChannels()
 {
-	time(&_lastActivity);
+	this->_identity->addr = addr;
 }
 
-
 User::User(User const &src) :
-	_addr(src._addr),
 	_socket(src._socket),
-	_nickname(src._nickname),
-	_username(src._username),
-	_servname(src._servname),
-	_realname(src._realname),
-	_password(src._password),
-	_awayMsg(src._awayMsg),
+	_state(src._state),
 	_modes(src._modes),
-	_msg(src._msg),
-	_isRegistered(src._isRegistered),
+	_caps(src._caps),
+	_pendingJobs(src._pendingJobs),
+	_isNegotiating(src._isNegotiating),
+	_isResolving(src._isResolving),
 	_waitingForPong(src._waitingForPong),
 	_lastActivity(src._lastActivity),
-	_lookupChannels(src._lookupChannels) {}
+	_nickname(src._nickname),
+	_mask(src._mask),
+	_msg(src._msg),
+	_input(src._input),
+	_sendq(src._sendq),
+	_hostname(src._hostname),
+	_identity(new t_identity(*src._identity)),
+	_lookupChannels(src._lookupChannels)
+{
+	if (this->_hostname)
+		++User::_lookupHostnames.find(*this->_hostname)->second;
+}
 
 // ************************************************************************* //
 //                                Destructors                                //
@@ -62,9 +99,28 @@ User::User(User const &src) :
 
 User::~User(void)
 {
-	if (this->_socket != -1)
-		close(this->_socket);
-	this->_socket = -1;
+	this->releaseHostname();
+	delete this->_identity;
+}
+
+// ************************************************************************* //
+//                          Private Member Functions                         //
+// ************************************************************************* //
+
+/**
+ * @brief	Stop sharing the hostname of the user,
+ * 			forgetting it when no user has it any more.
+ */
+void	User::releaseHostname(void)
+{
+	std::map<std::string const, unsigned long>::iterator	it;
+
+	if (!this->_hostname)
+		return ;
+	it = User::_lookupHostnames.find(*this->_hostname);
+	if (!--it->second)
+		User::_lookupHostnames.erase(it);
+	this->_hostname = NULL;
 }
 
 // ************************************************************************* //
@@ -78,7 +134,48 @@ User::~User(void)
  */
 void	User::addChannel(Channel &channel)
 {
-	this->_lookupChannels.insert(std::pair<std::string const, Channel *>(channel.getName(), &channel));
+	this->_lookupChannels.insert(std::pair<Identifier const, Channel *>(channel.getNameId(), &channel));
+}
+
+/**
+ * @brief	Set some modes of the user.
+ * 
+ * @param	modes The bits of the modes to set.
+ */
+void	User::addModes(unsigned int const modes)
+{
+	this->_modes |= modes;
+}
+
+/**
+ * @brief	Append some bytes to the message to send to the user,
+ * 			in place, the buffer keeping its capacity between the sends.
+ * 
+ * @param	data The bytes to append.
+ * @param	size The number of bytes to append.
+ */
+void	User::appendMsg(char const *const data, size_t const size)
+{
+	this->_msg.append(data, size);
+}
+
+/**
+ * @brief	Queue some bytes the socket of the user could not take yet.
+ * 
+ * @param	data The bytes to queue.
+ * @param	size The number of bytes to queue.
+ */
+void	User::appendSendq(char const *const data, size_t const size)
+{
+	this->_sendq.append(data, size);
+}
+
+/**
+ * @brief	Stop monitoring every nickname.
+ */
+void	User::clearMonitors(void)
+{
+	this->_identity->monitors.clear();
 }
 
 /**
@@ -86,22 +183,284 @@ void	User::addChannel(Channel &channel)
  * 
  * @param	channelName The name of the channel to remove.
  */
-void	User::delChannel(std::string const &channelName)
+void	User::delChannel(Identifier const &channelName)
 {
 	this->_lookupChannels.erase(channelName);
 }
 
+/**
+ * @brief	Remove from the send queue the bytes the socket took.
+ * 
+ * @param	size The number of bytes sent.
+ */
+void	User::eraseSendq(size_t const size)
+{
+	this->_sendq.erase(0, size);
+}
+
+/**
+ * @brief	Unset some modes of the user.
+ * 
+ * @param	modes The bits of the modes to unset.
+ */
+void	User::delModes(unsigned int const modes)
+{
+	this->_modes &= ~modes;
+}
+
+/**
+ * @brief	Get the bit of a capability from its name.
+ * 
+ * @param	name The name of the capability.
+ * 
+ * @return	The bit of the capability, or 0 if there is no such capability.
+ */
+unsigned int	User::getCapBit(std::string const &name)
+{
+	unsigned int	idx;
+
+	for (idx = 0U ; User::_arrayCaps[idx].first ; ++idx)
+		if (name == User::_arrayCaps[idx].first)
+			return User::_arrayCaps[idx].second;
+	return 0U;
+}
+
+/**
+ * @brief	Get the names of some capabilities, separated by spaces,
+ * 			as in the replies to CAP.
+ * 
+ * @param	caps The bits of the capabilities.
+ * 
+ * @return	The names of the capabilities.
+ */
+std::string	User::getCapString(unsigned int const caps)
+{
+	std::string		capString;
+	unsigned int	idx;
+
+	for (idx = 0U ; User::_arrayCaps[idx].first ; ++idx)
+		if (caps & User::_arrayCaps[idx].second)
+		{
+			if (!capString.empty())
+				capString += ' ';
+			capString += User::_arrayCaps[idx].first;
+		}
+	return capString;
+}
+
+/**
+ * @brief	Get the bit of an user mode from its letter.
+ * 
+ * @param	letter The letter of the mode.
+ * 
+ * @return	The bit of the mode, or 0 if there is no such mode.
+ */
+unsigned int	User::getModeBit(char const letter)
+{
+	unsigned int	idx;
+
+	for (idx = 0U ; User::_arrayModes[idx].first ; ++idx)
+		if (User::_arrayModes[idx].first == letter)
+			return User::_arrayModes[idx].second;
+	return 0U;
+}
+
+/**
+ * @brief	Get the letters of the modes set for the user, as in RPL_UMODEIS.
+ * 
+ * @return	The mode string of the user.
+ */
+std::string	User::getModeString(void) const
+{
+	std::string		modeString("+");
+	unsigned int	idx;
+
+	for (idx = 0U ; User::_arrayModes[idx].first ; ++idx)
+		if (this->_modes & User::_arrayModes[idx].second)
+			modeString += User::_arrayModes[idx].first;
+	return modeString;
+}
+
+/**
+ * @brief	Monitor a nickname.
+ * 
+ * @param	nickname The nickname to monitor.
+ * 
+ * @return	Either true if the nickname was not monitored yet, or false if it was.
+ */
+bool	User::addMonitor(Identifier const &nickname)
+{
+	return this->_identity->monitors.insert(nickname).second;
+}
+
+/**
+ * @brief	Stop monitoring a nickname.
+ * 
+ * @param	nickname The nickname to stop monitoring.
+ * 
+ * @return	Either true if the nickname was monitored, or false if not.
+ */
+bool	User::delMonitor(Identifier const &nickname)
+{
+	return this->_identity->monitors.erase(nickname) != 0UL;
+}
+
+/**
+ * @brief	Check if a capability is enabled for the user.
+ * 
+ * @param	cap The bit of the capability to check.
+ * 
+ * @return	Either true if the capability is enabled, or false if not.
+ */
+bool	User::hasCap(unsigned int const cap) const
+{
+	return this->_caps & cap;
+}
+
+/**
+ * @brief	Check if a mode is set for the user.
+ * 
+ * @param	mode The bit of the mode to check.
+ * 
+ * @return	Either true if the mode is set, or false if not.
+ */
+bool	User::hasMode(unsigned int const mode) const
+{
+	return this->_modes & mode;
+}
+
+/**
+ * @brief	Check if the user is connected to another server of the network.
+ * 
+ * @return	Either true if the user is remote, or false if it is local.
+ */
+bool	User::isRemote(void) const
+{
+	return this->_identity->link != NULL;
+}
+
+/**
+ * @brief	Restore the user from a state written by save().
+ * 			Its socket, its link and its server are not part of the state.
+ * 
+ * @param	state The state to read from.
+ */
+void	User::load(StateReader &state)
+{
+	std::string	nickname;
+	std::string	hostname;
+	uint64_t	nb;
+
+	this->_state = static_cast<int>(state.getVarint());
+	this->_modes = static_cast<unsigned int>(state.getVarint());
+	this->_caps = static_cast<unsigned int>(state.getVarint());
+	this->_isNegotiating = state.getVarint() != 0U;
+	this->_waitingForPong = state.getVarint() != 0U;
+	this->_lastActivity = static_cast<time_t>(state.getVarint());
+	this->_identity->registerDeadline = static_cast<time_t>(state.getVarint());
+	this->_identity->timestamp = static_cast<time_t>(state.getVarint());
+	this->_identity->addr.sin_family = AF_INET;
+	this->_identity->addr.sin_addr.s_addr = static_cast<in_addr_t>(state.getVarint());
+	this->_identity->addr.sin_port = static_cast<in_port_t>(state.getVarint());
+	nickname = state.getString();
+	if (!nickname.empty())
+		this->setNickname(nickname);
+	this->_identity->username = state.getString();
+	hostname = state.getString();
+	if (!hostname.empty())
+		this->setHostname(hostname);
+	this->_identity->realname = state.getString();
+	this->_identity->awayMsg = state.getString();
+	this->_mask = state.getString();
+	this->_msg = state.getString();
+	this->_input = state.getString();
+	this->_sendq = state.getString();
+	for (nb = state.getVarint() ; nb && state.isValid() ; --nb)
+		this->_identity->monitors.insert(Identifier(state.getString()));
+}
+
+/**
+ * @brief	Count a new password attempt of the user,
+ * 			restarting the count if the current window has elapsed.
+ * 
+ * @param	window The duration (in second) of an attempt window.
+ * @param	now The current time.
+ */
+void	User::newAuthAttempt(time_t const window, time_t const now)
+{
+	if (now - this->_identity->authWindowStart >= window)
+	{
+		this->_identity->authWindowStart = now;
+		this->_identity->authAttempts = 0U;
+	}
+	++this->_identity->authAttempts;
+}
+
+/**
+ * @brief	Mark one of the user's jobs as completed.
+ * 			Its pending lines are processed again once no job is left.
+ */
+void	User::resume(void)
+{
+	if (this->_pendingJobs)
+		--this->_pendingJobs;
+}
+
+/**
+ * @brief	Write what is needed to restore the user in another process:
+ * 			its registration, its modes, its identity, the lines
+ * 			not yet sent to it nor processed, and the nicknames it monitors.
+ * 
+ * @param	state The state to write to.
+ */
+void	User::save(StateWriter &state) const
+{
+	std::set<Identifier>::const_iterator	cit;
+
+	state.putVarint(static_cast<uint64_t>(this->_state));
+	state.putVarint(this->_modes);
+	state.putVarint(this->_caps);
+	state.putVarint(this->_isNegotiating);
+	state.putVarint(this->_waitingForPong);
+	state.putVarint(static_cast<uint64_t>(this->_lastActivity));
+	state.putVarint(static_cast<uint64_t>(this->_identity->registerDeadline));
+	state.putVarint(static_cast<uint64_t>(this->_identity->timestamp));
+	state.putVarint(this->_identity->addr.sin_addr.s_addr);
+	state.putVarint(this->_identity->addr.sin_port);
+	state.putString(this->_nickname.empty() ? std::string() : this->_nickname.getName());
+	state.putString(this->_identity->username);
+	state.putString(this->_hostname ? *this->_hostname : std::string());
+	state.putString(this->_identity->realname);
+	state.putString(this->_identity->awayMsg);
+	state.putString(this->_mask);
+	state.putString(this->_msg);
+	state.putString(this->_input);
+	state.putString(this->_sendq);
+	state.putVarint(this->_identity->monitors.size());
+	for (cit = this->_identity->monitors.begin() ; cit != this->_identity->monitors.end() ; ++cit)
+		state.putString(cit->getName());
+}
+
+/**
+ * @brief	Mark a job as pending for the user,
+ * 			parking the processing of its next lines until it completes.
+ */
+void	User::suspend(void)
+{
+	++this->_pendingJobs;
+}
+
 // TODO: write the function comment
 bool	User::init(int const &socket, sockaddr_in const &addr)
 {
 	this->_socket = socket;
-	this->_addr = addr;
+	this->_identity->addr = addr;
 	return true;
 }
 
-void	User::updateLastActivity(void)
+void	User::updateLastActivity(time_t const now)
 {
-	time(&this->_lastActivity);
+	this->_lastActivity = now;
 }
 
 // ************************************************************************* //
@@ -110,7 +469,7 @@ void	User::updateLastActivity(void)
 
 sockaddr_in const	&User::getAddr(void) const
 {
-	return this->_addr;
+	return this->_identity->addr;
 }
 
 std::string const	&User::getAvailableModes(void)
@@ -120,7 +479,7 @@ std::string const	&User::getAvailableModes(void)
 
 std::string const	&User::getAwayMsg(void) const
 {
-	return this->_awayMsg;
+	return this->_identity->awayMsg;
 }
 
 std::string const	&User::getAvailableNicknameChars(void)
@@ -130,25 +489,55 @@ std::string const	&User::getAvailableNicknameChars(void)
 
 std::string const	&User::getHostname(void) const
 {
-	return this->_hostname;
+	return this->_hostname ? *this->_hostname : User::_noHostname;
 }
 
-bool const	&User::getIsRegistered(void) const
+unsigned int const	&User::getAuthAttempts(void) const
 {
-	return this->_isRegistered;
+	return this->_identity->authAttempts;
 }
 
-std::map<std::string const, Channel *const> const	&User::getLookupChannels(void) const
+unsigned int const	&User::getCaps(void) const
+{
+	return this->_caps;
+}
+
+bool const	&User::getIsNegotiating(void) const
+{
+	return this->_isNegotiating;
+}
+
+bool const	&User::getIsResolving(void) const
+{
+	return this->_isResolving;
+}
+
+std::map<Identifier const, Channel *const> const	&User::getLookupChannels(void) const
 {
 	return this->_lookupChannels;
 }
 
+std::set<Identifier> const	&User::getMonitors(void) const
+{
+	return this->_identity->monitors;
+}
+
+User	*User::getLink(void) const
+{
+	return this->_identity->link;
+}
+
+std::string const	&User::getInput(void) const
+{
+	return this->_input;
+}
+
 std::string const	&User::getMask(void) const
 {
 	return this->_mask;
 }
 
-std::string const	&User::getModes(void) const
+unsigned int const	&User::getModes(void) const
 {
 	return this->_modes;
 }
@@ -159,13 +548,18 @@ std::string const	&User::getMsg(void) const
 }
 
 std::string const	&User::getNickname(void) const
+{
+	return this->_nickname.empty() ? User::_noNickname : this->_nickname.getName();
+}
+
+Identifier const	&User::getNicknameId(void) const
 {
 	return this->_nickname;
 }
 
-std::string const	&User::getPassword(void) const
+unsigned int const	&User::getPendingJobs(void) const
 {
-	return this->_password;
+	return this->_pendingJobs;
 }
 
 time_t const	&User::getLastActivity(void) const
@@ -175,12 +569,31 @@ time_t const	&User::getLastActivity(void) const
 
 std::string const	&User::getRealname(void) const
 {
-	return this->_realname;
+	return this->_identity->realname;
+}
+
+time_t const	&User::getResolveDeadline(void) const
+{
+	return this->_identity->resolveDeadline;
+}
+
+time_t const	&User::getRegisterDeadline(void) const
+{
+	return this->_identity->registerDeadline;
 }
 
-std::string const	&User::getServname(void) const
+std::string const	&User::getSendq(void) const
 {
-	return this->_servname;
+	return this->_sendq;
+}
+
+/**
+ * @brief	Get the name of the server the user is connected to,
+ * 			NULL if it is this one.
+ */
+std::string const	*User::getServer(void) const
+{
+	return this->_identity->server;
 }
 
 int const	&User::getSocket(void) const
@@ -188,9 +601,23 @@ int const	&User::getSocket(void) const
 	return this->_socket;
 }
 
+int const	&User::getState(void) const
+{
+	return this->_state;
+}
+
+/**
+ * @brief	Get when the user took its nickname, the oldest one winning
+ * 			a nickname two servers of the network gave at once.
+ */
+time_t const	&User::getTimestamp(void) const
+{
+	return this->_identity->timestamp;
+}
+
 std::string const	&User::getUsername(void) const
 {
-	return this->_username;
+	return this->_identity->username;
 }
 
 bool const	&User::getWaitingForPong(void) const
@@ -203,22 +630,53 @@ bool const	&User::getWaitingForPong(void) const
 
 void	User::setAddr(sockaddr_in const &addr)
 {
-	this->_addr = addr;
+	this->_identity->addr = addr;
 }
 
 void	User::setAwayMsg(std::string const &awayMsg)
 {
-	this->_awayMsg = awayMsg;
+	this->_identity->awayMsg = awayMsg;
 }
 
+/**
+ * @brief	Set the hostname of the user, shared with the other users having
+ * 			the same one.
+ * 
+ * @param	hostname The hostname to set.
+ */
 void	User::setHostname(std::string const &hostname)
 {
-	this->_hostname = hostname;
+	std::map<std::string const, unsigned long>::iterator	it;
+
+	it = User::_lookupHostnames.insert(std::make_pair(hostname, 0UL)).first;
+	++it->second;
+	this->releaseHostname();
+	this->_hostname = &it->first;
+}
+
+void	User::setInput(std::string const &input)
+{
+	this->_input = input;
 }
 
-void	User::setIsRegistered(bool const isRegistered)
+void	User::setCaps(unsigned int const caps)
 {
-	this->_isRegistered = isRegistered;
+	this->_caps = caps;
+}
+
+void	User::setIsNegotiating(bool const isNegotiating)
+{
+	this->_isNegotiating = isNegotiating;
+}
+
+void	User::setIsResolving(bool const isResolving)
+{
+	this->_isResolving = isResolving;
+}
+
+void	User::setLink(User *const link)
+{
+	this->_identity->link = link;
 }
 
 void	User::setMask(std::string const &mask)
@@ -228,7 +686,7 @@ void	User::setMask(std::string const &mask)
 
 void	User::setMask(void)
 {
-	this->_mask = this->_nickname + '!' + this->_username + '@' + this->_servname;
+	this->_mask = this->getNickname() + '!' + this->_identity->username + '@' + this->getHostname();
 }
 
 void	User::setMsg(std::string const &msg)
@@ -236,29 +694,35 @@ void	User::setMsg(std::string const &msg)
 	this->_msg = msg;
 }
 
-void	User::setModes(std::string const &modes)
+void	User::setModes(unsigned int const modes)
 {
 	this->_modes = modes;
 }
 
 void	User::setNickname(std::string const &nickname)
 {
-	this->_nickname = nickname;
+	this->_nickname = Identifier(nickname);
+	this->_nickname.setName(nickname);
 }
 
-void	User::setPassword(std::string const &password)
+void	User::setRealname(std::string const &realname)
 {
-	this->_password = password;
+	this->_identity->realname = realname;
 }
 
-void	User::setRealname(std::string const &realname)
+void	User::setResolveDeadline(time_t const resolveDeadline)
+{
+	this->_identity->resolveDeadline = resolveDeadline;
+}
+
+void	User::setRegisterDeadline(time_t const registerDeadline)
 {
-	this->_realname = realname;
+	this->_identity->registerDeadline = registerDeadline;
 }
 
-void	User::setServname(std::string const &servname)
+void	User::setServer(std::string const *const server)
 {
-	this->_servname = servname;
+	this->_identity->server = server;
 }
 
 void	User::setSocket(int const sockfd)
@@ -266,9 +730,19 @@ void	User::setSocket(int const sockfd)
 	this->_socket = sockfd;
 }
 
+void	User::setState(int const state)
+{
+	this->_state = state;
+}
+
+void	User::setTimestamp(time_t const timestamp)
+{
+	this->_identity->timestamp = timestamp;
+}
+
 void	User::setUsername(std::string const &username)
 {
-	this->_username = username;
+	this->_identity->username = username;
 }
 
 void	User::setWaitingForPong(bool const waitingForPong)
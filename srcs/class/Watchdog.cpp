@@ -0,0 +1,188 @@
+#include <cstring>
+#include <sstream>
+#include "class/Watchdog.hpp"
+
+char const *const	Watchdog::_arrayPhaseNames[] = {
+	"accept",
+	"read",
+	"dispatch",
+	"flush",
+	"timers",
+	"wait"
+};
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+Watchdog::Watchdog(void) :
+	_threshold(0),
+	_tickStart(0),
+	_last(0),
+	_durations(),
+	_phase(ACCEPT),
+	_fd(-1),
+	_name(),
+	_worstSlice(),
+	_worstCommand(),
+	_slowTicks() {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+Watchdog::~Watchdog(void) {}
+
+// ************************************************************************** //
+//                          Private Member Functions                          //
+// ************************************************************************** //
+
+/**
+ * @brief	Copy a name into a fixed size buffer, truncating it if needed.
+ * 
+ * @param	dst The buffer to copy the name into.
+ * @param	src The name to copy, if any.
+ */
+void	Watchdog::copyName(char *const dst, std::string const *const src)
+{
+	size_t	len;
+
+	len = 0;
+	if (src)
+		len = src->copy(dst, WATCHDOG_NAME_SIZE - 1);
+	dst[len] = 0;
+}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Register the slow ticks counters, and set the threshold
+ * 			above which a tick is slow.
+ * 
+ * @param	metrics The registry to register the counters in.
+ * @param	threshold The threshold in nanoseconds, 0 disabling the detection.
+ */
+void	Watchdog::init(Metrics &metrics, uint64_t const threshold)
+{
+	int	phase;
+
+	this->_threshold = threshold;
+	for (phase = ACCEPT ; phase < WAIT ; ++phase)
+		this->_slowTicks[phase] = metrics.addCounter("ircserv_slow_ticks_total",
+			"Loop iterations slower than the slow_tick threshold, by phase taking the most time.",
+			std::string("phase=\"") + Watchdog::_arrayPhaseNames[phase] + '"');
+}
+
+/**
+ * @brief	Start a new tick.
+ */
+void	Watchdog::start(void)
+{
+	this->_tickStart = Metrics::nanoseconds();
+	this->_last = this->_tickStart;
+	std::memset(this->_durations, 0, sizeof(this->_durations));
+	this->_phase = ACCEPT;
+	this->_fd = -1;
+	this->_name[0] = 0;
+	this->_worstSlice.duration = 0;
+	this->_worstCommand.duration = 0;
+}
+
+/**
+ * @brief	Charge the time elapsed since the previous mark to the previous
+ * 			phase, then enter the next one.
+ * 
+ * @param	phase The phase being entered.
+ * @param	fd The socket of the client the phase works for, if any.
+ * @param	name The nickname of this client, if any.
+ */
+void	Watchdog::mark(int const phase, int const fd, std::string const *const name)
+{
+	uint64_t const	now = Metrics::nanoseconds();
+	uint64_t const	elapsed = now - this->_last;
+
+	this->_durations[this->_phase] += elapsed;
+	if (this->_phase != WAIT && elapsed > this->_worstSlice.duration)
+	{
+		this->_worstSlice.duration = elapsed;
+		this->_worstSlice.phase = this->_phase;
+		this->_worstSlice.fd = this->_fd;
+		std::memcpy(this->_worstSlice.name, this->_name, WATCHDOG_NAME_SIZE);
+	}
+	this->_last = now;
+	this->_phase = phase;
+	this->_fd = fd;
+	Watchdog::copyName(this->_name, name);
+}
+
+/**
+ * @brief	Keep track of the longest command of the tick.
+ * 
+ * @param	name The name of the command.
+ * @param	duration The time the command took, in nanoseconds.
+ */
+void	Watchdog::command(std::string const &name, uint64_t const duration)
+{
+	if (duration <= this->_worstCommand.duration)
+		return ;
+	this->_worstCommand.duration = duration;
+	this->_worstCommand.phase = DISPATCH;
+	this->_worstCommand.fd = this->_fd;
+	Watchdog::copyName(this->_worstCommand.name, &name);
+}
+
+/**
+ * @brief	End the current tick, and count it if it was slow.
+ * 			The time spent waiting is not taken into account.
+ * 
+ * @return	true if the tick was slow, false otherwise.
+ */
+bool	Watchdog::finish(void)
+{
+	uint64_t	busy;
+	int			phase;
+	int			slowest;
+
+	this->mark(WAIT);
+	for (phase = ACCEPT, busy = 0, slowest = ACCEPT ; phase < WAIT ; ++phase)
+	{
+		busy += this->_durations[phase];
+		if (this->_durations[phase] > this->_durations[slowest])
+			slowest = phase;
+	}
+	if (!this->_threshold || busy < this->_threshold)
+		return false;
+	++*this->_slowTicks[slowest];
+	return true;
+}
+
+/**
+ * @brief	Describe the last tick: the time spent in each phase,
+ * 			the longest slice of time and the longest command.
+ * 
+ * @return	The description.
+ */
+std::string	Watchdog::report(void) const
+{
+	std::ostringstream	oss;
+	uint64_t			busy;
+	int					phase;
+
+	for (phase = ACCEPT, busy = 0 ; phase < WAIT ; ++phase)
+		busy += this->_durations[phase];
+	oss << "Slow tick: " << busy / 1000000 << "ms (";
+	for (phase = ACCEPT ; phase < WAIT ; ++phase)
+		oss << (phase == ACCEPT ? "" : ", ") << Watchdog::_arrayPhaseNames[phase] << ' ' << this->_durations[phase] / 1000000 << "ms";
+	oss << "), longest: " << Watchdog::_arrayPhaseNames[this->_worstSlice.phase];
+	if (this->_worstSlice.fd != -1)
+		oss << " for (" << this->_worstSlice.fd << ") " << this->_worstSlice.name;
+	else if (this->_worstSlice.name[0])
+		oss << " for " << this->_worstSlice.name;
+	oss << ' ' << this->_worstSlice.duration / 1000000 << "ms";
+	if (this->_worstCommand.duration)
+		oss << ", command " << this->_worstCommand.name << " from (" << this->_worstCommand.fd << ") "
+			<< this->_worstCommand.duration / 1000000 << "ms";
+	return oss.str();
+}
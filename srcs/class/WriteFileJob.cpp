@@ -0,0 +1,98 @@
+#include <cerrno>
+#include <cstdio> // rename
+#include <cstring> // strerror
+#include <fcntl.h>
+#include <unistd.h>
+#include "class/WriteFileJob.hpp"
+#include "ft.hpp"
+
+// ************************************************************************** //
+//                                Constructors                                //
+// ************************************************************************** //
+
+WriteFileJob::WriteFileJob(User *const user, t_done const done, std::string const &path, std::string const &data) :
+	Job(user, done),
+	_path(path),
+	_error(),
+	_data(data) {}
+
+// ************************************************************************* //
+//                                Destructors                                //
+// ************************************************************************* //
+
+WriteFileJob::~WriteFileJob(void) {}
+
+// ************************************************************************* //
+//                          Public Member Functions                          //
+// ************************************************************************* //
+
+/**
+ * @brief	Replace the whole file, atomically: the data is written and synced
+ * 			to a temporary file next to it, which is then renamed over it,
+ * 			so the file is either the former one or the new one, never a part.
+ * 			Run on a worker thread.
+ */
+void	WriteFileJob::execute(void)
+{
+	std::string const	tmpPath = this->_path + ".tmp." + ft::toString(static_cast<int>(getpid()));
+	std::string const	dir = this->_path.find('/') == std::string::npos ? "." : this->_path.substr(0, this->_path.rfind('/') + 1);
+	size_t				written;
+	ssize_t				ret;
+	int					fd;
+
+	fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if (fd == -1)
+	{
+		this->_error = "open: " + std::string(strerror(errno));
+		return ;
+	}
+	for (written = 0UL ; written < this->_data.size() ; written += static_cast<size_t>(ret))
+	{
+		ret = write(fd, this->_data.data() + written, this->_data.size() - written);
+		if (ret == -1 && errno != EINTR)
+			break ;
+		if (ret == -1)
+			ret = 0;
+	}
+	if (written < this->_data.size())
+		this->_error = "write: " + std::string(strerror(errno));
+	else if (fsync(fd) == -1)
+		this->_error = "fsync: " + std::string(strerror(errno));
+	close(fd);
+	if (this->_error.empty() && std::rename(tmpPath.c_str(), this->_path.c_str()) == -1)
+		this->_error = "rename: " + std::string(strerror(errno));
+	if (!this->_error.empty())
+	{
+		unlink(tmpPath.c_str());
+		return ;
+	}
+	// The rename itself only lasts once the directory is synced.
+	fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd != -1)
+	{
+		fsync(fd);
+		close(fd);
+	}
+}
+
+// ************************************************************************* //
+//                                 Accessors                                 //
+// ************************************************************************* //
+
+std::string const	&WriteFileJob::getPath(void) const
+{
+	return this->_path;
+}
+
+std::string const	&WriteFileJob::getData(void) const
+{
+	return this->_data;
+}
+
+/**
+ * @brief	Get why the file could not be written, empty if it was.
+ */
+std::string const	&WriteFileJob::getError(void) const
+{
+	return this->_error;
+}
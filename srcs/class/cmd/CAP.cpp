@@ -0,0 +1,71 @@
+#include <algorithm> // transform
+#include <cctype> // toupper
+#include "class/Server.hpp"
+
+/**
+ * @brief	Negotiate the IRCv3 capabilities of an user.
+ * 			The supported subcommands are:
+ * 			- LS [version]: list the capabilities offered
+ * 			- LIST: list the capabilities enabled for the user
+ * 			- REQ :<[-]capability>...: enable, or disable with a '-',
+ * 			all of the capabilities, or none if one is not offered
+ * 			- END: end the negotiation
+ * 			An user starting the negotiation with LS or REQ before being
+ * 			registered is only registered once it ends it.
+ * 
+ * @param	user The user that ran the command.
+ * @param	params The parameters of the command.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::CAP(User &user, ArenaString const &params)
+{
+	t_params					args;
+	ArenaString::const_iterator	cit0;
+	ArenaString::const_iterator	cit1;
+	std::string					subcommand;
+	std::string					name;
+	unsigned int				caps;
+	unsigned int				cap;
+
+	Server::splitParams(params, args);
+	if (args.empty())
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "CAP");
+	subcommand.assign(args[0].data(), args[0].size());
+	std::transform(subcommand.begin(), subcommand.end(), subcommand.begin(), ::toupper);
+
+	if (subcommand == "END")
+	{
+		if (!user.getIsNegotiating())
+			return true;
+		user.setIsNegotiating(false);
+		return this->registerUser(user);
+	}
+	if (subcommand == "LIST")
+		return this->replyPush(user, this->_numericPrefix + "CAP " + user.getNickname() + " LIST :" + User::getCapString(user.getCaps()));
+	if (subcommand != "LS" && subcommand != "REQ")
+		return this->replyNumeric<ERR_INVALIDCAPCMD>(user, subcommand);
+
+	if (user.getState() != User::REGISTERED)
+		user.setIsNegotiating(true);
+	if (subcommand == "LS")
+		return this->replyPush(user, this->_numericPrefix + "CAP " + user.getNickname() + " LS :" + User::getCapString(~0U));
+	if (args.size() < 2)
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "CAP");
+
+	caps = user.getCaps();
+	for (cit1 = args[1].begin() ; cit1 != args[1].end() ; )
+	{
+		for ( ; cit1 != args[1].end() && *cit1 == ' ' ; ++cit1);
+		for (cit0 = cit1 ; cit1 != args[1].end() && *cit1 != ' ' ; ++cit1);
+		if (cit0 == cit1)
+			break ;
+		name.assign(cit0 + (*cit0 == '-'), cit1);
+		cap = User::getCapBit(name);
+		if (!cap)
+			return this->replyPush(user, this->_numericPrefix + "CAP " + user.getNickname() + " NAK :" + args[1]);
+		caps = *cit0 == '-' ? caps & ~cap : caps | cap;
+	}
+	user.setCaps(caps);
+	return this->replyPush(user, this->_numericPrefix + "CAP " + user.getNickname() + " ACK :" + args[1]);
+}
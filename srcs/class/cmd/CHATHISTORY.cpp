@@ -0,0 +1,143 @@
+#include <algorithm> // transform
+#include <cctype> // toupper
+#include <cstdio> // sprintf, sscanf
+#include <cstring> // memcpy
+#include "class/Server.hpp"
+
+/**
+ * @brief	Read the message a CHATHISTORY command refers to: either
+ * 			`msgid=<msgid>`, `timestamp=YYYY-MM-DDThh:mm:ss.sssZ`, or `*`
+ * 			for the latest messages.
+ * 
+ * @param	reference The reference to the message.
+ * @param	byTime Set to whether the reference is a time or a msgid.
+ * @param	key Set to the msgid, or to the time in milliseconds,
+ * 			0 for `*`.
+ * 
+ * @return	true if the reference is valid, false otherwise.
+ */
+inline static bool	__parseReference(ArenaString const &reference, bool &byTime, uint64_t &key)
+{
+	tm		date;
+	char	*end;
+	char	zone;
+	int		ms;
+
+	byTime = false;
+	key = 0UL;
+	if (reference == "*")
+		return true;
+	if (!reference.compare(0, 6, "msgid="))
+	{
+		if (!isxdigit(reference.c_str()[6]))
+			return false;
+		key = std::strtoul(reference.c_str() + 6, &end, 16);
+		return !*end;
+	}
+	if (reference.compare(0, 10, "timestamp="))
+		return false;
+	std::memset(&date, 0, sizeof(date));
+	if (std::sscanf(reference.c_str() + 10, "%4d-%2d-%2dT%2d:%2d:%2d.%3d%c", &date.tm_year, &date.tm_mon, &date.tm_mday,
+		&date.tm_hour, &date.tm_min, &date.tm_sec, &ms, &zone) != 8 || zone != 'Z' || ms < 0)
+		return false;
+	date.tm_year -= 1900;
+	date.tm_mon -= 1;
+	byTime = true;
+	key = static_cast<uint64_t>(timegm(&date)) * 1000UL + static_cast<uint64_t>(ms);
+	return true;
+}
+
+/**
+ * @brief	Send the messages sent lately to a channel the user is a member of,
+ * 			oldest first, each tagged with its time and its msgid as the user
+ * 			asked for with CAP, in a `chathistory` batch if it asked for batch.
+ * 			The supported subcommands are:
+ * 			- LATEST <target> <* | reference> <limit>: the most recent ones,
+ * 			past the reference if any
+ * 			- BEFORE <target> <reference> <limit>: the most recent ones
+ * 			before the reference
+ * 			- AFTER <target> <reference> <limit>: the oldest ones past the
+ * 			reference
+ * 			The reference is either `msgid=<msgid>` or
+ * 			`timestamp=YYYY-MM-DDThh:mm:ss.sssZ`, and at most
+ * 			CHATHISTORY_LIMIT messages are sent: a client pages through the
+ * 			history with BEFORE the oldest message it got.
+ * 
+ * @param	user The user that ran the command.
+ * @param	params The parameters of the command.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::CHATHISTORY(User &user, ArenaString const &params)
+{
+	t_params										args;
+	std::map<Identifier const, Channel>::iterator	chan;
+	History::t_entry const							*entry;
+	History::e_select								way;
+	std::string										subcommand;
+	char											line[7 + 16 + 1 + TAGS_LENGTH + HISTORY_LINE_LENGTH];
+	char											batch[17];
+	char											*end;
+	uint64_t										key;
+	size_t											limit;
+	size_t											nb;
+	size_t											size;
+	size_t											tags;
+	bool											byTime;
+
+	Server::splitParams(params, args);
+	if (args.empty())
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "CHATHISTORY");
+	subcommand.assign(args[0].data(), args[0].size());
+	std::transform(subcommand.begin(), subcommand.end(), subcommand.begin(), ::toupper);
+	if (subcommand == "LATEST")
+		way = History::LATEST;
+	else if (subcommand == "BEFORE")
+		way = History::BEFORE;
+	else if (subcommand == "AFTER")
+		way = History::AFTER;
+	else
+		return this->fail(user, "CHATHISTORY UNKNOWN_COMMAND " + subcommand + " :Unknown subcommand");
+	if (args.size() < 4)
+		return this->fail(user, "CHATHISTORY NEED_MORE_PARAMS " + subcommand + " :Missing parameters");
+	if (!__parseReference(args[2], byTime, key) || (way != History::LATEST && !key))
+		return this->fail(user, "CHATHISTORY INVALID_PARAMS " + subcommand + " :Invalid message reference");
+	limit = isdigit(args[3][0]) ? std::strtoul(args[3].c_str(), &end, 10) : 0UL;
+	if (!limit || *end)
+		return this->fail(user, "CHATHISTORY INVALID_PARAMS " + subcommand + " :Invalid limit");
+
+	chan = this->_lookupChannels.find(Identifier::find(args[1]));
+	if (chan == this->_lookupChannels.end() || chan->second.find(user.getNicknameId()) == chan->second.end())
+		return this->fail(user, "CHATHISTORY INVALID_TARGET " + subcommand + ' ' + std::string(args[1].data(), args[1].size()) +
+			" :Messages could not be retrieved");
+
+	nb = this->_history.select(chan->second.getHistory(), way, byTime, key, std::min(limit, static_cast<size_t>(CHATHISTORY_LIMIT)), entry);
+	// The batch is named after its first message, an empty batch being sent too.
+	std::sprintf(batch, "%lx", nb ? static_cast<unsigned long>(entry->msgid) : 0UL);
+	if (user.hasCap(User::BATCH) &&
+		!this->replyPush(user, this->_numericPrefix + "BATCH +" + batch + " chathistory " + chan->second.getName()))
+		return false;
+	for ( ; nb ; --nb)
+	{
+		size = 0UL;
+		if (user.hasCap(User::BATCH))
+		{
+			size = static_cast<size_t>(std::sprintf(line, "@batch=%s", batch));
+			line[size] = ' ';
+		}
+		// The other tags follow the batch one, in place of its space.
+		tags = TaggedLine::putTags(line + size, user.getCaps(), entry->msgid, entry->time);
+		if (size && tags)
+			line[size] = ';';
+		else if (size)
+			tags = 1UL;
+		size += tags;
+		memcpy(line + size, History::getLine(entry), entry->size);
+		if (!this->replyPush(user, line, size + entry->size))
+			return false;
+		if (nb > 1)
+			entry = this->_history.next(chan->second.getHistory(), entry);
+	}
+	return !user.hasCap(User::BATCH) ||
+		this->replyPush(user, this->_numericPrefix + "BATCH -" + batch);
+}
@@ -9,10 +9,10 @@
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::DIE(User &user, std::string const &params __attribute__((unused)))
+bool	Server::DIE(User &user, ArenaString const &params __attribute__((unused)))
 {
-	if (user.getModes().find('o') == std::string::npos)
-		return this->replyPush(user, "481 " + user.getNickname() + " :Permission Denied - You're not an IRC operator");
+	if (!user.hasMode(User::OPERATOR))
+		return this->replyNumeric<ERR_NOPRIVILEGES>(user);
 	this->_state = STOPPED;
 	return true;
 }
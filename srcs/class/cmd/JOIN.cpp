@@ -1,65 +1,160 @@
 #include "class/Server.hpp"
+#include "ft.hpp"
 
 /**
  * @brief	Make an user joining one or more channel(s).
+ * 			Keys are matched with channels in the same order.
+ * 			The channels past the TARGMAX limit are not joined, and the names
+ * 			longer than `channel_length` are refused.
+ * 			The user creating a channel becomes its operator, the channel
+ * 			getting back its settings if it is in the snapshot.
+ * 			The linked servers are told with a SJOIN.
+ * 			An user asking for multi-prefix is told every prefix of a member.
+ * 			The names take as many RPL_NAMREPLY as their lines need.
  * 
  * @param	user The user that ran the command.
  * @param	params The parameters of the command.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::JOIN(User &user, std::string const &params)
+bool	Server::JOIN(User &user, ArenaString const &params)
 {
-	std::string													channelsToJoin;
-	std::string													reason("has joined the channel");
-	std::string													channelName;
-	std::string													userList;
-	std::string::const_iterator									cit0;
-	std::string::const_iterator									cit1;
-	std::map<std::string const, User *const>::const_iterator	cit2;
-	std::map<std::string const, Channel>::iterator				it;
+	ArenaString													channelsToJoin;
+	ArenaString													keys;
+	ArenaString													channelName;
+	ArenaString													key;
+	ArenaString													userList;
+	ArenaString													member;
+	ArenaString::const_iterator									cit0;
+	ArenaString::const_iterator									cit1;
+	ArenaString::const_iterator									cit3;
+	std::map<Identifier const, User *const>::const_iterator	cit2;
+	std::map<Identifier const, Channel>::iterator				it;
+	unsigned int												memberModes;
+	size_t														nbTargets;
+	size_t														headLength;
+	bool														isCreated;
 
 	for (cit0 = params.begin(), cit1 = params.begin() ; cit1 != params.end() && *cit1 != ' ' && *cit1 != ':' ; ++cit1);
-	channelsToJoin = std::string(cit0, cit1);
+	channelsToJoin = ArenaString(cit0, cit1);
 	if (channelsToJoin.empty())
-		return this->replyPush(user, ':' + user.getMask() + " 461 " + user.getNickname() + " JOIN :Not enough parameters");
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "JOIN");
 
-	if (cit1 != params.end() && *cit1 == ':')
-		reason = std::string(cit1 + 1, static_cast<std::string::const_iterator>(params.end()));
+	for ( ; cit1 != params.end() && (*cit1 == ' ' || *cit1 == ':') ; ++cit1);
+	for (cit0 = cit1 ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
+	keys = ArenaString(cit0, cit1);
 
-	for (cit1 = channelsToJoin.begin() ; cit1 != channelsToJoin.end() ; ++cit1)
+	for (cit1 = channelsToJoin.begin(), cit3 = keys.begin(), nbTargets = 0UL ; cit1 != channelsToJoin.end() ; ++cit1)
 	{
 		for (cit0 = cit1 ; cit1 != channelsToJoin.end() && *cit1 != ',' ; ++cit1);
-		channelName = std::string(cit0, cit1);
+		channelName = ArenaString(cit0, cit1);
 		if (*channelName.begin() != '#')
 			channelName.insert(channelName.begin(), '#');
+		for (cit0 = cit3 ; cit3 != keys.end() && *cit3 != ',' ; ++cit3);
+		key = ArenaString(cit0, cit3);
+		if (cit3 != keys.end())
+			++cit3;
+		if (this->_limits.joinTargets && ++nbTargets > this->_limits.joinTargets)
+			return this->replyNumeric<ERR_TOOMANYTARGETS>(user, channelName);
+		if (this->_limits.channelLength && channelName.size() > this->_limits.channelLength)
+		{
+			if (!this->replyNumeric<ERR_BADCHANMASK>(user, channelName))
+				return false;
+			if (cit1 == channelsToJoin.end())
+				break ;
+			continue ;
+		}
+
+		it = this->_lookupChannels.find(Identifier::find(channelName));
+		isCreated = (it == this->_lookupChannels.end());
+		if (isCreated)
+		{
+			Channel	newChannel(std::string(channelName.data(), channelName.size()));
 
-		it = this->_lookupChannels.find(channelName);
-		if (it == this->_lookupChannels.end())
+			// A channel of the snapshot comes back with its settings and bans.
+			if (!this->wakeChannel(newChannel))
+				newChannel.setTimestamp(this->_clock->now());
+			it = this->_lookupChannels.insert(std::pair<Identifier const, Channel>(newChannel.getNameId(), newChannel)).first;
+		}
+		Channel	&chan = it->second;
+		channelName.assign(chan.getName().data(), chan.getName().size());
+
+		if (chan.find(user.getNicknameId()) != chan.end())
+			;
+		else if (chan.isBanned(user))
 		{
-			this->_lookupChannels.insert(std::pair<std::string const, Channel>(channelName, Channel(channelName)));
-			it = this->_lookupChannels.find(channelName);
+			if (!this->replyNumeric<ERR_BANNEDFROMCHAN>(user, channelName))
+				return false;
 		}
-		if (it->second.find(user.getNickname()) == it->second.end())
+		else if (chan.hasMode(Channel::INVITE_ONLY) && !user.hasMode(User::OPERATOR))
 		{
-			it->second.addUser(user);
-			user.addChannel(it->second);
+			if (!this->replyNumeric<ERR_INVITEONLYCHAN>(user, channelName))
+				return false;
+		}
+		else if (chan.hasMode(Channel::KEY) && key != chan.getKey())
+		{
+			if (!this->replyNumeric<ERR_BADCHANNELKEY>(user, channelName))
+				return false;
+		}
+		else if (chan.hasMode(Channel::LIMIT) && chan.size() >= chan.getLimit())
+		{
+			if (!this->replyNumeric<ERR_CHANNELISFULL>(user, channelName))
+				return false;
+		}
+		else
+		{
+			chan.addUser(user);
+			if (isCreated)
+			{
+				chan.addMemberModes(user, Channel::CHANOP);
+				this->forgetDormant(chan.getNameId());
+			}
+			user.addChannel(chan);
 
-			for (cit2 = it->second.begin() ; cit2 != it->second.end() ; ++cit2)
-				userList += ' ' + cit2->second->getNickname();
+			if (!this->replyPush(user, ArenaString(1, ':') + user.getMask() + " JOIN " + channelName) ||
+				(chan.getTopic().empty() ?
+					!this->replyNumeric<RPL_NOTOPIC>(user, channelName) :
+					!this->replyNumeric<RPL_TOPIC>(user, channelName, chan.getTopic())))
+				return false;
 
-			if (!this->replyPush(user, ':' + user.getMask() + " JOIN " + channelName) ||
-				!this->replyPush(user, ':' + user.getMask() + " 332 " + user.getNickname() + ' ' + channelName + " :" + it->second.getTopic()) ||
-				!this->replyPush(user, ':' + user.getMask() + " 353 " + user.getNickname() + " = " + channelName + " :" + userList) ||
-				!this->replyPush(user, ':' + user.getMask() + " 366 " + user.getNickname() + ' ' + channelName + " :End of /NAMES list"))
+			// ":<server> 353 <nick> = <channel> :" comes before the names.
+			headLength = this->_numericPrefix.size() + user.getNickname().size() + channelName.size() + 9UL;
+			for (userList.clear(), cit2 = chan.begin() ; cit2 != chan.end() ; ++cit2)
+			{
+				memberModes = chan.getMemberModes(*cit2->second);
+				member.clear();
+				if (memberModes & Channel::CHANOP)
+					member += '@';
+				if ((memberModes & Channel::VOICE) && (!(memberModes & Channel::CHANOP) || user.hasCap(User::MULTI_PREFIX)))
+					member += '+';
+				member += cit2->second->getNickname();
+				// Big channels take several lines.
+				if (!userList.empty() && headLength + userList.size() + 1UL + member.size() > MAX_LINE_LENGTH)
+				{
+					if (!this->replyNumeric<RPL_NAMREPLY>(user, chan.hasMode(Channel::SECRET) ? '@' : '=', channelName, userList))
+						return false;
+					userList.clear();
+				}
+				if (!userList.empty())
+					userList += ' ';
+				userList += member;
+			}
+			if (!this->replyNumeric<RPL_NAMREPLY>(user, chan.hasMode(Channel::SECRET) ? '@' : '=', channelName, userList) ||
+				!this->replyNumeric<RPL_ENDOFNAMES>(user, channelName))
 				return false;
 
-			for (cit2 = it->second.begin() ; cit2 != it->second.end() ; cit2++)
+			for (cit2 = chan.begin() ; cit2 != chan.end() ; cit2++)
 				if (cit2->second != &user &&
-					(!this->replyPush(*cit2->second, ':' + user.getMask() + " JOIN " + channelName) ||
+					(!this->replyPush(*cit2->second, ArenaString(1, ':') + user.getMask() + " JOIN " + channelName) ||
 						!this->replySend(*cit2->second)))
 					return false;
+			if (!this->_lookupLinks.empty() &&
+				!this->propagate(NULL, ArenaString(1, ':') + this->_config["server_name"] + " SJOIN " + ft::toString(static_cast<int>(chan.getTimestamp())) + ' ' + channelName + ' ' + (isCreated ? chan.getModeString(true) : std::string("+")) + " :" + (isCreated ? "@" : "") + user.getNickname()))
+				return false;
 		}
+		// A channel of the snapshot nobody could join stays dormant.
+		if (chan.empty())
+			this->_lookupChannels.erase(it);
 		if (cit1 == channelsToJoin.end())
 			break ;
 	}
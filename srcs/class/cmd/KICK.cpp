@@ -1,56 +1,86 @@
 #include "class/Server.hpp"
 
 /**
- * @brief	Kick an user from a channel.
+ * @brief	Kick one or more user(s) from a channel.
+ * 			This command is reserved for channel operators and IRC operators.
+ * 			The users past the TARGMAX limit are not kicked.
  * 
  * @param	user The user that ran the command.
  * @param	params The parameters of the command.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::KICK(User &user, std::string const &params)
+bool	Server::KICK(User &user, ArenaString const &params)
 {
 	std::string					channelName;
+	std::string					usersToKick;
 	std::string					usernameToKick;
 	std::string					reason("Speaking elvish language.");
-	std::string::const_iterator	cit0;
-	std::string::const_iterator	cit1;
+	ArenaString::const_iterator	cit0;
+	ArenaString::const_iterator	cit1;
+	std::string::const_iterator	cit2;
+	std::string::const_iterator	cit3;
+	size_t						nbTargets;
 
 	for (cit0 = params.begin(), cit1 = params.begin() ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
 	channelName = std::string(cit0, cit1);
 	if (channelName.empty())
-		return this->replyPush(user, "461 " + user.getNickname() + " KICK :Not enough parameters");
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "KICK");
 
 	for ( ; cit1 != params.end() && *cit1 == ' ' ; ++cit1);
 	for (cit0 = cit1 ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
-	usernameToKick = std::string(cit0, cit1);
-	if (usernameToKick.empty())
-		return this->replyPush(user, "461 " + user.getNickname() + " KICK :Not enough parameters");
+	usersToKick = std::string(cit0, cit1);
+	if (usersToKick.empty())
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "KICK");
 
 	for ( ; cit1 != params.end() && *cit1 != ':' ; ++cit1);
-	if (cit1 + 1 != params.end())
-		reason = std::string(cit1 + 1, static_cast<std::string::const_iterator>(params.end()));
+	if (cit1 != params.end() && cit1 + 1 != params.end())
+		reason = std::string(cit1 + 1, static_cast<ArenaString::const_iterator>(params.end()));
 
-	if(this->_lookupChannels.find(channelName) == this->_lookupChannels.end())
-		return this->replyPush(user, "403 " + user.getNickname() + ' ' + channelName + " :No such channel");
+	if(this->_lookupChannels.find(Identifier::find(channelName)) == this->_lookupChannels.end())
+		return this->replyNumeric<ERR_NOSUCHCHANNEL>(user, channelName);
 
-	Channel	&chan = this->_lookupChannels.find(channelName)->second;
+	Channel	&chan = this->_lookupChannels.find(Identifier::find(channelName))->second;
 
-	if (this->_lookupUsers.find(usernameToKick) == this->_lookupUsers.end())
-		return this->replyPush(user, "441 " + user.getNickname() + ' ' + usernameToKick + ' ' + channelName + " :They aren't on that channel");
+	for (cit3 = usersToKick.begin(), nbTargets = 0UL ; cit3 != usersToKick.end() ; ++cit3)
+	{
+		for (cit2 = cit3 ; cit3 != usersToKick.end() && *cit3 != ',' ; ++cit3);
+		usernameToKick = std::string(cit2, cit3);
+		if (this->_limits.kickTargets && ++nbTargets > this->_limits.kickTargets)
+			return this->replyNumeric<ERR_TOOMANYTARGETS>(user, usernameToKick);
 
-	if (user.getModes().find('o') == std::string::npos)
-		return this->replyPush(user, "481 " + user.getNickname() + " :Permission Denied - You're not an IRC operator");
+		if (chan.find(usernameToKick) == chan.end())
+		{
+			if (!this->replyNumeric<ERR_USERNOTINCHANNEL>(user, usernameToKick, channelName))
+				return false;
+		}
+		else
+		{
+			if (!(chan.getMemberModes(user) & Channel::CHANOP) && !user.hasMode(User::OPERATOR))
+				return this->replyNumeric<ERR_CHANOPRIVSNEEDED>(user, channelName);
 
-	User	&userToKick = *this->_lookupUsers.find(usernameToKick)->second;
-	if (!this->replyPush(userToKick, ":" + userToKick.getMask() + " PART " + channelName))
-		return false;
-	for (std::map<std::string const, User *const>::const_iterator cit = chan.begin(); cit != chan.end(); cit++)
-	{
-		this->replyPush(*cit->second, ":" + user.getMask() + " KICK " + channelName + " " + usernameToKick + " :" + reason);
-		this->replySend(*cit->second);
+			User	&userToKick = *chan.find(usernameToKick)->second;
+			if (!this->replyPush(userToKick, ":" + userToKick.getMask() + " PART " + channelName))
+				return false;
+			for (std::map<Identifier const, User *const>::const_iterator cit = chan.begin(); cit != chan.end(); cit++)
+			{
+				this->replyPush(*cit->second, ":" + user.getMask() + " KICK " + channelName + " " + usernameToKick + " :" + reason);
+				this->replySend(*cit->second);
+			}
+			if (!this->_lookupLinks.empty() &&
+				!this->propagate(NULL, ArenaString(1, ':') + user.getNickname() + " KICK " + chan.getName() + ' ' + userToKick.getNickname() + " :" + reason))
+				return false;
+
+			chan.delUser(userToKick.getNicknameId());
+			userToKick.delChannel(chan.getNameId());
+			if (chan.empty())
+			{
+				this->_lookupChannels.erase(this->_lookupChannels.find(chan.getNameId()));
+				return true;
+			}
+		}
+		if (cit3 == usersToKick.end())
+			break ;
 	}
-	
-	chan.delUser(usernameToKick);
 	return true;
 }
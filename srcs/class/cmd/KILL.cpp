@@ -1,4 +1,5 @@
 #include "class/Server.hpp"
+#include "ft.hpp"
 
 /**
  * @brief	Remove an user from the network.
@@ -8,53 +9,74 @@
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::KILL(User &user, std::string const &params)
+bool	Server::KILL(User &user, ArenaString const &params)
 {
 	std::string					nickname;
 	std::string					reason("Being an elf");
 	std::string					subParams;
-	std::string::const_iterator	cit0;
-	std::string::const_iterator	cit1;
+	ArenaString::const_iterator	cit0;
+	ArenaString::const_iterator	cit1;
 
 	for (cit0 = params.begin(), cit1 = params.begin() ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
 	nickname = std::string(cit0, cit1);
 	if (nickname.empty())
-		return this->replyPush(user, "461 " + user.getNickname() + " KILL :Not enough parameters");
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "KILL");
 
 	for ( ; cit1 != params.end() && *cit1 != ':' ; ++cit1);
 	if (cit1 == params.end())
-		return this->replyPush(user, "461 " + user.getNickname() + " KILL :Not enough parameters");
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "KILL");
 	if (cit1 + 1 != params.end())
-		reason = std::string(cit1 + 1, static_cast<std::string::const_iterator>(params.end()));
+		reason = std::string(cit1 + 1, static_cast<ArenaString::const_iterator>(params.end()));
 
-	if (user.getModes().find('o') == std::string::npos)
-		return this->replyPush(user, "481 " + user.getNickname() + " :Permission Denied - You're not an IRC operator");
-	if (this->_lookupUsers.find(nickname) == this->_lookupUsers.end())
+	if (!user.hasMode(User::OPERATOR))
+		return this->replyNumeric<ERR_NOPRIVILEGES>(user);
+	if (this->_lookupUsers.find(Identifier::find(nickname)) == this->_lookupUsers.end())
 	{
 		if (nickname == this->_config["server_name"])
-			return this->replyPush(user, "483 " + user.getNickname() + " :You can't kill a server!");
-		return this->replyPush(user, "401 " + user.getNickname() + ' ' + nickname + " :No such nick/channel");
+			return this->replyNumeric<ERR_CANTKILLSERVER>(user);
+		return this->replyNumeric<ERR_NOSUCHNICK>(user, nickname);
 	}
 
-	User	&userToKill = *this->_lookupUsers.find(nickname)->second;
+	User	&userToKill = *this->_lookupUsers.find(Identifier::find(nickname))->second;
 	Server::addToBanList(userToKill);
 
-	if (!this->replyPush(userToKill, ":" + user.getMask() + " KILL " + userToKill.getNickname() + " :" + reason))
+	return this->kill(userToKill, user.getMask(), user.getNickname(), reason);
+}
+
+/**
+ * @brief	Disconnect an user, telling it and the members of its channels why.
+ * 			The linked servers are told too, but the one the kill comes from,
+ * 			and the users monitoring its nickname.
+ * 
+ * @param	userToKill The user to disconnect.
+ * @param	source The mask of the user, or the name of the server, killing it.
+ * @param	killer The name of the user, or of the server, killing it.
+ * @param	reason The reason of the kill.
+ * @param	from The link the kill comes from, if any.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::kill(User &userToKill, std::string const &source, std::string const &killer, std::string reason, User const *const from)
+{
+	if (userToKill.getState() == User::REGISTERED && !this->_lookupLinks.empty() &&
+		!this->propagate(from, ArenaString(1, ':') + killer + " KILL " + userToKill.getNickname() + ' ' + ft::toString(static_cast<int>(userToKill.getTimestamp())) + " :" + reason))
+		return false;
+	if (!this->replyPush(userToKill, ":" + source + " KILL " + userToKill.getNickname() + " :" + reason))
 		return false;
 	if (!userToKill.getLookupChannels().empty())
 	{
 		std::list<User *>	usersToNotice;
 
-		reason = "Killed (" + user.getNickname() + " (" + reason + "))";
+		reason = "Killed (" + killer + " (" + reason + "))";
 
-		for (std::map<std::string const, Channel *const>::const_iterator itChan = userToKill.getLookupChannels().begin(); itChan != userToKill.getLookupChannels().end(); itChan++)
+		for (std::map<Identifier const, Channel *const>::const_iterator itChan = userToKill.getLookupChannels().begin(); itChan != userToKill.getLookupChannels().end(); itChan++)
 		{
-			for (std::map<std::string const, User *const>::const_iterator itUser = itChan->second->begin(); itUser != itChan->second->end(); itUser++)
+			for (std::map<Identifier const, User *const>::const_iterator itUser = itChan->second->begin(); itUser != itChan->second->end(); itUser++)
 			{
 				if (std::find(usersToNotice.begin(), usersToNotice.end(), itUser->second) == usersToNotice.end())
 					usersToNotice.push_back(itUser->second);
 			}
-			itChan->second->delUser(userToKill.getNickname());
+			itChan->second->delUser(userToKill.getNicknameId());
 		}
 
 		for (std::list<User *>::const_iterator cit = usersToNotice.begin(); cit != usersToNotice.end(); cit++)
@@ -64,11 +86,15 @@ bool	Server::KILL(User &user, std::string const &params)
 				return false;
 		}
 	}
+	// The nickname is free at once, for a colliding user to take it.
+	if (!this->forgetNickname(userToKill))
+		return false;
+	if (userToKill.isRemote())
+		return this->removeRemoteUser(userToKill);
 	if (!this->replyPush(userToKill, "Error :Closing Link: " + this->_config["server_name"] + " (" + reason + ")") ||
 		!this->replySend(userToKill))
 		return false;
 
-	close(userToKill.getSocket());
-	userToKill.setSocket(-1);
+	this->disconnect(userToKill);
 	return true;
 }
@@ -9,127 +9,260 @@
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::MODE(User &user, std::string const &params)
+bool	Server::MODE(User &user, ArenaString const &params)
 {
-	static std::string const								delimiter("+- ");
-	std::string												targetName;
-	std::string												modeString;
-	std::string												modeArgs;
-	std::string::size_type									pos;
-	std::string::const_iterator								cit0;
-	std::string::const_iterator								cit1;
-	std::map<std::string const, Channel>::iterator			it;
+	std::string					targetName;
+	std::string					modeString;
+	std::vector<std::string>	modeArgs;
+	ArenaString::const_iterator	cit0;
+	ArenaString::const_iterator	cit1;
 
 	for (cit0 = params.begin(), cit1 = params.begin() ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
 	targetName = std::string(cit0, cit1);
 	if (targetName.empty())
-		return this->replyPush(user, "461 " + user.getNickname() + " MODE :Not enough parameters");
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "MODE");
 
 	for ( ; cit1 != params.end() && *cit1 == ' ' ; ++cit1);
-	for (cit0 = cit1 ; cit1 != params.end() ; ++cit1)
+	for (cit0 = cit1 ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
+	modeString = std::string(cit0, cit1);
+
+	while (cit1 != params.end())
 	{
-		if (*cit1 != '+' && *cit1 != '-')
-			break ;
-		for ( ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
-		if (cit1 == params.end())
+		for ( ; cit1 != params.end() && *cit1 == ' ' ; ++cit1);
+		if (cit1 != params.end() && *cit1 == ':')
+		{
+			modeArgs.push_back(std::string(cit1 + 1, static_cast<ArenaString::const_iterator>(params.end())));
 			break ;
+		}
+		for (cit0 = cit1 ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
+		if (cit0 != cit1)
+			modeArgs.push_back(std::string(cit0, cit1));
 	}
-	modeString = std::string(cit0, cit1);
 
-	for ( ; cit1 != params.end() && *cit1 == ' ' ; ++cit1);
-	modeArgs = std::string(cit1, static_cast<std::string::const_iterator>(params.end()));
+	if (*targetName.begin() == '#')
+		return this->channelMode(user, targetName, modeString, modeArgs);
+	return this->userMode(user, targetName, modeString);
+}
+
+/**
+ * @brief	Change the modes of a channel, as a channel operator.
+ * 			Each mode letter is handled according to its type
+ * 			in the channel modes table, taking its parameter, if any,
+ * 			from `modeArgs`. The applied changes are broadcast to the members.
+ * 			At most `max_modes` modes taking a parameter are applied.
+ * 
+ * @param	user The user that ran the command.
+ * @param	targetName The name of the channel.
+ * @param	modeString The modes to set (+) or unset (-).
+ * @param	modeArgs The parameters of the modes.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::channelMode(User &user, std::string const &targetName, std::string const &modeString, std::vector<std::string> const &modeArgs)
+{
+	std::string												applied;
+	std::string												appliedArgs;
+	std::string::const_iterator								cit0;
+	std::vector<std::string>::const_iterator				arg;
+	std::vector<std::string>::const_iterator				cit1;
+	std::map<Identifier const, Channel>::iterator			it;
+	std::map<Identifier const, User *const>::iterator		member;
+	Channel::t_modeDef const								*def;
+	char													sign;
+	char													appliedSign;
+	bool													isOp;
+	bool													isDenied;
+
+	it = this->_lookupChannels.find(Identifier::find(targetName));
+	if (it == this->_lookupChannels.end())
+		return this->replyNumeric<ERR_NOSUCHCHANNEL>(user, targetName);
+	Channel	&chan = it->second;
+
+	if (modeString.empty())
+		return this->replyNumeric<RPL_CHANNELMODEIS>(user, targetName, chan.getModeString(chan.find(user.getNicknameId()) != chan.end()));
 
-	if (*targetName.begin() == '#') // channel mode
+	isOp = (chan.getMemberModes(user) & Channel::CHANOP) || user.hasMode(User::OPERATOR);
+	isDenied = false;
+	arg = modeArgs.begin();
+	for (sign = '+', appliedSign = 0, cit0 = modeString.begin() ; cit0 != modeString.end() ; ++cit0)
 	{
-		it = this->_lookupChannels.find(targetName);
-		if (it == this->_lookupChannels.end())
-			return this->replyPush(user, "403 " + user.getNickname() + ' ' + targetName + " :No such channel");
-		if (!modeString.empty())
+		if (*cit0 == '+' || *cit0 == '-')
+		{
+			sign = *cit0;
+			continue ;
+		}
+		def = Channel::getModeDef(*cit0);
+		if (!def)
+		{
+			if (!this->replyNumeric<ERR_UNKNOWNMODE>(user, *cit0))
+				return false;
+			continue ;
+		}
+		if (def->type == Channel::LIST && arg == modeArgs.end())
 		{
-			// REMIND: This operator check would be changed into a chanops check, if we decide to implement channel modes someday.
-			if (user.getModes().find('o') == std::string::npos)
-				return this->replyPush(user, "482 " + user.getNickname() + ' ' + targetName + " :You're not channel operator");
-			for (cit0 = modeString.begin() ; cit0 != modeString.end() ; )
-			{
-				if (*cit0 == '+')
+			for (cit1 = chan.getBanList().begin() ; cit1 != chan.getBanList().end() ; ++cit1)
+				if (!this->replyNumeric<RPL_BANLIST>(user, targetName, *cit1))
+					return false;
+			if (!this->replyNumeric<RPL_ENDOFBANLIST>(user, targetName))
+				return false;
+			continue ;
+		}
+		if (!isOp)
+		{
+			if (!isDenied && !this->replyNumeric<ERR_CHANOPRIVSNEEDED>(user, targetName))
+				return false;
+			isDenied = true;
+			continue ;
+		}
+		// The modes taking a parameter past the MODES limit are ignored.
+		if ((def->type == Channel::LIST || def->type == Channel::MEMBER || def->type == Channel::PARAM || (def->type == Channel::PARAM_SET && sign == '+')) &&
+			this->_limits.modes && static_cast<size_t>(arg - modeArgs.begin()) >= this->_limits.modes)
+			continue ;
+		if ((def->type == Channel::MEMBER || def->type == Channel::PARAM || (def->type == Channel::PARAM_SET && sign == '+')) &&
+			arg == modeArgs.end())
+		{
+			if (!this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "MODE"))
+				return false;
+			continue ;
+		}
+
+		switch (def->type)
+		{
+			case Channel::LIST:
+				if (!(sign == '+' ? chan.addBan(*arg) : chan.delBan(*arg)))
 				{
-					for (++cit0 ; cit0 != modeString.end() && delimiter.find(*cit0) == std::string::npos ; ++cit0)
-					{
-						if (Channel::getAvailableModes().find(*cit0) == std::string::npos)
-						{
-							if (!this->replyPush(user, "472 " + user.getNickname() + ' ' + *cit0 + " :is unknown mode char to me"))
-								return false;
-						}
-						else if (it->second.getModes().find(*cit0) == std::string::npos)
-							it->second.setModes(it->second.getModes() + *cit0);
-					}
+					++arg;
+					continue ;
 				}
-				else if (*cit0 == '-')
+				appliedArgs += ' ' + *arg++;
+				break ;
+			case Channel::MEMBER:
+				member = chan.find(*arg);
+				if (member == chan.end())
 				{
-					for (++cit0 ; cit0 != modeString.end() && delimiter.find(*cit0) == std::string::npos ; ++cit0)
-					{
-						if (Channel::getAvailableModes().find(*cit0) == std::string::npos)
-						{
-							if (!this->replyPush(user, "472 " + user.getNickname() + ' ' + *cit0 + " :is unknown mode char to me"))
-								return false;
-						}
-						pos = it->second.getModes().find(*cit0);
-						if (pos != std::string::npos)
-							it->second.setModes(std::string(user.getModes()).erase(pos, 1));
-					}
+					if (!this->replyNumeric<ERR_USERNOTINCHANNEL>(user, *arg, targetName))
+						return false;
+					++arg;
+					continue ;
 				}
-				else if (*cit0 != ' ')
-					return this->replyPush(user, "501 " + user.getNickname() + " :Unknown MODE flag");
+				if (sign == '+')
+					chan.addMemberModes(*member->second, def->bit);
 				else
-					++cit0;
-			}
-			
-		}
-		return this->replyPush(user, "324 " + user.getNickname() + ' ' + targetName + ' ' + modeString);
-	}
-	else // user mode
-	{
-		if (!modeString.empty())
-		{
-			if (this->_lookupUsers.find(targetName) == this->_lookupUsers.end())
-				return this->replyPush(user, "401 " + user.getNickname() + ' ' + targetName + " :No such nick/channel");
-			if (targetName != user.getNickname())
-				return this->replyPush(user, "502 " + user.getNickname() + " :Cant change mode for other users");
-			for (cit0 = modeString.begin() ; cit0 != modeString.end() ; )
-			{
-				if (*cit0 == '+')
+					chan.delMemberModes(*member->second, def->bit);
+				appliedArgs += ' ' + *arg++;
+				break ;
+			case Channel::PARAM:
+				if (sign == '+')
 				{
-					for (++cit0 ; cit0 != modeString.end() && delimiter.find(*cit0) == std::string::npos ; ++cit0)
-					{
-						if (User::getAvailableModes().find(*cit0) == std::string::npos)
-						{
-							if (!this->replyPush(user, "472 " + user.getNickname() + ' ' + *cit0 + " :is unknown mode char to me"))
-								return false;
-						}
-						else if (*cit0 != 'o' && user.getModes().find(*cit0) == std::string::npos)
-							user.setModes(user.getModes() + *cit0);
-					}
+					chan.setKey(*arg);
+					chan.addModes(def->bit);
+					appliedArgs += ' ' + *arg;
+				}
+				else if (chan.hasMode(def->bit))
+				{
+					chan.setKey("");
+					chan.delModes(def->bit);
+					appliedArgs += " *";
 				}
-				else if (*cit0 == '-')
+				++arg;
+				break ;
+			case Channel::PARAM_SET:
+				if (sign == '+')
 				{
-					for (++cit0 ; cit0 != modeString.end() && delimiter.find(*cit0) == std::string::npos ; ++cit0)
+					if (std::strtol(arg->c_str(), NULL, 10) <= 0)
 					{
-						if (User::getAvailableModes().find(*cit0) == std::string::npos)
-						{
-							if (!this->replyPush(user, "472 " + user.getNickname() + ' ' + *cit0 + " :is unknown mode char to me"))
-								return false;
-						}
-						pos = user.getModes().find(*cit0);
-						if (pos != std::string::npos)
-							user.setModes(std::string(user.getModes()).erase(pos, 1));
+						++arg;
+						continue ;
 					}
+					chan.setLimit(static_cast<unsigned int>(std::strtol(arg->c_str(), NULL, 10)));
+					chan.addModes(def->bit);
+					appliedArgs += ' ' + ft::toString(chan.getLimit());
+					++arg;
+				}
+				else if (chan.hasMode(def->bit))
+				{
+					chan.setLimit(0U);
+					chan.delModes(def->bit);
 				}
-				else if (*cit0 != ' ')
-					return this->replyPush(user, "501 " + user.getNickname() + " :Unknown MODE flag");
 				else
-					++cit0;
-			}
+					continue ;
+				break ;
+			default:
+				if ((sign == '+') == chan.hasMode(def->bit))
+					continue ;
+				if (sign == '+')
+					chan.addModes(def->bit);
+				else
+					chan.delModes(def->bit);
+		}
+		if (appliedSign != sign)
+			applied += sign;
+		appliedSign = sign;
+		applied += *cit0;
+	}
+
+	if (applied.empty())
+		return true;
+	for (member = chan.begin() ; member != chan.end() ; ++member)
+		if (!this->replyPush(*member->second, ':' + user.getMask() + " MODE " + targetName + ' ' + applied + appliedArgs) ||
+			(member->second != &user && !this->replySend(*member->second)))
+			return false;
+	if (chan.find(user.getNicknameId()) == chan.end())
+		return this->replyPush(user, ':' + user.getMask() + " MODE " + targetName + ' ' + applied + appliedArgs);
+	return true;
+}
+
+/**
+ * @brief	Change the modes of an user, which can only be the one
+ * 			that ran the command. The operator mode cannot be set that way.
+ * 
+ * @param	user The user that ran the command.
+ * @param	targetName The nickname of the user.
+ * @param	modeString The modes to set (+) or unset (-).
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::userMode(User &user, std::string const &targetName, std::string const &modeString)
+{
+	std::string					applied;
+	std::string::const_iterator	cit;
+	unsigned int				bit;
+	char						sign;
+	char						appliedSign;
+
+	if (this->_lookupUsers.find(Identifier::find(targetName)) == this->_lookupUsers.end())
+		return this->replyNumeric<ERR_NOSUCHNICK>(user, targetName);
+	if (Identifier::find(targetName) != user.getNicknameId())
+		return this->replyNumeric<ERR_USERSDONTMATCH>(user);
+	if (modeString.empty())
+		return this->replyNumeric<RPL_UMODEIS>(user, user.getModeString());
+
+	for (sign = '+', appliedSign = 0, cit = modeString.begin() ; cit != modeString.end() ; ++cit)
+	{
+		if (*cit == '+' || *cit == '-')
+		{
+			sign = *cit;
+			continue ;
+		}
+		bit = User::getModeBit(*cit);
+		if (!bit)
+		{
+			if (!this->replyNumeric<ERR_UMODEUNKNOWNFLAG>(user))
+				return false;
+			continue ;
 		}
-		return this->replyPush(user, "221 " + user.getNickname() + " :" + user.getModes());
+		if ((sign == '+') == user.hasMode(bit) || (sign == '+' && bit == User::OPERATOR))
+			continue ;
+		if (sign == '+')
+			user.addModes(bit);
+		else
+			user.delModes(bit);
+		if (appliedSign != sign)
+			applied += sign;
+		appliedSign = sign;
+		applied += *cit;
 	}
+	if (applied.empty())
+		return true;
+	return this->replyPush(user, ':' + user.getMask() + " MODE " + user.getNickname() + " :" + applied);
 }
@@ -0,0 +1,142 @@
+#include <cctype> // toupper
+#include "class/Server.hpp"
+
+/**
+ * @brief	Add a target to lists of comma-separated targets, starting
+ * 			a new list when the last one would get too long for a reply.
+ * 
+ * @param	lists The lists of targets.
+ * @param	target The target to add.
+ * @param	maxLength The longest list.
+ */
+inline static void	__addTarget(std::vector<std::string> &lists, std::string const &target, size_t const maxLength)
+{
+	if (lists.empty() || lists.back().size() + 1UL + target.size() > maxLength)
+		lists.push_back(target);
+	else
+		lists.back() += ',' + target;
+}
+
+/**
+ * @brief	Monitor the presence of some nicknames, the users getting and
+ * 			leaving them being pushed to the watchers instead of polled.
+ * 			The supported subcommands are:
+ * 			- + <targets>: monitor the nicknames, telling which are online
+ * 			- - <targets>: stop monitoring the nicknames
+ * 			- C: stop monitoring every nickname
+ * 			- L: list the nicknames monitored
+ * 			- S: tell which of the nicknames monitored are online
+ * 			The targets are separated by a comma, an user monitoring
+ * 			at most `max_monitor` nicknames.
+ * 
+ * @param	user The user that ran the command.
+ * @param	params The parameters of the command.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::MONITOR(User &user, ArenaString const &params)
+{
+	size_t const												maxLength = MAX_LINE_LENGTH - this->_numericPrefix.size() - user.getNickname().size() - 6UL;
+	t_params													args;
+	std::vector<std::string>									online;
+	std::vector<std::string>									offline;
+	std::vector<std::string>::const_iterator					cit;
+	std::set<Identifier>::const_iterator						itMonitor;
+	std::map<Identifier const, User *const>::const_iterator	itUser;
+	std::map<Identifier const, std::set<User *> >::iterator	itWatchers;
+	ArenaString::const_iterator									cit0;
+	ArenaString::const_iterator									cit1;
+	std::string													target;
+	Identifier													nickname;
+	char														subcommand;
+	bool														isFull;
+
+	isFull = false;
+	Server::splitParams(params, args);
+	if (args.empty() || args[0].size() != 1UL)
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "MONITOR");
+	subcommand = static_cast<char>(toupper(args[0][0]));
+	if ((subcommand == '+' || subcommand == '-') && args.size() < 2UL)
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "MONITOR");
+
+	if (subcommand == 'C')
+	{
+		this->forgetWatcher(user);
+		return true;
+	}
+	if (subcommand == 'L')
+	{
+		for (itMonitor = user.getMonitors().begin() ; itMonitor != user.getMonitors().end() ; ++itMonitor)
+			__addTarget(online, itMonitor->getName(), maxLength);
+		for (cit = online.begin() ; cit != online.end() ; ++cit)
+			if (!this->replyNumeric<RPL_MONLIST>(user, *cit))
+				return false;
+		return this->replyNumeric<RPL_ENDOFMONLIST>(user);
+	}
+	if (subcommand == '-')
+	{
+		for (cit1 = args[1].begin() ; cit1 != args[1].end() ; ++cit1)
+		{
+			for (cit0 = cit1 ; cit1 != args[1].end() && *cit1 != ',' ; ++cit1);
+			nickname = Identifier::find(ArenaString(cit0, cit1));
+			if (!nickname.empty() && user.delMonitor(nickname))
+			{
+				itWatchers = this->_lookupWatchers.find(nickname);
+				itWatchers->second.erase(&user);
+				if (itWatchers->second.empty())
+					this->_lookupWatchers.erase(itWatchers);
+			}
+			if (cit1 == args[1].end())
+				break ;
+		}
+		return true;
+	}
+	if (subcommand == 'S')
+	{
+		for (itMonitor = user.getMonitors().begin() ; itMonitor != user.getMonitors().end() ; ++itMonitor)
+		{
+			itUser = this->_lookupUsers.find(*itMonitor);
+			if (itUser != this->_lookupUsers.end() && itUser->second->getState() == User::REGISTERED)
+				__addTarget(online, itUser->second->getMask(), maxLength);
+			else
+				__addTarget(offline, itMonitor->getName(), maxLength);
+		}
+	}
+	else if (subcommand == '+')
+	{
+		for (cit1 = args[1].begin() ; cit1 != args[1].end() ; ++cit1)
+		{
+			for (cit0 = cit1 ; cit1 != args[1].end() && *cit1 != ',' ; ++cit1);
+			target.assign(cit0, cit1);
+			if (!target.empty() && target.find_first_not_of(User::getAvailableNicknameChars()) == std::string::npos)
+			{
+				nickname = Identifier(target);
+				isFull = this->_limits.monitors && user.getMonitors().size() >= this->_limits.monitors && !user.getMonitors().count(nickname);
+				if (isFull)
+					break ;
+				if (user.addMonitor(nickname))
+					this->_lookupWatchers[nickname].insert(&user);
+				itUser = this->_lookupUsers.find(nickname);
+				if (itUser != this->_lookupUsers.end() && itUser->second->getState() == User::REGISTERED)
+					__addTarget(online, itUser->second->getMask(), maxLength);
+				else
+					__addTarget(offline, target, maxLength);
+			}
+			if (cit1 == args[1].end())
+				break ;
+		}
+	}
+	else
+		return true;
+
+	for (cit = online.begin() ; cit != online.end() ; ++cit)
+		if (!this->replyNumeric<RPL_MONONLINE>(user, *cit))
+			return false;
+	for (cit = offline.begin() ; cit != offline.end() ; ++cit)
+		if (!this->replyNumeric<RPL_MONOFFLINE>(user, *cit))
+			return false;
+	// The targets left out once the list is full.
+	if (subcommand == '+' && isFull)
+		return this->replyNumeric<ERR_MONLISTFULL>(user, this->_limits.monitors, ArenaString(cit0, static_cast<ArenaString::const_iterator>(args[1].end())));
+	return true;
+}
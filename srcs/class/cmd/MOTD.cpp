@@ -1,7 +1,9 @@
+#include "class/ReadFileJob.hpp"
 #include "class/Server.hpp"
 
 /**
  * @brief	Send de Message of the Day to the user.
+ * 			The file is read by a worker thread, see MOTDdone().
  * 
  * @param	user The user that ran the command.
  * @param	params The parameters of the command.
@@ -9,26 +11,45 @@
  * @return	true if success, false otherwise.
  */
 
-bool	Server::MOTD(User &user, std::string const &params)
+bool	Server::MOTD(User &user, ArenaString const &params)
 {
-	std::ifstream	infile;
-	std::string		line;
-	std::string		motd;
+	Job	*job;
 
-	if (params.empty() == false && params.compare(this->_config["host"]) != 0)
-		return this->replyPush(user, ":" + this->_config["host"] + " 402 " + user.getNickname() + " " + params + " :No such server");
-	
-	infile.open(this->_config["motd"].c_str());
-	if (infile.is_open() == false)
-		return this->replyPush(user, ":" + this->_config["host"] + " 422 " + user.getNickname() + " :MOTD File is missing");
+	if (params.empty() == false && params != this->_config["host"])
+		return this->replyNumeric<ERR_NOSUCHSERVER>(user, params);
 
-	this->replyPush(user, /* ":" + this->_config["host"] + "  */"375 " + user.getNickname() + " :- Hello Digger! -");
-
-	while (infile.good() && std::getline(infile, line))
+	try
+	{
+		job = new ReadFileJob(&user, &Server::MOTDdone, this->_config["motd"]);
+	}
+	catch (std::exception const &e)
 	{
-		motd.append(line + "\n");
+		Server::logMsg(ERROR, "    Exception: " + std::string(e.what()));
+		return false;
 	}
-	infile.close();
-	return this->replyPush(user, /* ":" + this->_config["host"] + "  */"372 " + user.getNickname() + " :" + motd)
-		&& this->replyPush(user, "376 " + user.getNickname() + " :End of /MOTD command");
+	return this->async(job);
+}
+
+/**
+ * @brief	Send the Message of the Day read by a worker thread to the user.
+ * 
+ * @param	job The completed ReadFileJob.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::MOTDdone(Job &job)
+{
+	User										&user = *job.getUser();
+	ReadFileJob const							&file = static_cast<ReadFileJob const &>(job);
+	std::vector<std::string>::const_iterator	cit;
+
+	if (file.getIsOpen() == false)
+		return this->replyNumeric<ERR_NOMOTD>(user);
+
+	if (!this->replyNumeric<RPL_MOTDSTART>(user))
+		return false;
+	for (cit = file.getLines().begin() ; cit != file.getLines().end() ; ++cit)
+		if (!this->replyNumeric<RPL_MOTD>(user, *cit))
+			return false;
+	return this->replyNumeric<RPL_ENDOFMOTD>(user);
 }
@@ -1,33 +1,46 @@
 #include "class/Server.hpp"
+#include "ft.hpp"
 
 /**
  * @brief	Set a new nickname for an user.
+ * 			Nicknames are compared casefolded, an user may change the case of its own,
+ * 			and are at most `nick_length` characters long.
+ * 			The time of the change settles a collision with an user of another
+ * 			server taking the same nickname, the linked servers being told.
+ * 			An user that sent USER before having a nickname is registered
+ * 			once it gets one.
  * 
  * @param	user The user that ran the command.
  * @param	params The parameters of the command.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::NICK(User &user, std::string const &params)
+bool	Server::NICK(User &user, ArenaString const &params)
 {
-	std::string	nickname;
+	ArenaString												nickname;
+	std::string												former;
+	std::map<Identifier const, User *const>::const_iterator	cit;
 
 	nickname = params;
 	if (nickname.empty())
-		return this->replyPush(user, "431 " + user.getNickname() + " :No nickname given");
+		return this->replyNumeric<ERR_NONICKNAMEGIVEN>(user);
 
-	if (nickname.find_first_not_of(User::getAvailableNicknameChars()) != std::string::npos ||
+	if (nickname.find_first_not_of(User::getAvailableNicknameChars().c_str()) != ArenaString::npos ||
+		(this->_limits.nicknameLength && nickname.size() > this->_limits.nicknameLength) ||
 		nickname == this->_config["server_name"])
-		return this->replyPush(user, "432 " + user.getNickname() + ' ' + nickname + " :Erroneous nickname");
+		return this->replyNumeric<ERR_ERRONEUSNICKNAME>(user, nickname);
 
-	if (this->_lookupUsers.find(nickname) != this->_lookupUsers.end())
-		return this->replyPush(user, "433 " + user.getNickname() + ' ' + nickname + " :Nickname is already in use");
+	cit = this->_lookupUsers.find(Identifier::find(nickname));
+	if (cit != this->_lookupUsers.end() && cit->second != &user)
+		return this->replyNumeric<ERR_NICKNAMEINUSE>(user, nickname);
 
-	this->_lookupUsers.erase(user.getNickname());
-	user.setNickname(nickname);
-	this->_lookupUsers.insert(std::pair<std::string, User *const>(user.getNickname(), &user));
-	if (user.getIsRegistered() && !this->replyPush(user, ':' + user.getMask() + " NICK " + params))
+	former = user.getNickname();
+	user.setTimestamp(this->_clock->now());
+	if (!this->rename(user, std::string(nickname.data(), nickname.size())))
 		return false;
-	user.setMask();
-	return true;
+	if (user.getState() == User::AUTHENTICATED)
+		return this->registerUser(user);
+	if (user.getState() != User::REGISTERED || this->_lookupLinks.empty())
+		return true;
+	return this->propagate(NULL, ArenaString(1, ':') + former + " NICK " + user.getNickname() + " :" + ft::toString(static_cast<int>(user.getTimestamp())));
 }
@@ -1,34 +1,84 @@
+#include "class/CheckPasswordJob.hpp"
 #include "class/Server.hpp"
+#include "ft.hpp"
+
+/**
+ * A bcrypt hash of the same cost as the operator ones, checked in place of
+ * theirs for an unknown name, so that the time of the answer tells nothing
+ * about which names exist.
+ */
+#define DUMMY_HASH	"$2b$10$KFsD6iFqcYGZjN41ciOpfO8Ste6xJvfG.x/YBmZQ5k3yfJXuMNg8K"
 
 /**
  * @brief	Make an user being promoted to operator status.
+ * 			The hash is checked by a worker thread, see OPERdone(), even
+ * 			for an unknown name.
  * 
  * @param	user The user that ran the command.
  * @param	params The parameters of the command.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::OPER(User &user, std::string const &params)
+bool	Server::OPER(User &user, ArenaString const &params)
 {
 	std::string					name;
 	std::string					password;
-	std::string::const_iterator	cit0;
-	std::string::const_iterator	cit1;
+	std::string					hash;
+	ArenaString::const_iterator	cit0;
+	ArenaString::const_iterator	cit1;
+	Job							*job;
 
 	for (cit0 = params.begin(), cit1 = params.begin() ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
 	name = std::string(cit0, cit1);
 	if (name.empty())
-		return this->replyPush(user, "461 " + user.getNickname() + " OPER :Not enough parameters");
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "OPER");
 
 	for ( ; cit1 != params.end() && *cit1 == ' ' ; ++cit1);
-	password = std::string(cit1, static_cast<std::string::const_iterator>(params.end()));
+	password = std::string(cit1, static_cast<ArenaString::const_iterator>(params.end()));
 	if (password.empty())
-		return this->replyPush(user, "461 " + user.getNickname() + " OPER :Not enough parameters");
-
-	if (this->_config.find("oper_" + name) == this->_config.end() || this->_config["oper_" + name] != password)
-		return this->replyPush(user, "464 " + user.getNickname() + " :Password incorrect");
-	if (user.getModes().find('o') == std::string::npos)
-		user.setModes(user.getModes() + 'o');
-	return replyPush(user, "221 " + user.getNickname() + " :" + user.getModes())
-		&& replyPush(user, "381 " + user.getNickname() + " :You are now an IRC operator.");
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "OPER");
+
+	if (!this->allowAuthAttempt(user))
+		return this->replyNumeric<ERR_PASSWDMISMATCH>(user);
+
+	if (this->_config.find("oper_" + name) != this->_config.end())
+		hash = this->_config["oper_" + name];
+	else
+	{
+		hash = DUMMY_HASH;
+		name.clear();
+	}
+
+	try
+	{
+		job = new CheckPasswordJob(&user, &Server::OPERdone, password, hash, name);
+	}
+	catch (std::exception const &e)
+	{
+		Server::logMsg(ERROR, "    Exception: " + std::string(e.what()));
+		return false;
+	}
+	return this->async(job);
+}
+
+/**
+ * @brief	Promote the user to operator status if the password checked
+ * 			by a worker thread matches the operator one. The name is empty
+ * 			when it was unknown, which is always refused.
+ * 
+ * @param	job The completed CheckPasswordJob.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::OPERdone(Job &job)
+{
+	User					&user = *job.getUser();
+	CheckPasswordJob const	&check = static_cast<CheckPasswordJob const &>(job);
+
+	if (check.getName().empty() || !check.getIsValid())
+		return this->replyNumeric<ERR_PASSWDMISMATCH>(user);
+	Server::logMsg(INTERNAL, "(" + ft::toString(user.getSocket()) + ") Promoted to operator as " + check.getName());
+	user.addModes(User::OPERATOR);
+	return this->replyNumeric<RPL_UMODEIS>(user, user.getModeString())
+		&& this->replyNumeric<RPL_YOUREOPER>(user);
 }
@@ -2,60 +2,68 @@
 
 /**
  * @brief	Make an user leaving one or more channel(s).
+ * 			The channels past the TARGMAX limit are not left.
  * 
  * @param	user The user that ran the command.
  * @param	params The parameters of the command.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::PART(User &user, std::string const &params)
+bool	Server::PART(User &user, ArenaString const &params)
 {
-	std::string													channelsToLeave;
-	std::string													reason("has left the channel");
-	std::string													channelName;
-	std::string::const_iterator									cit0;
-	std::string::const_iterator									cit1;
-	std::map<std::string const, User *const>::const_iterator	cit2;
-	std::map<std::string const, Channel>::iterator				it;
+	ArenaString													channelsToLeave;
+	ArenaString													reason("has left the channel");
+	ArenaString													channelName;
+	ArenaString::const_iterator									cit0;
+	ArenaString::const_iterator									cit1;
+	std::map<Identifier const, User *const>::const_iterator	cit2;
+	std::map<Identifier const, Channel>::iterator				it;
+	size_t														nbTargets;
 
 	for (cit0 = params.begin(), cit1 = params.begin() ; cit1 != params.end() && *cit1 != ' ' && *cit1 != ':' ; ++cit1);
-	channelsToLeave = std::string(cit0, cit1);
+	channelsToLeave = ArenaString(cit0, cit1);
 	if (channelsToLeave.empty())
-		return this->replyPush(user, ':' + user.getMask() + " 461 " + user.getNickname() + " PART :Not enough parameters");
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "PART");
 
 	for ( ; cit1 != params.end() && *cit1 == ' ' ; ++cit1);
 	if (cit1 != params.end() && *cit1 == ':')
-		reason = std::string(cit1 + 1, static_cast<std::string::const_iterator>(params.end()));
+		reason = ArenaString(cit1 + 1, static_cast<ArenaString::const_iterator>(params.end()));
 
-	for (cit1 = channelsToLeave.begin() ; cit1 != channelsToLeave.end() ; ++cit1)
+	for (cit1 = channelsToLeave.begin(), nbTargets = 0UL ; cit1 != channelsToLeave.end() ; ++cit1)
 	{
 		for (cit0 = cit1 ; cit1 != channelsToLeave.end() && *cit1 != ',' ; ++cit1);
-		channelName = std::string(cit0, cit1);
+		channelName = ArenaString(cit0, cit1);
 		if (*channelName.begin() != '#')
 			channelName.insert(channelName.begin(), '#');
+		if (this->_limits.partTargets && ++nbTargets > this->_limits.partTargets)
+			return this->replyNumeric<ERR_TOOMANYTARGETS>(user, channelName);
 
-		it = this->_lookupChannels.find(channelName);
+		it = this->_lookupChannels.find(Identifier::find(channelName));
 		if (it == this->_lookupChannels.end())
 		{
-			if (!this->replyPush(user, ':' + user.getMask() + " 403 " + user.getNickname() + ' ' + channelName + " :No such channel"))
+			if (!this->replyNumeric<ERR_NOSUCHCHANNEL>(user, channelName))
 				return false;
 		}
 		else
 		{
-			if (it->second.find(user.getNickname()) == it->second.end())
+			if (it->second.find(user.getNicknameId()) == it->second.end())
 			{
-				if (!this->replyPush(user, ':' + user.getMask() + " 442 " + user.getNickname() + ' ' + channelName + " :You're not on that channel"))
+				if (!this->replyNumeric<ERR_NOTONCHANNEL>(user, channelName))
 					return false;
 			}
 			else
 			{
 				for (cit2 = it->second.begin() ; cit2 != it->second.end() ; ++cit2)
 				{
-					if (!this->replyPush(*cit2->second, ':' + user.getMask() + " PART " + channelName + " :" + reason) ||
+					if (!this->replyPush(*cit2->second, ArenaString(1, ':') + user.getMask() + " PART " + channelName + " :" + reason) ||
 						!this->replySend(*cit2->second))
 						return false;
 				}
-				it->second.delUser(user.getNickname());
+				if (!this->_lookupLinks.empty() &&
+					!this->propagate(NULL, ArenaString(1, ':') + user.getNickname() + " PART " + channelName + " :" + reason))
+					return false;
+				it->second.delUser(user.getNicknameId());
+				user.delChannel(it->first);
 				if (it->second.empty())
 					this->_lookupChannels.erase(it);
 			}
@@ -1,19 +1,68 @@
+#include "class/CheckPasswordJob.hpp"
 #include "class/Server.hpp"
 
 /**
  * @brief	Check if a provided password is correct to connect to the server.
+ * 			The hash is checked by a worker thread, see PASSdone().
+ * 			A server linking sends the link password, followed by `TS`.
  * 
  * @param	user The user that ran the command.
  * @param	params The parameters of the command.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::PASS(User &user, std::string const &params)
+bool	Server::PASS(User &user, ArenaString const &params)
 {
-	if (user.getIsRegistered())
-		return this->replyPush(user, "462 " + user.getNickname() + " :You may not reregister");
+	Job	*job;
+
+	if (user.getState() == User::REGISTERED)
+		return this->replyNumeric<ERR_ALREADYREGISTRED>(user);
 	if (params.empty())
-		return this->replyPush(user, "461 PASS :not enough parameters");
-	user.setPassword(params);
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "PASS");
+	if (!this->_config["link_password"].empty() && params == this->_config["link_password"] + " TS")
+	{
+		this->_lookupLinks[&user].isAuthenticated = true;
+		return true;
+	}
+	if (this->_config["server_password"].empty())
+		return true;
+	if (!this->allowAuthAttempt(user))
+	{
+		if (!this->replyNumeric<ERR_PASSWDMISMATCH>(user) ||
+			!this->replyPush(user, "Error :Closing Link: " + this->_config["server_name"] + " (Too many password attempts)") ||
+			!this->replySend(user))
+			return false;
+		this->disconnect(user);
+		return true;
+	}
+
+	try
+	{
+		job = new CheckPasswordJob(&user, &Server::PASSdone, std::string(params.data(), params.size()), this->_config["server_password"]);
+	}
+	catch (std::exception const &e)
+	{
+		Server::logMsg(ERROR, "    Exception: " + std::string(e.what()));
+		return false;
+	}
+	return this->async(job);
+}
+
+/**
+ * @brief	Authenticate the user if the password checked by a worker thread
+ * 			matches the server one.
+ * 
+ * @param	job The completed CheckPasswordJob.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::PASSdone(Job &job)
+{
+	User	&user = *job.getUser();
+
+	if (!static_cast<CheckPasswordJob const &>(job).getIsValid())
+		return this->replyNumeric<ERR_PASSWDMISMATCH>(user);
+	if (user.getState() == User::CONNECTED)
+		user.setState(User::AUTHENTICATED);
 	return true;
 }
@@ -8,10 +8,10 @@
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::PING(User &user, std::string const &params)
+bool	Server::PING(User &user, ArenaString const &params)
 {
 	if (params.empty())
-		return this->replyPush(user, "461 " + user.getNickname() + " PING :Not enough parameters");
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "PING");
 	return this->replyPush(user, "PONG " + params);
 }
 
@@ -2,72 +2,119 @@
 
 /**
  * @brief	Send a message either to a channel or to an user.
+ * 			A message reaches the users of other servers through the links
+ * 			to them, each link being sent the message once.
+ * 			A message to a channel is kept in its history.
+ * 			The message is tagged with its msgid and its time for the users
+ * 			asking for it, and sent back to its sender if it asked for
+ * 			echo-message.
+ * 			The targets past the TARGMAX limit are not sent the message.
  * 
  * @param	user The user that ran the command.
  * @param	params The parameters of the command.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::PRIVMSG(User &user, std::string const &params)
+bool	Server::PRIVMSG(User &user, ArenaString const &params)
 {
-	std::string													targets;
-	std::string													text;
-	std::string													targetName;
-	std::string::const_iterator									cit0;
-	std::string::const_iterator									cit1;
-	std::map<std::string const, Channel>::const_iterator		cit2;
-	std::map<std::string const, User *const>::const_iterator	cit3;
+	ArenaString													targets;
+	ArenaString													text;
+	ArenaString													targetName;
+	ArenaString													line;
+	ArenaString::const_iterator									cit0;
+	ArenaString::const_iterator									cit1;
+	std::map<Identifier const, Channel>::iterator				cit2;
+	std::map<Identifier const, User *const>::const_iterator	cit3;
+	SpamFilter::t_match											match;
+	size_t														nbTargets;
 
 	for (cit0 = params.begin(), cit1 = params.begin() ; cit1 != params.end() && *cit1 != ' ' && *cit1 != ':' ; ++cit1);
-	targets = std::string(cit0, cit1);
+	targets = ArenaString(cit0, cit1);
 	if (targets.empty())
-		return this->replyPush(user, "411 " + user.getNickname() + " :No recipent given PRIVMSG");
+		return this->replyNumeric<ERR_NORECIPENT>(user, "PRIVMSG");
 
 	for ( ; cit1 != params.end() && *cit1 != ':' ; ++cit1);
 	if (cit1 == params.end())
-		return this->replyPush(user, "412 " + user.getNickname() + " :No text to send");
-	text = std::string(cit1 + 1, static_cast<std::string::const_iterator>(params.end()));
+		return this->replyNumeric<ERR_NOTEXTTOSEND>(user);
+	text = ArenaString(cit1 + 1, static_cast<ArenaString::const_iterator>(params.end()));
 
-	for (cit1 = targets.begin() ; cit1 != targets.end() ; ++cit1)
+	// Operators are trusted, everyone else is checked once for all targets.
+	if (!user.hasMode(User::OPERATOR))
+	{
+		match = this->_spamFilter.match(text.data(), text.size());
+		if (match.action != SpamFilter::NONE)
+		{
+			if (!this->spamCaught(user, match))
+				return false;
+			if (match.action != SpamFilter::WARN)
+				return true;
+		}
+	}
+
+	for (cit1 = targets.begin(), nbTargets = 0UL ; cit1 != targets.end() ; ++cit1)
 	{
 		for (cit0 = cit1 ; cit1 != targets.end() && *cit1 != ',' ; ++cit1);
-		targetName = std::string(cit0, cit1);
+		targetName = ArenaString(cit0, cit1);
+		if (this->_limits.privmsgTargets && ++nbTargets > this->_limits.privmsgTargets)
+			return this->replyNumeric<ERR_TOOMANYTARGETS>(user, targetName);
 
 		if (*targetName.begin() == '#') // message to channel
 		{
-			cit2 = this->_lookupChannels.find(targetName);
+			cit2 = this->_lookupChannels.find(Identifier::find(targetName));
 			if (cit2 == this->_lookupChannels.end())
 			{
-				if (!this->replyPush(user, "401 " + user.getNickname() + ' ' + targetName + " :No such nick/channel"))
+				if (!this->replyNumeric<ERR_NOSUCHNICK>(user, targetName))
+					return false;
+			}
+			else if ((cit2->second.hasMode(Channel::INSIDE_ONLY) && cit2->second.find(user.getNicknameId()) == cit2->second.end()) ||
+				(cit2->second.hasMode(Channel::MODERATED) && !(cit2->second.getMemberModes(user) & (Channel::CHANOP | Channel::VOICE))) ||
+				(!(cit2->second.getMemberModes(user) & (Channel::CHANOP | Channel::VOICE)) && cit2->second.isBanned(user)))
+			{
+				if (!this->replyNumeric<ERR_CANTSENDTOCHAN>(user, targetName))
 					return false;
 			}
 			else
 			{
-				for (cit3 = cit2->second.begin() ; cit3 != cit2->second.end() ; cit3++)
-					if (cit3->second != &user &&
-						(!this->replyPush(*cit3->second, ':' + user.getMask() + " PRIVMSG " + targetName + " :" + text) ||
-							!this->replySend(*cit3->second)))
+				line = ArenaString(1, ':') + user.getMask() + " PRIVMSG " + targetName + " :" + text;
+
+				TaggedLine	tagged(line, this->_history.newMsgid(), this->_clock->milliseconds());
+
+				if (!this->localSend(cit2->second, user.hasCap(User::ECHO_MESSAGE) ? NULL : &user, tagged))
+					return false;
+				this->keepHistory(cit2->second, tagged);
+				if (!this->propagateChannel(cit2->second, NULL, ArenaString(1, ':') + user.getNickname() + " PRIVMSG " + cit2->second.getName() + " :" + text))
 					return false;
 			}
 		}
 		else // message to user
 		{
-			cit3 = this->_lookupUsers.find(targetName);
-			if (cit3 == this->_lookupUsers.end() || cit3->second->getModes().find('i') != std::string::npos)
+			cit3 = this->_lookupUsers.find(Identifier::find(targetName));
+			if (cit3 == this->_lookupUsers.end() || cit3->second->hasMode(User::INVISIBLE))
 			{
-				if (!this->replyPush(user, "401 " + user.getNickname() + ' ' + targetName + " :No such nick/channel"))
+				if (!this->replyNumeric<ERR_NOSUCHNICK>(user, targetName))
 					return false;
 			}
-			else if (cit3->second->getModes().find('a') != std::string::npos)
+			else if (cit3->second->hasMode(User::AWAY))
 			{
-				if (!this->replyPush(user, "301 " + user.getNickname() + ' ' + targetName + " :" + cit3->second->getAwayMsg()))
+				if (!this->replyNumeric<RPL_AWAY>(user, targetName, cit3->second->getAwayMsg()))
 					return false;
 			}
 			else
 			{
-				if (!this->replyPush(*cit3->second, ':' + user.getMask() + " PRIVMSG " + targetName + " :" + text) ||
+				line = ArenaString(1, ':') + user.getMask() + " PRIVMSG " + targetName + " :" + text;
+
+				TaggedLine	tagged(line, this->_history.newMsgid(), this->_clock->milliseconds());
+
+				if (cit3->second->isRemote())
+				{
+					if (!this->linkSend(*cit3->second->getLink(), ArenaString(1, ':') + user.getNickname() + " PRIVMSG " + cit3->second->getNickname() + " :" + text))
+						return false;
+				}
+				else if (!this->replyPush(*cit3->second, tagged.get(cit3->second->getCaps())) ||
 					!this->replySend(*cit3->second))
 					return false;
+				if (user.hasCap(User::ECHO_MESSAGE) && !this->replyPush(user, tagged.get(user.getCaps())))
+					return false;
 			}
 		}
 		if (cit1 == targets.end())
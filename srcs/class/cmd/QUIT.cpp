@@ -1,38 +1,42 @@
 #include "class/Server.hpp"
 
 /**
- * @brief	Disconnect an user from the server.
+ * @brief	Disconnect an user from the server, telling the members of its
+ * 			channels and the users monitoring its nickname.
  * 
  * @param	user The user that ran the command.
  * @param	params The parameters of the command.
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::QUIT(User &user, std::string const &params)
+bool	Server::QUIT(User &user, ArenaString const &params)
 {
-	std::string	reason;
+	ArenaString	reason;
 
 	if (!this->replyPush(user, "Error :Connection terminated by dwarf") ||
 		!this->replySend(user))
 		return false;
 
+	reason = params;
+	if (*reason.begin() == ':')
+		reason.erase(reason.begin());
+	reason = "Quit: " + reason;
+	if (user.getState() == User::REGISTERED && !this->_lookupLinks.empty() &&
+		!this->propagate(NULL, ArenaString(1, ':') + user.getNickname() + " QUIT :" + reason))
+		return false;
+
 	if (!user.getLookupChannels().empty())
 	{
-		reason = params;
-		if (*reason.begin() == ':')
-			reason.erase(reason.begin());
-		reason = "Quit: " + reason;
-
 		std::list<User *>	usersToNotice;
 
-		for (std::map<std::string const, Channel *const>::const_iterator citChan = user.getLookupChannels().begin() ; citChan != user.getLookupChannels().end() ; citChan++)
+		for (std::map<Identifier const, Channel *const>::const_iterator citChan = user.getLookupChannels().begin() ; citChan != user.getLookupChannels().end() ; citChan++)
 		{
-			for (std::map<std::string const, User *const>::const_iterator citUser = citChan->second->begin(); citUser != citChan->second->end(); citUser++)
+			for (std::map<Identifier const, User *const>::const_iterator citUser = citChan->second->begin(); citUser != citChan->second->end(); citUser++)
 			{
 				if (citUser->second != &user && std::find(usersToNotice.begin(), usersToNotice.end(), citUser->second) == usersToNotice.end())
 					usersToNotice.push_back(citUser->second);
 			}
-			citChan->second->delUser(user.getNickname());
+			citChan->second->delUser(user.getNicknameId());
 		}
 		
 		for (std::list<User *>::const_iterator cit = usersToNotice.begin(); cit != usersToNotice.end(); cit++)
@@ -43,7 +47,9 @@ bool	Server::QUIT(User &user, std::string const &params)
 		}
 	}
 
-	close(user.getSocket());
-	user.setSocket(-1);
+	// The watchers are told at once, even if a job still holds the user.
+	if (!this->forgetNickname(user))
+		return false;
+	this->disconnect(user);
 	return true;
 }
@@ -0,0 +1,68 @@
+#include "class/ReadFileJob.hpp"
+#include "class/Server.hpp"
+#include "ft.hpp"
+
+/**
+ * @brief	Read the configuration file again, then the spam filter patterns.
+ * 			The new limits (RPL_ISUPPORT) hold for every user, but are only
+ * 			told to the ones registering from now on.
+ * 			This command is reserved for IRC operators.
+ * 			The patterns are read by a worker thread, see REHASHdone().
+ * 
+ * @param	user The user that ran the command.
+ * @param	params The parameters of the command.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::REHASH(User &user, ArenaString const &params __attribute__((unused)))
+{
+	Job	*job;
+
+	if (!user.hasMode(User::OPERATOR))
+		return this->replyNumeric<ERR_NOPRIVILEGES>(user);
+	if (!this->replyNumeric<RPL_REHASHING>(user, this->_configFile))
+		return false;
+	if (!this->_config.init(this->_configFile.c_str()))
+	{
+		Server::logMsg(ERROR, "REHASH: " + this->_configFile + " could not be read");
+		return this->notice(user, "REHASH: " + this->_configFile + " could not be read");
+	}
+	Server::logMsg(INTERNAL, "(" + ft::toString(user.getSocket()) + ") " + this->_configFile + " read again");
+	if (!this->initSupport())
+		return false;
+	if (this->_config["spam_filter"].empty())
+		return true;
+
+	try
+	{
+		job = new ReadFileJob(&user, &Server::REHASHdone, this->_config["spam_filter"]);
+	}
+	catch (std::exception const &e)
+	{
+		Server::logMsg(ERROR, "    Exception: " + std::string(e.what()));
+		return false;
+	}
+	return this->async(job);
+}
+
+/**
+ * @brief	Replace the spam filter patterns with the ones read by a worker
+ * 			thread, telling the operator how it went.
+ * 
+ * @param	job The completed ReadFileJob.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::REHASHdone(Job &job)
+{
+	User				&user = *job.getUser();
+	ReadFileJob const	&file = static_cast<ReadFileJob const &>(job);
+	std::string			error;
+
+	if (!this->loadSpamFilter(file, error))
+	{
+		Server::logMsg(ERROR, "Spam filter: " + this->_config["spam_filter"] + ": " + error);
+		return this->notice(user, "Spam filter: " + this->_config["spam_filter"] + ": " + error + ", patterns kept");
+	}
+	return this->notice(user, "Spam filter: " + ft::toString(static_cast<int>(this->_spamFilter.getSize())) + " patterns loaded");
+}
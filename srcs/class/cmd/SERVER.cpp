@@ -0,0 +1,50 @@
+#include "class/Server.hpp"
+#include "ft.hpp"
+
+/**
+ * @brief	Link a server to this one, once it sent the link password.
+ * 			The other linked servers are told about it, and it is told
+ * 			about the whole network.
+ * 
+ * @param	user The connection the command was sent on.
+ * @param	params The parameters of the command: `<name> <hops> :<description>`.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::SERVER(User &user, ArenaString const &params)
+{
+	t_params									args;
+	std::map<User *const, t_link>::iterator		it;
+	std::string									name;
+	t_server									server;
+
+	if (user.getState() == User::REGISTERED)
+		return this->replyNumeric<ERR_ALREADYREGISTRED>(user);
+	Server::splitParams(params, args);
+	if (args.size() < 3)
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "SERVER");
+	it = this->_lookupLinks.find(&user);
+	if (it == this->_lookupLinks.end() || !it->second.isAuthenticated ||
+		!user.getNicknameId().empty())
+		return this->dropLink(user, "Bad link password");
+	name.assign(args[0].data(), args[0].size());
+	if (name == this->_config["server_name"] || this->_lookupServers.count(name))
+		return this->dropLink(user, "Server exists: " + name);
+
+	user.setState(User::LINK);
+	user.setWaitingForPong(false);
+	this->forgetResolving(user);
+	it->second.name = name;
+	server.link = &user;
+	server.uplink = this->_config["server_name"];
+	server.description.assign(args[2].data(), args[2].size());
+	server.hops = 1U;
+	this->_lookupServers.insert(std::make_pair(name, server));
+	Server::logMsg(INTERNAL, "(" + ft::toString(user.getSocket()) + ") Linked to " + name + " (" + server.description + ')');
+
+	// A server linking to this one is answered with the same handshake.
+	if (it->second.target.empty() && !this->linkHandshake(user))
+		return false;
+	return this->propagate(&user, ArenaString(1, ':') + server.uplink + " SERVER " + name + " 2 :" + server.description) &&
+		this->burst(user);
+}
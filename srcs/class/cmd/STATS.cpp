@@ -0,0 +1,60 @@
+#include <sstream>
+#include "class/Server.hpp"
+#include "ft.hpp"
+
+/**
+ * @brief	Format a duration in microseconds, with a tenth of precision.
+ * 
+ * @param	ns The duration in nanoseconds.
+ * 
+ * @return	The formated duration.
+ */
+inline static std::string	__microseconds(uint64_t const ns)
+{
+	std::ostringstream	oss;
+
+	oss.setf(std::ios::fixed);
+	oss.precision(1);
+	oss << static_cast<double>(ns) / 1000.0 << "us";
+	return oss.str();
+}
+
+/**
+ * @brief	Get statistics about the server.
+ * 			This command is reserved for IRC operators.
+ * 			The supported queries are:
+ * 			- m: the number of calls and errors of each command
+ * 			- l: the p50, p99 and max latency of each command
+ * 
+ * @param	user The user that ran the command.
+ * @param	params The parameters of the command.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::STATS(User &user, ArenaString const &params)
+{
+	std::map<std::string const, t_cmdMetrics>::const_iterator	cit;
+	char														query;
+
+	if (params.empty())
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "STATS");
+	if (!user.hasMode(User::OPERATOR))
+		return this->replyNumeric<ERR_NOPRIVILEGES>(user);
+
+	query = params[0];
+	for (cit = this->_lookupCmdMetrics.begin() ; cit != this->_lookupCmdMetrics.end() ; ++cit)
+	{
+		if (cit->first.empty() || !*cit->second.calls)
+			continue ;
+		if (query == 'm' &&
+			!this->replyNumeric<RPL_STATSCOMMANDS>(user, cit->first, *cit->second.calls, *cit->second.errors))
+			return false;
+		if (query == 'l' &&
+			!this->replyNumeric<RPL_STATSLINKINFO>(user, cit->first,
+				__microseconds(cit->second.latency.percentile(0.50)),
+				__microseconds(cit->second.latency.percentile(0.99)),
+				__microseconds(cit->second.latency.getMax())))
+			return false;
+	}
+	return this->replyNumeric<RPL_ENDOFSTATS>(user, query);
+}
@@ -0,0 +1,53 @@
+#include "class/Server.hpp"
+
+/**
+ * @brief	Get or set the topic of a channel.
+ * 			When the channel has the mode t, only its operators
+ * 			and IRC operators can change the topic.
+ * 
+ * @param	user The user that ran the command.
+ * @param	params The parameters of the command.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::TOPIC(User &user, ArenaString const &params)
+{
+	std::string													channelName;
+	ArenaString::const_iterator									cit0;
+	ArenaString::const_iterator									cit1;
+	std::map<Identifier const, User *const>::const_iterator	cit2;
+	std::map<Identifier const, Channel>::iterator				it;
+
+	for (cit0 = params.begin(), cit1 = params.begin() ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
+	channelName = std::string(cit0, cit1);
+	if (channelName.empty())
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "TOPIC");
+
+	it = this->_lookupChannels.find(Identifier::find(channelName));
+	if (it == this->_lookupChannels.end())
+		return this->replyNumeric<ERR_NOSUCHCHANNEL>(user, channelName);
+	Channel	&chan = it->second;
+
+	if (chan.find(user.getNicknameId()) == chan.end())
+		return this->replyNumeric<ERR_NOTONCHANNEL>(user, channelName);
+
+	for ( ; cit1 != params.end() && *cit1 == ' ' ; ++cit1);
+	if (cit1 == params.end())
+	{
+		if (chan.getTopic().empty())
+			return this->replyNumeric<RPL_NOTOPIC>(user, channelName);
+		return this->replyNumeric<RPL_TOPIC>(user, channelName, chan.getTopic());
+	}
+
+	if (chan.hasMode(Channel::TOPIC_LOCK) && !(chan.getMemberModes(user) & Channel::CHANOP) && !user.hasMode(User::OPERATOR))
+		return this->replyNumeric<ERR_CHANOPRIVSNEEDED>(user, channelName);
+
+	if (*cit1 == ':')
+		++cit1;
+	chan.setTopic(std::string(cit1, params.end()));
+	for (cit2 = chan.begin() ; cit2 != chan.end() ; ++cit2)
+		if (!this->replyPush(*cit2->second, ':' + user.getMask() + " TOPIC " + channelName + " :" + chan.getTopic()) ||
+			(cit2->second != &user && !this->replySend(*cit2->second)))
+			return false;
+	return true;
+}
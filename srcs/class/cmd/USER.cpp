@@ -1,8 +1,9 @@
 #include "class/Server.hpp"
 
 /**
- * @brief	Set a new username, hostname and realname for an user.
- * 			Set the user mask accordingly.
+ * @brief	Set a new username and realname for an user.
+ * 			The hostname and servname given by the client are ignored,
+ * 			the hostname resolved from its address being used instead.
  * 			If everything is correct, the command set the user as registered.
  * 
  * @param	user The user that ran the command.
@@ -10,70 +11,57 @@
  * 
  * @return	true if success, false otherwise.
  */
-bool	Server::USER(User &user, std::string const &params)
+bool	Server::USER(User &user, ArenaString const &params)
 {
 	std::string					username;
 	std::string					hostname;
 	std::string					servname;
 	std::string					realname;
-	std::string::const_iterator	cit0;
-	std::string::const_iterator	cit1;
+	ArenaString::const_iterator	cit0;
+	ArenaString::const_iterator	cit1;
 
-	if (user.getIsRegistered())
-		return this->replyPush(user, "462 :You may not reregister");
+	if (user.getState() == User::REGISTERED)
+		return this->replyNumeric<ERR_ALREADYREGISTRED>(user);
 
 	for (cit0 = params.begin(), cit1 = params.begin() ; cit0 != params.end() && *cit1 != ' ' ; ++cit1);
 	username = std::string(cit0, cit1);
 	if (username.empty())
-		return this->replyPush(user, "461 " + user.getNickname() + " USER :Not enough parameters");
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "USER");
 	user.setUsername(username);
 
 	for ( ; cit1 != params.end() && *cit1 == ' ' ; ++cit1);
 	for (cit0 = cit1 ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
 	hostname = std::string(cit0, cit1);
 	if (hostname.empty())
-		return this->replyPush(user, "461 " + user.getNickname() + " USER :Not enough parameters");
-	user.setHostname(hostname);
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "USER");
 
 	for ( ; cit1 != params.end() && *cit1 == ' ' ; ++cit1);
 	for (cit0 = cit1 ; cit1 != params.end() && *cit1 != ' ' ; ++cit1);
 	servname = std::string(cit0, cit1);
 	if (servname.empty())
-		return this->replyPush(user, "461 " + user.getNickname() + " USER :Not enough parameters");
-	user.setServname(servname);
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "USER");
 
 	for ( ; cit1 != params.end() && *cit1 == ' ' ; ++cit1);
-	realname = std::string(cit0, static_cast<std::string::const_iterator>(params.end()));
+	realname = std::string(cit0, static_cast<ArenaString::const_iterator>(params.end()));
 	if (realname.empty())
-		return this->replyPush(user, "461 " + user.getNickname() + " USER :Not enough parameters");
+		return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "USER");
 	if (*realname.begin() == ':')
 	{
 		realname.erase(realname.begin());
 		if (realname.empty())
-			return this->replyPush(user, "461 " + user.getNickname() + " USER :Not enough parameters");
+			return this->replyNumeric<ERR_NEEDMOREPARAMS>(user, "USER");
 	}
 	else if (realname.find(' ') != std::string::npos)
 		realname.erase(realname.find(' '));
 	user.setRealname(realname);
 
-	if (!this->_config["server_password"].empty() &&
-		user.getPassword() != this->_config["server_password"])
+	if (user.getState() == User::CONNECTED)
 	{
-		if (!this->replyPush(user, "464 " + user.getNickname() + " :Password incorrect") ||
+		if (!this->replyNumeric<ERR_PASSWDMISMATCH>(user) ||
 			!this->replySend(user))
 			return false;
-		close(user.getSocket());
-		user.setSocket(-1);
+		this->disconnect(user);
 		return true;
 	}
-	user.setIsRegistered(true);
-	user.setMask();
-
-	std::string	motdParams("");
-
-	return this->replyPush(user, "001 " + user.getNickname() + " :Welcome to the Mine, " + user.getMask() + '.')
-		&& this->replyPush(user, "002 " + user.getNickname() + " :Your host is " + this->_config["server_name"] + ", running version " + this->_config["server_version"] + '.')
-		&& this->replyPush(user, "003 " + user.getNickname() + " :This server was created " + this->_creationTime + '.')
-		&& this->replyPush(user, "004 " + user.getNickname() + " :" + this->_config["server_name"] + " " + this->_config["server_version"] + ' ' + User::getAvailableModes() + ' ' + Channel::getAvailableModes() + '.')
-		&& this->MOTD(user, motdParams);
+	return this->registerUser(user);
 }
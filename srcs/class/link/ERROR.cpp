@@ -0,0 +1,18 @@
+#include "class/Server.hpp"
+
+/**
+ * @brief	Close a link on the error the linked server sent before closing it.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The server the error comes from.
+ * @param	params The parameters of the command: `:<text>`.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkERROR(User &link, ArenaString const &source __attribute__((unused)), ArenaString const &params)
+{
+	t_params	args;
+
+	Server::splitParams(params, args);
+	return this->dropLink(link, args.empty() ? std::string("Link error") : std::string(args[0].data(), args[0].size()));
+}
@@ -0,0 +1,42 @@
+#include "class/Server.hpp"
+
+/**
+ * @brief	Kick an user from a channel on behalf of another server,
+ * 			telling the members connected to this server.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The user, or the server, kicking.
+ * @param	params The parameters of the command: `<channel> <nickname> :<reason>`.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkKICK(User &link, ArenaString const &source, ArenaString const &params)
+{
+	t_params												args;
+	User													*kicker;
+	ArenaString												reason;
+	std::map<Identifier const, Channel>::iterator			it;
+	std::map<Identifier const, User *const>::iterator		itUser;
+
+	Server::splitParams(params, args);
+	if (args.size() < 2)
+		return true;
+	reason = args.size() > 2 ? args[2] : source;
+	it = this->_lookupChannels.find(Identifier::find(args[0]));
+	if (it == this->_lookupChannels.end())
+		return true;
+	itUser = it->second.find(std::string(args[1].data(), args[1].size()));
+	if (itUser == it->second.end())
+		return true;
+	User	&userToKick = *itUser->second;
+
+	kicker = this->findRemote(link, source);
+	if (!this->localSend(it->second, NULL, ArenaString(1, ':') + (kicker ? ArenaString(kicker->getMask().data(), kicker->getMask().size()) : source) + " KICK " + it->second.getName() + ' ' + userToKick.getNickname() + " :" + reason) ||
+		!this->propagate(&link, ArenaString(1, ':') + source + " KICK " + it->second.getName() + ' ' + userToKick.getNickname() + " :" + reason))
+		return false;
+	it->second.delUser(userToKick.getNicknameId());
+	userToKick.delChannel(it->first);
+	if (it->second.empty())
+		this->_lookupChannels.erase(it);
+	return true;
+}
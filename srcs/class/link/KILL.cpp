@@ -0,0 +1,42 @@
+#include "class/Server.hpp"
+
+/**
+ * @brief	Remove an user from the network on behalf of another server,
+ * 			either killed by an operator or on a nickname collision.
+ * 			A KILL naming an user by its timestamp is ignored when the user
+ * 			now having the nickname took it at another time: the user it was
+ * 			meant for already lost a collision, and the one left won it.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The user, or the server, killing.
+ * @param	params The parameters of the command:
+ * 			`<nickname> [<timestamp>] :<reason>`.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkKILL(User &link, ArenaString const &source, ArenaString const &params)
+{
+	t_params												args;
+	User													*killer;
+	std::string												reason;
+	std::map<Identifier const, User *const>::const_iterator	cit;
+
+	Server::splitParams(params, args);
+	if (args.empty())
+		return true;
+	cit = this->_lookupUsers.find(Identifier::find(args[0]));
+	if (cit == this->_lookupUsers.end())
+		return true;
+	if (args.size() > 2 &&
+		std::strtol(args[1].c_str(), NULL, 10) != static_cast<long>(cit->second->getTimestamp()))
+	{
+		Server::logMsg(INTERNAL, "    KILL of " + cit->second->getNickname() + " from another time ignored");
+		return true;
+	}
+	if (args.size() > 1)
+		reason.assign(args.back().data(), args.back().size());
+	else
+		reason.assign(source.data(), source.size());
+	killer = this->findRemote(link, source);
+	return this->kill(*cit->second, killer ? killer->getMask() : std::string(source.data(), source.size()), std::string(source.data(), source.size()), reason, &link);
+}
@@ -0,0 +1,98 @@
+#include "class/Server.hpp"
+#include "ft.hpp"
+
+/**
+ * @brief	Either add an user of another server to the network, or change
+ * 			the nickname of one, telling the other linked servers.
+ * 			An user introduced with 7 parameters comes from its server, a
+ * 			nickname change with 2 parameters from the user itself.
+ * 			Two users taking the same nickname collide: the one that took it
+ * 			first keeps it, the other one is killed, and both are killed
+ * 			when they took it at the same time.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The server of the new user, or the user renamed.
+ * @param	params The parameters of the command, either
+ * 			`<nickname> <hops> <timestamp> <modes> <username> <hostname> :<realname>`
+ * 			or `<nickname> :<timestamp>`.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkNICK(User &link, ArenaString const &source, ArenaString const &params)
+{
+	std::string const										name = this->_config["server_name"];
+	t_params												args;
+	std::map<std::string const, t_server>::const_iterator	server;
+	std::map<Identifier const, User *const>::const_iterator	cit;
+	ArenaString::const_iterator								itMode;
+	ArenaString												former;
+	User													*user;
+	time_t													timestamp;
+	bool													isUserKept;
+
+	server = this->_lookupServers.end();
+	Server::splitParams(params, args);
+	if (args.empty() || (args.size() > 1 && args.size() < 7 && args.size() != 2))
+		return true;
+	timestamp = args.size() >= 7 ? std::strtol(args[2].c_str(), NULL, 10) :
+		args.size() == 2 ? std::strtol(args[1].c_str(), NULL, 10) : this->_clock->now();
+	if (args.size() >= 7)
+	{
+		server = this->_lookupServers.find(std::string(source.data(), source.size()));
+		user = NULL;
+		if (server == this->_lookupServers.end() || server->second.link != &link)
+			return true;
+	}
+	else if (!(user = this->findRemote(link, source)))
+		return true;
+
+	cit = this->_lookupUsers.find(Identifier::find(args[0]));
+	if (cit != this->_lookupUsers.end() && cit->second != user)
+	{
+		User	&other = *cit->second;
+
+		isUserKept = timestamp < other.getTimestamp();
+		Server::logMsg(INTERNAL, "    Nick collision on " + other.getNickname() + " with " + source);
+		if (timestamp <= other.getTimestamp() &&
+			!this->kill(other, name, name, "Nick collision", &link))
+			return false;
+		if (!isUserKept)
+		{
+			// The KILL names the loser by its timestamp too, not to hit the winner.
+			if (!this->linkSend(link, ArenaString(1, ':') + name + " KILL " + args[0] + ' ' + ft::toString(static_cast<int>(timestamp)) + " :Nick collision"))
+				return false;
+			if (!user)
+				return true;
+			// The other servers know the user by its former nickname.
+			if (!this->propagate(&link, ArenaString(1, ':') + name + " KILL " + user->getNickname() + ' ' + ft::toString(static_cast<int>(user->getTimestamp())) + " :Nick collision") ||
+				!this->quitChannels(*user, "Nick collision"))
+				return false;
+			return this->removeRemoteUser(*user);
+		}
+	}
+
+	if (user)
+	{
+		former.assign(user->getNickname().data(), user->getNickname().size());
+		user->setTimestamp(timestamp);
+		return this->rename(*user, std::string(args[0].data(), args[0].size())) &&
+			this->propagate(&link, ArenaString(1, ':') + former + " NICK " + user->getNickname() + " :" + ft::toString(static_cast<int>(timestamp)));
+	}
+	this->_remoteUsers.push_back(User());
+	user = &this->_remoteUsers.back();
+	this->_lookupRemoteUsers.insert(std::make_pair(user, --this->_remoteUsers.end()));
+	user->setNickname(std::string(args[0].data(), args[0].size()));
+	user->setTimestamp(timestamp);
+	for (itMode = args[3].begin() ; itMode != args[3].end() ; ++itMode)
+		user->addModes(User::getModeBit(*itMode));
+	user->setUsername(std::string(args[4].data(), args[4].size()));
+	user->setHostname(std::string(args[5].data(), args[5].size()));
+	user->setRealname(std::string(args[6].data(), args[6].size()));
+	user->setLink(&link);
+	user->setServer(&server->first);
+	user->setState(User::REGISTERED);
+	user->setMask();
+	this->_lookupUsers.insert(std::pair<Identifier const, User *const>(user->getNicknameId(), user));
+	return this->propagate(&link, this->introduce(*user)) &&
+		this->notifyWatchers(user->getNicknameId(), true, user->getMask());
+}
@@ -0,0 +1,46 @@
+#include "class/Server.hpp"
+
+/**
+ * @brief	Make an user of another server leaving one or more channel(s),
+ * 			telling the members connected to this server.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The user leaving.
+ * @param	params The parameters of the command: `<channel>{,<channel>} :<reason>`.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkPART(User &link, ArenaString const &source, ArenaString const &params)
+{
+	t_params										args;
+	User											*user;
+	ArenaString										reason;
+	ArenaString										channelName;
+	ArenaString::size_type							pos;
+	ArenaString::size_type							end;
+	std::map<Identifier const, Channel>::iterator	it;
+
+	user = this->findRemote(link, source);
+	Server::splitParams(params, args);
+	if (!user || args.empty())
+		return true;
+	if (args.size() > 1)
+		reason = args[1];
+	for (pos = 0 ; pos < args[0].size() ; pos = end + 1)
+	{
+		end = args[0].find(',', pos);
+		if (end == ArenaString::npos)
+			end = args[0].size();
+		channelName = args[0].substr(pos, end - pos);
+		it = this->_lookupChannels.find(Identifier::find(channelName));
+		if (it == this->_lookupChannels.end() || it->second.find(user->getNicknameId()) == it->second.end())
+			continue ;
+		if (!this->localSend(it->second, user, ArenaString(1, ':') + user->getMask() + " PART " + it->second.getName() + " :" + reason))
+			return false;
+		it->second.delUser(user->getNicknameId());
+		user->delChannel(it->first);
+		if (it->second.empty())
+			this->_lookupChannels.erase(it);
+	}
+	return this->propagate(&link, ArenaString(1, ':') + user->getNickname() + " PART " + args[0] + " :" + reason);
+}
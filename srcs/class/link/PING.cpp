@@ -0,0 +1,33 @@
+#include "class/Server.hpp"
+
+/**
+ * @brief	Answer a linked server checking the link is alive.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The server that sent the command.
+ * @param	params The parameters of the command: `:<token>`.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkPING(User &link, ArenaString const &source __attribute__((unused)), ArenaString const &params)
+{
+	t_params	args;
+
+	Server::splitParams(params, args);
+	return this->linkSend(link, ArenaString(1, ':') + this->_config["server_name"] + " PONG " + this->_config["server_name"] + " :" + (args.empty() ? ArenaString() : args[0]));
+}
+
+/**
+ * @brief	Take the answer of a linked server to the PING checking the link.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The server that sent the command.
+ * @param	params The parameters of the command.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkPONG(User &link, ArenaString const &source __attribute__((unused)), ArenaString const &params __attribute__((unused)))
+{
+	link.setWaitingForPong(false);
+	return true;
+}
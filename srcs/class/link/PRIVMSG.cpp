@@ -0,0 +1,54 @@
+#include "class/Server.hpp"
+
+/**
+ * @brief	Deliver a message from an user of another server, either to
+ * 			a channel or to an user, forwarding it to the linked servers
+ * 			it has to go through.
+ * 			The message was checked by the server of its sender, and
+ * 			a message to a channel is kept in its history.
+ * 			The message is tagged for the users asking for it.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The user that sent the message.
+ * @param	params The parameters of the command: `<target> :<text>`.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkPRIVMSG(User &link, ArenaString const &source, ArenaString const &params)
+{
+	t_params												args;
+	ArenaString												line;
+	User													*user;
+	std::map<Identifier const, Channel>::iterator			it;
+	std::map<Identifier const, User *const>::const_iterator	itUser;
+
+	user = this->findRemote(link, source);
+	Server::splitParams(params, args);
+	if (!user || args.size() < 2)
+		return true;
+	if (args[0][0] == '#')
+	{
+		it = this->_lookupChannels.find(Identifier::find(args[0]));
+		if (it == this->_lookupChannels.end())
+			return true;
+		line = ArenaString(1, ':') + user->getMask() + " PRIVMSG " + it->second.getName() + " :" + args[1];
+
+		TaggedLine	tagged(line, this->_history.newMsgid(), this->_clock->milliseconds());
+
+		this->keepHistory(it->second, tagged);
+		return this->localSend(it->second, user, tagged) &&
+			this->propagateChannel(it->second, &link, ArenaString(1, ':') + user->getNickname() + " PRIVMSG " + it->second.getName() + " :" + args[1]);
+	}
+	itUser = this->_lookupUsers.find(Identifier::find(args[0]));
+	if (itUser == this->_lookupUsers.end())
+		return true;
+	if (itUser->second->getSocket() == -1 && itUser->second->isRemote())
+		return itUser->second->getLink() == &link ||
+			this->linkSend(*itUser->second->getLink(), ArenaString(1, ':') + user->getNickname() + " PRIVMSG " + itUser->second->getNickname() + " :" + args[1]);
+	line = ArenaString(1, ':') + user->getMask() + " PRIVMSG " + itUser->second->getNickname() + " :" + args[1];
+
+	TaggedLine	tagged(line, this->_history.newMsgid(), this->_clock->milliseconds());
+
+	return this->replyPush(*itUser->second, tagged.get(itUser->second->getCaps())) &&
+		this->replySend(*itUser->second);
+}
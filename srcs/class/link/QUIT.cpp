@@ -0,0 +1,28 @@
+#include "class/Server.hpp"
+
+/**
+ * @brief	Forget an user of another server that left the network,
+ * 			telling the members of its channels.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The user that quit.
+ * @param	params The parameters of the command: `:<reason>`.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkQUIT(User &link, ArenaString const &source, ArenaString const &params)
+{
+	t_params	args;
+	User		*user;
+	std::string	reason;
+
+	user = this->findRemote(link, source);
+	if (!user)
+		return true;
+	Server::splitParams(params, args);
+	if (!args.empty())
+		reason.assign(args[0].data(), args[0].size());
+	return this->quitChannels(*user, reason) &&
+		this->propagate(&link, ArenaString(1, ':') + user->getNickname() + " QUIT :" + reason) &&
+		this->removeRemoteUser(*user);
+}
@@ -0,0 +1,37 @@
+#include "class/Server.hpp"
+#include "ft.hpp"
+
+/**
+ * @brief	Add a server joining the network behind a linked server, telling
+ * 			the other linked servers about it.
+ * 			A server already known means the network has a loop: the link
+ * 			it comes from is closed.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The server the new one is linked to.
+ * @param	params The parameters of the command: `<name> <hops> :<description>`.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkSERVER(User &link, ArenaString const &source, ArenaString const &params)
+{
+	t_params		args;
+	std::string		name;
+	t_server		server;
+
+	Server::splitParams(params, args);
+	if (args.size() < 3)
+		return true;
+	name.assign(args[0].data(), args[0].size());
+	if (name == this->_config["server_name"] || this->_lookupServers.count(name))
+		return this->dropLink(link, "Server exists: " + name);
+	server.link = &link;
+	server.uplink.assign(source.data(), source.size());
+	server.description.assign(args[2].data(), args[2].size());
+	server.hops = static_cast<unsigned int>(std::strtol(args[1].c_str(), NULL, 10));
+	if (!server.hops)
+		server.hops = 2U;
+	this->_lookupServers.insert(std::make_pair(name, server));
+	Server::logMsg(INTERNAL, "    Server " + name + " joined the network behind " + server.uplink);
+	return this->propagate(&link, ArenaString(1, ':') + source + " SERVER " + name + ' ' + ft::toString(static_cast<int>(server.hops + 1)) + " :" + server.description);
+}
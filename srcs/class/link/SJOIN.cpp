@@ -0,0 +1,136 @@
+#include "class/Server.hpp"
+#include "ft.hpp"
+
+/**
+ * @brief	Make users of another server joining a channel, telling the
+ * 			members connected to this server and the other linked servers.
+ * 			Of two versions of a channel, the one created first wins: its
+ * 			modes and the statuses of its members are kept, those of the other
+ * 			one are dropped. Versions created at the same time are merged.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The server of the users.
+ * @param	params The parameters of the command:
+ * 			`<timestamp> <channel> <modes> [<mode parameters>] :<members>`,
+ * 			each member prefixed by `@` if operator and `+` if voiced.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkSJOIN(User &link, ArenaString const &source, ArenaString const &params)
+{
+	std::string const										name = this->_config["server_name"];
+	t_params												args;
+	std::map<Identifier const, Channel>::iterator			it;
+	std::map<Identifier const, User *const>::iterator		itUser;
+	Channel::t_modeDef const								*modeDef;
+	ArenaString::const_iterator								itMode;
+	ArenaString												members;
+	ArenaString												nickname;
+	ArenaString::size_type									pos;
+	ArenaString::size_type									end;
+	User													*user;
+	time_t													timestamp;
+	size_t													idxParam;
+	unsigned int											memberModes;
+	bool													isCreated;
+	bool													isAccepted;
+
+	Server::splitParams(params, args);
+	if (args.size() < 4 || args[1][0] != '#')
+		return true;
+	timestamp = std::strtol(args[0].c_str(), NULL, 10);
+	it = this->_lookupChannels.find(Identifier::find(args[1]));
+	isCreated = it == this->_lookupChannels.end();
+	if (isCreated)
+	{
+		Channel	newChannel(std::string(args[1].data(), args[1].size()));
+
+		newChannel.setTimestamp(timestamp);
+		it = this->_lookupChannels.insert(std::pair<Identifier const, Channel>(newChannel.getNameId(), newChannel)).first;
+		// The version of the network wins over the one of the snapshot.
+		this->forgetDormant(newChannel.getNameId());
+	}
+	Channel	&chan = it->second;
+	isAccepted = isCreated || timestamp <= chan.getTimestamp();
+
+	// The version of this server is the newer one: its modes and statuses go.
+	if (timestamp < chan.getTimestamp())
+	{
+		if (chan.getModes() &&
+			!this->localSend(chan, NULL, ArenaString(1, ':') + name + " MODE " + chan.getName() + " -" + chan.getModeString(false).substr(1)))
+			return false;
+		chan.setModes(0U);
+		chan.setKey("");
+		chan.setLimit(0U);
+		for (itUser = chan.begin() ; itUser != chan.end() ; ++itUser)
+		{
+			memberModes = chan.getMemberModes(*itUser->second);
+			if ((memberModes & Channel::CHANOP) &&
+				!this->localSend(chan, NULL, ArenaString(1, ':') + name + " MODE " + chan.getName() + " -o " + itUser->second->getNickname()))
+				return false;
+			if ((memberModes & Channel::VOICE) &&
+				!this->localSend(chan, NULL, ArenaString(1, ':') + name + " MODE " + chan.getName() + " -v " + itUser->second->getNickname()))
+				return false;
+			chan.delMemberModes(*itUser->second, memberModes);
+		}
+		chan.setTimestamp(timestamp);
+	}
+	if (isAccepted)
+		for (itMode = args[2].begin(), idxParam = 3UL ; itMode != args[2].end() ; ++itMode)
+		{
+			modeDef = Channel::getModeDef(*itMode);
+			if (!modeDef || modeDef->type == Channel::LIST || modeDef->type == Channel::MEMBER)
+				continue ;
+			if (modeDef->bit == Channel::KEY && idxParam + 1 < args.size())
+				chan.setKey(std::string(args[idxParam].data(), args[idxParam].size()));
+			else if (modeDef->bit == Channel::LIMIT && idxParam + 1 < args.size())
+				chan.setLimit(static_cast<unsigned int>(std::strtol(args[idxParam].c_str(), NULL, 10)));
+			if (modeDef->type != Channel::FLAG)
+				++idxParam;
+			chan.addModes(modeDef->bit);
+		}
+
+	for (pos = 0 ; pos < args.back().size() ; pos = end + 1)
+	{
+		end = args.back().find(' ', pos);
+		if (end == ArenaString::npos)
+			end = args.back().size();
+		nickname = args.back().substr(pos, end - pos);
+		for (memberModes = 0U ; !nickname.empty() && (nickname[0] == '@' || nickname[0] == '+') ; nickname.erase(0, 1))
+			memberModes |= nickname[0] == '@' ? Channel::CHANOP : Channel::VOICE;
+		user = this->findRemote(link, nickname);
+		if (!user)
+			continue ;
+		if (chan.find(user->getNicknameId()) == chan.end())
+		{
+			chan.addUser(*user);
+			user->addChannel(chan);
+			if (!this->localSend(chan, user, ArenaString(1, ':') + user->getMask() + " JOIN " + chan.getName()))
+				return false;
+		}
+		if (!isAccepted)
+			memberModes = 0U;
+		chan.addMemberModes(*user, memberModes);
+		if ((memberModes & Channel::CHANOP) &&
+			!this->localSend(chan, NULL, ArenaString(1, ':') + name + " MODE " + chan.getName() + " +o " + user->getNickname()))
+			return false;
+		if ((memberModes & Channel::VOICE) &&
+			!this->localSend(chan, NULL, ArenaString(1, ':') + name + " MODE " + chan.getName() + " +v " + user->getNickname()))
+			return false;
+		if (!members.empty())
+			members += ' ';
+		if (memberModes & Channel::CHANOP)
+			members += '@';
+		if (memberModes & Channel::VOICE)
+			members += '+';
+		members += user->getNickname();
+	}
+	if (chan.empty())
+	{
+		this->_lookupChannels.erase(it);
+		return true;
+	}
+	if (members.empty())
+		return true;
+	return this->propagate(&link, ArenaString(1, ':') + source + " SJOIN " + ft::toString(static_cast<int>(chan.getTimestamp())) + ' ' + chan.getName() + ' ' + (isAccepted ? chan.getModeString(true) : std::string("+")) + " :" + members);
+}
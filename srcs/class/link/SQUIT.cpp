@@ -0,0 +1,36 @@
+#include "class/Server.hpp"
+
+/**
+ * @brief	Forget a server that left the network behind a linked server,
+ * 			telling the other linked servers.
+ * 			A linked server asking this one, or itself, to leave is unlinked.
+ * 
+ * @param	link The connection the command was sent on.
+ * @param	source The server or the operator that removed the server.
+ * @param	params The parameters of the command: `<name> :<reason>`.
+ * 
+ * @return	true if success, false otherwise.
+ */
+bool	Server::linkSQUIT(User &link, ArenaString const &source, ArenaString const &params)
+{
+	t_params												args;
+	std::string												name;
+	std::string												reason;
+	std::map<std::string const, t_server>::const_iterator	cit;
+
+	Server::splitParams(params, args);
+	if (args.empty())
+		return true;
+	name.assign(args[0].data(), args[0].size());
+	if (args.size() > 1)
+		reason.assign(args[1].data(), args[1].size());
+	else
+		reason.assign(source.data(), source.size());
+	if (name == this->_config["server_name"] || name == this->_lookupLinks[&link].name)
+		return this->dropLink(link, reason);
+	cit = this->_lookupServers.find(name);
+	if (cit == this->_lookupServers.end() || cit->second.link != &link)
+		return true;
+	return this->propagate(&link, ArenaString(1, ':') + source + " SQUIT " + name + " :" + reason) &&
+		this->squit(name, reason);
+}
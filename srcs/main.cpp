@@ -5,8 +5,10 @@
 #include "color.h"
 #include "class/Config.hpp"
 #include "class/Server.hpp"
+#include "ft.hpp"
 
 bool	g_interrupted = false;
+bool	g_upgrade = false;
 
 void	sigintHandler(int const sig __attribute__((unused)))
 {
@@ -14,6 +16,11 @@ void	sigintHandler(int const sig __attribute__((unused)))
 	std::cout << "\b\b";
 }
 
+void	sigusr2Handler(int const sig __attribute__((unused)))
+{
+	g_upgrade = true;
+}
+
 inline static bool	__getPort(std::string const str, uint16_t &port)
 {
 	std::string::const_iterator it;
@@ -40,17 +47,35 @@ int	main(int const argc, char const *const *const argv)
 	Server		server;
 	uint16_t	port;
 
-	if (argc != 3)
+	if (argc != 3 && argc != 4)
 	{
 		std::cerr
 		<< RED_FG "Error: Wrong usage\n"
-		<< YELLOW_FG "./ircserv <port> <password>\n"
+		<< YELLOW_FG "./ircserv <port> <password> [config file]\n"
+		<< YELLOW_FG "./ircserv --hash <password>\n"
 		<< RESET;
 		return EXIT_FAILURE;
 	}
+	if (argc == 3 && !std::string(argv[1]).compare("--hash"))
+	{
+		std::string const	hash = ft::hashPassword(argv[2]);
+
+		if (hash.empty())
+			return EXIT_FAILURE;
+		std::cout << hash << '\n';
+		return EXIT_SUCCESS;
+	}
 	signal(SIGINT, sigintHandler);
-	if (!__getPort(argv[1], port) ||
-		!server.init(argv[2]) ||
+	signal(SIGUSR2, sigusr2Handler);
+	// Started by a server handing itself over, see Server::upgrade().
+	if (argc == 3 && !std::string(argv[1]).compare("--upgrade"))
+	{
+		if (!server.resume(static_cast<int>(std::strtol(argv[2], NULL, 10))) ||
+			!server.run())
+			return EXIT_FAILURE;
+	}
+	else if (!__getPort(argv[1], port) ||
+		!server.init(argv[2], argc == 4 ? argv[3] : CONFIG_FILE) ||
 		!server.start(port) ||
 		!server.run())
 		return EXIT_FAILURE;
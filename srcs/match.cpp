@@ -0,0 +1,45 @@
+#include <cctype>
+#include "ft.hpp"
+
+/**
+ * @brief	Check if a string matches a mask, case insensitively.
+ * 			In the mask, `*` matches any sequence of characters,
+ * 			and `?` matches any single character.
+ * 
+ * @param	mask The mask to match.
+ * @param	str The string to check.
+ * 
+ * @return	Either true if the string matches the mask, or false if not.
+ */
+bool	ft::match(std::string const &mask, std::string const &str)
+{
+	std::string::size_type	m = 0;
+	std::string::size_type	s = 0;
+	std::string::size_type	star = std::string::npos;
+	std::string::size_type	backtrack = 0;
+
+	while (s < str.size())
+	{
+		if (m < mask.size() && mask[m] == '*')
+		{
+			star = m++;
+			backtrack = s;
+		}
+		else if (m < mask.size() &&
+			(mask[m] == '?' || tolower(static_cast<unsigned char>(mask[m])) == tolower(static_cast<unsigned char>(str[s]))))
+		{
+			++m;
+			++s;
+		}
+		else if (star != std::string::npos)
+		{
+			m = star + 1;
+			s = ++backtrack;
+		}
+		else
+			return false;
+	}
+	while (m < mask.size() && mask[m] == '*')
+		++m;
+	return m == mask.size();
+}
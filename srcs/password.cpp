@@ -0,0 +1,50 @@
+#include <crypt.h>
+#include <cstring>
+#include "ft.hpp"
+
+/**
+ * @brief	Check a password against a bcrypt hash.
+ * 			This is slow on purpose: only call it from a worker thread.
+ * 
+ * @param	password The plaintext password to check.
+ * @param	hash The hash to check the password against.
+ * 
+ * @return	Either true if the password matches the hash, or false if not.
+ */
+bool	ft::checkPassword(std::string const &password, std::string const &hash)
+{
+	crypt_data		data;
+	char const		*output;
+	size_t			idx;
+	unsigned char	diff;
+
+	memset(&data, 0, sizeof(data));
+	output = crypt_r(password.c_str(), hash.c_str(), &data);
+	if (!output || *output == '*' || strlen(output) != hash.size())
+		return false;
+	for (idx = 0, diff = 0 ; idx < hash.size() ; ++idx)
+		diff |= static_cast<unsigned char>(output[idx] ^ hash[idx]);
+	return !diff;
+}
+
+/**
+ * @brief	Hash a password with bcrypt and a random salt.
+ * 
+ * @param	password The plaintext password to hash.
+ * 
+ * @return	The hash of the password, or an empty string if an error occured.
+ */
+std::string	ft::hashPassword(std::string const &password)
+{
+	crypt_data	data;
+	char		salt[CRYPT_GENSALT_OUTPUT_SIZE];
+	char const	*output;
+
+	if (!crypt_gensalt_rn("$2b$", PASSWORD_COST, NULL, 0, salt, sizeof(salt)))
+		return std::string();
+	memset(&data, 0, sizeof(data));
+	output = crypt_r(password.c_str(), salt, &data);
+	if (!output || *output == '*')
+		return std::string();
+	return std::string(output);
+}